@@ -0,0 +1,124 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <bench/Bench.h>
+#include <vw/Core/Exception.h>
+#include <vw/Core/Stopwatch.h>
+
+#include <algorithm>
+#include <iomanip>
+#include <ostream>
+
+namespace vw {
+namespace bench {
+
+  double BenchResult::percentile( double p ) const {
+    if ( seconds.empty() )
+      return 0;
+    double rank = p / 100 * ( seconds.size() - 1 );
+    size_t below = size_t( rank );
+    if ( below + 1 >= seconds.size() )
+      return seconds.back();
+    double fraction = rank - below;
+    return seconds[below] * ( 1 - fraction ) + seconds[below+1] * fraction;
+  }
+
+  double BenchResult::pixels_per_second() const {
+    double t = median();
+    return t > 0 ? pixels / t : 0;
+  }
+
+  double BenchResult::bytes_per_second() const {
+    double t = median();
+    return t > 0 ? bytes / t : 0;
+  }
+
+  std::vector<boost::shared_ptr<Benchmark> >& benchmarks() {
+    // Constructed on first use, since registrars run during static
+    // initialization in no particular order.
+    static std::vector<boost::shared_ptr<Benchmark> > registry;
+    return registry;
+  }
+
+  BenchmarkRegistrar::BenchmarkRegistrar( Benchmark* benchmark ) {
+    benchmarks().push_back( boost::shared_ptr<Benchmark>( benchmark ) );
+  }
+
+  BenchResult run_benchmark( Benchmark& benchmark, BenchConfig const& config ) {
+    VW_ASSERT( config.repetitions > 0, ArgumentErr() << "run_benchmark: need at least one repetition." );
+
+    BenchResult result;
+    result.name = benchmark.name();
+    benchmark.setup( config );
+    result.pixels = benchmark.pixels();
+    result.bytes  = benchmark.bytes();
+
+    for ( int32 i = 0; i < config.warmup; i++ )
+      benchmark.run();
+    for ( int32 i = 0; i < config.repetitions; i++ ) {
+      uint64 start = Stopwatch::microtime();
+      benchmark.run();
+      result.seconds.push_back( ( Stopwatch::microtime() - start ) / 1e6 );
+    }
+    benchmark.teardown();
+
+    std::sort( result.seconds.begin(), result.seconds.end() );
+    return result;
+  }
+
+  void write_summary( std::ostream& os, BenchResult const& result ) {
+    std::ios::fmtflags flags = os.flags();
+    os << std::left << std::setw(32) << result.name << std::right << std::fixed
+       << std::setprecision(4) << std::setw(10) << result.median() << " s  "
+       << "[p10 " << result.percentile(10) << ", p90 " << result.percentile(90) << "]  "
+       << std::setprecision(1) << std::setw(8) << result.pixels_per_second() / 1e6 << " Mpix/s  "
+       << std::setw(8) << result.bytes_per_second() / ( 1 << 20 ) << " MiB/s\n";
+    os.flags( flags );
+  }
+
+  void write_json( std::ostream& os, BenchConfig const& config, std::vector<BenchResult> const& results ) {
+    std::ios::fmtflags flags = os.flags();
+    std::streamsize precision = os.precision( 9 );
+    os << "{\n"
+       << "  \"config\": { \"size\": " << config.size << ", \"threads\": " << config.threads
+       << ", \"warmup\": " << config.warmup << ", \"repetitions\": " << config.repetitions << " },\n"
+       << "  \"benchmarks\": [";
+    for ( size_t i = 0; i < results.size(); i++ ) {
+      BenchResult const& r = results[i];
+      // Names are plain identifiers, so need no escaping
+      os << ( i ? ",\n" : "\n" )
+         << "    { \"name\": \"" << r.name << "\""
+         << ", \"pixels\": " << r.pixels << ", \"bytes\": " << r.bytes
+         << ", \"median_seconds\": " << r.median()
+         << ", \"p10_seconds\": " << r.percentile(10)
+         << ", \"p90_seconds\": " << r.percentile(90)
+         << ", \"min_seconds\": " << r.seconds.front()
+         << ", \"max_seconds\": " << r.seconds.back()
+         << ", \"pixels_per_second\": " << r.pixels_per_second()
+         << ", \"bytes_per_second\": " << r.bytes_per_second() << ",\n"
+         << "      \"seconds\": [";
+      for ( size_t j = 0; j < r.seconds.size(); j++ )
+        os << ( j ? ", " : "" ) << r.seconds[j];
+      os << "] }";
+    }
+    os << "\n  ]\n}\n";
+    os.precision( precision );
+    os.flags( flags );
+  }
+
+}} // namespace vw::bench
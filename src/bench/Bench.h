@@ -0,0 +1,104 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file Bench.h
+///
+/// A small micro-benchmark harness for tracking the speed of hot paths
+/// from one release to the next.  Each benchmark builds its inputs in
+/// setup(), outside the timing, and then run() is timed: a few warm-up
+/// runs first, then the measured repetitions.  The results report the
+/// median and percentiles of the run times and the throughput at the
+/// median, and are written out as JSON for comparing runs.
+///
+/// Benchmarks register themselves with VW_BENCHMARK(ClassName), so
+/// adding one is a matter of adding a class to one of the .cc files.
+///
+#ifndef __VW_BENCH_BENCH_H__
+#define __VW_BENCH_BENCH_H__
+
+#include <vw/Core/FundamentalTypes.h>
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace vw {
+namespace bench {
+
+  /// Settings shared by every benchmark, from the command line.
+  struct BenchConfig {
+    int32       size;        ///< Side of the synthetic images, in pixels
+    int32       threads;     ///< Threads for the parallel paths
+    int32       warmup;      ///< Untimed runs before the measured ones
+    int32       repetitions; ///< Measured runs
+    std::string filter;      ///< Only run benchmarks whose names contain this
+
+    BenchConfig() : size(1024), threads(1), warmup(1), repetitions(5) {}
+  };
+
+  /// One benchmark.  pixels() and bytes() are the work done by each
+  /// call to run(), and may depend on the configuration given to
+  /// setup().
+  class Benchmark {
+  public:
+    virtual ~Benchmark() {}
+    virtual std::string name() const = 0;
+    virtual void setup( BenchConfig const& /*config*/ ) {}
+    virtual void run() = 0;
+    virtual void teardown() {}
+    virtual uint64 pixels() const = 0;
+    virtual uint64 bytes() const = 0;
+  };
+
+  struct BenchResult {
+    std::string         name;
+    uint64              pixels, bytes;
+    std::vector<double> seconds; ///< Each measured run, sorted
+
+    /// The p'th percentile of the run times, 0 <= p <= 100,
+    /// interpolating between runs.
+    double percentile( double p ) const;
+    double median() const { return percentile( 50 ); }
+    double pixels_per_second() const;
+    double bytes_per_second() const;
+  };
+
+  /// Every registered benchmark, in registration order.
+  std::vector<boost::shared_ptr<Benchmark> >& benchmarks();
+
+  struct BenchmarkRegistrar {
+    BenchmarkRegistrar( Benchmark* benchmark );
+  };
+
+  /// Set up, warm up, time and tear down one benchmark.
+  BenchResult run_benchmark( Benchmark& benchmark, BenchConfig const& config );
+
+  /// A line per result, for reading at the terminal.
+  void write_summary( std::ostream& os, BenchResult const& result );
+
+  /// The configuration and all the results, as a JSON object.
+  void write_json( std::ostream& os, BenchConfig const& config, std::vector<BenchResult> const& results );
+
+}} // namespace vw::bench
+
+#define VW_BENCHMARK(ClassName) \
+  static vw::bench::BenchmarkRegistrar ClassName##_registrar( new ClassName )
+
+#endif // __VW_BENCH_BENCH_H__
@@ -0,0 +1,76 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file FileIOBench.cc
+///
+/// Benchmarks of reading images through DiskImageView.
+
+#include <bench/Bench.h>
+#include <bench/SyntheticImages.h>
+#include <vw/FileIO/DiskImageResource.h>
+#include <vw/FileIO/DiskImageView.h>
+#include <vw/Image/BlockRasterize.h>
+
+#include <boost/filesystem/operations.hpp>
+
+using namespace vw;
+using namespace vw::bench;
+
+namespace {
+
+  // Writes a synthetic image to a scratch file, then times reading all
+  // of it back, block by block on the configured number of threads.
+  // Each run opens a fresh view, with nothing cached, so every block
+  // is read from the file.
+  class DiskReadBenchmark : public Benchmark {
+    std::string m_filename;
+    int32 m_threads;
+    ImageView<PixelGray<uint8> > m_result;
+  public:
+    std::string name() const { return "disk_image_view_read"; }
+
+    void setup( BenchConfig const& config ) {
+      m_threads = config.threads;
+      ImageView<PixelGray<uint8> > image = synthetic_image_uint8( config.size, config.size );
+      // TIFF where it is supported, otherwise PNG
+      try {
+        m_filename = "vwbench_read.tif";
+        write_image( m_filename, image );
+      } catch ( const Exception& ) {
+        m_filename = "vwbench_read.png";
+        write_image( m_filename, image );
+      }
+      m_result.set_size( image.cols(), image.rows() );
+    }
+
+    void run() {
+      DiskImageView<PixelGray<uint8> > view( m_filename );
+      m_result = block_rasterize( view, Vector2i( 256, 256 ), m_threads );
+    }
+
+    void teardown() {
+      m_result.reset();
+      boost::filesystem::remove( m_filename );
+    }
+
+    uint64 pixels() const { return uint64( m_result.cols() ) * m_result.rows(); }
+    uint64 bytes() const { return pixels() * sizeof( PixelGray<uint8> ); }
+  };
+  VW_BENCHMARK( DiskReadBenchmark );
+
+} // namespace
@@ -0,0 +1,119 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file ImageBench.cc
+///
+/// Benchmarks of the Image module: lazy views rasterized block by
+/// block on the configured number of threads.
+
+#include <bench/Bench.h>
+#include <bench/SyntheticImages.h>
+#include <vw/Image/BlockRasterize.h>
+#include <vw/Image/Filter.h>
+#include <vw/Image/ImageMath.h>
+#include <vw/Image/ImageView.h>
+#include <vw/Image/Transform.h>
+
+using namespace vw;
+using namespace vw::bench;
+
+namespace {
+
+  // The block size used throughout; small enough that every thread
+  // gets work on the default image size.
+  const int32 block_size = 256;
+
+  class ImageBenchmark : public Benchmark {
+  protected:
+    ImageView<PixelGray<float32> > m_source, m_result;
+    int32 m_threads;
+  public:
+    virtual void setup( BenchConfig const& config ) {
+      m_source  = synthetic_image( config.size, config.size );
+      m_result.set_size( config.size, config.size );
+      m_threads = config.threads;
+    }
+    virtual void teardown() {
+      m_source.reset();
+      m_result.reset();
+    }
+    virtual uint64 pixels() const { return uint64( m_source.cols() ) * m_source.rows(); }
+    // Read once and written once
+    virtual uint64 bytes() const { return 2 * pixels() * sizeof( PixelGray<float32> ); }
+  };
+
+  // Per-pixel arithmetic: the cost of rasterizing itself
+  class RasterizeBenchmark : public ImageBenchmark {
+  public:
+    std::string name() const { return "rasterize"; }
+    void run() {
+      m_result = block_rasterize( 2.0f * m_source + 1.0f, Vector2i( block_size, block_size ), m_threads );
+    }
+  };
+  VW_BENCHMARK( RasterizeBenchmark );
+
+  class ConvolutionBenchmark : public ImageBenchmark {
+    ImageView<float32> m_kernel;
+  public:
+    std::string name() const { return "convolution_filter_5x5"; }
+    void setup( BenchConfig const& config ) {
+      ImageBenchmark::setup( config );
+      m_kernel.set_size( 5, 5 );
+      for ( int32 y = 0; y < 5; y++ )
+        for ( int32 x = 0; x < 5; x++ )
+          m_kernel(x,y) = float32( 1 + x * y ) / 125;
+    }
+    void run() {
+      m_result = block_rasterize( convolution_filter( m_source, m_kernel ),
+                                  Vector2i( block_size, block_size ), m_threads );
+    }
+  };
+  VW_BENCHMARK( ConvolutionBenchmark );
+
+  class SeparableConvolutionBenchmark : public ImageBenchmark {
+  public:
+    std::string name() const { return "gaussian_filter"; }
+    void run() {
+      m_result = block_rasterize( gaussian_filter( m_source, 2.0 ),
+                                  Vector2i( block_size, block_size ), m_threads );
+    }
+  };
+  VW_BENCHMARK( SeparableConvolutionBenchmark );
+
+  // A small rotation and scale with bilinear interpolation
+  class TransformBenchmark : public ImageBenchmark {
+    Matrix3x3 m_homography;
+  public:
+    std::string name() const { return "transform_bilinear"; }
+    void setup( BenchConfig const& config ) {
+      ImageBenchmark::setup( config );
+      double c = 0.9 * std::cos( 0.1 ), s = 0.9 * std::sin( 0.1 );
+      m_homography.set_identity();
+      m_homography(0,0) = c; m_homography(0,1) = -s;
+      m_homography(1,0) = s; m_homography(1,1) =  c;
+      m_homography(0,2) = 0.05 * config.size;
+    }
+    void run() {
+      m_result = block_rasterize( transform( m_source, HomographyTransform( m_homography ),
+                                             ZeroEdgeExtension(), BilinearInterpolation() ),
+                                  Vector2i( block_size, block_size ), m_threads );
+    }
+  };
+  VW_BENCHMARK( TransformBenchmark );
+
+} // namespace
@@ -0,0 +1,201 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file StereoBench.cc
+///
+/// Benchmarks of the stereo correlators on a synthetic pair with a
+/// known offset.  These run on half the configured image size, since
+/// their cost grows with the search range as well as the image; the EM
+/// subpixel refinement, which fits a model at every pixel, runs on a
+/// thirty-second of it.  They are single threaded.
+
+#include <bench/Bench.h>
+#include <bench/SyntheticImages.h>
+#include <vw/Image/Manipulation.h>
+#include <vw/Stereo/Correlation.h>
+#include <vw/Stereo/CorrelationView.h>
+#include <vw/Stereo/EMSubpixelCorrelatorView.h>
+#include <vw/Stereo/SGM.h>
+
+using namespace vw;
+using namespace vw::bench;
+using namespace vw::stereo;
+
+namespace {
+
+  // Search 32 pixels across and 4 down
+  const Vector2i search_range( 32, 4 );
+
+  template <class PixelT>
+  class StereoBenchmark : public Benchmark {
+  protected:
+    ImageView<PixelT> m_left, m_right;
+    int32 m_size;
+  public:
+    virtual void setup( BenchConfig const& config ) {
+      m_size = config.size / 2;
+      // A disparity of 8 pixels across; the right image covers the
+      // whole search range
+      m_left  = pixel_cast<PixelT>( synthetic_image( m_size, m_size, 8 ) );
+      m_right = pixel_cast<PixelT>( synthetic_image( m_size + search_range[0] + 1, m_size + search_range[1] + 1 ) );
+    }
+    virtual void teardown() {
+      m_left.reset();
+      m_right.reset();
+    }
+    virtual uint64 pixels() const { return uint64( m_size ) * m_size; }
+    virtual uint64 bytes() const {
+      return ( uint64( m_left.cols() ) * m_left.rows() + uint64( m_right.cols() ) * m_right.rows() ) * sizeof( PixelT );
+    }
+  };
+
+  class BestOfSearchBenchmark : public StereoBenchmark<PixelGray<float32> > {
+    CostFunctionType m_cost;
+    std::string      m_name;
+  public:
+    BestOfSearchBenchmark( CostFunctionType cost, std::string const& name ) : m_cost(cost), m_name(name) {}
+    std::string name() const { return m_name; }
+    void run() {
+      calc_disparity( m_cost, m_left, m_right, bounding_box( m_left ),
+                      search_range + Vector2i( 1, 1 ), Vector2i( 7, 7 ) );
+    }
+  };
+
+  struct BestOfSearchAbsolute : public BestOfSearchBenchmark {
+    BestOfSearchAbsolute() : BestOfSearchBenchmark( ABSOLUTE_DIFFERENCE, "best_of_search_convolution_abs" ) {}
+  };
+  VW_BENCHMARK( BestOfSearchAbsolute );
+
+  struct BestOfSearchNCC : public BestOfSearchBenchmark {
+    BestOfSearchNCC() : BestOfSearchBenchmark( CROSS_CORRELATION, "best_of_search_convolution_ncc" ) {}
+  };
+  VW_BENCHMARK( BestOfSearchNCC );
+
+  struct BestOfSearchCensus : public BestOfSearchBenchmark {
+    BestOfSearchCensus() : BestOfSearchBenchmark( CENSUS_TRANSFORM, "best_of_search_convolution_census" ) {}
+  };
+  VW_BENCHMARK( BestOfSearchCensus );
+
+  struct BestOfSearchTernaryCensus : public BestOfSearchBenchmark {
+    BestOfSearchTernaryCensus() : BestOfSearchBenchmark( TERNARY_CENSUS_TRANSFORM, "best_of_search_convolution_ternary_census" ) {}
+  };
+  VW_BENCHMARK( BestOfSearchTernaryCensus );
+
+  class SemiGlobalMatcherBenchmark : public StereoBenchmark<uint8> {
+  public:
+    std::string name() const { return "semi_global_matcher_census"; }
+    void run() {
+      boost::shared_ptr<SemiGlobalMatcher> matcher;
+      calc_disparity_sgm( CENSUS_TRANSFORM, m_left, m_right, bounding_box( m_left ),
+                          search_range + Vector2i( 1, 1 ), Vector2i( 5, 5 ), false,
+                          SemiGlobalMatcher::SUBPIXEL_NONE, Vector2i( 4, 4 ), 1024, matcher );
+    }
+  };
+  VW_BENCHMARK( SemiGlobalMatcherBenchmark );
+
+  // Small tiles and a large kernel leave few pyramid levels in each
+  // tile, which is where a seed from the whole image helps
+  class PyramidCorrelationBenchmark : public StereoBenchmark<PixelGray<float32> > {
+    int32 m_seed_level;
+    std::string m_name;
+    ImageView<uint8> m_left_mask, m_right_mask;
+  public:
+    PyramidCorrelationBenchmark( int32 seed_level, std::string const& name )
+      : m_seed_level(seed_level), m_name(name) {}
+    std::string name() const { return m_name; }
+    void setup( BenchConfig const& config ) {
+      StereoBenchmark<PixelGray<float32> >::setup( config );
+      m_left_mask  = constant_view( uint8(255), m_left );
+      m_right_mask = constant_view( uint8(255), m_right );
+    }
+    void teardown() {
+      StereoBenchmark<PixelGray<float32> >::teardown();
+      m_left_mask.reset();
+      m_right_mask.reset();
+    }
+    void run() {
+      typedef ImageView<PixelGray<float32> > ImageT;
+      PyramidCorrelationView<ImageT, ImageT, ImageView<uint8>, ImageView<uint8> > view =
+        pyramid_correlate( m_left, m_right, m_left_mask, m_right_mask, PREFILTER_NONE, 0,
+                           BBox2i( Vector2i(), search_range ), Vector2i( 15, 15 ),
+                           ABSOLUTE_DIFFERENCE, 0, 0, -1, 0, 5, 5 );
+      view.set_search_seed_level( m_seed_level );
+      ImageView<PixelMask<Vector2f> > result = block_rasterize( view, Vector2i( 128, 128 ), 1 );
+    }
+  };
+
+  struct PyramidCorrelation : public PyramidCorrelationBenchmark {
+    PyramidCorrelation() : PyramidCorrelationBenchmark( 0, "pyramid_correlation" ) {}
+  };
+  VW_BENCHMARK( PyramidCorrelation );
+
+  struct PyramidCorrelationSeeded : public PyramidCorrelationBenchmark {
+    PyramidCorrelationSeeded() : PyramidCorrelationBenchmark( 2, "pyramid_correlation_seeded" ) {}
+  };
+  VW_BENCHMARK( PyramidCorrelationSeeded );
+
+  // Refines a disparity that is off by up to a pixel
+  class EMSubpixelBenchmark : public Benchmark {
+    double m_affine_epsilon;
+    std::string m_name;
+    ImageView<float32> m_left, m_right;
+    ImageView<PixelMask<Vector2f> > m_disparity;
+  public:
+    EMSubpixelBenchmark( double affine_epsilon, std::string const& name )
+      : m_affine_epsilon(affine_epsilon), m_name(name) {}
+    std::string name() const { return m_name; }
+    void setup( BenchConfig const& config ) {
+      int32 size = std::max( config.size / 32, 16 );
+      m_left  = pixel_cast<float32>( synthetic_image( size, size, 8 ) );
+      m_right = pixel_cast<float32>( synthetic_image( size, size ) );
+      m_disparity.set_size( size, size );
+      for ( int32 row = 0; row < size; row++ )
+        for ( int32 col = 0; col < size; col++ )
+          m_disparity( col, row ) = PixelMask<Vector2f>( Vector2f( 7 + ( col % 3 ) * 0.4, 0.2 ) );
+    }
+    void teardown() {
+      m_left.reset();
+      m_right.reset();
+      m_disparity.reset();
+    }
+    void run() {
+      EMSubpixelCorrelatorView<float32> view( m_left, m_right, m_disparity );
+      view.set_kernel_size( Vector2i( 15, 15 ) );
+      view.set_pyramid_levels( 2 );
+      view.set_affine_epsilon( m_affine_epsilon );
+      ImageView<PixelMask<Vector<float,5> > > result = view;
+    }
+    uint64 pixels() const { return uint64( m_left.cols() ) * m_left.rows(); }
+    uint64 bytes() const {
+      return uint64( m_left.cols() ) * m_left.rows() * ( 2 * sizeof( float32 ) + sizeof( PixelMask<Vector2f> ) );
+    }
+  };
+
+  struct EMSubpixel : public EMSubpixelBenchmark {
+    EMSubpixel() : EMSubpixelBenchmark( 1e-4, "em_subpixel" ) {}
+  };
+  VW_BENCHMARK( EMSubpixel );
+
+  // Without the early exit, every pixel runs the EM loop to its end as
+  // it did before the exit was added
+  struct EMSubpixelFull : public EMSubpixelBenchmark {
+    EMSubpixelFull() : EMSubpixelBenchmark( 0, "em_subpixel_full" ) {}
+  };
+  VW_BENCHMARK( EMSubpixelFull );
+
+} // namespace
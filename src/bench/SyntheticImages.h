@@ -0,0 +1,68 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file SyntheticImages.h
+///
+/// Deterministic test images for the benchmarks, so that runs on
+/// different machines and releases process the same pixels.
+///
+#ifndef __VW_BENCH_SYNTHETICIMAGES_H__
+#define __VW_BENCH_SYNTHETICIMAGES_H__
+
+#include <vw/Image/ImageView.h>
+#include <vw/Image/PixelTypes.h>
+
+#include <cmath>
+
+namespace vw {
+namespace bench {
+
+  /// Noise in [0,1) that depends only on the position
+  inline float32 synthetic_noise( int32 x, int32 y ) {
+    uint32 h = uint32( x ) * 73856093u ^ uint32( y ) * 19349663u;
+    h ^= h >> 13;  h *= 0x5bd1e995u;  h ^= h >> 15;
+    return float32( h % 1024 ) / 1024;
+  }
+
+  /// Smooth waves with noise on top, in [0,1].  'offset' shifts the
+  /// pattern left, so that an image made with offset d matches one
+  /// made without it d pixels further right: a stereo pair with a
+  /// disparity of d.
+  inline ImageView<PixelGray<float32> > synthetic_image( int32 cols, int32 rows, int32 offset = 0 ) {
+    ImageView<PixelGray<float32> > image( cols, rows );
+    for ( int32 y = 0; y < rows; y++ )
+      for ( int32 x = 0; x < cols; x++ ) {
+        int32 u = x + offset;
+        float32 wave = 0.5f + 0.25f * std::sin( u * 0.05f ) * std::cos( y * 0.03f );
+        image(x,y) = 0.6f * wave + 0.4f * synthetic_noise( u, y );
+      }
+    return image;
+  }
+
+  inline ImageView<PixelGray<uint8> > synthetic_image_uint8( int32 cols, int32 rows, int32 offset = 0 ) {
+    ImageView<PixelGray<float32> > image = synthetic_image( cols, rows, offset );
+    ImageView<PixelGray<uint8> > result( cols, rows );
+    for ( int32 y = 0; y < rows; y++ )
+      for ( int32 x = 0; x < cols; x++ )
+        result(x,y) = uint8( 255 * image(x,y).v() );
+    return result;
+  }
+
+}} // namespace vw::bench
+
+#endif // __VW_BENCH_SYNTHETICIMAGES_H__
@@ -0,0 +1,105 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file bench_main.cc
+///
+/// Runs the registered benchmarks and writes their results as JSON,
+/// for keeping track of performance across releases.  "make bench"
+/// builds and runs this with the default settings.
+
+#include <bench/Bench.h>
+#include <vw/Core/Exception.h>
+#include <vw/Core/Settings.h>
+
+#include <fstream>
+#include <iostream>
+
+#include <boost/program_options.hpp>
+namespace po = boost::program_options;
+
+using namespace vw;
+using namespace vw::bench;
+
+int main( int argc, char *argv[] ) {
+  BenchConfig config;
+  std::string output;
+
+  po::options_description desc("Usage: vwbench [options]\n\nOptions");
+  desc.add_options()
+    ("help,h", "Display this help message")
+    ("size",        po::value(&config.size)->default_value(config.size), "Side of the synthetic images, in pixels")
+    ("threads",     po::value(&config.threads)->default_value(config.threads), "Threads for the parallel code paths")
+    ("warmup",      po::value(&config.warmup)->default_value(config.warmup), "Untimed runs before timing")
+    ("repetitions", po::value(&config.repetitions)->default_value(config.repetitions), "Timed runs of each benchmark")
+    ("filter",      po::value(&config.filter), "Only run benchmarks whose names contain this")
+    ("list",        "List the benchmarks and exit")
+    ("output,o",    po::value(&output)->default_value("bench.json"), "Write the JSON results here (\"-\" for stdout)");
+
+  po::variables_map vm;
+  try {
+    po::store( po::parse_command_line( argc, argv, desc ), vm );
+    po::notify( vm );
+  } catch ( const po::error& e ) {
+    std::cerr << "Error parsing input:\n\t" << e.what() << "\n" << desc << std::endl;
+    return 1;
+  }
+  if ( vm.count("help") ) {
+    std::cout << desc << std::endl;
+    return 0;
+  }
+  if ( vm.count("list") ) {
+    for ( size_t i = 0; i < benchmarks().size(); i++ )
+      std::cout << benchmarks()[i]->name() << "\n";
+    return 0;
+  }
+  if ( config.size < 16 || config.threads < 1 || config.warmup < 0 || config.repetitions < 1 ) {
+    std::cerr << "Need size >= 16, threads >= 1, warmup >= 0 and repetitions >= 1.\n";
+    return 1;
+  }
+
+  vw_settings().set_default_num_threads( config.threads );
+
+  // Keep the summaries out of the way of JSON on stdout
+  std::ostream& summary = output == "-" ? std::cerr : std::cout;
+
+  std::vector<BenchResult> results;
+  try {
+    for ( size_t i = 0; i < benchmarks().size(); i++ ) {
+      Benchmark& benchmark = *benchmarks()[i];
+      if ( benchmark.name().find( config.filter ) == std::string::npos )
+        continue;
+      results.push_back( run_benchmark( benchmark, config ) );
+      write_summary( summary, results.back() );
+    }
+  } catch ( const Exception& e ) {
+    std::cerr << "Error: " << e.what() << std::endl;
+    return 1;
+  }
+
+  if ( output == "-" ) {
+    write_json( std::cout, config, results );
+  } else {
+    std::ofstream ofs( output.c_str() );
+    write_json( ofs, config, results );
+    if ( !ofs ) {
+      std::cerr << "Error: could not write " << output << std::endl;
+      return 1;
+    }
+  }
+  return 0;
+}
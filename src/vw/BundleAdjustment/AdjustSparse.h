@@ -19,12 +19,23 @@
 /// \file AdjustSparse.h
 ///
 /// Sparse implementation of bundle adjustment. Fast yo!
+///
+/// The reduced camera system S * delta_a = e can either be formed
+/// explicitly and solved with a skyline LDL^T decomposition (the
+/// default), formed in block compressed storage and solved with a
+/// minimum degree ordered block LDL^T whose symbolic analysis is
+/// reused across iterations, or applied implicitly and solved with
+/// block-Jacobi preconditioned conjugate gradients. The last never
+/// forms S and so does not suffer from fill-in on loosely connected
+/// camera networks. Use set_solver() to pick one.
 
 #ifndef __VW_BUNDLEADJUSTMENT_ADJUST_SPARSE_H__
 #define __VW_BUNDLEADJUSTMENT_ADJUST_SPARSE_H__
 
 // Vision Workbench
 #include <vw/Math/MatrixSparseSkyline.h>
+#include <vw/Math/MatrixSparseBlock.h>
+#include <vw/Math/ConjugateGradient.h>
 #include <vw/Core/Debugging.h>
 #include <vw/BundleAdjustment/AdjustBase.h>
 #include <vw/BundleAdjustment/CameraRelation.h>
@@ -49,6 +60,13 @@
 namespace vw {
 namespace ba {
 
+  // Method used by AdjustSparse to solve the reduced camera system.
+  enum SchurSolverType {
+    SkylineLDLSolver,     // Form S, reorder with Cuthill-McKee, LDL^T solve
+    SparseBlockLDLSolver, // Form S in blocks, minimum degree, block LDL^T solve
+    SchurPCGSolver        // Apply S implicitly, block-Jacobi PCG solve
+  };
+
   template <class BundleAdjustModelT, class RobustCostT>
   class AdjustSparse : public AdjustBase<BundleAdjustModelT, RobustCostT> {
 
@@ -62,6 +80,7 @@ namespace ba {
     typedef Vector<double,BundleAdjustModelT::point_params_n> vector_point;
 
     math::MatrixSparseSkyline<double> m_S;
+    math::MatrixSparseBlock<double,BundleAdjustModelT::camera_params_n> m_block_S;
     std::vector<size_t> m_ideal_ordering;
     Vector<size_t> m_ideal_skyline;
     bool m_found_ideal_ordering;
@@ -74,6 +93,57 @@ namespace ba {
     std::vector< vector_camera > epsilon_a;
     std::vector< vector_point > epsilon_b;
 
+    // Reduced camera system solver settings
+    SchurSolverType m_solver;
+    double m_pcg_tolerance;
+    int m_pcg_max_iterations;
+    int m_pcg_iterations;
+
+    // Applies S = U - sum( Y_ij * W_ij^T ) to a flattened camera
+    // vector without forming S. Requires U to already be augmented
+    // and the Y blocks to be current.
+    struct SchurOperator {
+      AdjustSparse& m_adjuster;
+      SchurOperator( AdjustSparse& adjuster ) : m_adjuster(adjuster) {}
+
+      Vector<double> operator()( Vector<double> const& x ) const {
+        size_t num_cam_params = BundleAdjustModelT::camera_params_n;
+        CameraRelationNetwork<JFeature>& crn = m_adjuster.m_crn;
+
+        // t_i = sum_j( W_ij^T * x_j )
+        std::vector< vector_point > t( m_adjuster.m_model.num_points() );
+        for ( size_t j = 0; j < crn.size(); j++ )
+          for ( crn_iter fiter = crn[j].begin(); fiter != crn[j].end(); fiter++ )
+            t[ (**fiter).m_point_id ] += transpose( (**fiter).m_w ) *
+              subvector( x, j*num_cam_params, num_cam_params );
+
+        // y_j = U_j * x_j - sum_i( Y_ij * t_i )
+        Vector<double> y( x.size() );
+        for ( size_t j = 0; j < crn.size(); j++ ) {
+          vector_camera y_j = m_adjuster.U[j] *
+            subvector( x, j*num_cam_params, num_cam_params );
+          for ( crn_iter fiter = crn[j].begin(); fiter != crn[j].end(); fiter++ )
+            y_j -= (**fiter).m_y * t[ (**fiter).m_point_id ];
+          subvector( y, j*num_cam_params, num_cam_params ) = y_j;
+        }
+        return y;
+      }
+    };
+
+    // Multiplies by the inverse of the diagonal camera blocks of S.
+    struct BlockJacobiPreconditioner {
+      std::vector< matrix_camera_camera > m_inverse_blocks;
+
+      Vector<double> operator()( Vector<double> const& r ) const {
+        size_t num_cam_params = BundleAdjustModelT::camera_params_n;
+        Vector<double> z( r.size() );
+        for ( size_t j = 0; j < m_inverse_blocks.size(); j++ )
+          subvector( z, j*num_cam_params, num_cam_params ) =
+            m_inverse_blocks[j] * subvector( r, j*num_cam_params, num_cam_params );
+        return z;
+      }
+    };
+
   public:
 
     AdjustSparse( BundleAdjustModelT & model,
@@ -85,7 +155,9 @@ namespace ba {
                                                 use_gcp_constraint ),
       U( this->m_model.num_cameras() ), V( this->m_model.num_points() ),
       V_inverse( this->m_model.num_points() ),
-      epsilon_a( this->m_model.num_cameras() ), epsilon_b( this->m_model.num_points() ) {
+      epsilon_a( this->m_model.num_cameras() ), epsilon_b( this->m_model.num_points() ),
+      m_solver( SkylineLDLSolver ), m_pcg_tolerance( 1e-10 ),
+      m_pcg_max_iterations( 500 ), m_pcg_iterations( 0 ) {
       vw_out(DebugMessage,"ba") << "Constructed Sparse Bundle Adjuster.\n";
       m_crn.read_controlnetwork( *(this->m_control_net).get() );
       m_found_ideal_ordering = false;
@@ -93,31 +165,36 @@ namespace ba {
 
     math::MatrixSparseSkyline<double> S() const { return m_S; }
 
+    // Reduced camera system solver controls. The PCG tolerance is
+    // relative to the norm of the right hand side.
+    SchurSolverType solver() const { return m_solver; }
+    void set_solver( SchurSolverType solver ) { m_solver = solver; }
+    double pcg_tolerance() const { return m_pcg_tolerance; }
+    void set_pcg_tolerance( double tolerance ) { m_pcg_tolerance = tolerance; }
+    int pcg_max_iterations() const { return m_pcg_max_iterations; }
+    void set_pcg_max_iterations( int iterations ) { m_pcg_max_iterations = iterations; }
+    // Number of CG iterations used by the last update
+    int pcg_iterations() const { return m_pcg_iterations; }
+
     // Covariance Calculator
     // ___________________________________________________________
-    // This routine inverts a sparse matrix S, and prints the individual
-    // covariance matrices for each camera
-    void covCalc(){
-      // camera params
-      size_t num_cam_params = BundleAdjustModelT::camera_params_n;
-      size_t num_cameras = this->m_model.num_cameras();
-
-      size_t inverse_size = num_cam_params * num_cameras;
-
-      typedef Matrix<double, BundleAdjustModelT::camera_params_n, BundleAdjustModelT::camera_params_n> matrix_camera_camera;
-
-      // final vector of camera covariance matrices
-      vw::Vector< matrix_camera_camera > sparse_cov(num_cameras);
-
-      // Get the S matrix from the model
-      math::MatrixSparseSkyline<double> S = this->S();  // Make copy as solve is destructive
-      Matrix<double> Id(inverse_size, inverse_size);
-      Id.set_identity();
-      Matrix<double> Cov = multi_sparse_solve(S, Id);
+    // Returns the covariance of each camera, the diagonal blocks of
+    // inverse(S). They are found by selected inversion from the block
+    // LDL^T factors of S (reusing the ones from the last update when
+    // the SparseBlockLDLSolver is in use), so the off-diagonal blocks of
+    // the inverse are never formed.
+    std::vector< matrix_camera_camera > camera_covariances() {
+      if ( m_solver != SparseBlockLDLSolver || !m_block_S.factored() )
+        build_block_schur();
+      Timer time("Selected Inversion of S", DebugMessage, "ba");
+      return math::sparse_selected_inverse( m_block_S );
+    }
 
-      //pick out covariances of individual cameras
-      for ( size_t i = 0; i < num_cameras; i++ )
-        sparse_cov(i) = submatrix(Cov, i*num_cam_params, i*num_cam_params, num_cam_params, num_cam_params);
+    // Prints the individual covariance matrices for each camera
+    void covCalc(){
+      std::vector< matrix_camera_camera > blocks = camera_covariances();
+      vw::Vector< matrix_camera_camera > sparse_cov( blocks.size() );
+      std::copy( blocks.begin(), blocks.end(), sparse_cov.begin() );
 
       std::cout << "Covariance matrices for cameras are:"
                 << sparse_cov << "\n\n";
@@ -293,90 +370,14 @@ namespace ba {
 
       time.reset();
 
-      // --- BUILD SPARSE, SOLVE A'S UPDATE STEP -------------------------
-      time.reset(new Timer("Build Sparse", DebugMessage, "ba"));
-
-      // The S matrix is a m x m block matrix with blocks that are
-      // camera_params_n x camera_params_n in size.  It has a sparse
-      // skyline structure, which makes it more efficient to solve
-      // through L*D*L^T decomposition and forward/back substitution
-      // below.
-      math::MatrixSparseSkyline<double> S(this->m_model.num_cameras()*num_cam_params,
-                                          this->m_model.num_cameras()*num_cam_params);
-      for ( size_t j = 0; j < m_crn.size(); j++ ) {
-        { // Filling in diagonal
-          matrix_camera_camera S_jj;
-
-          // Iterate across all features seen by the camera
-          for ( crn_iter fiter = m_crn[j].begin();
-                fiter != m_crn[j].end(); fiter++ ) {
-            S_jj -= (**fiter).m_y*transpose((**fiter).m_w);
-          }
-
-          // Augmenting Diagonal
-          S_jj += U[j];
-
-          // Loading into sparse matrix
-          size_t offset = j * num_cam_params;
-          for ( size_t aa = 0; aa < num_cam_params; aa++ ) {
-            for ( size_t bb = aa; bb < num_cam_params; bb++ ) {
-              S( offset+bb, offset+aa ) = S_jj(aa,bb);  // Transposing
-            }
-          }
-        }
-
-        // Filling in off diagonal
-        for ( size_t k = j+1; k < m_crn.size(); k++ ) {
-          typedef boost::weak_ptr<JFeature> w_ptr;
-          typedef boost::shared_ptr<JFeature> f_ptr;
-          typedef std::multimap< size_t, f_ptr >::iterator mm_iterator;
-          std::pair< mm_iterator, mm_iterator > feature_range;
-          feature_range = m_crn[j].map.equal_range( k );
-
-          // Iterating through all features in camera j that have
-          // connections to camera k.
-          matrix_camera_camera S_jk;
-          bool found = false;
-          for ( mm_iterator f_j_iter = feature_range.first;
-                f_j_iter != feature_range.second; f_j_iter++ ) {
-            w_ptr f_k = (*f_j_iter).second->m_map[k];
-            found = true;
-            S_jk -= (*f_j_iter).second->m_y *
-              transpose( f_k.lock()->m_w );
-          }
-
-          // Loading into sparse matrix
-          // - if it seems we are loading in oddly, it's because the sparse
-          //   matrix is row major.
-          if ( found ) {
-            submatrix( S, k*num_cam_params, j*num_cam_params,
-                       num_cam_params, num_cam_params ) = transpose(S_jk);
-          }
-        }
-      }
-
-      m_S = S; // S is modified in sparse solve. Keeping a copy.
-      time.reset();
-
-      // Computing ideal ordering
-      if (!m_found_ideal_ordering) {
-        time.reset(new Timer("Solving Cuthill-Mckee", DebugMessage, "ba"));
-        m_ideal_ordering = cuthill_mckee_ordering(S,num_cam_params);
-        math::MatrixReorganize<math::MatrixSparseSkyline<double> > mod_S( S, m_ideal_ordering );
-        m_ideal_skyline = solve_for_skyline(mod_S);
-
-        m_found_ideal_ordering = true;
-        time.reset();
-      }
-
-      time.reset(new Timer("Solve Delta A", DebugMessage, "ba"));
-
-      // Compute the LDL^T decomposition and solve using sparse methods.
-      math::MatrixReorganize<math::MatrixSparseSkyline<double> > modified_S( S, m_ideal_ordering );
-      Vector<double> delta_a = sparse_solve( modified_S,
-                                             reorganize(e, m_ideal_ordering),
-                                             m_ideal_skyline );
-      delta_a = reorganize(delta_a, modified_S.inverse());
+      // --- SOLVE A'S UPDATE STEP ---------------------------------------
+      Vector<double> delta_a;
+      if ( m_solver == SchurPCGSolver )
+        delta_a = solve_schur_pcg( e );
+      else if ( m_solver == SparseBlockLDLSolver )
+        delta_a = solve_schur_block( e );
+      else
+        delta_a = solve_schur_skyline( e );
       BOOST_FOREACH( double& e, delta_a )
         if ( std::isnan( e ) ) e = 0;
       time.reset();
@@ -531,6 +532,196 @@ namespace ba {
       return 0;
     }
 
+
+  private:
+
+    // Diagonal block S_jj = U_j - sum_i( Y_ij * W_ij^T ) of the
+    // reduced camera system.
+    matrix_camera_camera schur_diagonal_block( size_t j ) {
+      matrix_camera_camera S_jj;
+
+      // Iterate across all features seen by the camera
+      for ( crn_iter fiter = m_crn[j].begin();
+            fiter != m_crn[j].end(); fiter++ ) {
+        S_jj -= (**fiter).m_y*transpose((**fiter).m_w);
+      }
+
+      // Augmenting Diagonal
+      S_jj += U[j];
+      return S_jj;
+    }
+
+    // Off diagonal block S_jk = -sum_i( Y_ij * W_ik^T ). Returns false
+    // if cameras j and k share no features, in which case the block is
+    // structurally zero.
+    bool schur_offdiagonal_block( size_t j, size_t k, matrix_camera_camera& S_jk ) {
+      typedef boost::weak_ptr<JFeature> w_ptr;
+      typedef boost::shared_ptr<JFeature> f_ptr;
+      typedef std::multimap< size_t, f_ptr >::iterator mm_iterator;
+      std::pair< mm_iterator, mm_iterator > feature_range;
+      feature_range = m_crn[j].map.equal_range( k );
+
+      // Iterating through all features in camera j that have
+      // connections to camera k.
+      bool found = false;
+      for ( mm_iterator f_j_iter = feature_range.first;
+            f_j_iter != feature_range.second; f_j_iter++ ) {
+        w_ptr f_k = (*f_j_iter).second->m_map[k];
+        found = true;
+        S_jk -= (*f_j_iter).second->m_y *
+          transpose( f_k.lock()->m_w );
+      }
+      return found;
+    }
+
+    // Form S explicitly and solve S * delta_a = e through a reordered
+    // skyline LDL^T decomposition.
+    Vector<double> solve_schur_skyline( Vector<double> const& e ) {
+      boost::scoped_ptr<Timer> time( new Timer("Build Sparse", DebugMessage, "ba") );
+      size_t num_cam_params = BundleAdjustModelT::camera_params_n;
+
+      // The S matrix is a m x m block matrix with blocks that are
+      // camera_params_n x camera_params_n in size.  It has a sparse
+      // skyline structure, which makes it more efficient to solve
+      // through L*D*L^T decomposition and forward/back substitution
+      // below.
+      math::MatrixSparseSkyline<double> S(this->m_model.num_cameras()*num_cam_params,
+                                          this->m_model.num_cameras()*num_cam_params);
+      for ( size_t j = 0; j < m_crn.size(); j++ ) {
+        { // Filling in diagonal
+          matrix_camera_camera S_jj = schur_diagonal_block( j );
+
+          // Loading into sparse matrix
+          size_t offset = j * num_cam_params;
+          for ( size_t aa = 0; aa < num_cam_params; aa++ ) {
+            for ( size_t bb = aa; bb < num_cam_params; bb++ ) {
+              S( offset+bb, offset+aa ) = S_jj(aa,bb);  // Transposing
+            }
+          }
+        }
+
+        // Filling in off diagonal
+        for ( size_t k = j+1; k < m_crn.size(); k++ ) {
+          matrix_camera_camera S_jk;
+
+          // Loading into sparse matrix
+          // - if it seems we are loading in oddly, it's because the sparse
+          //   matrix is row major.
+          if ( schur_offdiagonal_block( j, k, S_jk ) ) {
+            submatrix( S, k*num_cam_params, j*num_cam_params,
+                       num_cam_params, num_cam_params ) = transpose(S_jk);
+          }
+        }
+      }
+
+      m_S = S; // S is modified in sparse solve. Keeping a copy.
+      time.reset();
+
+      // Computing ideal ordering
+      if (!m_found_ideal_ordering) {
+        time.reset(new Timer("Solving Cuthill-Mckee", DebugMessage, "ba"));
+        m_ideal_ordering = cuthill_mckee_ordering(S,num_cam_params);
+        math::MatrixReorganize<math::MatrixSparseSkyline<double> > mod_S( S, m_ideal_ordering );
+        m_ideal_skyline = solve_for_skyline(mod_S);
+
+        m_found_ideal_ordering = true;
+        time.reset();
+      }
+
+      time.reset(new Timer("Solve Delta A", DebugMessage, "ba"));
+
+      // Compute the LDL^T decomposition and solve using sparse methods.
+      math::MatrixReorganize<math::MatrixSparseSkyline<double> > modified_S( S, m_ideal_ordering );
+      Vector<double> delta_a = sparse_solve( modified_S,
+                                             reorganize(e, m_ideal_ordering),
+                                             m_ideal_skyline );
+      delta_a = reorganize(delta_a, modified_S.inverse());
+      return delta_a;
+    }
+
+    // Form S in block compressed storage. The camera connectivity
+    // doesn't change between iterations, so the structure and its
+    // symbolic analysis are only computed on the first call.
+    void build_block_schur() {
+      boost::scoped_ptr<Timer> time;
+      size_t num_cameras = m_crn.size();
+
+      if ( !m_block_S.compressed() ) {
+        time.reset(new Timer("Build Block Sparse Structure", DebugMessage, "ba"));
+        m_block_S = math::MatrixSparseBlock<double,BundleAdjustModelT::camera_params_n>( num_cameras );
+        for ( size_t j = 0; j < num_cameras; j++ )
+          for ( crn_iter fiter = m_crn[j].begin();
+                fiter != m_crn[j].end(); fiter++ )
+            for ( std::map<size_t,JFeature::w_ptr>::const_iterator it = (**fiter).m_map.begin();
+                  it != (**fiter).m_map.end(); it++ )
+              m_block_S.add_block( it->first, j );
+        m_block_S.compress();
+        time.reset();
+      } else {
+        m_block_S.set_zero();
+      }
+
+      time.reset(new Timer("Build Block Sparse", DebugMessage, "ba"));
+      for ( size_t j = 0; j < num_cameras; j++ ) {
+        m_block_S.block(j,j) = schur_diagonal_block( j );
+        for ( size_t k = j+1; k < num_cameras; k++ ) {
+          if ( !m_block_S.has_block(k,j) )
+            continue;
+          matrix_camera_camera S_jk;
+          schur_offdiagonal_block( j, k, S_jk );
+          m_block_S.block(k,j) = transpose(S_jk);
+        }
+      }
+    }
+
+    // Solve S * delta_a = e with a block LDL^T decomposition
+    Vector<double> solve_schur_block( Vector<double> const& e ) {
+      build_block_schur();
+      Timer time("Solve Delta A (Block LDL)", DebugMessage, "ba");
+      return math::sparse_solve( m_block_S, e );
+    }
+
+    // Solve S * delta_a = e with block-Jacobi preconditioned conjugate
+    // gradients, applying S implicitly through the W and Y blocks.
+    Vector<double> solve_schur_pcg( Vector<double> const& e ) {
+      boost::scoped_ptr<Timer> time( new Timer("Build Block Jacobi Preconditioner", DebugMessage, "ba") );
+      BlockJacobiPreconditioner preconditioner;
+      preconditioner.m_inverse_blocks.resize( m_crn.size() );
+      for ( size_t j = 0; j < m_crn.size(); j++ ) {
+        matrix_camera_camera S_jj = schur_diagonal_block( j );
+
+        Matrix<double> S_temp = S_jj;
+        if ( chol_inverse( S_temp ) ) {
+          preconditioner.m_inverse_blocks[j] = transpose(S_temp)*S_temp;
+        } else {
+          // Fall back to plain Jacobi on a block that isn't positive definite
+          matrix_camera_camera& block = preconditioner.m_inverse_blocks[j];
+          block = matrix_camera_camera();
+          for ( size_t k = 0; k < BundleAdjustModelT::camera_params_n; k++ )
+            block(k,k) = S_jj(k,k) != 0 ? 1.0 / S_jj(k,k) : 1.0;
+        }
+      }
+      time.reset();
+
+      time.reset(new Timer("Solve Delta A (PCG)", DebugMessage, "ba"));
+      Vector<double> delta_a( e.size() );
+      math::PCGStatus status;
+      m_pcg_iterations =
+        math::preconditioned_conjugate_gradient( SchurOperator(*this), preconditioner,
+                                                 e, delta_a, m_pcg_tolerance,
+                                                 m_pcg_max_iterations, &status );
+      if ( status == math::PCG_CONVERGED )
+        vw_out(DebugMessage,"ba") << "PCG converged in " << m_pcg_iterations
+                                  << " iterations.\n";
+      else if ( status == math::PCG_NOT_POSITIVE_DEFINITE )
+        vw_out(WarningMessage,"ba") << "PCG stopped after " << m_pcg_iterations
+                                    << " iterations: the reduced camera system is not"
+                                    << " positive definite; using the last iterate.\n";
+      else
+        vw_out(WarningMessage,"ba") << "PCG did not converge in " << m_pcg_max_iterations
+                                    << " iterations; using the last iterate.\n";
+      return delta_a;
+    }
   };
 
 }} // namespace vw::ba
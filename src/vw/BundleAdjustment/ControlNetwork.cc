@@ -19,10 +19,26 @@
 /// \file ControlNetwork.cc
 ///
 
+#include <vw/config.h>
 #include <vw/BundleAdjustment/ControlNetwork.h>
 #include <vw/Core/Log.h>
+#include <vw/Core/Thread.h>
 #include <boost/algorithm/string.hpp>
 #include <boost/foreach.hpp>
+#include <boost/static_assert.hpp>
+#include <boost/tuple/tuple.hpp>
+#include <boost/tuple/tuple_comparison.hpp>
+#include <cstring>
+#include <map>
+
+#if VW_HAVE_PKG_BOOST_IOSTREAMS
+#include <boost/iostreams/device/mapped_file.hpp>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#endif
 
 // Time Headers
 #include <boost/thread/xtime.hpp>
@@ -44,6 +60,81 @@ inline std::string current_posix_time_string() {
   return std::string(time_string);
 }
 
+// Layout of the columnar control network format. Everything is
+// native endian and every section starts 8 byte aligned, so records
+// can be used straight out of the mapped file:
+//
+//   ColumnarHeader
+//   ColumnarPoint   [num_points]
+//   ColumnarMeasure [num_measures]
+//   uint64          [num_strings+1]   offsets into the characters
+//   char            [...]             string table characters
+//
+// String 0 is always the empty string, strings 1 to 6 are the
+// network's target name, id, created, modified, description and user.
+namespace {
+
+  const char COLUMNAR_MAGIC[8] = { 'V','W','C','N','E','T','C','\0' };
+  const vw::uint32 COLUMNAR_VERSION = 1;
+
+  struct ColumnarHeader {
+    char magic[8];
+    vw::uint32 version, type;
+    vw::uint64 num_points, num_measures, num_strings;
+    vw::uint64 measures_offset, strings_offset, characters_offset;
+  };
+
+  struct ColumnarPoint {
+    double position[3], sigma[3];
+    vw::uint64 first_measure;
+    vw::uint32 num_measures, id;
+    vw::uint8 type, ignore, padding[6];
+  };
+
+  struct ColumnarMeasure {
+    float col, row, col_sigma, row_sigma, diameter, padding;
+    double focalplane_x, focalplane_y, ephemeris_time;
+    vw::uint64 image_id;
+    vw::uint32 serial, date_time, description, chooser;
+    vw::uint8 type, ignore, pixels_dominant, padding2[5];
+  };
+
+  BOOST_STATIC_ASSERT( sizeof(ColumnarHeader)  == 64 );
+  BOOST_STATIC_ASSERT( sizeof(ColumnarPoint)   == 72 );
+  BOOST_STATIC_ASSERT( sizeof(ColumnarMeasure) == 80 );
+
+  // Gives each distinct string an index in the string table
+  class StringTable {
+    std::map<std::string, vw::uint32> m_index;
+    std::vector<std::string const*> m_strings;
+  public:
+    StringTable() { (*this)( std::string() ); }
+
+    // Adds a string at the next index even if it is already present
+    void append( std::string const& str ) {
+      m_strings.push_back( &m_index.insert( std::make_pair( str, vw::uint32(m_strings.size()) ) ).first->first );
+    }
+
+    vw::uint32 operator()( std::string const& str ) {
+      std::pair<std::map<std::string,vw::uint32>::iterator,bool> result =
+        m_index.insert( std::make_pair( str, vw::uint32(m_strings.size()) ) );
+      if ( result.second )
+        m_strings.push_back( &result.first->first );
+      return result.first->second;
+    }
+
+    size_t size() const { return m_strings.size(); }
+    std::string const& operator[]( size_t i ) const { return *m_strings[i]; }
+  };
+
+  vw::uint64 align8( vw::uint64 offset ) { return (offset + 7) & ~vw::uint64(7); }
+
+  void write_padding( std::ostream& f, vw::uint64 from, vw::uint64 to ) {
+    for ( ; from < to; from++ )
+      f.put( 0 );
+  }
+}
+
 inline std::string isis_style_time_string() {
   std::string time = current_posix_time_string();
   boost::erase_all( time, "\n" );
@@ -64,13 +155,14 @@ namespace ba {
                                   float col_sigma, float row_sigma,
                                   uint64 image_id,
                                   ControlMeasureType type ) :
-    m_col(col), m_row(row), m_col_sigma(col_sigma), m_row_sigma(row_sigma), m_image_id(image_id), m_type(type) {
+    m_strings(new ControlMeasureStrings), m_col(col), m_row(row),
+    m_col_sigma(col_sigma), m_row_sigma(row_sigma), m_image_id(image_id), m_type(type) {
 
     // Recording time
-    m_date_time = isis_style_time_string();
+    m_strings->date_time = isis_style_time_string();
 
-    m_serialNumber = "Null";
-    m_description = "Null";
+    m_strings->serial = "Null";
+    m_strings->description = "Null";
     m_ignore = false;
     m_pixels_dominant = true;
 
@@ -78,24 +170,33 @@ namespace ba {
   }
 
   ControlMeasure::ControlMeasure( ControlMeasureType type ) :
-    m_col(0), m_row(0), m_col_sigma(0), m_row_sigma(0), m_image_id(0), m_type(type) {
+    m_strings(new ControlMeasureStrings), m_col(0), m_row(0),
+    m_col_sigma(0), m_row_sigma(0), m_image_id(0), m_type(type) {
 
     // Recording time
-    m_date_time = isis_style_time_string();
+    m_strings->date_time = isis_style_time_string();
 
-    m_serialNumber = "Null";
-    m_description = "Null";
+    m_strings->serial = "Null";
+    m_strings->description = "Null";
     m_ignore = false;
     m_pixels_dominant = true;
 
     m_ephemeris_time = m_focalplane_x = m_focalplane_y = m_diameter = 0;
   }
 
+  ControlMeasureStrings& ControlMeasure::strings() {
+    if ( !m_strings )
+      m_strings.reset( new ControlMeasureStrings );
+    else if ( !m_strings.unique() )
+      m_strings.reset( new ControlMeasureStrings( *m_strings ) );
+    return *m_strings;
+  }
+
   /// Write a compressed binary style of measure
   void ControlMeasure::write_binary( std::ostream &f ) const {
     // Writing out all the strings first
-    f << m_serialNumber << char(0) << m_date_time << char(0)
-      << m_description << char(0) << m_chooserName << char(0);
+    f << serial() << char(0) << date_time() << char(0)
+      << description() << char(0) << chooser() << char(0);
     // Writing the binary data
     f.write((char*)&(m_col), sizeof(m_col));
     f.write((char*)&(m_row), sizeof(m_row));
@@ -114,10 +215,11 @@ namespace ba {
   /// Reading a compressed binary style of measure
   void ControlMeasure::read_binary( std::istream &f ) {
     // Reading in all the strings
-    std::getline( f, m_serialNumber, '\0' );
-    std::getline( f, m_date_time, '\0' );
-    std::getline( f, m_description, '\0' );
-    std::getline( f, m_chooserName, '\0' );
+    ControlMeasureStrings& strs = strings();
+    std::getline( f, strs.serial, '\0' );
+    std::getline( f, strs.date_time, '\0' );
+    std::getline( f, strs.description, '\0' );
+    std::getline( f, strs.chooser, '\0' );
     // Reading the binary data
     f.read((char*)&(m_col),             sizeof(m_col));
     f.read((char*)&(m_row),             sizeof(m_row));
@@ -136,7 +238,7 @@ namespace ba {
   /// Write an isis style measure
   void ControlMeasure::write_isis( std::ostream &f ) const {
     f << "    Group = ControlMeasure\n";
-    f << "      SerialNumber   = " << m_serialNumber << std::endl;
+    f << "      SerialNumber   = " << serial() << std::endl;
     f << "      MeasureType    = ";
     if ( m_type == ControlMeasure::Unmeasured ) {
       f << "Unmeasured\n";
@@ -170,10 +272,10 @@ namespace ba {
       f << "      EphemerisTime  = " << m_ephemeris_time << "\n";
     if ( m_diameter > 0 )
       f << "      Diameter       = " << m_diameter << "\n";
-    if ( m_date_time != "" )
-      f << "      DateTime       = " << m_date_time << "\n";
-    if ( m_chooserName != "" )
-      f << "      ChooserName    = " << m_chooserName << "\n";
+    if ( date_time() != "" )
+      f << "      DateTime       = " << date_time() << "\n";
+    if ( chooser() != "" )
+      f << "      ChooserName    = " << chooser() << "\n";
     if ( m_ignore )
       f << "      Ignore         = True\n";
     f << "      Reference      = False\n";    // What is reference?
@@ -192,9 +294,10 @@ namespace ba {
     std::string str;
 
     // Setting defaults
+    ControlMeasureStrings& strs = strings();
     m_diameter = 0;
-    m_date_time = "";
-    m_chooserName = "";
+    strs.date_time = "";
+    strs.chooser = "";
     m_ignore = false;
     m_pixels_dominant = true;
 
@@ -224,7 +327,7 @@ namespace ba {
         break;
       else if ( tokens[0] == "SerialNumber" ) {
         read_pvl_property( ostr, tokens );
-        m_serialNumber = ostr.str();
+        strs.serial = ostr.str();
       } else if ( tokens[0] == "MeasureType" ) {
         read_pvl_property( ostr, tokens );
         if ( ostr.str() == "Unmeasured" )
@@ -292,10 +395,10 @@ namespace ba {
         converter >> m_diameter;
       } else if ( tokens[0] == "DateTime" ) {
         read_pvl_property( ostr, tokens );
-        m_date_time = ostr.str();
+        strs.date_time = ostr.str();
       } else if ( tokens[0] == "ChooserName" ) {
         read_pvl_property( ostr, tokens );
-        m_chooserName = ostr.str();
+        strs.chooser = ostr.str();
       } else if ( tokens[0] == "Ignore" ) {
         m_ignore = true;
       } else if ( tokens[0] == "PixelsDominant" ) {
@@ -593,6 +696,11 @@ namespace ba {
   /// Reading a compressed binary style control network
   void ControlNetwork::read_binary( std::string const& filename ) {
 
+    if ( ControlNetworkReader::is_columnar( filename ) ) {
+      read_columnar( filename );
+      return;
+    }
+
     // Opening file
     std::ifstream f( filename.c_str() );
     if ( !f.is_open() )
@@ -622,6 +730,126 @@ namespace ba {
     f.close();
   }
 
+  /// Write the columnar binary style control network
+  void ControlNetwork::write_columnar( std::string const& filename ) const {
+
+    // Recording the modified time
+    m_modified = isis_style_time_string();
+
+    vw_out() << "Writing: " << filename << std::endl;
+
+    std::ofstream f( filename.c_str(), std::ios::binary );
+    if ( !f.is_open() )
+      vw_throw( IOErr() << "Failed to open \"" << filename << "\" for writing." );
+
+    StringTable strings;
+    strings.append( m_targetName );
+    strings.append( m_networkId );
+    strings.append( m_created );
+    strings.append( m_modified );
+    strings.append( m_description );
+    strings.append( m_userName );
+
+    ColumnarHeader header;
+    std::memset( &header, 0, sizeof(header) );
+    std::memcpy( header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC) );
+    header.version = COLUMNAR_VERSION;
+    header.type = m_type;
+    header.num_points = m_control_points.size();
+    header.num_measures = 0;
+    BOOST_FOREACH( ControlPoint const& cp, m_control_points )
+      header.num_measures += cp.size();
+    header.measures_offset = sizeof(ColumnarHeader) + header.num_points * sizeof(ColumnarPoint);
+    f.write( (char*)&header, sizeof(header) );
+
+    // Point records
+    ColumnarPoint point;
+    std::memset( &point, 0, sizeof(point) );
+    uint64 first_measure = 0;
+    BOOST_FOREACH( ControlPoint const& cp, m_control_points ) {
+      for ( size_t i = 0; i < 3; i++ ) {
+        point.position[i] = cp.position()[i];
+        point.sigma[i] = cp.sigma()[i];
+      }
+      point.first_measure = first_measure;
+      point.num_measures = cp.size();
+      point.id = strings( cp.id() );
+      point.type = cp.type();
+      point.ignore = cp.ignore();
+      f.write( (char*)&point, sizeof(point) );
+      first_measure += cp.size();
+    }
+
+    // Measure records
+    ColumnarMeasure measure;
+    std::memset( &measure, 0, sizeof(measure) );
+    BOOST_FOREACH( ControlPoint const& cp, m_control_points ) {
+      BOOST_FOREACH( ControlMeasure const& cm, cp ) {
+        measure.col = cm.position()[0];
+        measure.row = cm.position()[1];
+        measure.col_sigma = cm.sigma()[0];
+        measure.row_sigma = cm.sigma()[1];
+        measure.diameter = cm.diameter();
+        measure.focalplane_x = cm.focalplane()[0];
+        measure.focalplane_y = cm.focalplane()[1];
+        measure.ephemeris_time = cm.ephemeris_time();
+        measure.image_id = cm.image_id();
+        if ( cm.is_compact() ) {
+          measure.serial = measure.date_time = measure.description = measure.chooser = 0;
+        } else {
+          measure.serial = strings( cm.serial() );
+          measure.date_time = strings( cm.date_time() );
+          measure.description = strings( cm.description() );
+          measure.chooser = strings( cm.chooser() );
+        }
+        measure.type = cm.type();
+        measure.ignore = cm.ignore();
+        measure.pixels_dominant = cm.is_pixels_dominant();
+        f.write( (char*)&measure, sizeof(measure) );
+      }
+    }
+
+    // String table
+    header.num_strings = strings.size();
+    header.strings_offset = header.measures_offset + header.num_measures * sizeof(ColumnarMeasure);
+    header.characters_offset = header.strings_offset + (header.num_strings+1) * sizeof(uint64);
+    uint64 offset = 0;
+    for ( size_t i = 0; i < strings.size(); i++ ) {
+      f.write( (char*)&offset, sizeof(offset) );
+      offset += strings[i].size();
+    }
+    f.write( (char*)&offset, sizeof(offset) );
+    for ( size_t i = 0; i < strings.size(); i++ )
+      f.write( strings[i].data(), strings[i].size() );
+    write_padding( f, header.characters_offset + offset, align8( header.characters_offset + offset ) );
+
+    // Now that the string table is placed, finish the header
+    f.seekp( 0 );
+    f.write( (char*)&header, sizeof(header) );
+
+    if ( !f.good() )
+      vw_throw( IOErr() << "Failed to write \"" << filename << "\"." );
+    f.close();
+  }
+
+  /// Reading the columnar binary style control network
+  void ControlNetwork::read_columnar( std::string const& filename ) {
+    ControlNetworkReader reader( filename );
+
+    m_type = reader.type();
+    m_targetName = reader.target_name();
+    m_networkId = reader.network_id();
+    m_created = reader.created();
+    m_modified = reader.modified();
+    m_description = reader.description();
+    m_userName = reader.user_name();
+
+    m_control_points.clear();
+    m_control_points.resize( reader.size() );
+    for ( size_t p = 0; p < reader.size(); p++ )
+      reader.read_point( p, m_control_points[p] );
+  }
+
   /// Write an isis style control network
   void ControlNetwork::write_isis( std::string filename ) {
     // Recording the modified time
@@ -767,6 +995,171 @@ namespace ba {
     f.close();
   }
 
+  ////////////////////////////
+  // Control Network Reader //
+  ////////////////////////////
+
+  struct ControlNetworkReader::MappedFile {
+#if VW_HAVE_PKG_BOOST_IOSTREAMS
+    boost::iostreams::mapped_file_source file;
+#else
+    size_t length;
+#endif
+    const char* data;
+    ColumnarHeader const* header;
+    ColumnarPoint const* points;
+    ColumnarMeasure const* measures;
+    uint64 const* string_offsets;
+    const char* characters;
+
+    // The string table decoded once, so measures copy shared strings
+    // rather than allocating their own
+    std::vector<std::string> strings;
+
+    // Measures with the same serial, date, description and chooser
+    // share one set of strings
+    typedef boost::tuple<uint32,uint32,uint32,uint32> StringsKey;
+    mutable std::map<StringsKey, boost::shared_ptr<ControlMeasureStrings> > measure_strings;
+    mutable Mutex measure_strings_mutex;
+
+    std::string const& string( uint32 index ) const {
+      if ( index >= strings.size() )
+        vw_throw( IOErr() << "Control network string index out of range." );
+      return strings[index];
+    }
+
+    boost::shared_ptr<ControlMeasureStrings> const& shared_strings( ColumnarMeasure const& record ) const {
+      StringsKey key( record.serial, record.date_time, record.description, record.chooser );
+      boost::shared_ptr<ControlMeasureStrings>& result = measure_strings[key];
+      if ( !result ) {
+        result.reset( new ControlMeasureStrings );
+        result->serial = string( record.serial );
+        result->date_time = string( record.date_time );
+        result->description = string( record.description );
+        result->chooser = string( record.chooser );
+      }
+      return result;
+    }
+  };
+
+  ControlNetworkReader::ControlNetworkReader( std::string const& filename ) :
+    m_file( new MappedFile ) {
+    if ( !is_columnar( filename ) )
+      vw_throw( IOErr() << "\"" << filename << "\" is not a columnar control network." );
+
+    size_t length;
+#if VW_HAVE_PKG_BOOST_IOSTREAMS
+    m_file->file.open( filename );
+    m_file->data = m_file->file.data();
+    length = m_file->file.size();
+#else
+    int filedes = open( filename.c_str(), O_RDONLY );
+    if ( filedes < 0 )
+      vw_throw( IOErr() << "Failed to open \"" << filename << "\"." );
+    length = m_file->length = lseek( filedes, 0, SEEK_END );
+    void* data = mmap( 0, length, PROT_READ, MAP_PRIVATE, filedes, 0 );
+    close( filedes );
+    if ( data == MAP_FAILED )
+      vw_throw( IOErr() << "Failed to map \"" << filename << "\"." );
+    m_file->data = (const char*)data;
+#endif
+
+    // The sections are 8 byte aligned within the page aligned mapping
+    MappedFile& file = *m_file;
+    file.header = (ColumnarHeader const*)file.data;
+    if ( length < sizeof(ColumnarHeader) )
+      vw_throw( IOErr() << "\"" << filename << "\" is a truncated or corrupt control network." );
+    if ( file.header->version != COLUMNAR_VERSION )
+      vw_throw( IOErr() << "\"" << filename << "\" has unsupported columnar control network version "
+                << file.header->version << "." );
+    if ( file.header->characters_offset > length ||
+         file.header->measures_offset != sizeof(ColumnarHeader) + file.header->num_points * sizeof(ColumnarPoint) ||
+         file.header->strings_offset != file.header->measures_offset + file.header->num_measures * sizeof(ColumnarMeasure) ||
+         file.header->characters_offset != file.header->strings_offset + (file.header->num_strings+1) * sizeof(uint64) ||
+         file.header->num_strings < 7 )
+      vw_throw( IOErr() << "\"" << filename << "\" is a truncated or corrupt control network." );
+    file.points = (ColumnarPoint const*)( file.data + sizeof(ColumnarHeader) );
+    file.measures = (ColumnarMeasure const*)( file.data + file.header->measures_offset );
+    file.string_offsets = (uint64 const*)( file.data + file.header->strings_offset );
+    file.characters = file.data + file.header->characters_offset;
+    if ( file.header->characters_offset + file.string_offsets[file.header->num_strings] > length )
+      vw_throw( IOErr() << "\"" << filename << "\" is a truncated or corrupt control network." );
+
+    file.strings.reserve( file.header->num_strings );
+    for ( size_t i = 0; i < file.header->num_strings; i++ ) {
+      if ( file.string_offsets[i] > file.string_offsets[i+1] )
+        vw_throw( IOErr() << "\"" << filename << "\" is a truncated or corrupt control network." );
+      file.strings.push_back( std::string( file.characters + file.string_offsets[i],
+                                           file.string_offsets[i+1] - file.string_offsets[i] ) );
+    }
+  }
+
+  ControlNetworkReader::~ControlNetworkReader() {
+#if !VW_HAVE_PKG_BOOST_IOSTREAMS
+    munmap( (void*)m_file->data, m_file->length );
+#endif
+  }
+
+  bool ControlNetworkReader::is_columnar( std::string const& filename ) {
+    std::ifstream f( filename.c_str(), std::ios::binary );
+    ColumnarHeader header;
+    if ( !f.read( (char*)&header, sizeof(header) ) )
+      return false;
+    return std::memcmp( header.magic, COLUMNAR_MAGIC, sizeof(COLUMNAR_MAGIC) ) == 0;
+  }
+
+  uint32 ControlNetworkReader::version() const { return m_file->header->version; }
+  ControlNetwork::ControlNetworkType ControlNetworkReader::type() const {
+    return ControlNetwork::ControlNetworkType( m_file->header->type );
+  }
+  std::string ControlNetworkReader::target_name() const { return m_file->string(1); }
+  std::string ControlNetworkReader::network_id()  const { return m_file->string(2); }
+  std::string ControlNetworkReader::created()     const { return m_file->string(3); }
+  std::string ControlNetworkReader::modified()    const { return m_file->string(4); }
+  std::string ControlNetworkReader::description() const { return m_file->string(5); }
+  std::string ControlNetworkReader::user_name()   const { return m_file->string(6); }
+  size_t ControlNetworkReader::size() const { return m_file->header->num_points; }
+  size_t ControlNetworkReader::num_measures() const { return m_file->header->num_measures; }
+
+  void ControlNetworkReader::read_point( size_t index, ControlPoint& point ) const {
+    VW_ASSERT( index < size(), ArgumentErr() << "ControlNetworkReader: point index out of range." );
+    ColumnarPoint const& record = m_file->points[index];
+    if ( record.first_measure + record.num_measures > num_measures() )
+      vw_throw( IOErr() << "Control network point " << index << " has invalid measures." );
+
+    point.set_id( m_file->string( record.id ) );
+    point.set_type( ControlPoint::ControlPointType( record.type ) );
+    point.set_ignore( record.ignore );
+    point.set_position( Vector3( record.position[0], record.position[1], record.position[2] ) );
+    point.set_sigma( Vector3( record.sigma[0], record.sigma[1], record.sigma[2] ) );
+
+    point.resize( record.num_measures );
+    Mutex::Lock lock( m_file->measure_strings_mutex );
+    for ( size_t m = 0; m < record.num_measures; m++ ) {
+      ColumnarMeasure const& mrecord = m_file->measures[record.first_measure + m];
+      ControlMeasure& cm = point[m];
+      cm.set_position( mrecord.col, mrecord.row );
+      cm.set_sigma( mrecord.col_sigma, mrecord.row_sigma );
+      cm.set_diameter( mrecord.diameter );
+      cm.set_focalplane( mrecord.focalplane_x, mrecord.focalplane_y );
+      cm.set_ephemeris_time( mrecord.ephemeris_time );
+      cm.set_image_id( mrecord.image_id );
+      cm.set_type( ControlMeasure::ControlMeasureType( mrecord.type ) );
+      cm.set_ignore( mrecord.ignore );
+      cm.set_pixels_dominant( mrecord.pixels_dominant );
+      if ( mrecord.serial || mrecord.date_time || mrecord.description || mrecord.chooser )
+        cm.set_strings( m_file->shared_strings( mrecord ) );
+      else
+        cm.set_compact();
+    }
+  }
+
+  ControlPoint ControlNetworkReader::operator[]( size_t index ) const {
+    ControlPoint point;
+    read_point( index, point );
+    return point;
+  }
+
   ////////////////////////////
   // Generic Ostream        //
   ////////////////////////////
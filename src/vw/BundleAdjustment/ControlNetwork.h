@@ -33,25 +33,37 @@
 
 // Boost
 #include <boost/algorithm/string.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/iterator/iterator_facade.hpp>
 
 namespace vw {
 namespace ba {
 
   enum ControlStorageFmt { FmtBinary, FmtIsisPvl };
 
+  /// The descriptive strings of a ControlMeasure. They are stored out
+  /// of line and shared between copies of a measure.
+  struct ControlMeasureStrings {
+    std::string serial, date_time, description, chooser;
+  };
+
   /// A ControlMeasure identifies a pixel in an image that corresponds
   /// to a control point.  In addition to the location of the pixel, the
   /// control measure also stores the uncertainty of the measurement,
   /// and a identifier for the image from which it was derived.
   class ControlMeasure {
-    std::string m_serialNumber;
+    boost::shared_ptr<ControlMeasureStrings> m_strings;
     float       m_col, m_row, m_col_sigma, m_row_sigma, m_diameter;
-    std::string m_date_time, m_description, m_chooserName;
     double      m_focalplane_x, m_focalplane_y;
     double      m_ephemeris_time;
     uint64      m_image_id;
     bool        m_ignore, m_pixels_dominant;
 
+    // Writable strings, unshared from any copies (copy on write)
+    ControlMeasureStrings& strings();
+
   public:
 
     /// Control Measure Type
@@ -128,7 +140,7 @@ namespace ba {
         m_focalplane_x = location[0]; m_focalplane_y = location[1];
       }
     }
-    bool is_pixels_dominant() { return m_pixels_dominant; }
+    bool is_pixels_dominant() const { return m_pixels_dominant; }
     void set_pixels_dominant( bool state ) { m_pixels_dominant = state; }
 
     /// Setting/Reading the pixel error for this point.
@@ -152,26 +164,40 @@ namespace ba {
     void set_image_id(uint64 image_id) { m_image_id = image_id; }
 
     /// Setting/Reading the description
-    std::string description() const { return m_description; }
-    void set_description(std::string const& description) { m_description = description; }
+    std::string description() const { return m_strings ? m_strings->description : std::string(); }
+    void set_description(std::string const& description) { strings().description = description; }
 
     /// Setting/Reading the data & time
-    std::string date_time() const { return m_date_time; }
-    void set_date_time(std::string const& date_time) { m_date_time = date_time; }
+    std::string date_time() const { return m_strings ? m_strings->date_time : std::string(); }
+    void set_date_time(std::string const& date_time) { strings().date_time = date_time; }
 
     /// Setting/Reading the chooser's name
-    std::string chooser() const { return m_chooserName; }
-    void set_chooser(std::string const& chooser) { m_chooserName = chooser; }
+    std::string chooser() const { return m_strings ? m_strings->chooser : std::string(); }
+    void set_chooser(std::string const& chooser) { strings().chooser = chooser; }
 
     /// Setting/Reading the measure's serial number
-    std::string serial() const { return m_serialNumber; }
-    void set_serial(std::string const& serial) { m_serialNumber = serial; }
+    std::string serial() const { return m_strings ? m_strings->serial : std::string(); }
+    void set_serial(std::string const& serial) { strings().serial = serial; }
+
+    /// A compact measure doesn't store the serial number, date,
+    /// description or chooser; they all read back as empty. Setting
+    /// any of them makes the measure full size again.
+    bool is_compact() const { return !m_strings; }
+    void set_compact() { m_strings.reset(); }
+
+    /// Shares an existing set of strings with this measure. They are
+    /// copied if this measure later changes one of them.
+    void set_strings(boost::shared_ptr<ControlMeasureStrings> const& strings) { m_strings = strings; }
 
     /// Setting/Reading whether this control measurement should be
     /// ignored in a bundle adjustment.
     bool ignore() const { return m_ignore; }
     void set_ignore(bool state) { m_ignore = state; }
 
+    /// Setting/Reading the measured feature's diameter
+    float diameter() const { return m_diameter; }
+    void set_diameter( float diameter ) { m_diameter = diameter; }
+
     /// Setting/Reading Ephemeris Time
     double ephemeris_time() const { return m_ephemeris_time; }
     void set_ephemeris_time( double const& time ) { m_ephemeris_time = time; }
@@ -407,15 +433,93 @@ namespace ba {
     size_t find_measure(ControlMeasure const& query);
 
     /// File I/O
+    ///
+    /// read_binary also accepts the columnar format, which is
+    /// detected by its header.
     void read_binary ( std::string const& filename );
     void read_isis   ( std::string const& filename );
     void write_binary( std::string        filename ) const;
     void write_isis  ( std::string        filename );
 
+    /// Columnar binary format: fixed width point and measure records
+    /// with all strings (serial numbers, ids, ...) stored once in a
+    /// string table. See ControlNetworkReader for reading one without
+    /// loading it all.
+    void read_columnar ( std::string const& filename );
+    void write_columnar( std::string const& filename ) const;
+
   }; // End class ControlNetwork
 
   std::ostream& operator<<( std::ostream& os, ControlNetwork const& cnet);
 
+  /// Reads a control network written by ControlNetwork::write_columnar.
+  /// The file is memory mapped and control points are only decoded
+  /// when they are asked for, so a network can be streamed through
+  /// without ever building the whole ControlNetwork:
+  ///
+  ///   ControlNetworkReader reader( "points.cnet" );
+  ///   BOOST_FOREACH( ControlPoint const& cp, reader ) { ... }
+  ///
+  /// The format is native endian, like the other binary format.
+  class ControlNetworkReader : private boost::noncopyable {
+    struct MappedFile;
+    boost::scoped_ptr<MappedFile> m_file;
+
+  public:
+    ControlNetworkReader( std::string const& filename );
+    ~ControlNetworkReader();
+
+    /// Returns true if the file starts with a columnar header
+    static bool is_columnar( std::string const& filename );
+
+    /// Format version of the opened file
+    uint32 version() const;
+
+    /// Network description
+    ControlNetwork::ControlNetworkType type() const;
+    std::string target_name() const;
+    std::string network_id() const;
+    std::string created() const;
+    std::string modified() const;
+    std::string description() const;
+    std::string user_name() const;
+
+    /// Number of control points and measures in the file
+    size_t size() const;
+    size_t num_measures() const;
+
+    /// Decodes a single control point. Reusing the same ControlPoint
+    /// reuses its measure storage.
+    void read_point( size_t index, ControlPoint& point ) const;
+    ControlPoint operator[]( size_t index ) const;
+
+    /// Forward iteration, decoding one point at a time
+    class const_iterator : public boost::iterator_facade<const_iterator, ControlPoint const,
+                                                         boost::forward_traversal_tag> {
+      friend class boost::iterator_core_access;
+      ControlNetworkReader const* m_reader;
+      size_t m_index;
+      mutable ControlPoint m_point;
+      mutable bool m_decoded;
+
+      void increment() { m_index++; m_decoded = false; }
+      bool equal( const_iterator const& other ) const { return m_index == other.m_index; }
+      ControlPoint const& dereference() const {
+        if ( !m_decoded ) {
+          m_reader->read_point( m_index, m_point );
+          m_decoded = true;
+        }
+        return m_point;
+      }
+    public:
+      const_iterator( ControlNetworkReader const* reader = 0, size_t index = 0 ) :
+        m_reader(reader), m_index(index), m_decoded(false) {}
+    };
+    typedef const_iterator iterator;
+    const_iterator begin() const { return const_iterator( this, 0 ); }
+    const_iterator end  () const { return const_iterator( this, size() ); }
+  };
+
   /// I/O for ISIS Pvl file
   void read_pvl_property( std::ostringstream& ostr,
                           std::vector< std::string >& tokens );
@@ -17,6 +17,7 @@
 
 
 #include <vw/BundleAdjustment/ControlNetworkLoader.h>
+#include <vw/Core/ThreadPool.h>
 #include <vw/Stereo/StereoModel.h>
 #include <vw/InterestPoint/Matcher.h>
 
@@ -27,17 +28,93 @@ using namespace vw::ba;
 
 namespace fs = boost::filesystem;
 
-struct ContainsEqualIP {
-  ip::InterestPoint& m_compare;
-  ContainsEqualIP( ip::InterestPoint& comp ) : m_compare(comp) {}
+namespace {
+
+  // Reads one match file. Run on a worker thread; the results are
+  // only looked at after the queue has been joined.
+  class MatchFileReadTask : public Task, private boost::noncopyable {
+    std::string m_match_file;
+    std::vector<ip::InterestPoint> &m_ip1, &m_ip2;
+  public:
+    MatchFileReadTask( std::string const& match_file,
+                       std::vector<ip::InterestPoint>& ip1,
+                       std::vector<ip::InterestPoint>& ip2 ) :
+      m_match_file(match_file), m_ip1(ip1), m_ip2(ip2) {}
+
+    void operator()() {
+      vw_out(DebugMessage,"ba") << "Loading: " << m_match_file << std::endl;
+      ip::read_binary_match_file( m_match_file, m_ip1, m_ip2 );
+      // Descriptors are not needed and are most of the memory
+      std::for_each( m_ip1.begin(), m_ip1.end(), ip::remove_descriptor );
+      std::for_each( m_ip2.begin(), m_ip2.end(), ip::remove_descriptor );
+    }
+  };
+
+  // Triangulates a contiguous range of control points
+  class TriangulateTask : public Task, private boost::noncopyable {
+    ba::ControlNetwork& m_cnet;
+    size_t m_begin, m_end;
+    std::vector<boost::shared_ptr<camera::CameraModel> > const& m_camera_models;
+    double m_min_angle_radians;
+    TerminalProgressCallback const& m_progress;
+  public:
+    TriangulateTask( ba::ControlNetwork& cnet, size_t begin, size_t end,
+                     std::vector<boost::shared_ptr<camera::CameraModel> > const& camera_models,
+                     double min_angle_radians, TerminalProgressCallback const& progress ) :
+      m_cnet(cnet), m_begin(begin), m_end(end), m_camera_models(camera_models),
+      m_min_angle_radians(min_angle_radians), m_progress(progress) {}
+
+    void operator()() {
+      for ( size_t i = m_begin; i < m_end; i++ )
+        ba::triangulate_control_point( m_cnet[i], m_camera_models, m_min_angle_radians );
+      m_progress.report_incremental_progress( double(m_end - m_begin) / double(m_cnet.size()) );
+    }
+  };
+
+  // Disjoint sets with path halving and union by rank. Every matched
+  // interest point is a set; each match joins two of them, and the
+  // sets that are left are the tracks.
+  class DisjointSets {
+    std::vector<size_t> m_parent;
+    std::vector<uint8> m_rank;
+  public:
+    size_t add() {
+      m_parent.push_back( m_parent.size() );
+      m_rank.push_back( 0 );
+      return m_parent.size() - 1;
+    }
 
-  bool operator()( boost::shared_ptr<IPFeature> in ) {
-    if (  m_compare.x == in->m_ip.x &&
-          m_compare.y == in->m_ip.y )
-      return true;
-    return false;
+    size_t find( size_t i ) {
+      while ( m_parent[i] != i ) {
+        m_parent[i] = m_parent[m_parent[i]];
+        i = m_parent[i];
+      }
+      return i;
+    }
+
+    void join( size_t i, size_t j ) {
+      i = find(i);
+      j = find(j);
+      if ( i == j )
+        return;
+      if ( m_rank[i] < m_rank[j] )
+        std::swap(i,j);
+      m_parent[j] = i;
+      if ( m_rank[i] == m_rank[j] )
+        m_rank[i]++;
+    }
+  };
+
+  // A matched interest point, unique per image and location
+  struct TrackFeature {
+    size_t image_id;
+    float x, y, scale;
+  };
+
+  bool feature_image_less( TrackFeature const* a, TrackFeature const* b ) {
+    return a->image_id < b->image_id;
   }
-};
+}
 
 // Utility for checking that the point is BA safe
 void safe_measurement( ip::InterestPoint& ip ) {
@@ -114,20 +191,21 @@ bool vw::ba::build_control_network( bool triangulate_control_points,
                                     std::vector<std::string> const& image_files,
                                     std::map< std::pair<int, int>, std::string> const& match_files,
                                     size_t min_matches,
-                                    double min_angle_radians) {
+                                    double min_angle_radians,
+                                    bool compact_measures,
+                                    int num_threads ) {
 
   cnet.clear();
+  if ( image_files.empty() )
+    vw_throw( ArgumentErr() << "No images given to build the control network from." );
 
   // We can't guarantee that image_files is sorted, so we make a
   // std::map to give ourselves a sorted list and access to a binary search.
   std::map<std::string,size_t> image_prefix_map;
   size_t count = 0;
-  ba::CameraRelationNetwork<ba::IPFeature> crn;
   BOOST_FOREACH( std::string const& file, image_files ) {
     fs::path file_path(file);
     image_prefix_map[file_path.replace_extension().string()] = count;
-    crn.add_node( ba::CameraNode<ba::IPFeature>( count,
-                                                 file_path.stem().string() ) );
     count++;
   }
 
@@ -170,67 +248,67 @@ bool vw::ba::build_control_network( bool triangulate_control_points,
     }
   }
 
-  // Loop through the match files...
+  // Reading the match files in parallel
+  std::vector< std::vector<ip::InterestPoint> > ip1_vec( match_files_vec.size() ),
+    ip2_vec( match_files_vec.size() );
+  {
+    vw_out() << "Loading " << match_files_vec.size() << " match files.\n";
+    FifoWorkQueue queue( num_threads );
+    for (size_t file_iter = 0; file_iter < match_files_vec.size(); file_iter++)
+      queue.add_task( boost::shared_ptr<Task>( new MatchFileReadTask( match_files_vec[file_iter],
+                                                                      ip1_vec[file_iter],
+                                                                      ip2_vec[file_iter] ) ) );
+    queue.join_all();
+  }
+
+  // Giving every distinct interest point (by image and location) a
+  // feature index, and joining the features of every match. Each
+  // image keeps a lookup of the locations it has seen.
+  typedef std::map<std::pair<float,float>, size_t> LocationMap;
+  std::vector<LocationMap> image_features( num_images );
+  std::vector<TrackFeature> features;
+  DisjointSets tracks;
   size_t num_load_rejected = 0, num_loaded = 0;
   for (size_t file_iter = 0; file_iter < match_files_vec.size(); file_iter++){
-    std::string match_file = match_files_vec[file_iter];
-    size_t index1 = index1_vec[file_iter];
-    size_t index2 = index2_vec[file_iter];
-
-    // Actually read in the file as it seems we've found something correct
-    std::vector<ip::InterestPoint> ip1, ip2;
-    vw_out(DebugMessage,"ba") << "Loading: " << match_file << std::endl;
-    ip::read_binary_match_file( match_file, ip1, ip2 );
-    if ( ip1.size() < min_matches ) {
+    std::string const& match_file = match_files_vec[file_iter];
+    size_t index[2] = { index1_vec[file_iter], index2_vec[file_iter] };
+    std::vector<ip::InterestPoint>* ip[2] = { &ip1_vec[file_iter], &ip2_vec[file_iter] };
+
+    if ( ip[0]->size() < min_matches ) {
       vw_out(DebugMessage,"ba") << "\t" << match_file << "    "
-                                << ip1.size() << " matches. [rejected]\n";
-      num_load_rejected += ip1.size();
+                                << ip[0]->size() << " matches. [rejected]\n";
+      num_load_rejected += ip[0]->size();
+      std::vector<ip::InterestPoint>().swap( *ip[0] );
+      std::vector<ip::InterestPoint>().swap( *ip[1] );
       continue;
     }
     vw_out(DebugMessage,"ba") << "\t" << match_file << "    "
-                              << ip1.size() << " matches.\n";
-    num_loaded += ip1.size();
-
-    // Remove descriptors from interest points and correct scale
-    std::for_each( ip1.begin(), ip1.end(), ip::remove_descriptor );
-    std::for_each( ip2.begin(), ip2.end(), ip::remove_descriptor );
-    std::for_each( ip1.begin(), ip1.end(), safe_measurement );
-    std::for_each( ip2.begin(), ip2.end(), safe_measurement );
-
-    typedef boost::shared_ptr< ba::IPFeature > f_ptr;
-    typedef std::list< f_ptr >::iterator f_itr;
-
-    // Checking to see if features already exist, adding if they
-    // don't, then linking them.
-    vw_out() << "Building the control network for " << match_file <<".\n";
-    TerminalProgressCallback progress("ba", "Building: ");
-    progress.report_progress(0);
-    double inc_prog = 1.0/double(ip1.size());
-    for ( size_t k = 0; k < ip1.size(); k++ ) { // Loop through all existing IP
-      // Check if either IP is already in the lists
-      f_itr ipfeature1 = std::find_if( crn[index1].begin(),
-                                       crn[index1].end(),
-                                       ContainsEqualIP( ip1[k] ) );
-      f_itr ipfeature2 = std::find_if( crn[index2].begin(),
-                                       crn[index2].end(),
-                                       ContainsEqualIP( ip2[k] ) );
-      // If the IP are new, add them to the list
-      if ( ipfeature1 == crn[index1].end() ) {
-        crn[index1].relations.push_front( f_ptr( new ba::IPFeature( ip1[k], index1 ) ) );
-        ipfeature1 = crn[index1].begin();
-      }
-      if ( ipfeature2 == crn[index2].end() ) {
-        crn[index2].relations.push_front( f_ptr( new ba::IPFeature( ip2[k], index2 ) ) );
-        ipfeature2 = crn[index2].begin();
+                              << ip[0]->size() << " matches.\n";
+    num_loaded += ip[0]->size();
+
+    for ( size_t k = 0; k < ip[0]->size(); k++ ) {
+      size_t feature[2];
+      for ( size_t side = 0; side < 2; side++ ) {
+        ip::InterestPoint& point = (*ip[side])[k];
+        safe_measurement( point );
+        std::pair<LocationMap::iterator,bool> result =
+          image_features[index[side]].insert( std::make_pair( std::make_pair( point.x, point.y ),
+                                                              features.size() ) );
+        if ( result.second ) {
+          TrackFeature f = { index[side], point.x, point.y, point.scale };
+          features.push_back( f );
+          tracks.add();
+        }
+        feature[side] = result.first->second;
       }
+      tracks.join( feature[0], feature[1] );
+    }
 
-      // Doubly linking
-      (*ipfeature1)->connection( *ipfeature2, false );
-      (*ipfeature2)->connection( *ipfeature1, false );
-      progress.report_incremental_progress(inc_prog );
-    } // End loop through ip1
-    progress.report_finished();
-  } // End loop through match files
+    // Release the interest points as soon as they are indexed
+    std::vector<ip::InterestPoint>().swap( *ip[0] );
+    std::vector<ip::InterestPoint>().swap( *ip[1] );
+  }
+  std::vector<LocationMap>().swap( image_features );
 
   if ( num_load_rejected != 0 ) {
     vw_out(WarningMessage,"ba") << "\tDidn't load " << num_load_rejected
@@ -240,21 +318,72 @@ bool vw::ba::build_control_network( bool triangulate_control_points,
     vw_out(WarningMessage,"ba") << "\tLoaded " << num_loaded << " matches.\n";
   }
 
-  // Building control network
-  bool success = crn.write_controlnetwork( cnet );
+  // Gathering the features of each track, in order of first appearance
+  std::vector<size_t> track_of_root( features.size(), size_t(-1) );
+  std::vector< std::vector<TrackFeature const*> > track_features;
+  for ( size_t i = 0; i < features.size(); i++ ) {
+    size_t root = tracks.find(i);
+    if ( track_of_root[root] == size_t(-1) ) {
+      track_of_root[root] = track_features.size();
+      track_features.push_back( std::vector<TrackFeature const*>() );
+    }
+    track_features[track_of_root[root]].push_back( &features[i] );
+  }
+
+  // Building control network. Tracks that saw the same image twice
+  // are 'spiral' errors, some match was wrong, and are thrown out.
+  ControlMeasure prototype;
+  if ( compact_measures )
+    prototype.set_compact();
+  int spiral_error_count = 0;
+  cnet.reserve( track_features.size() );
+  BOOST_FOREACH( std::vector<TrackFeature const*>& track, track_features ) {
+    std::sort( track.begin(), track.end(), feature_image_less );
+    bool spiral = false;
+    for ( size_t i = 1; i < track.size(); i++ )
+      if ( track[i]->image_id == track[i-1]->image_id )
+        spiral = true;
+    if ( spiral ) {
+      spiral_error_count++;
+      continue;
+    }
+
+    ControlPoint cpoint( ControlPoint::TiePoint );
+    cpoint.reserve( track.size() );
+    BOOST_FOREACH( TrackFeature const* f, track ) {
+      ControlMeasure cm( prototype );
+      cm.set_position( f->x, f->y );
+      cm.set_sigma( f->scale, f->scale );
+      cm.set_image_id( f->image_id );
+      cpoint.add_measure( cm );
+    }
+    cnet.add_control_point( cpoint );
+  }
+  if ( spiral_error_count != 0 )
+    vw_out(WarningMessage,"ba") << "\t" << spiral_error_count
+                                << " control points removed due to spiral errors.\n";
+
+  if ( cnet.size() == 0 ) {
+    vw_out(WarningMessage,"ba")
+      << "Failed to load any points, control network is empty.";
+    return false;
+  }
 
   // Triangulating Positions
   if (triangulate_control_points){
     TerminalProgressCallback progress("ba", "Triangulating: ");
     progress.report_progress(0);
-    double inc_prog = 1.0/double(cnet.size());
-    BOOST_FOREACH( ba::ControlPoint& cpoint, cnet ) {
-      progress.report_incremental_progress(inc_prog );
-      ba::triangulate_control_point( cpoint, camera_models, min_angle_radians );
-    }
+    const size_t points_per_task = 1024;
+    FifoWorkQueue queue( num_threads );
+    for ( size_t begin = 0; begin < cnet.size(); begin += points_per_task )
+      queue.add_task( boost::shared_ptr<Task>( new TriangulateTask( cnet, begin,
+                                                                    std::min( begin + points_per_task, cnet.size() ),
+                                                                    camera_models, min_angle_radians,
+                                                                    progress ) ) );
+    queue.join_all();
     progress.report_finished();
   }
-  return success;
+  return true;
 }
 
 void vw::ba::add_ground_control_points(vw::ba::ControlNetwork& cnet,
@@ -36,6 +36,12 @@ namespace ba {
   /// image names. This function uses Boost::FS to then find match files
   /// that would have been created by 'ipmatch' by searching the entire
   /// permutation of the image_files vector.
+  ///
+  /// Match files are read and control points triangulated on
+  /// num_threads threads. The default is serial; only pass more when
+  /// the camera models are safe to call concurrently. Matches are chained into tracks
+  /// with a union-find pass. With compact_measures the measures don't
+  /// carry any strings (see ControlMeasure::set_compact).
   bool build_control_network(bool triangulate_points,
                              ControlNetwork& cnet,
                              std::vector<boost::shared_ptr<camera::CameraModel> >
@@ -43,7 +49,9 @@ namespace ba {
                              std::vector<std::string> const& image_files,
                              std::map< std::pair<int, int>, std::string> const& match_files,
                              size_t min_matches,
-                             double min_angle_radians);
+                             double min_angle_radians,
+                             bool compact_measures = false,
+                             int num_threads = 1);
   
   /// Recomputes the world location of a point based on camera observations.
   /// - Returns the mean triangulation error.
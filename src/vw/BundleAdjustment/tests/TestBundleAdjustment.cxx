@@ -242,6 +242,25 @@ TEST_F( NullTest, AdjustSparse ) {
   }
 }
 
+TEST_F( NullTest, AdjustSparsePCG ) {
+  TestBAModel model( cameras, cnet );
+  AdjustSparse< TestBAModel, L2Error > adjuster( model, L2Error(), false, false);
+  adjuster.set_solver( SchurPCGSolver );
+
+  // Running BA
+  double abs_tol = 1e10, rel_tol = 1e10;
+  for ( uint32 i = 0; i < 5; i++ )
+    adjuster.update(abs_tol,rel_tol);
+  EXPECT_GT( adjuster.pcg_iterations(), 0 );
+
+  // Checking solutions
+  Vector<double,6> zero_vector;
+  for ( uint32 i = 0; i < 5; i++ ) {
+    Vector<double> solution = model.cam_params(i);
+    EXPECT_VECTOR_NEAR( solution, zero_vector, 1e-1 );
+  }
+}
+
 TEST_F( NullTest, AdjustRobustRef ) {
   TestBAModel model( cameras, cnet );
   AdjustRobustRef< TestBAModel, L2Error > adjuster( model, L2Error(), false, false);
@@ -317,6 +336,107 @@ TEST_F( ComparisonTest, Ref_VS_Sparse ) {
                         1e-3 );
 }
 
+TEST_F( ComparisonTest, Sparse_VS_SparsePCG ) {
+  std::vector<Vector<double> > ldl_solution;
+  std::vector<Vector<double> > pcg_solution;
+
+  { // Performing Sparse BA with the skyline LDL solver
+    TestBAModel model( cameras, cnet );
+    AdjustSparse< TestBAModel, L2Error > adjuster( model, L2Error(), false, false);
+
+    // Running BA
+    Timer timer("Sparse BA, skyline LDL solver");
+    double abs_tol = 1e10, rel_tol = 1e10;
+    for ( unsigned i = 0; i < 10; i++ )
+      adjuster.update(abs_tol,rel_tol);
+
+    // Storing result
+    for ( uint32 i = 0; i < 5; i++ )
+      ldl_solution.push_back( model.cam_params(i) );
+  }
+
+  { // Performing Sparse BA with the implicit Schur PCG solver
+    TestBAModel model( cameras, cnet );
+    AdjustSparse< TestBAModel, L2Error > adjuster( model, L2Error(), false, false);
+    adjuster.set_solver( SchurPCGSolver );
+
+    // Running BA
+    Timer timer("Sparse BA, Schur PCG solver");
+    double abs_tol = 1e10, rel_tol = 1e10;
+    for ( unsigned i = 0; i < 10; i++ )
+      adjuster.update(abs_tol,rel_tol);
+
+    // Storing result
+    for ( uint32 i = 0; i < 5; i++ )
+      pcg_solution.push_back( model.cam_params(i) );
+  }
+
+  // Comparison
+  for ( uint32 i = 0; i < 5; i++ )
+    ASSERT_VECTOR_NEAR( ldl_solution[i],
+                        pcg_solution[i],
+                        1e-3 );
+}
+
+TEST_F( ComparisonTest, Sparse_VS_SparseBlock ) {
+  std::vector<Vector<double> > ldl_solution;
+  std::vector<Vector<double> > blk_solution;
+
+  { // Performing Sparse BA with the skyline LDL solver
+    TestBAModel model( cameras, cnet );
+    AdjustSparse< TestBAModel, L2Error > adjuster( model, L2Error(), false, false);
+
+    // Running BA
+    Timer timer("Sparse BA, skyline LDL solver");
+    double abs_tol = 1e10, rel_tol = 1e10;
+    for ( unsigned i = 0; i < 10; i++ )
+      adjuster.update(abs_tol,rel_tol);
+
+    // Storing result
+    for ( uint32 i = 0; i < 5; i++ )
+      ldl_solution.push_back( model.cam_params(i) );
+  }
+
+  { // Performing Sparse BA with the block compressed LDL solver
+    TestBAModel model( cameras, cnet );
+    AdjustSparse< TestBAModel, L2Error > adjuster( model, L2Error(), false, false);
+    adjuster.set_solver( SparseBlockLDLSolver );
+
+    // Running BA
+    Timer timer("Sparse BA, block LDL solver");
+    double abs_tol = 1e10, rel_tol = 1e10;
+    for ( unsigned i = 0; i < 10; i++ )
+      adjuster.update(abs_tol,rel_tol);
+
+    // Storing result
+    for ( uint32 i = 0; i < 5; i++ )
+      blk_solution.push_back( model.cam_params(i) );
+  }
+
+  // Comparison
+  for ( uint32 i = 0; i < 5; i++ )
+    ASSERT_VECTOR_NEAR( ldl_solution[i],
+                        blk_solution[i],
+                        1e-3 );
+}
+
+TEST_F( ComparisonTest, SparseCovariance ) {
+  TestBAModel model( cameras, cnet );
+  AdjustSparse< TestBAModel, L2Error > adjuster( model, L2Error(), false, false);
+  double abs_tol = 1e10, rel_tol = 1e10;
+  for ( unsigned i = 0; i < 3; i++ )
+    adjuster.update(abs_tol,rel_tol);
+
+  // Dense inverse of the S used in the last update
+  Matrix<double> Cov = inverse( Matrix<double>( adjuster.S() ) );
+
+  std::vector<Matrix<double,6,6> > sparse_cov = adjuster.camera_covariances();
+  ASSERT_EQ( 5u, sparse_cov.size() );
+  for ( uint32 i = 0; i < 5; i++ )
+    EXPECT_MATRIX_NEAR( submatrix(Cov, 6*i, 6*i, 6, 6), sparse_cov[i],
+                        1e-6 * norm_frobenius(sparse_cov[i]) );
+}
+
 // For whatever reason .. RobustRef and RobustSparse diverge
 // quickly. This is probably do to unwise application of floats or
 // arithmetic ordering.
@@ -19,6 +19,7 @@
 #include <gtest/gtest_VW.h>
 
 #include <sstream>
+#include <boost/foreach.hpp>
 #include <vw/BundleAdjustment/ControlNetwork.h>
 
 #include <test/Helpers.h>
@@ -88,3 +89,91 @@ TEST( ControlNetwork, Construction ) {
   cnet.clear();
   ASSERT_EQ( cnet.size(), 0u );
 }
+
+TEST( ControlNetwork, CompactMeasure ) {
+  ControlMeasure cm( 10, 20, 1, 1, 3 );
+  EXPECT_FALSE( cm.is_compact() );
+  EXPECT_EQ( "Null", cm.serial() );
+
+  cm.set_compact();
+  EXPECT_TRUE( cm.is_compact() );
+  EXPECT_EQ( "", cm.serial() );
+  EXPECT_EQ( "", cm.date_time() );
+  EXPECT_VECTOR_DOUBLE_EQ( Vector2(10,20), cm.position() );
+
+  // Copies share strings until one of them is changed
+  ControlMeasure full( 1, 2, 1, 1, 0 );
+  full.set_serial( "image0" );
+  ControlMeasure copy( full );
+  copy.set_serial( "image1" );
+  EXPECT_EQ( "image0", full.serial() );
+  EXPECT_EQ( "image1", copy.serial() );
+
+  // Compact measures survive a round trip through a file
+  std::stringstream stream;
+  cm.write_binary( stream );
+  ControlMeasure read( stream, FmtBinary );
+  EXPECT_EQ( cm, read );
+  EXPECT_EQ( "", read.serial() );
+}
+
+TEST( ControlNetwork, Columnar ) {
+  ControlNetwork cnet( "Columnar", ControlNetwork::ImageToGround, "Moon" );
+  for ( uint32 i = 0; i < 20; i++ ) {
+    ControlPoint cpoint( i % 5 ? ControlPoint::TiePoint : ControlPoint::GroundControlPoint );
+    cpoint.set_position( Vector3( i, 2*i, 3*i ) );
+    cpoint.set_sigma( Vector3( 1, 2, 3 ) );
+    for ( uint32 j = 0; j < i % 4 + 1; j++ ) {
+      ControlMeasure cm( i + 0.5, j + 0.25, 1, 2, j );
+      cm.set_focalplane( j, i );
+      if ( i % 2 )
+        cm.set_compact();
+      else
+        cm.set_serial( j ? "image1" : "image0" );
+      cpoint.add_measure( cm );
+    }
+    cnet.add_control_point( cpoint );
+  }
+
+  test::UnlinkName filename( "columnar.cnet" );
+  cnet.write_columnar( filename );
+  EXPECT_TRUE( ControlNetworkReader::is_columnar( filename ) );
+
+  // Streaming through the points
+  ControlNetworkReader reader( filename );
+  EXPECT_EQ( cnet.size(), reader.size() );
+  EXPECT_EQ( "Moon", reader.target_name() );
+  EXPECT_EQ( "Columnar", reader.network_id() );
+  size_t p = 0;
+  BOOST_FOREACH( ControlPoint const& cp, reader ) {
+    ASSERT_LT( p, cnet.size() );
+    EXPECT_EQ( cnet[p].type(), cp.type() );
+    EXPECT_VECTOR_DOUBLE_EQ( cnet[p].position(), cp.position() );
+    EXPECT_VECTOR_DOUBLE_EQ( cnet[p].sigma(), cp.sigma() );
+    ASSERT_EQ( cnet[p].size(), cp.size() );
+    for ( size_t m = 0; m < cp.size(); m++ ) {
+      EXPECT_EQ( cnet[p][m], cp[m] );
+      EXPECT_VECTOR_DOUBLE_EQ( cnet[p][m].focalplane(), cp[m].focalplane() );
+      EXPECT_EQ( cnet[p][m].serial(), cp[m].serial() );
+      EXPECT_EQ( cnet[p][m].is_compact(), cp[m].is_compact() );
+    }
+    p++;
+  }
+  EXPECT_EQ( cnet.size(), p );
+
+  // read_binary recognizes the format too
+  ControlNetwork copy( "copy" );
+  copy.read_binary( filename );
+  EXPECT_EQ( ControlNetwork::ImageToGround, copy.type() );
+  EXPECT_EQ( cnet.num_ground_control_points(), copy.num_ground_control_points() );
+  ASSERT_EQ( cnet.size(), copy.size() );
+  EXPECT_EQ( cnet[7][3], copy[7][3] );
+
+  // Measures with the same strings share them, but still copy on write
+  ASSERT_EQ( "image0", copy[0][0].serial() );
+  ASSERT_EQ( "image0", copy[2][0].serial() );
+  copy[0][0].set_serial( "renamed" );
+  EXPECT_EQ( "renamed", copy[0][0].serial() );
+  EXPECT_EQ( "image0", copy[2][0].serial() );
+  EXPECT_EQ( "image0", reader[4][0].serial() );
+}
@@ -20,6 +20,8 @@
 
 #include <sstream>
 #include <vw/BundleAdjustment/ControlNetworkLoader.h>
+#include <vw/Camera/PinholeModel.h>
+#include <vw/InterestPoint/InterestData.h>
 
 #include <test/Helpers.h>
 
@@ -97,3 +99,59 @@ TEST( GCPLoad, LoadingGCP ) {
   EXPECT_EQ(27, cnet.size());
 }
 
+TEST( ControlNetworkLoad, BuildFromMatches ) {
+  // Three cameras side by side looking down +Z at a grid of points
+  std::vector<boost::shared_ptr<camera::CameraModel> > cameras;
+  std::vector<std::string> image_files;
+  for ( size_t i = 0; i < 3; i++ ) {
+    cameras.push_back( boost::shared_ptr<camera::CameraModel>
+                       ( new camera::PinholeModel( Vector3(double(i),0,0),
+                                                   math::identity_matrix<3>(),
+                                                   500, 500, 250, 250 ) ) );
+    std::ostringstream name;
+    name << "image" << i << ".tif";
+    image_files.push_back( name.str() );
+  }
+  std::vector<Vector3> points;
+  for ( int x = -2; x <= 2; x++ )
+    for ( int y = -2; y <= 2; y++ )
+      points.push_back( Vector3( x, y, 20 + x - y ) );
+
+  // Every pair of images matches every point, so the three matches of
+  // a point have to be chained into a single track.
+  std::map< std::pair<int,int>, std::string > match_files;
+  std::list<UnlinkName> unlink_names;
+  for ( int i = 0; i < 3; i++ )
+    for ( int j = i+1; j < 3; j++ ) {
+      std::ostringstream name;
+      name << "image" << i << "__image" << j << ".match";
+      unlink_names.push_back( UnlinkName( name.str() ) );
+      std::vector<ip::InterestPoint> ip1, ip2;
+      BOOST_FOREACH( Vector3 const& point, points ) {
+        Vector2 p1 = cameras[i]->point_to_pixel( point );
+        Vector2 p2 = cameras[j]->point_to_pixel( point );
+        ip1.push_back( ip::InterestPoint( p1[0], p1[1], 1 ) );
+        ip2.push_back( ip::InterestPoint( p2[0], p2[1], 1 ) );
+      }
+      ip::write_binary_match_file( unlink_names.back(), ip1, ip2 );
+      match_files[std::make_pair(i,j)] = unlink_names.back();
+    }
+
+  ControlNetwork cnet("loader");
+  ASSERT_TRUE( build_control_network( true, cnet, cameras, image_files,
+                                      match_files, 5, 0, true, 4 ) );
+  ASSERT_EQ( points.size(), cnet.size() );
+  BOOST_FOREACH( ControlPoint const& cp, cnet ) {
+    ASSERT_EQ( 3u, cp.size() );
+    for ( size_t m = 0; m < 3; m++ ) {
+      EXPECT_EQ( m, cp[m].image_id() );
+      EXPECT_TRUE( cp[m].is_compact() );
+    }
+
+    // The triangulated position is one of the grid points
+    double best = norm_2( cp.position() - points[0] );
+    BOOST_FOREACH( Vector3 const& point, points )
+      best = std::min( best, norm_2( cp.position() - point ) );
+    EXPECT_NEAR( 0, best, 1e-2 );
+  }
+}
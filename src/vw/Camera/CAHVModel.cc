@@ -150,6 +150,40 @@ namespace camera {
     return C;
   };
 
+  void CAHVModel::points_to_pixels(std::vector<Vector3> const& points,
+                                   std::vector<Vector2>      & pixels) const {
+    pixels.resize(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+      Vector3 vec = points[i] - C;
+      double dDot = dot_prod(vec, A);
+      pixels[i] = Vector2( dot_prod(vec, H) / dDot,
+                           dot_prod(vec, V) / dDot );
+    }
+  }
+
+  // (V - y*A) x (H - x*A) = VxH - x*(VxA) - y*(AxH), so only these three
+  // cross products are needed.
+  void CAHVModel::pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                    std::vector<Vector3>      & vectors) const {
+    Vector3 VxH = cross_prod(V, H);
+    Vector3 VxA = cross_prod(V, A);
+    Vector3 AxH = cross_prod(A, H);
+    if (dot_prod(VxH, A) < 0.0) {
+      VxH *= -1.0;
+      VxA *= -1.0;
+      AxH *= -1.0;
+    }
+
+    vectors.resize(pixels.size());
+    for (size_t i = 0; i < pixels.size(); i++)
+      vectors[i] = normalize(VxH - pixels[i].x()*VxA - pixels[i].y()*AxH);
+  }
+
+  void CAHVModel::camera_centers(std::vector<Vector2> const& pixels,
+                                 std::vector<Vector3>      & centers) const {
+    centers.assign(pixels.size(), C);
+  }
+
   // --------------------------------------------------
   //                 Private Methods
   // --------------------------------------------------
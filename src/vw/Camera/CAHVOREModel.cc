@@ -166,12 +166,16 @@ void CAHVOREModel::write(std::string const& filename) {
 
 vw::Vector3 CAHVOREModel::pixel_to_vector(vw::Vector2 const& pix) const {
   // Based on JPL's cmod_cahvore_2d_to_3d
-  Vector3 result;
 
   // Calculate initial terms
   Vector3 w3 = cross_prod(V - pix[1]*A,
                           H - pix[0]*A);
   Vector3 rp = (1/dot_prod(A,cross_prod(V,H))) * w3;
+  return undistort_ray(rp);
+}
+
+vw::Vector3 CAHVOREModel::undistort_ray(vw::Vector3 const& rp) const {
+  Vector3 result;
 
   double zetap = dot_prod(rp,O);
   Vector3 lambdap3 = rp - zetap*O;
@@ -229,6 +233,33 @@ vw::Vector3 CAHVOREModel::pixel_to_vector(vw::Vector2 const& pix) const {
 
 Vector3 CAHVOREModel::camera_center(Vector2 const& pix ) const { return C; }
 
+// The Newton iteration dominates here, so this only saves the virtual calls.
+void CAHVOREModel::points_to_pixels(std::vector<Vector3> const& points,
+                                    std::vector<Vector2>      & pixels) const {
+  pixels.resize(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+    pixels[i] = CAHVOREModel::point_to_pixel(points[i]);
+}
+
+// (V - y*A) x (H - x*A) = VxH - x*(VxA) - y*(AxH)
+void CAHVOREModel::pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                     std::vector<Vector3>      & vectors) const {
+  Vector3 VxH = cross_prod(V, H);
+  double  scale = 1/dot_prod(A, VxH);
+  VxH *= scale;
+  Vector3 VxA = scale * cross_prod(V, A);
+  Vector3 AxH = scale * cross_prod(A, H);
+
+  vectors.resize(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i++)
+    vectors[i] = undistort_ray(VxH - pixels[i][0]*VxA - pixels[i][1]*AxH);
+}
+
+void CAHVOREModel::camera_centers(std::vector<Vector2> const& pixels,
+                                  std::vector<Vector3>      & centers) const {
+  centers.assign(pixels.size(), C);
+}
+
 Vector2 CAHVOREModel::point_to_pixel(vw::Vector3 const& point) const {
   // Base on JPL's cmod_cahvore_3d_to_2d_general
 
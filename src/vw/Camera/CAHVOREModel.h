@@ -71,6 +71,15 @@ namespace camera {
     virtual Vector3 pixel_to_vector(Vector2 const& pix) const;
     virtual Vector3 camera_center(Vector2 const& /*pix*/ = Vector2() ) const;
 
+    /// Batch versions. pixels_to_vectors() sets up the CAHV cross
+    /// products once for all pixels.
+    virtual void points_to_pixels (std::vector<Vector3> const& points,
+                                   std::vector<Vector2>      & pixels ) const;
+    virtual void pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & vectors) const;
+    virtual void camera_centers   (std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & centers) const;
+
     /// Write CAHVORE model to file.
     void write(std::string const& filename);
 
@@ -87,6 +96,8 @@ namespace camera {
     double    P; // We don't have T as it is redundant information
   private:
     bool check_line( std::istream& istream, char letter );
+    /// Removes the lens distortion from the image plane vector 'rp'.
+    Vector3 undistort_ray( Vector3 const& rp ) const;
   };
 
   // Function to "map" the CAHVORE parameters into CAHV:
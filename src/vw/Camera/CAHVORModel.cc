@@ -306,6 +306,10 @@ Vector3 CAHVORModel::pixel_to_vector(Vector2 const& pix) const {
   if (dot_prod(cross_prod(V,H), A) < 0)
     rr = -1.0 * rr;
 
+  return undistort_ray(rr);
+}
+
+Vector3 CAHVORModel::undistort_ray(Vector3 const& rr) const {
   // Remove the radial lens distortion.  Preliminary values of
   // omega, lambda, and tau are computed from the rr vector
   // including distortion, in order to obtain the coefficients of
@@ -349,6 +353,45 @@ Vector3 CAHVORModel::pixel_to_vector(Vector2 const& pix) const {
 
 Vector3 CAHVORModel::camera_center( Vector2 const& pix ) const { return C; }
 
+void CAHVORModel::points_to_pixels(std::vector<Vector3> const& points,
+                                   std::vector<Vector2>      & pixels) const {
+  const double r0 = R(0), r1 = R(1), r2 = R(2);
+  pixels.resize(points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    Vector3 vec = points[i] - C;
+    double omega = dot_prod(vec,O);
+    Vector3 lambda = vec - omega * O;
+    double tau = dot_prod(lambda,lambda) / (omega*omega);
+    Vector3 pp_c = vec + (r0 + (r1 + r2 * tau) * tau) * lambda;
+
+    double alpha = dot_prod(pp_c, A);
+    pixels[i] = Vector2( dot_prod(pp_c,H) / alpha,
+                         dot_prod(pp_c,V) / alpha );
+  }
+}
+
+// See CAHVModel::pixels_to_vectors() for the cross product expansion.
+void CAHVORModel::pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                    std::vector<Vector3>      & vectors) const {
+  Vector3 VxH = cross_prod(V, H);
+  Vector3 VxA = cross_prod(V, A);
+  Vector3 AxH = cross_prod(A, H);
+  if (dot_prod(VxH, A) < 0) {
+    VxH *= -1.0;
+    VxA *= -1.0;
+    AxH *= -1.0;
+  }
+
+  vectors.resize(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i++)
+    vectors[i] = undistort_ray(normalize(VxH - pixels[i].x()*VxA - pixels[i].y()*AxH));
+}
+
+void CAHVORModel::camera_centers(std::vector<Vector2> const& pixels,
+                                 std::vector<Vector3>      & centers) const {
+  centers.assign(pixels.size(), C);
+}
+
 // vector_to_pixel with partial_derivatives
 Vector2 CAHVORModel::point_to_pixel(Vector3 const& point,
                                     Matrix<double> &partial_derivatives) const {
@@ -65,6 +65,15 @@ namespace camera {
     virtual Vector3 pixel_to_vector(Vector2 const& pix) const;
     virtual Vector3 camera_center(Vector2 const& /*pix*/ = Vector2() ) const;
 
+    /// Batch versions, which set up the CAHV cross products and the
+    /// radial distortion terms once for all points.
+    virtual void points_to_pixels (std::vector<Vector3> const& points,
+                                   std::vector<Vector2>      & pixels ) const;
+    virtual void pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & vectors) const;
+    virtual void camera_centers   (std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & centers) const;
+
     // Overloaded versions also return partial derviatives in a Matrix.
     Vector2 point_to_pixel(Vector3 const& point, Matrix<double> &partial_derivatives) const;
     Vector3 pixel_to_vector(Vector2 const& pix, Matrix<double> &partial_derivatives) const;
@@ -85,6 +94,10 @@ namespace camera {
     Vector3   V;
     Vector3   O;
     Vector3   R;
+
+  private:
+    /// Removes the radial distortion from the undistorted ray 'rr'.
+    Vector3 undistort_ray(Vector3 const& rr) const;
   };
 
   /// Function to "map" the CAHVOR parameters into CAHV parameters:
@@ -32,6 +32,27 @@ CameraModel::camera_pose(Vector2 const& pix) const {
   return Quaternion<double>();
 }
 
+void CameraModel::points_to_pixels(std::vector<Vector3> const& points,
+                                   std::vector<Vector2>      & pixels) const {
+  pixels.resize(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+    pixels[i] = this->point_to_pixel(points[i]);
+}
+
+void CameraModel::pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                    std::vector<Vector3>      & vectors) const {
+  vectors.resize(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i++)
+    vectors[i] = this->pixel_to_vector(pixels[i]);
+}
+
+void CameraModel::camera_centers(std::vector<Vector2> const& pixels,
+                                 std::vector<Vector3>      & centers) const {
+  centers.resize(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i++)
+    centers[i] = this->camera_center(pixels[i]);
+}
+
 AdjustedCameraModel::AdjustedCameraModel(boost::shared_ptr<CameraModel> camera_model,
                                          Vector3 const& translation, Quat const& rotation,
                                          Vector2 const& pixel_offset, double scale) :
@@ -104,6 +125,46 @@ Vector3 AdjustedCameraModel::camera_center(Vector2 const& pix) const {
   //return m_camera->camera_center(m_scale*pix + m_pixel_offset) + m_translation;
 }
 
+// The batch versions convert the rotations to matrices once and hand
+// the whole batch to the underlying camera.
+void AdjustedCameraModel::points_to_pixels(std::vector<Vector3> const& points,
+                                           std::vector<Vector2>      & pixels) const {
+  Matrix3x3 rotation_inverse = m_rotation_inverse.rotation_matrix();
+  Vector3   shift            = m_rotation_center + m_translation;
+  std::vector<Vector3> new_pts(points.size());
+  for (size_t i = 0; i < points.size(); i++)
+    new_pts[i] = rotation_inverse*(points[i] - shift) + m_rotation_center;
+
+  m_camera->points_to_pixels(new_pts, pixels);
+  for (size_t i = 0; i < pixels.size(); i++)
+    pixels[i] = (pixels[i] - m_pixel_offset)/m_scale;
+}
+
+void AdjustedCameraModel::pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                            std::vector<Vector3>      & vectors) const {
+  std::vector<Vector2> old_pix(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i++)
+    old_pix[i] = m_scale*pixels[i] + m_pixel_offset;
+
+  m_camera->pixels_to_vectors(old_pix, vectors);
+  Matrix3x3 rotation = m_rotation.rotation_matrix();
+  for (size_t i = 0; i < vectors.size(); i++)
+    vectors[i] = rotation*vectors[i];
+}
+
+void AdjustedCameraModel::camera_centers(std::vector<Vector2> const& pixels,
+                                         std::vector<Vector3>      & centers) const {
+  std::vector<Vector2> old_pix(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i++)
+    old_pix[i] = m_scale*pixels[i] + m_pixel_offset;
+
+  m_camera->camera_centers(old_pix, centers);
+  Matrix3x3 rotation = m_rotation.rotation_matrix();
+  Vector3   shift    = m_rotation_center + m_translation;
+  for (size_t i = 0; i < centers.size(); i++)
+    centers[i] = rotation*(centers[i] - m_rotation_center) + shift;
+}
+
 Quat AdjustedCameraModel::camera_pose(Vector2 const& pix) const {
   return m_rotation*m_camera->camera_pose(m_scale*pix + m_pixel_offset);
 }
@@ -25,6 +25,7 @@
 #define __VW_CAMERA_CAMERAMODEL_H__
 
 #include <fstream>
+#include <vector>
 #include <vw/Core/Exception.h>
 #include <vw/Math/Matrix.h>
 #include <vw/Math/Vector.h>
@@ -91,6 +92,19 @@ namespace camera {
     /// Subclasses must define a method that return the camera type as a string.
     virtual std::string type() const = 0;
 
+    /// Batch versions of point_to_pixel(), pixel_to_vector() and
+    /// camera_center().  The output is resized to match the input.
+    /// The defaults just loop over the single point methods, camera
+    /// models override them to set up per-camera constants once for
+    /// the whole batch.  An exception for any point is passed on, as
+    /// with the single point methods.
+    virtual void points_to_pixels (std::vector<Vector3> const& points,
+                                   std::vector<Vector2>      & pixels ) const;
+    virtual void pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & vectors) const;
+    virtual void camera_centers   (std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & centers) const;
+
     /// Returns the pose (as a quaternion) of the camera for a given
     /// pixel. It represents the rotation from the camera frame to world frame.
     /// - Generally the input pixel is only used for linescane cameras.
@@ -183,6 +197,12 @@ namespace camera {
     virtual Vector2 point_to_pixel (Vector3 const&) const;
     virtual Vector3 pixel_to_vector(Vector2 const&) const;
     virtual Vector3 camera_center  (Vector2 const&) const;
+    virtual void points_to_pixels (std::vector<Vector3> const& points,
+                                   std::vector<Vector2>      & pixels ) const;
+    virtual void pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & vectors) const;
+    virtual void camera_centers   (std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & centers) const;
     virtual Quat    camera_pose    (Vector2 const&) const;
 
     Vector3 adjusted_point(Vector3 const& point) const;
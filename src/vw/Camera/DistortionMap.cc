@@ -0,0 +1,166 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+
+#include <vw/Camera/DistortionMap.h>
+#include <vw/Camera/LensDistortion.h>
+#include <vw/Camera/PinholeModel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+using namespace vw;
+using namespace vw::camera;
+
+namespace {
+  const char       MAP_MAGIC[8] = { 'V','W','D','M','A','P','\0','\0' };
+  const vw::uint32 MAP_VERSION  = 1;
+
+  template <class T>
+  void write_value( std::ostream& os, T const& value ) {
+    os.write( reinterpret_cast<const char*>(&value), sizeof(T) );
+  }
+
+  template <class T>
+  void read_value( std::istream& is, T& value ) {
+    is.read( reinterpret_cast<char*>(&value), sizeof(T) );
+  }
+
+  // The lens distortion models work in the units of the focal length,
+  // the map in pixels. reverse() is what TransformGrid tabulates.
+  class UndistortTransform {
+    PinholeModel const* m_camera;
+  public:
+    UndistortTransform( PinholeModel const& camera ) : m_camera(&camera) {}
+    Vector2 reverse( Vector2 const& pix ) const {
+      double pitch = m_camera->pixel_pitch();
+      return m_camera->lens_distortion()->undistorted_coordinates( *m_camera, pix*pitch ) / pitch;
+    }
+  };
+
+  class DistortTransform {
+    PinholeModel const* m_camera;
+  public:
+    DistortTransform( PinholeModel const& camera ) : m_camera(&camera) {}
+    Vector2 reverse( Vector2 const& pix ) const {
+      double pitch = m_camera->pixel_pitch();
+      return m_camera->lens_distortion()->distorted_coordinates( *m_camera, pix*pitch ) / pitch;
+    }
+  };
+
+  // Everything the lens distortion of a camera depends on
+  std::string camera_key( PinholeModel const& camera ) {
+    std::ostringstream os;
+    os.precision(17);
+    os << camera.focal_length() << " " << camera.point_offset() << " "
+       << camera.pixel_pitch() << " " << camera.lens_distortion()->name() << "\n";
+    camera.lens_distortion()->write( os );
+    return os.str();
+  }
+}
+
+DistortionMap::DistortionMap( PinholeModel const& camera, Vector2i const& image_size,
+                              double tolerance, int32 cell_size )
+  : m_image_size(image_size), m_tolerance(tolerance), m_key(camera_key(camera)) {
+  VW_ASSERT( image_size[0] > 0 && image_size[1] > 0,
+             ArgumentErr() << "DistortionMap: the image size must be positive." );
+
+  // Pixels a little outside of the image are still looked up
+  int32 margin = std::max( image_size[0], image_size[1] ) / 20 + 1;
+  BBox2i image_bbox( -margin, -margin, image_size[0] + 2*margin, image_size[1] + 2*margin );
+  UndistortTransform undistort( camera );
+  m_undistort = TransformGrid( undistort, image_bbox, tolerance, cell_size );
+
+  // The undistorted pixels come from undistorting the border of the
+  // distorted domain.
+  const int32 SAMPLES = 64;
+  BBox2 undistorted_bbox;
+  Vector2 lo = image_bbox.min(), hi = image_bbox.max();
+  for ( int32 i = 0; i <= SAMPLES; i++ ) {
+    double t = double(i) / SAMPLES;
+    undistorted_bbox.grow( undistort.reverse( Vector2( lo.x() + t*(hi.x()-lo.x()), lo.y() ) ) );
+    undistorted_bbox.grow( undistort.reverse( Vector2( lo.x() + t*(hi.x()-lo.x()), hi.y() ) ) );
+    undistorted_bbox.grow( undistort.reverse( Vector2( lo.x(), lo.y() + t*(hi.y()-lo.y()) ) ) );
+    undistorted_bbox.grow( undistort.reverse( Vector2( hi.x(), lo.y() + t*(hi.y()-lo.y()) ) ) );
+  }
+  BBox2i distort_bbox( Vector2i( int32(std::floor(undistorted_bbox.min().x())),
+                                 int32(std::floor(undistorted_bbox.min().y())) ),
+                       Vector2i( int32(std::ceil (undistorted_bbox.max().x())) + 1,
+                                 int32(std::ceil (undistorted_bbox.max().y())) + 1 ) );
+  m_distort = TransformGrid( DistortTransform( camera ), distort_bbox, tolerance, cell_size );
+}
+
+bool DistortionMap::matches( PinholeModel const& camera ) const {
+  return !m_key.empty() && m_key == camera_key( camera );
+}
+
+void DistortionMap::write( std::string const& filename ) const {
+  std::ofstream os( filename.c_str(), std::ios::binary );
+  if ( !os )
+    vw_throw( IOErr() << "DistortionMap: could not open " << filename << " for writing." );
+
+  os.write( MAP_MAGIC, sizeof(MAP_MAGIC) );
+  write_value( os, MAP_VERSION );
+  write_value( os, m_image_size[0] );
+  write_value( os, m_image_size[1] );
+  write_value( os, m_tolerance );
+  write_value( os, uint32(m_key.size()) );
+  os.write( m_key.data(), m_key.size() );
+  m_distort.write( os );
+  m_undistort.write( os );
+  if ( !os )
+    vw_throw( IOErr() << "DistortionMap: failed to write " << filename << "." );
+}
+
+void DistortionMap::read( std::string const& filename ) {
+  std::ifstream is( filename.c_str(), std::ios::binary );
+  if ( !is )
+    vw_throw( IOErr() << "DistortionMap: could not open " << filename << "." );
+
+  char magic[8];
+  uint32 version = 0, key_size = 0;
+  Vector2i image_size;
+  double tolerance = 0;
+  is.read( magic, sizeof(magic) );
+  read_value( is, version );
+  read_value( is, image_size[0] );
+  read_value( is, image_size[1] );
+  read_value( is, tolerance );
+  read_value( is, key_size );
+  if ( !is || std::memcmp( magic, MAP_MAGIC, sizeof(magic) ) != 0 ||
+       version != MAP_VERSION || key_size > (1u << 20) )
+    vw_throw( IOErr() << "DistortionMap: " << filename << " is not a distortion map." );
+  std::string key( key_size, '\0' );
+  if ( key_size )
+    is.read( &key[0], key_size );
+
+  DistortionMap map;
+  map.m_image_size = image_size;
+  map.m_tolerance  = tolerance;
+  map.m_key        = key;
+  try {
+    map.m_distort.read( is );
+    map.m_undistort.read( is );
+  } catch ( const IOErr& e ) {
+    vw_throw( IOErr() << "DistortionMap: " << filename << ": " << e.what() );
+  }
+  *this = map;
+}
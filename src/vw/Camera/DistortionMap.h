@@ -0,0 +1,90 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file DistortionMap.h
+///
+/// Precomputed lens distortion for a PinholeModel.
+///
+/// Lens distortion models without a closed form inverse solve a small
+/// least squares problem on every undistorted_coordinates() (or
+/// distorted_coordinates()) call, which adds up quickly when every
+/// pixel of an image goes through the camera.  A DistortionMap
+/// tabulates both directions once, on grids that are refined until
+/// they agree with the lens distortion model to within a tolerance.
+/// PinholeModel uses it instead of the lens distortion model once it
+/// is set with PinholeModel::set_distortion_map().
+///
+#ifndef __VW_CAMERA_DISTORTIONMAP_H__
+#define __VW_CAMERA_DISTORTIONMAP_H__
+
+#include <vw/Math/Vector.h>
+#include <vw/Image/TransformGrid.h>
+
+#include <string>
+
+namespace vw {
+namespace camera {
+
+  class PinholeModel;
+
+  class DistortionMap {
+  public:
+    /// An empty map, which has no entries.
+    DistortionMap() : m_tolerance(0) {}
+
+    /// Tabulate the lens distortion of 'camera' for an image of
+    /// 'image_size' pixels, plus a margin around it.  Both directions
+    /// are within 'tolerance' pixels of the lens distortion model at
+    /// the points checked while refining the grids.
+    DistortionMap( PinholeModel const& camera, Vector2i const& image_size,
+                   double tolerance = 1e-3, int32 cell_size = 64 );
+
+    Vector2i const& image_size() const { return m_image_size; }
+    double          tolerance () const { return m_tolerance;  }
+
+    /// The distorted pixel for the undistorted pixel 'pix', both in
+    /// pixel units.  Returns false if 'pix' is not covered by the map.
+    bool distorted_pixel  ( Vector2 const& pix, Vector2& result ) const {
+      return m_distort.reverse( pix, result );
+    }
+
+    /// The undistorted pixel for the distorted pixel 'pix', both in
+    /// pixel units.  Returns false if 'pix' is not covered by the map.
+    bool undistorted_pixel( Vector2 const& pix, Vector2& result ) const {
+      return m_undistort.reverse( pix, result );
+    }
+
+    /// True if the map was built for the intrinsics and lens
+    /// distortion of 'camera'.
+    bool matches( PinholeModel const& camera ) const;
+
+    /// Save the map to a binary file, or load one written by write().
+    /// read() throws IOErr if the file can't be read.
+    void write( std::string const& filename ) const;
+    void read ( std::string const& filename );
+
+  private:
+    Vector2i      m_image_size;
+    double        m_tolerance;
+    std::string   m_key;
+    TransformGrid m_distort, m_undistort;
+  };
+
+}} // namespace vw::camera
+
+#endif // __VW_CAMERA_DISTORTIONMAP_H__
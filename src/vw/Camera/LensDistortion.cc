@@ -184,29 +184,21 @@ TsaiLensDistortion::distorted_coordinates(const camera::PinholeModel& cam, Vecto
 
   Vector2 dudv(p - offset); // = [u-cx, v-cy]
   Vector2 p_0 = elem_quot(dudv, focal); // = dudv / f = [x, y] // Normalized pixel coordinates (1 == f)
-  double r2 = norm_2_sqr( p_0 ); // = x^2 + y^2
-  Vector2 distortion( m_distortion[3], m_distortion[2] ); // [p2, p1]
-  Vector2 p_1 =   elem_quot(distortion, p_0); // = [  p2/x,   p1/y]
-  Vector2 p_3 = 2*elem_prod(distortion, p_0); // = [2*p2*x, 2*p1*y]
-
-  Vector2 b =  elem_prod(r2,p_1); // = [r2*p2/x, r2*p1/y]
-  b = elem_sum(b,r2*(m_distortion[0] + r2 * m_distortion[1]) + sum(p_3));
-  // = elem_sum(b, k1*r2 + k2*r4 + 2*p2*x + 2*p1*y);
-  // = [ k1*r2 + k2*r4 + 2*p2*x + 2*p1*y + r2*p2/x, 
-  //     k1*r2 + k2*r4 + 2*p2*x + 2*p1*y + r2*p1/y ]
-
-  // Note that after the multiplication step below, this matches the commonly seen equations:
-  // = [ x(k1*r2 + k2*r4) + 2*p2*x^2 + 2*p1*y*x + r2*p2, 
-  //     y(k1*r2 + k2*r4) + 2*p2*x*y + 2*p1*y^2 + r2*p1 ]
+  double x = p_0[0], y = p_0[1];
+  double r2 = x*x + y*y;
+  double k1 = m_distortion[0], k2 = m_distortion[1];
+  double p1 = m_distortion[2], p2 = m_distortion[3];
+
+  // The commonly seen equations:
   // = [ x(k1*r2 + k2*r4) + 2*p1*x*y + p2(r2 + 2x^2), 
   //     y(k1*r2 + k2*r4) + 2*p2*x*y + p1(r2 + 2y^2) ]
-
-  // Prevent divide by zero at the origin or along the x and y center line
-  Vector2 result = p + elem_prod(b, dudv); // = p + [du, dv]*(b)
-  if (p[0] == offset[0])
-    result[0] = p[0];
-  if (p[1] == offset[1])
-    result[1] = p[1];
+  // - These are written out directly rather than factored through
+  //   dudv, which needs a division by x and y and broke down along
+  //   the x and y center lines.
+  double radial = k1*r2 + k2*r2*r2;
+  Vector2 result = p + elem_prod(focal,
+                                 Vector2(x*radial + 2*p1*x*y + p2*(r2 + 2*x*x),
+                                         y*radial + 2*p2*x*y + p1*(r2 + 2*y*y)));
 
   return result;
 }
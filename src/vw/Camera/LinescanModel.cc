@@ -28,6 +28,15 @@ Vector2 LinescanModel::point_to_pixel(Vector3 const& point) const {
 
 Vector2 LinescanModel::point_to_pixel(Vector3 const& point, double starty) const {
 
+  if (m_fast_point_to_pixel) {
+    Vector2 pixel = m_image_size / 2.0;
+    if (starty >= 0)
+      pixel[1] = starty;
+    Matrix<double,3,2> jacobian;
+    if (solve_point_to_pixel(point, pixel, jacobian))
+      return pixel;
+  }
+
   // Use the generic solver to find the pixel 
   // - This method will be slower but works for more complicated geometries
   CameraGenericLMA model( this, point );
@@ -50,6 +59,76 @@ Vector2 LinescanModel::point_to_pixel(Vector3 const& point, double starty) const
   return solution;
 }
 
+void LinescanModel::points_to_pixels(std::vector<Vector3> const& points,
+                                     std::vector<Vector2>      & pixels) const {
+  pixels.resize(points.size());
+  Vector2 pixel = m_image_size / 2.0;
+  Matrix<double,3,2> jacobian; // Zero, so it is estimated for the first point
+  for (size_t i = 0; i < points.size(); i++) {
+    Vector2 start = pixel;
+    if (!solve_point_to_pixel(points[i], pixel, jacobian)) {
+      pixel = this->point_to_pixel(points[i], start[1]);
+      jacobian.set_zero();
+    }
+    pixels[i] = pixel;
+  }
+}
+
+namespace {
+  // The residual CameraGenericLMA minimizes
+  inline Vector3 ray_error(CameraModel const& camera, Vector3 const& point,
+                           Vector2 const& pixel) {
+    return camera.pixel_to_vector(pixel) - normalize(point - camera.camera_center(pixel));
+  }
+}
+
+bool LinescanModel::solve_point_to_pixel(Vector3 const& point, Vector2 & pixel,
+                                         Matrix<double,3,2> & jacobian) const {
+  // Solver constants
+  const double PIXEL_TOL      = 1e-8;
+  const double MAX_STEP       = 10*norm_2(m_image_size);
+  const int    MAX_ITERATIONS = 50;
+
+  try {
+    Vector3 error = ray_error(*this, point, pixel);
+
+    if (jacobian == Matrix<double,3,2>()) {
+      select_col(jacobian, 0) = ray_error(*this, point, pixel + Vector2(1,0)) - error;
+      select_col(jacobian, 1) = ray_error(*this, point, pixel + Vector2(0,1)) - error;
+    }
+
+    for (int i = 0; i < MAX_ITERATIONS; i++) {
+      // Gauss-Newton step from the normal equations (J^T J) delta = -J^T error
+      Matrix2x2 jtj = transpose(jacobian) * jacobian;
+      Vector2   jte = transpose(jacobian) * error;
+      double    det = jtj(0,0)*jtj(1,1) - jtj(0,1)*jtj(1,0);
+      if (!(fabs(det) > 0))
+        return false;
+      Vector2 delta( (jtj(0,1)*jte[1] - jtj(1,1)*jte[0]) / det,
+                     (jtj(1,0)*jte[0] - jtj(0,0)*jte[1]) / det );
+      if (!(norm_2(delta) < MAX_STEP))
+        return false;
+
+      pixel += delta;
+      if (norm_2(delta) < PIXEL_TOL)
+        return true;
+      Vector3 new_error = ray_error(*this, point, pixel);
+
+      // Broyden update: make the Jacobian agree with the step just taken
+      Vector3 correction = ((new_error - error) - jacobian*delta) / dot_prod(delta, delta);
+      for (int r = 0; r < 3; r++) {
+        jacobian(r,0) += correction[r]*delta[0];
+        jacobian(r,1) += correction[r]*delta[1];
+      }
+      error = new_error;
+    }
+  } catch (const vw::Exception&) {
+    // E.g. a line outside of the available ephemeris. Let the
+    // generic solver deal with it.
+  }
+  return false;
+}
+
 // WARNING: This currently only works for Earth!
 Vector3 LinescanModel::get_rotation_corrected_velocity(Vector2 const& pixel,
                                                        Vector3 const& uncorrected_vector) const {
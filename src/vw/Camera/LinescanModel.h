@@ -53,7 +53,8 @@ namespace camera {
     LinescanModel(Vector2i const& image_size,
 		              bool            correct_velocity_aberration) :
       m_image_size(image_size), 
-      m_correct_velocity_aberration(correct_velocity_aberration){}
+      m_correct_velocity_aberration(correct_velocity_aberration),
+      m_fast_point_to_pixel(false){}
 
     virtual ~LinescanModel() {}
     virtual std::string type() const { return "Linescan"; }
@@ -117,6 +118,20 @@ namespace camera {
     //   linescan cameras may be able to use more specific implementation.
     virtual Vector2 point_to_pixel(vw::Vector3 const& point, double starty) const;
 
+    /// Batched point_to_pixel().  Each point is solved starting from the
+    /// pixel and solver state of the previous one, so this is much
+    /// faster when neighbouring points come in order, e.g. along a row
+    /// of a DEM.  Points the fast solver can't handle go through
+    /// point_to_pixel().
+    virtual void points_to_pixels(std::vector<Vector3> const& points,
+                                  std::vector<Vector2>      & pixels) const;
+
+    /// If enabled, point_to_pixel() first tries the secant solver used
+    /// by points_to_pixels() and only falls back to the generic
+    /// Levenberg-Marquardt solver if that fails.
+    void set_fast_point_to_pixel(bool enable) { m_fast_point_to_pixel = enable; }
+    bool fast_point_to_pixel() const { return m_fast_point_to_pixel; }
+
   protected:
 
     /// Image size in pixels: [num lines, num samples]
@@ -126,8 +141,23 @@ namespace camera {
     /// - For satellites this makes a big difference, make sure it is set!
     bool m_correct_velocity_aberration;
 
+    /// Set this flag to try solve_point_to_pixel() in point_to_pixel().
+    bool m_fast_point_to_pixel;
+
   protected:
 
+    /// Solve for the pixel observing 'point' with Gauss-Newton steps on
+    /// the difference between the pixel ray and the direction to the
+    /// point.  The 3x2 Jacobian of that difference is not recomputed,
+    /// it is carried in 'jacobian' and refined with a secant (Broyden)
+    /// update after every step, so each iteration costs one
+    /// pixel_to_vector() and camera_center().  On input 'pixel' is the
+    /// starting guess and 'jacobian' the one from a nearby solve, or
+    /// zero to estimate it by finite differences.  Returns false if the
+    /// solve did not converge.
+    bool solve_point_to_pixel(Vector3 const& point, Vector2 & pixel,
+                              Matrix<double,3,2> & jacobian) const;
+
     /// Returns the velocity corrected to account for the planetary rotation.
     /// - For efficiency, requires the uncorrected look vector at this location.
     virtual Vector3 get_rotation_corrected_velocity(Vector2 const& pixel,
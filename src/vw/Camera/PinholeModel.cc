@@ -22,6 +22,7 @@
 #include <vw/Math/Quaternion.h>
 #include <vw/Camera/PinholeModel.h>
 #include <vw/Camera/LensDistortion.h>
+#include <vw/Camera/DistortionMap.h>
 
 #if defined(VW_HAVE_PKG_LAPACK) && VW_HAVE_PKG_LAPACK==1
 #include <vw/Math/LinearAlgebra.h>
@@ -57,6 +58,7 @@ PinholeModel::PinholeModel(std::string const& filename) : m_distortion(DistortPt
 
 PinholeModel::PinholeModel(PinholeModel const& other) :
     m_distortion   (other.m_distortion->copy()),
+    m_distortion_map(other.m_distortion_map),
     m_camera_matrix(other.m_camera_matrix),
     m_camera_center(other.m_camera_center),
     m_rotation     (other.m_rotation),
@@ -121,6 +123,8 @@ PinholeModel::PinholeModel(Vector3 camera_center, Matrix<double,3,3> rotation,
 
 void PinholeModel::read(std::string const& filename) {
 
+  m_distortion_map.reset();
+
   // Open the input file
   std::ifstream cam_file;
   cam_file.open(filename.c_str());
@@ -339,6 +343,9 @@ Vector2 PinholeModel::point_to_pixel(Vector3 const& point) const {
   // Apply the lens distortion model
   // - Divide by pixel pitch to convert from metric units to pixels if the intrinsic
   //   values were not specified in pixel units (in that case m_pixel_pitch == 1.0)
+  Vector2 result;
+  if (m_distortion_map && m_distortion_map->distorted_pixel(pixel/m_pixel_pitch, result))
+    return result;
   return m_distortion->distorted_coordinates(*this, pixel)/m_pixel_pitch;
 }
 
@@ -367,7 +374,11 @@ bool PinholeModel::projection_valid(Vector3 const& point) const {
 
 Vector3 PinholeModel::pixel_to_vector (Vector2 const& pix) const {
   // Apply the inverse lens distortion model
-  Vector2 undistorted_pix = m_distortion->undistorted_coordinates(*this, pix*m_pixel_pitch);
+  Vector2 undistorted_pix;
+  if (m_distortion_map && m_distortion_map->undistorted_pixel(pix, undistorted_pix))
+    undistorted_pix *= m_pixel_pitch;
+  else
+    undistorted_pix = m_distortion->undistorted_coordinates(*this, pix*m_pixel_pitch);
 
   // Compute the direction of the ray emanating from the camera center.
   Vector3 p(0,0,1);
@@ -379,6 +390,65 @@ Vector3 PinholeModel::camera_center(Vector2 const& /*pix*/ ) const {
   return m_camera_center;
 };
 
+void PinholeModel::points_to_pixels(std::vector<Vector3> const& points,
+                                    std::vector<Vector2>      & pixels) const {
+  const double p00 = m_camera_matrix(0,0), p01 = m_camera_matrix(0,1),
+               p02 = m_camera_matrix(0,2), p03 = m_camera_matrix(0,3),
+               p10 = m_camera_matrix(1,0), p11 = m_camera_matrix(1,1),
+               p12 = m_camera_matrix(1,2), p13 = m_camera_matrix(1,3),
+               p20 = m_camera_matrix(2,0), p21 = m_camera_matrix(2,1),
+               p22 = m_camera_matrix(2,2), p23 = m_camera_matrix(2,3);
+  const bool   distorted = !dynamic_cast<NullLensDistortion const*>(m_distortion.get());
+  const double inv_pitch = 1.0/m_pixel_pitch;
+  DistortionMap const* map = m_distortion_map.get();
+
+  pixels.resize(points.size());
+  for (size_t i = 0; i < points.size(); i++) {
+    const double x = points[i][0], y = points[i][1], z = points[i][2];
+    const double inv_denominator = 1.0/(p20*x + p21*y + p22*z + p23);
+    Vector2 pixel( (p00*x + p01*y + p02*z + p03)*inv_denominator,
+                   (p10*x + p11*y + p12*z + p13)*inv_denominator );
+    if (distorted) {
+      if (map && map->distorted_pixel(pixel*inv_pitch, pixels[i]))
+        continue;
+      pixel = m_distortion->distorted_coordinates(*this, pixel);
+    }
+    pixels[i] = pixel*inv_pitch;
+  }
+}
+
+void PinholeModel::pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                     std::vector<Vector3>      & vectors) const {
+  const double m00 = m_inv_camera_transform(0,0), m01 = m_inv_camera_transform(0,1),
+               m02 = m_inv_camera_transform(0,2),
+               m10 = m_inv_camera_transform(1,0), m11 = m_inv_camera_transform(1,1),
+               m12 = m_inv_camera_transform(1,2),
+               m20 = m_inv_camera_transform(2,0), m21 = m_inv_camera_transform(2,1),
+               m22 = m_inv_camera_transform(2,2);
+  const bool distorted = !dynamic_cast<NullLensDistortion const*>(m_distortion.get());
+  DistortionMap const* map = m_distortion_map.get();
+
+  vectors.resize(pixels.size());
+  for (size_t i = 0; i < pixels.size(); i++) {
+    Vector2 pix;
+    if (!distorted)
+      pix = pixels[i]*m_pixel_pitch;
+    else if (map && map->undistorted_pixel(pixels[i], pix))
+      pix *= m_pixel_pitch;
+    else
+      pix = m_distortion->undistorted_coordinates(*this, pixels[i]*m_pixel_pitch);
+    Vector3 vec( m00*pix[0] + m01*pix[1] + m02,
+                 m10*pix[0] + m11*pix[1] + m12,
+                 m20*pix[0] + m21*pix[1] + m22 );
+    vectors[i] = vec/norm_2(vec);
+  }
+}
+
+void PinholeModel::camera_centers(std::vector<Vector2> const& pixels,
+                                  std::vector<Vector3>      & centers) const {
+  centers.assign(pixels.size(), m_camera_center);
+}
+
 void PinholeModel::set_camera_center(Vector3 const& position) {
   m_camera_center = position; 
   rebuild_camera_matrix();
@@ -419,6 +489,13 @@ Vector3 PinholeModel::coordinate_frame_w_direction() const { return m_w_directio
 const LensDistortion* PinholeModel::lens_distortion() const { return m_distortion.get(); };
 void PinholeModel::set_lens_distortion(LensDistortion const& distortion) {
   m_distortion = distortion.copy();
+  m_distortion_map.reset();
+}
+
+void PinholeModel::set_distortion_map(boost::shared_ptr<DistortionMap const> map) {
+  VW_ASSERT( !map || map->matches(*this),
+             ArgumentErr() << "PinholeModel: the distortion map was built for a different camera." );
+  m_distortion_map = map;
 }
 
 void PinholeModel::intrinsic_parameters(double& f_u, double& f_v,
@@ -429,21 +506,27 @@ void PinholeModel::intrinsic_parameters(double& f_u, double& f_v,
 void PinholeModel::set_intrinsic_parameters(double f_u, double f_v,
                                             double c_u, double c_v) {
   m_fu = f_u;  m_fv = f_v;  m_cu = c_u;  m_cv = c_v;
+  m_distortion_map.reset();
   rebuild_camera_matrix();
 }
 
 Vector2 PinholeModel::focal_length() const { return Vector2(m_fu,m_fv); }
 void PinholeModel::set_focal_length(Vector2 const& f, bool rebuild ) {
   m_fu = f[0]; m_fv = f[1];
+  m_distortion_map.reset();
   if (rebuild) rebuild_camera_matrix();
 }
 Vector2 PinholeModel::point_offset() const { return Vector2(m_cu,m_cv); }
 void PinholeModel::set_point_offset(Vector2 const& c, bool rebuild ) {
   m_cu = c[0]; m_cv = c[1];
+  m_distortion_map.reset();
   if (rebuild) rebuild_camera_matrix();
 }
 double PinholeModel::pixel_pitch() const { return m_pixel_pitch; }
-void PinholeModel::set_pixel_pitch( double pitch ) { m_pixel_pitch = pitch; }
+void PinholeModel::set_pixel_pitch( double pitch ) {
+  m_pixel_pitch = pitch;
+  m_distortion_map.reset();
+}
 
 
 void PinholeModel::set_camera_matrix( Matrix<double,3,4> const& p ) {
@@ -480,6 +563,7 @@ void PinholeModel::set_camera_matrix( Matrix<double,3,4> const& p ) {
   m_fv = R(1,1);
   m_cu = R(0,2);
   m_cv = R(1,2);
+  m_distortion_map.reset();
 
   if ( fabs(R(0,1)) >= 1.2 )
     vw_out(WarningMessage,"camera") << "Significant skew not modelled by pinhole camera\n";
@@ -33,6 +33,7 @@ namespace vw {
 namespace camera {
 
   class LensDistortion;
+  class DistortionMap;
 
   /// This is a simple "generic" pinhole camera model.
   ///
@@ -83,6 +84,9 @@ namespace camera {
     typedef boost::shared_ptr<LensDistortion> DistortPtr;
 
     DistortPtr m_distortion;
+
+    /// Optional precomputed lens distortion, see set_distortion_map().
+    boost::shared_ptr<DistortionMap const> m_distortion_map;
     Matrix<double,3,4> m_camera_matrix;
 
     // Stored for easy access.
@@ -226,6 +230,15 @@ namespace camera {
 
     // The pinhole camera position does not vary by pixel so the input pixel is ignored.
     virtual Vector3 camera_center(Vector2 const& /*pix*/ = Vector2() ) const;
+
+    // Batch versions, with the camera matrix held in locals and the
+    // lens distortion skipped entirely when there is none.
+    virtual void points_to_pixels (std::vector<Vector3> const& points,
+                                   std::vector<Vector2>      & pixels ) const;
+    virtual void pixels_to_vectors(std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & vectors) const;
+    virtual void camera_centers   (std::vector<Vector2> const& pixels,
+                                   std::vector<Vector3>      & centers) const;
     void set_camera_center(Vector3 const& position);
 
     // Pose is a rotation which moves a vector in camera coordinates
@@ -253,6 +266,15 @@ namespace camera {
     const LensDistortion* lens_distortion() const;
     void set_lens_distortion(LensDistortion const& distortion);
 
+    /// Use a precomputed DistortionMap instead of the lens distortion
+    /// model in point_to_pixel() and pixel_to_vector().  Pixels outside
+    /// of the map still go through the lens distortion model.  The map
+    /// must have been built for this camera; it is dropped whenever the
+    /// lens distortion or the intrinsics change.  Pass an empty pointer
+    /// to stop using it.
+    void set_distortion_map(boost::shared_ptr<DistortionMap const> map);
+    boost::shared_ptr<DistortionMap const> distortion_map() const { return m_distortion_map; }
+
     //  f_u and f_v :  focal length in horiz and vert. pixel units
     //  c_u and c_v :  principal point in pixel units
     void intrinsic_parameters(double& f_u, double& f_v,
@@ -100,3 +100,38 @@ TEST( AdjustedCameraModel, AdjustedConstruct ) {
     acos(dot_prod(Vector3(0,0,1),inverse(center_pose).rotate(adjcam2.pixel_to_vector(center_pixel))));
   EXPECT_LT( angle_from_z, 0.5 );
 }
+
+TEST( AdjustedCameraModel, Batch ) {
+  boost::shared_ptr<CameraModel> pinhole(
+      new PinholeModel( Vector3(3,-2,1),
+                        math::euler_to_rotation_matrix(0.1,-0.2,0.05,"xyz"),
+                        600,620, 500,480,
+                        NullLensDistortion() ) );
+  AdjustedCameraModel adjcam( pinhole, Vector3(0.5,-1,2),
+                              Quat(math::euler_to_rotation_matrix(0.02,0.01,-0.03,"xyz")),
+                              Vector2(20,-10), 0.5 );
+
+  std::vector<Vector2> pixels;
+  for ( int i = 0; i < 1000; i += 111 )
+    for ( int j = 0; j < 1000; j += 143 )
+      pixels.push_back( Vector2(i,j) );
+
+  std::vector<Vector3> vectors, centers, points;
+  adjcam.pixels_to_vectors( pixels, vectors );
+  adjcam.camera_centers( pixels, centers );
+  ASSERT_EQ( pixels.size(), vectors.size() );
+  ASSERT_EQ( pixels.size(), centers.size() );
+  for ( size_t i = 0; i < pixels.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( adjcam.pixel_to_vector(pixels[i]), vectors[i], 1e-10 );
+    EXPECT_VECTOR_NEAR( adjcam.camera_center(pixels[i]), centers[i], 1e-10 );
+    points.push_back( centers[i] + 20*vectors[i] );
+  }
+
+  std::vector<Vector2> result;
+  adjcam.points_to_pixels( points, result );
+  ASSERT_EQ( points.size(), result.size() );
+  for ( size_t i = 0; i < points.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( adjcam.point_to_pixel(points[i]), result[i], 1e-6 );
+    EXPECT_VECTOR_NEAR( pixels[i], result[i], 1e-2 );
+  }
+}
@@ -189,3 +189,34 @@ TEST( CAHVModel, ForwardReverse ) {
     }
   }
 }
+
+TEST( CAHVModel, Batch ) {
+  CAHVModel cahv(Vector3(0.606583,-0.036214,-0.234717),
+                 Vector3(0.708256,-0.0113108,0.705866),
+                 Vector3(365.881,275.126,361.931),
+                 Vector3(173.589,-3.95587,550.402));
+
+  std::vector<Vector2> pixels;
+  for ( uint32 i = 100; i < 901; i += 100 )
+    for ( uint32 j = 100; j < 901; j+= 100 )
+      pixels.push_back( Vector2(i,j) );
+
+  std::vector<Vector3> vectors, centers, points;
+  cahv.pixels_to_vectors( pixels, vectors );
+  cahv.camera_centers( pixels, centers );
+  ASSERT_EQ( pixels.size(), vectors.size() );
+  ASSERT_EQ( pixels.size(), centers.size() );
+  for ( size_t i = 0; i < pixels.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( cahv.pixel_to_vector(pixels[i]), vectors[i], 1e-12 );
+    EXPECT_VECTOR_EQ( cahv.C, centers[i] );
+    points.push_back( centers[i] + 30*vectors[i] );
+  }
+
+  std::vector<Vector2> result;
+  cahv.points_to_pixels( points, result );
+  ASSERT_EQ( points.size(), result.size() );
+  for ( size_t i = 0; i < points.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( cahv.point_to_pixel(points[i]), result[i], 1e-8 );
+    EXPECT_VECTOR_NEAR( pixels[i], result[i], 1e-2 );
+  }
+}
@@ -96,3 +96,37 @@ TEST( CAHVOREModel, Linearize ) {
   EXPECT_VECTOR_NEAR(Vector3(177.463,13.6499,548.543),
                      cahv.V, 1e-2);
 }
+
+TEST( CAHVOREModel, Batch ) {
+  CAHVOREModel cahvore(Vector3(0.606185,-0.043367,-0.234891),
+                       Vector3(0.712013,0.037316,0.701174),
+                       Vector3(353.341,474.873,350.82),
+                       Vector3(44.0102,16.904,683.916),
+                       Vector3(0.712953,0.038186,0.700171),
+                       Vector3(3e-06,-0.013032,-0.00754),
+                       Vector3(0.000942,0.00228,0.001613),
+                       3, 0.37 );
+
+  std::vector<Vector2> pixels;
+  for ( uint32 i = 100; i < 901; i += 100 )
+    for ( uint32 j = 100; j < 901; j+= 100 )
+      pixels.push_back( Vector2(i,j) );
+
+  std::vector<Vector3> vectors, centers, points;
+  cahvore.pixels_to_vectors( pixels, vectors );
+  cahvore.camera_centers( pixels, centers );
+  ASSERT_EQ( pixels.size(), vectors.size() );
+  for ( size_t i = 0; i < pixels.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( cahvore.pixel_to_vector(pixels[i]), vectors[i], 1e-10 );
+    EXPECT_VECTOR_EQ( cahvore.C, centers[i] );
+    points.push_back( centers[i] + 30*vectors[i] );
+  }
+
+  std::vector<Vector2> result;
+  cahvore.points_to_pixels( points, result );
+  ASSERT_EQ( points.size(), result.size() );
+  for ( size_t i = 0; i < points.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( cahvore.point_to_pixel(points[i]), result[i], 1e-8 );
+    EXPECT_VECTOR_NEAR( pixels[i], result[i], 3e-2 );
+  }
+}
@@ -177,3 +177,35 @@ TEST( CAHVORModel, ForwardReverse) {
     }
   }
 }
+
+TEST( CAHVORModel, Batch ) {
+  CAHVORModel cahvor(Vector3(0.491222,-0.0717236,-1.24143),
+                     Vector3(0.921657,-0.230518,0.312107),
+                     Vector3(757.076,1071.6,160.227),
+                     Vector3(91.7479,-27.7504,1319.48),
+                     Vector3(0.920759,-0.206185,0.331197),
+                     Vector3(0.00096,-0.002183,0.018547));
+
+  std::vector<Vector2> pixels;
+  for ( uint32 i = 100; i < 901; i += 100 )
+    for ( uint32 j = 100; j < 901; j+= 100 )
+      pixels.push_back( Vector2(i,j) );
+
+  std::vector<Vector3> vectors, centers, points;
+  cahvor.pixels_to_vectors( pixels, vectors );
+  cahvor.camera_centers( pixels, centers );
+  ASSERT_EQ( pixels.size(), vectors.size() );
+  for ( size_t i = 0; i < pixels.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( cahvor.pixel_to_vector(pixels[i]), vectors[i], 1e-12 );
+    EXPECT_VECTOR_EQ( cahvor.C, centers[i] );
+    points.push_back( centers[i] + 30*vectors[i] );
+  }
+
+  std::vector<Vector2> result;
+  cahvor.points_to_pixels( points, result );
+  ASSERT_EQ( points.size(), result.size() );
+  for ( size_t i = 0; i < points.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( cahvor.point_to_pixel(points[i]), result[i], 1e-8 );
+    EXPECT_VECTOR_NEAR( pixels[i], result[i], 1e-2 );
+  }
+}
@@ -0,0 +1,124 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+
+#include <gtest/gtest_VW.h>
+#include <test/Helpers.h>
+
+#include <vw/Camera/DistortionMap.h>
+#include <vw/Camera/LensDistortion.h>
+#include <vw/Camera/PinholeModel.h>
+
+using namespace vw;
+using namespace vw::camera;
+using namespace vw::test;
+
+// A camera with its intrinsics in mm, 0.01 mm pixels
+static PinholeModel test_camera( LensDistortion const& distortion ) {
+  return PinholeModel( Vector3(1,2,3), math::identity_matrix<3>(),
+                       6.0, 6.1, 3.2, 2.4, distortion, 0.01 );
+}
+
+#if defined(VW_HAVE_PKG_LAPACK) && VW_HAVE_PKG_LAPACK==1
+
+TEST( DistortionMap, Lookup ) {
+  PinholeModel camera = test_camera( TsaiLensDistortion(Vector4(-0.028, 0.0106, -0.0004, 0.0003)) );
+  DistortionMap map( camera, Vector2i(640, 480), 1e-3 );
+  EXPECT_TRUE( map.matches( camera ) );
+
+  LensDistortion const* lens = camera.lens_distortion();
+  for ( double y = -10; y < 490; y += 13.7 )
+    for ( double x = -10; x < 650; x += 17.3 ) {
+      Vector2 undistorted, distorted;
+      ASSERT_TRUE( map.undistorted_pixel( Vector2(x,y), undistorted ) );
+      EXPECT_VECTOR_NEAR( lens->undistorted_coordinates( camera, Vector2(x,y)*0.01 )/0.01,
+                          undistorted, 2e-3 );
+      ASSERT_TRUE( map.distorted_pixel( undistorted, distorted ) );
+      EXPECT_VECTOR_NEAR( Vector2(x,y), distorted, 3e-3 );
+    }
+
+  Vector2 result;
+  EXPECT_FALSE( map.undistorted_pixel( Vector2(-1000, 0), result ) );
+}
+
+TEST( DistortionMap, PinholeModel ) {
+  PinholeModel camera = test_camera( BrownConradyDistortion(Vector2(0.01,-0.02), Vector3(-0.03,0.002,-0.0001),
+                                                            Vector2(0.0005,-0.0003), 0.3) );
+  PinholeModel mapped = camera;
+  mapped.set_distortion_map( boost::shared_ptr<DistortionMap const>
+                             ( new DistortionMap( camera, Vector2i(640, 480) ) ) );
+  ASSERT_TRUE( mapped.distortion_map().get() != 0 );
+
+  std::vector<Vector2> pixels;
+  std::vector<Vector3> points;
+  for ( double y = 0; y < 480; y += 37.1 )
+    for ( double x = 0; x < 640; x += 41.3 ) {
+      Vector2 pix(x,y);
+      Vector3 vec = camera.pixel_to_vector( pix );
+      EXPECT_VECTOR_NEAR( vec, mapped.pixel_to_vector( pix ), 1e-6 );
+      Vector3 point = camera.camera_center() + 10*vec;
+      EXPECT_VECTOR_NEAR( camera.point_to_pixel( point ), mapped.point_to_pixel( point ), 3e-3 );
+      pixels.push_back( pix );
+      points.push_back( point );
+    }
+
+  // The batch methods use the map too
+  std::vector<Vector3> vectors;
+  std::vector<Vector2> result;
+  mapped.pixels_to_vectors( pixels, vectors );
+  mapped.points_to_pixels( points, result );
+  for ( size_t i = 0; i < pixels.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( mapped.pixel_to_vector( pixels[i] ), vectors[i], 1e-12 );
+    EXPECT_VECTOR_NEAR( mapped.point_to_pixel( points[i] ), result[i], 1e-8 );
+  }
+
+  // A map for another camera is refused, and changing the camera drops it
+  PinholeModel other = test_camera( NullLensDistortion() );
+  EXPECT_THROW( other.set_distortion_map( mapped.distortion_map() ), ArgumentErr );
+  mapped.set_focal_length( Vector2(6.0, 6.2) );
+  EXPECT_TRUE( mapped.distortion_map().get() == 0 );
+}
+
+TEST( DistortionMap, ReadWrite ) {
+  PinholeModel camera = test_camera( TsaiLensDistortion(Vector4(-0.028, 0.0106, -0.0004, 0.0003)) );
+  DistortionMap map( camera, Vector2i(320, 240), 1e-3, 32 );
+
+  UnlinkName file( "map.vwdm" );
+  map.write( file );
+  DistortionMap loaded;
+  loaded.read( file );
+  EXPECT_TRUE( loaded.matches( camera ) );
+  EXPECT_EQ( map.image_size(), loaded.image_size() );
+  EXPECT_EQ( map.tolerance(),  loaded.tolerance()  );
+
+  for ( double y = 0; y < 240; y += 11.3 )
+    for ( double x = 0; x < 320; x += 9.7 ) {
+      Vector2 a, b;
+      ASSERT_TRUE( map.undistorted_pixel( Vector2(x,y), a ) );
+      ASSERT_TRUE( loaded.undistorted_pixel( Vector2(x,y), b ) );
+      EXPECT_VECTOR_EQ( a, b );
+      ASSERT_TRUE( map.distorted_pixel( Vector2(x,y), a ) );
+      ASSERT_TRUE( loaded.distorted_pixel( Vector2(x,y), b ) );
+      EXPECT_VECTOR_EQ( a, b );
+    }
+
+  EXPECT_FALSE( loaded.matches( test_camera( NullLensDistortion() ) ) );
+  EXPECT_THROW( loaded.read( "does-not-exist.vwdm" ), IOErr );
+}
+
+#endif
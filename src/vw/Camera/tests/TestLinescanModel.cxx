@@ -26,6 +26,38 @@
 using namespace vw;
 using namespace camera;
 
+// A pushbroom camera 700 km up, flying along -Y and looking down, with
+// a slight roll wobble and lens distortion. It counts how many times
+// the camera is evaluated.
+class WobblyPushbroom : public LinescanModel {
+  mutable int m_evaluations;
+public:
+  WobblyPushbroom() : LinescanModel(Vector2i(2000, 3000), false), m_evaluations(0) {}
+
+  virtual Vector3 get_camera_center_at_time  (double time) const {
+    return Vector3(0, 0, 700000) + time*get_camera_velocity_at_time(time);
+  }
+  virtual Vector3 get_camera_velocity_at_time(double /*time*/) const {
+    return Vector3(0, -7000, 0);
+  }
+  virtual Quat    get_camera_pose_at_time    (double time) const {
+    // Camera +Z points down, +Y along the flight direction
+    return Quat(math::axis_angle_to_quaternion(Vector3(1e-4*sin(20*time), 0, 0)))
+      * Quat(0, 1, 0, 0);
+  }
+  virtual double  get_time_at_line           (double line) const {
+    return 1e-4*line;
+  }
+  virtual Vector3 get_local_pixel_vector(Vector2 const& pix) const {
+    m_evaluations++;
+    double x = (pix.x() - 1000) / 20000;
+    return normalize(Vector3(x + 0.05*x*x*x, 0, 1));
+  }
+
+  int  evaluations() const { return m_evaluations; }
+  void reset_evaluations() { m_evaluations = 0; }
+};
+
 // TODO: Is there a good test we can do here?
 //       - Not as important since we are not using templates anymore.
 
@@ -113,3 +145,44 @@ TEST( LinearPushbroom, PixelToVector ) {
   */
 }
 
+TEST( LinescanModel, PointToPixel ) {
+  WobblyPushbroom cam;
+
+  // Ground points for a block of pixels, in row order
+  std::vector<Vector2> truth;
+  std::vector<Vector3> points;
+  for ( int j = 100; j < 3000; j += 290 )
+    for ( int i = 50; i < 2000; i += 97 ) {
+      Vector2 pixel( i + 0.25, j + 0.5 );
+      Vector3 center = cam.camera_center(pixel);
+      Vector3 vec    = cam.pixel_to_vector(pixel);
+      truth.push_back( pixel );
+      points.push_back( center - (center[2] + 30*sin(0.01*i)) / vec[2] * vec );
+    }
+
+  cam.reset_evaluations();
+  std::vector<Vector2> generic(points.size());
+  for ( size_t i = 0; i < points.size(); i++ )
+    generic[i] = cam.point_to_pixel( points[i] );
+  int generic_evaluations = cam.evaluations();
+
+  cam.reset_evaluations();
+  std::vector<Vector2> batch;
+  cam.points_to_pixels( points, batch );
+  int batch_evaluations = cam.evaluations();
+
+  ASSERT_EQ( points.size(), batch.size() );
+  for ( size_t i = 0; i < points.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( truth[i], batch[i],   1e-5 );
+    EXPECT_VECTOR_NEAR( generic[i], batch[i], 1e-4 );
+  }
+  // The warm started secant solver needs a small fraction of the work
+  EXPECT_LT( 10*batch_evaluations, generic_evaluations );
+
+  // The same solver for single points
+  cam.set_fast_point_to_pixel( true );
+  cam.reset_evaluations();
+  for ( size_t i = 0; i < points.size(); i++ )
+    EXPECT_VECTOR_NEAR( truth[i], cam.point_to_pixel( points[i] ), 1e-5 );
+  EXPECT_LT( cam.evaluations(), generic_evaluations );
+}
@@ -113,6 +113,45 @@ TEST( PinholeModel, TsaiDistortion ) {
 #endif
 }
 
+// Batch results must match the single point methods
+static void check_batch( PinholeModel const& pinhole, double tol ) {
+  std::vector<Vector2> pixels;
+  for ( int i = 0; i < 1000; i += 111 )
+    for ( int j = 0; j < 1000; j += 143 )
+      pixels.push_back( Vector2(i,j) );
+
+  std::vector<Vector3> vectors, centers, points;
+  pinhole.pixels_to_vectors( pixels, vectors );
+  pinhole.camera_centers( pixels, centers );
+  ASSERT_EQ( pixels.size(), vectors.size() );
+  ASSERT_EQ( pixels.size(), centers.size() );
+  for ( size_t i = 0; i < pixels.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( pinhole.pixel_to_vector(pixels[i]), vectors[i], 1e-12 );
+    EXPECT_VECTOR_EQ( pinhole.camera_center(), centers[i] );
+    points.push_back( centers[i] + 20*vectors[i] );
+  }
+
+  std::vector<Vector2> result;
+  pinhole.points_to_pixels( points, result );
+  ASSERT_EQ( points.size(), result.size() );
+  for ( size_t i = 0; i < points.size(); i++ ) {
+    EXPECT_VECTOR_NEAR( pinhole.point_to_pixel(points[i]), result[i], 1e-8 );
+    EXPECT_VECTOR_NEAR( pixels[i], result[i], tol );
+  }
+}
+
+TEST( PinholeModel, Batch ) {
+  PinholeModel pinhole( Vector3(3,-2,1),
+                        math::euler_to_rotation_matrix(0.1,-0.2,0.05,"xyz"),
+                        600,620, 500,480, 0.5 );
+  check_batch( pinhole, 1e-8 );
+
+#if defined(VW_HAVE_PKG_LAPACK) && VW_HAVE_PKG_LAPACK==1
+  pinhole.set_lens_distortion( TsaiLensDistortion(Vector4(-0.28,0.106,-0.00014,0.0011)) );
+  check_batch( pinhole, 1e-2 );
+#endif
+}
+
 TEST( PinholeModel, ScalePinhole ) {
   Matrix<double,3,3> rot = vw::math::euler_to_quaternion(1.15, 0.0, -1.57, "xyz").rotation_matrix();
   PinholeModel pinhole4(Vector3(-0.329, 0.065, -0.82),
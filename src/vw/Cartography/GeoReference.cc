@@ -797,6 +797,118 @@ double GeoReference::test_pixel_reprojection_error(Vector2 const& pixel) {
     return Vector2(projected.u, projected.v);
   }
 
+  // Applies a homogeneous 3x3 transform to every point
+  static void apply_homography( Matrix3x3 const& M, std::vector<Vector2> const& in,
+                                std::vector<Vector2>& out ) {
+    out.resize( in.size() );
+    for ( size_t i = 0; i < in.size(); i++ ) {
+      double x = in[i][0], y = in[i][1];
+      double denom = x * M(2,0) + y * M(2,1) + M(2,2);
+      out[i][0] = (x * M(0,0) + y * M(0,1) + M(0,2)) / denom;
+      out[i][1] = (x * M(1,0) + y * M(1,1) + M(1,2)) / denom;
+    }
+  }
+
+  void GeoReference::pixel_to_point(std::vector<Vector2> const& pixels,
+                                    std::vector<Vector2>& points) const {
+    apply_homography( this->vw_native_transform(), pixels, points );
+  }
+
+  void GeoReference::point_to_pixel(std::vector<Vector2> const& points,
+                                    std::vector<Vector2>& pixels) const {
+    apply_homography( this->vw_native_inverse_transform(), points, pixels );
+  }
+
+  // Runs pj_transform() over x/y arrays, from src to dst, and throws
+  // if the call or any single point failed. Lon/lat is in radians.
+  static void transform_points( ProjContext const& ctx, void* src, void* dst,
+                                std::vector<double>& x, std::vector<double>& y,
+                                std::vector<Vector2> const& input ) {
+    if ( x.empty() )
+      return;
+    int err = pj_transform( src, dst, long(x.size()), 1, &x[0], &y[0], NULL );
+    if ( err == 0 )
+      err = ctx.error_no();
+    for ( size_t i = 0; i < x.size(); i++ ) {
+      if ( err || x[i] == HUGE_VAL || y[i] == HUGE_VAL )
+        vw_throw( ProjectionErr() << "Bad projection in GeoReference.cc. Proj.4 error: "
+                  << (err ? pj_strerrno(err) : "point out of range")
+                  << ".\nLocation is " << input[i] << ".\n" );
+    }
+  }
+
+  void GeoReference::point_to_lonlat(std::vector<Vector2> const& points,
+                                     std::vector<Vector2>& lonlats) const {
+    lonlats.resize( points.size() );
+    if ( !m_is_projected ) {
+      for ( size_t i = 0; i < points.size(); i++ ) {
+        lonlats[i][0] = math::normalize_longitude(points[i][0], m_center_lon_zero);
+        lonlats[i][1] = points[i][1];
+      }
+      return;
+    }
+
+    // One pj_transform() from the projection to its own lon/lat
+    void* proj_ptr = m_proj_context.proj_ptr();
+    boost::shared_ptr<void> latlong( pj_latlong_from_proj(proj_ptr), pj_free );
+    VW_ASSERT( latlong, ProjectionErr() << "Proj.4 could not build the lon/lat system of "
+               << overall_proj4_str() << ".\n" );
+    std::vector<double> x( points.size() ), y( points.size() );
+    for ( size_t i = 0; i < points.size(); i++ ) {
+      x[i] = points[i][0];
+      y[i] = points[i][1];
+    }
+    transform_points( m_proj_context, proj_ptr, latlong.get(), x, y, points );
+    for ( size_t i = 0; i < points.size(); i++ ) {
+      lonlats[i][0] = math::normalize_longitude(x[i] * RAD_TO_DEG, m_center_lon_zero);
+      lonlats[i][1] = y[i] * RAD_TO_DEG;
+    }
+  }
+
+  void GeoReference::lonlat_to_point(std::vector<Vector2> const& lonlats,
+                                     std::vector<Vector2>& points) const {
+    points.resize( lonlats.size() );
+    if ( !m_is_projected ) {
+      for ( size_t i = 0; i < lonlats.size(); i++ ) {
+        points[i][0] = math::normalize_longitude(lonlats[i][0], m_center_lon_zero);
+        points[i][1] = lonlats[i][1];
+      }
+      return;
+    }
+
+    // Same latitude clamp as the single point version
+    static const double BOUND = 1.5707963267948966 - (1e-10) - std::numeric_limits<double>::epsilon();
+
+    void* proj_ptr = m_proj_context.proj_ptr();
+    boost::shared_ptr<void> latlong( pj_latlong_from_proj(proj_ptr), pj_free );
+    VW_ASSERT( latlong, ProjectionErr() << "Proj.4 could not build the lon/lat system of "
+               << overall_proj4_str() << ".\n" );
+    std::vector<double> x( lonlats.size() ), y( lonlats.size() );
+    for ( size_t i = 0; i < lonlats.size(); i++ ) {
+      x[i] = math::normalize_longitude(lonlats[i][0], m_center_lon_zero) * DEG_TO_RAD;
+      y[i] = lonlats[i][1] * DEG_TO_RAD;
+      if(y[i] > BOUND)        y[i] = BOUND;
+      else if(y[i] < -BOUND) y[i] = -BOUND;
+    }
+    transform_points( m_proj_context, latlong.get(), proj_ptr, x, y, lonlats );
+    for ( size_t i = 0; i < lonlats.size(); i++ ) {
+      points[i][0] = x[i];
+      points[i][1] = y[i];
+    }
+  }
+
+  void GeoReference::pixel_to_lonlat(std::vector<Vector2> const& pixels,
+                                     std::vector<Vector2>& lonlats) const {
+    pixel_to_point( pixels, lonlats );
+    point_to_lonlat( lonlats, lonlats );
+  }
+
+  void GeoReference::lonlat_to_pixel(std::vector<Vector2> const& lonlats,
+                                     std::vector<Vector2>& pixels) const {
+    lonlat_to_point( lonlats, pixels );
+    point_to_pixel( pixels, pixels );
+  }
+
   /// Convert lon/lat/alt to projected x/y/alt 
   Vector3 GeoReference::geodetic_to_point(Vector3 llh) const {
 
@@ -316,6 +316,19 @@ namespace cartography {
       return point_to_pixel(lonlat_to_point(lat_lon));
     }
 
+    /// Batched versions of the conversions above, for converting many
+    /// points (like a row of pixels) at once. Projected conversions
+    /// hand the whole batch to one pj_transform() call, unprojected
+    /// georeferences don't touch proj.4 at all, and they throw if any
+    /// point fails to project. The output
+    /// is resized to match the input and may be the input itself.
+    void pixel_to_point (std::vector<Vector2> const& pixels,  std::vector<Vector2>& points ) const;
+    void point_to_pixel (std::vector<Vector2> const& points,  std::vector<Vector2>& pixels ) const;
+    void point_to_lonlat(std::vector<Vector2> const& points,  std::vector<Vector2>& lonlats) const;
+    void lonlat_to_point(std::vector<Vector2> const& lonlats, std::vector<Vector2>& points ) const;
+    void pixel_to_lonlat(std::vector<Vector2> const& pixels,  std::vector<Vector2>& lonlats) const;
+    void lonlat_to_pixel(std::vector<Vector2> const& lonlats, std::vector<Vector2>& pixels ) const;
+
     /// For a given pixel bbox, return the corresponding bbox in projected space
     BBox2  pixel_to_point_bbox(BBox2i const& pixel_bbox) const;
 
@@ -118,6 +118,29 @@ double get_image_meters_per_pixel(int width, int height, GeoReference const& geo
   return (d1 + d2) / 2.0;
 }
 
+void dem_pixel_spacing(GeoReference const& georef, int32 rows,
+                       std::vector<double>& x_spacing, std::vector<double>& y_spacing) {
+  Matrix3x3 transform = georef.transform();
+  x_spacing.assign(rows, transform(0,0));
+  y_spacing.assign(rows, transform(1,1));
+  if (georef.is_projected())
+    return;
+
+  // Degrees to meters along the parallel and the meridian
+  double a  = georef.datum().semi_major_axis();
+  double b  = georef.datum().semi_minor_axis();
+  double e2 = (a*a - b*b) / (a*a);
+  for (int32 row = 0; row < rows; ++row) {
+    double lat  = georef.pixel_to_lonlat(Vector2(0, row))[1];
+    double slat = sin(lat*M_PI/180), clat = cos(lat*M_PI/180);
+    double w    = 1 - e2*slat*slat;
+    double prime_vertical = a / sqrt(w);
+    double meridian       = a * (1 - e2) / (w * sqrt(w));
+    x_spacing[row] *= prime_vertical * clat * M_PI/180;
+    y_spacing[row] *= meridian * M_PI/180;
+  }
+}
+
 }} // vw::cartography
 
 #undef CHECK_PROJ_ERROR
@@ -58,6 +58,14 @@ namespace cartography {
   /// Estimates meters per pixel for an image.
   double get_image_meters_per_pixel(int width, int height, GeoReference const& georef);
 
+  /// Ground spacing in meters between neighbouring pixels of each row
+  /// of a DEM, for TerrainDerivativeView: x_spacing eastward along the
+  /// row and y_spacing northward down the column (negative when north
+  /// is up).  Geographic georeferences use the datum's radii of
+  /// curvature at each row's latitude, found once per row.
+  void dem_pixel_spacing(GeoReference const& georef, int32 rows,
+                         std::vector<double>& x_spacing, std::vector<double>& y_spacing);
+
   /// Standard options for multi-threaded GDAL (tif) image writing.
   /// - num_threads sets the number of parallel block-writing threads when calling one
   ///   of the block write functions in this file.  By default it is set to
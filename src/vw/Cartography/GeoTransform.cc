@@ -110,6 +110,32 @@ namespace cartography {
   }
 
 
+  void GeoTransform::reverse(std::vector<Vector2> const& in, std::vector<Vector2>& out) const {
+    if (m_skip_map_projection) {
+      m_dst_georef.pixel_to_point(in, out);
+      m_src_georef.point_to_pixel(out, out);
+      return;
+    }
+    m_dst_georef.pixel_to_lonlat(in, out);
+    if (!m_skip_datum_conversion)
+      lonlat_to_lonlat(out, out, false);
+    m_src_georef.lonlat_to_pixel(out, out);
+  }
+
+
+  void GeoTransform::forward(std::vector<Vector2> const& in, std::vector<Vector2>& out) const {
+    if (m_skip_map_projection) {
+      m_src_georef.pixel_to_point(in, out);
+      m_dst_georef.point_to_pixel(out, out);
+      return;
+    }
+    m_src_georef.pixel_to_lonlat(in, out);
+    if (!m_skip_datum_conversion)
+      lonlat_to_lonlat(out, out, true);
+    m_dst_georef.lonlat_to_pixel(out, out);
+  }
+
+
   BBox2i GeoTransform::forward_bbox( BBox2i const& bbox ) const {
 
     if (bbox.empty()) return BBox2();
@@ -192,6 +218,32 @@ namespace cartography {
     return Vector2(lon, lat);
   }
 
+  void GeoTransform::lonlat_to_lonlat(std::vector<Vector2> const& in, std::vector<Vector2>& out,
+                                      bool forward) const {
+    out.resize(in.size());
+    if (in.empty())
+      return;
+
+    // pj_transform wants separate coordinate arrays
+    std::vector<double> lon(in.size()), lat(in.size()), alt(in.size(), 0.0);
+    for (size_t i = 0; i < in.size(); i++) {
+      lon[i] = in[i][0];
+      lat[i] = in[i][1];
+    }
+
+    if(forward) // src to dst
+      pj_transform(m_src_datum_proj.proj_ptr(), m_dst_datum_proj.proj_ptr(), long(in.size()), 0,
+                   &lon[0], &lat[0], &alt[0]);
+    else // dst to src
+      pj_transform(m_dst_datum_proj.proj_ptr(), m_src_datum_proj.proj_ptr(), long(in.size()), 0,
+                   &lon[0], &lat[0], &alt[0]);
+    CHECK_PROJ_ERROR( m_src_datum_proj );
+    CHECK_PROJ_ERROR( m_dst_datum_proj );
+
+    for (size_t i = 0; i < in.size(); i++)
+      out[i] = Vector2(lon[i], lat[i]);
+  }
+
   bool GeoTransform::check_bbox_wraparound() const {
 
     // Check if we are converting between georefs with different lon centers.
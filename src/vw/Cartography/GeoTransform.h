@@ -21,6 +21,7 @@
 
 #include <sstream>
 #include <string>
+#include <vector>
 
 #include <vw/Math/Vector.h>
 #include <vw/Image/Transform.h>
@@ -73,6 +74,13 @@ namespace cartography {
     /// pixel from an image in the source georeference frame.
     Vector2 reverse(Vector2 const& v) const;
 
+    /// Batched versions of forward() and reverse(). These convert a
+    /// whole set of pixels (like the grid of an ApproximateTransform)
+    /// through each georeference in turn instead of one point at a
+    /// time through all of them. The output may be the input itself.
+    void forward(std::vector<Vector2> const& in, std::vector<Vector2>& out) const;
+    void reverse(std::vector<Vector2> const& in, std::vector<Vector2>& out) const;
+
     /// Convert a pixel bounding box in the source image to
     ///  a pixel bounding box in the destination image.
     /// - This function handles the case where the image crosses the poles.
@@ -101,6 +109,10 @@ namespace cartography {
     /// - The parameter 'forward' specifies whether we convert forward (true) or reverse (false).
     Vector2 lonlat_to_lonlat(Vector2 const& lonlat, bool forward=true) const;
 
+    /// Batched version of lonlat_to_lonlat(), with a single call to proj.4.
+    void lonlat_to_lonlat(std::vector<Vector2> const& in, std::vector<Vector2>& out,
+                          bool forward=true) const;
+
 
     /// Returns true if bounding box conversions wrap around the output
     ///  georeference, creating a very large bounding box.
@@ -128,6 +140,23 @@ namespace cartography {
   /// Format a GeoTransform to a text stream (for debugging)
   std::ostream& operator<<(std::ostream& os, const GeoTransform& trans);
 
+  /// Lets ApproximateTransform<GeoTransform> build its lookup table
+  /// with the batched reverse() instead of one point at a time.
+  inline void reverse_transform_points( GeoTransform const& transform,
+                                        std::vector<Vector2> const& in,
+                                        std::vector<Vector2>& out ) {
+    transform.reverse( in, out );
+  }
+
+  /// Rows of a TransformView also go through the batched reverse().
+  inline void reverse_transform_row( GeoTransform const& transform, Vector2 const& start,
+                                     int32 n, std::vector<Vector2>& out ) {
+    std::vector<Vector2> points( n );
+    for ( int32 i = 0; i < n; i++ )
+      points[i] = start + Vector2(i,0);
+    transform.reverse( points, out );
+  }
+
 
   // ---------------------------------------------------------------------------
   // Image View Functions
@@ -297,3 +297,61 @@ TEST(GeoTransform, sinusoidalTest) {
   EXPECT_NEAR(pixel2.max().y(), 914.0, eps);  
 }
 
+
+TEST(GeoTransform, BatchMatchesSingle) {
+  // UTM to lonlat with a datum change, so every stage of the batch
+  // path is exercised.
+  GeoReference utm_georef, ll_georef;
+
+  Matrix3x3 utm_map;
+  utm_map(0,0) =  15.0;
+  utm_map(1,1) = -15.0;
+  utm_map(0,2) = 419832.648;
+  utm_map(1,2) = 5184829.285;
+  utm_map(2,2) = 1;
+  utm_georef.set_transform(utm_map);
+  utm_georef.set_UTM(59, false);
+
+  Matrix3x3 ll_map;
+  ll_map(0,0) =  0.0002;
+  ll_map(1,1) = -0.0002;
+  ll_map(0,2) = 169.9;
+  ll_map(1,2) = -43.2;
+  ll_map(2,2) = 1;
+  ll_georef.set_transform(ll_map);
+  ll_georef.set_well_known_geogcs("NAD27");
+
+  std::vector<Vector2> pixels;
+  for (int y = 0; y < 200; y += 37)
+    for (int x = 0; x < 300; x += 41)
+      pixels.push_back(Vector2(x, y) + Vector2(0.25, 0.5));
+
+  GeoTransform geotx(utm_georef, ll_georef);
+  std::vector<Vector2> fwd, rev;
+  geotx.forward(pixels, fwd);
+  geotx.reverse(pixels, rev);
+  ASSERT_EQ(pixels.size(), fwd.size());
+  ASSERT_EQ(pixels.size(), rev.size());
+  for (size_t i = 0; i < pixels.size(); i++) {
+    EXPECT_VECTOR_NEAR(geotx.forward(pixels[i]), fwd[i], 1e-8);
+    EXPECT_VECTOR_NEAR(geotx.reverse(pixels[i]), rev[i], 1e-8);
+  }
+
+  // Same projection, only the affine transforms differ
+  GeoReference utm_georef2 = utm_georef;
+  utm_map(0,2) += 1000;
+  utm_georef2.set_transform(utm_map);
+  GeoTransform affine_tx(utm_georef, utm_georef2);
+  affine_tx.reverse(pixels, rev);
+  for (size_t i = 0; i < pixels.size(); i++)
+    EXPECT_VECTOR_NEAR(affine_tx.reverse(pixels[i]), rev[i], 1e-8);
+
+  // And the in-place georeference conversions round trip
+  std::vector<Vector2> points = pixels;
+  utm_georef.pixel_to_lonlat(points, points);
+  for (size_t i = 0; i < pixels.size(); i++)
+    EXPECT_VECTOR_NEAR(utm_georef.pixel_to_lonlat(pixels[i]), points[i], 1e-10);
+  utm_georef.lonlat_to_pixel(points, points);
+  for (size_t i = 0; i < pixels.size(); i++)
+    EXPECT_VECTOR_NEAR(pixels[i], points[i], 1e-5);
+}
@@ -35,5 +35,7 @@
 #include <vw/Core/ConfigParser.h>
 #include <vw/Core/ThreadQueue.h>
 #include <vw/Core/ProgressCallback.h>
+#include <vw/Core/Metrics.h>
+#include <vw/Core/Trace.h>
 
 #endif // __VW_CORE_H__
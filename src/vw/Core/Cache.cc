@@ -21,6 +21,27 @@
 /// Types and functions to assist cacheing regeneratable data.
 ///
 #include <vw/Core/Cache.h>
+#include <vw/Core/Metrics.h>
+
+namespace {
+  // Totals over every cache, for vw_metrics()
+  vw::MetricGauge& cache_bytes_metric() {
+    static vw::MetricGauge& gauge = vw::vw_metrics().gauge( "vw_cache_bytes", "Bytes of data held by caches" );
+    return gauge;
+  }
+  vw::MetricCounter& cache_evictions_metric() {
+    static vw::MetricCounter& counter = vw::vw_metrics().counter( "vw_cache_evictions_total", "Cache lines evicted to make room" );
+    return counter;
+  }
+  vw::MetricCounter& cache_hits_metric() {
+    static vw::MetricCounter& counter = vw::vw_metrics().counter( "vw_cache_hits_total", "Cache lookups that found the data in memory" );
+    return counter;
+  }
+  vw::MetricCounter& cache_misses_metric() {
+    static vw::MetricCounter& counter = vw::vw_metrics().counter( "vw_cache_misses_total", "Cache lookups that had to generate the data" );
+    return counter;
+  }
+}
 
 // Note that this function does not actually load the data,
 // it is up to the calling function to do that.
@@ -45,6 +66,7 @@ void vw::Cache::allocate( size_t size, CacheLineBase* line ) {
                     // This places the line at the beginning of the valid list.
                     
   m_size += size;   // Update the size after adding the new line
+  cache_bytes_metric().add( size );
   VW_CACHE_DEBUG( VW_OUT(DebugMessage, "cache") << "Cache allocated " << size
                   << " bytes (" << m_size << " / " << m_max_size << " used)" << "\n"; );
 
@@ -60,9 +82,11 @@ void vw::Cache::allocate( size_t size, CacheLineBase* line ) {
     }
 
     // Deallocate the oldest CacheLine object if nothing is using it.
+    size_t line_size = local_last_valid->size();
     bool invalidated = local_last_valid->try_invalidate();
     if (invalidated) { // If we were able to clear it...
       local_evictions++;
+      trace_instant( "cache", "evict", "bytes", line_size );
       local_last_valid = m_last_valid;  // Update the local pointer to the new oldest CacheLine.
     } else {
       // If we can't deallocate current line,
@@ -74,6 +98,7 @@ void vw::Cache::allocate( size_t size, CacheLineBase* line ) {
   {
     Mutex::WriteLock cache_lock( m_stats_mutex );
     m_evictions += local_evictions; // Update class evictions stat
+    cache_evictions_metric().increment( local_evictions );
     
     // Warn about exceeding the cache size. Note that the warning is
     // printed only if the size now is a multiple of the previous size
@@ -132,6 +157,7 @@ void vw::Cache::deallocate( size_t size, CacheLineBase *line ) {
   invalidate( line );
 
   m_size -= size; // Remove the given size contribution.
+  cache_bytes_metric().add( -int64(size) );
   VW_CACHE_DEBUG( VW_OUT(DebugMessage, "cache") << "Cache deallocated " << size << " bytes (" << m_size << " / " << m_max_size << " used)" << "\n"; )
 }
 
@@ -215,4 +241,16 @@ void vw::Cache::deprioritize( CacheLineBase *line ) {
   m_last_valid = line;
 }
 
-
+void vw::Cache::record_access( bool hit ) {
+  {
+    Mutex::WriteLock cache_lock( m_stats_mutex );
+    if (hit)
+      m_hits++;
+    else
+      m_misses++;
+  }
+  if (hit)
+    cache_hits_metric().increment();
+  else
+    cache_misses_metric().increment();
+}
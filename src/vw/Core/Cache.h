@@ -67,6 +67,7 @@
 #include <vw/Core/Thread.h>
 #include <vw/Core/Log.h>
 #include <vw/Core/FundamentalTypes.h>
+#include <vw/Core/Trace.h>
 
 #include <typeinfo>
 #include <sstream>
@@ -220,6 +221,7 @@ namespace vw {
     void invalidate  ( CacheLineBase *line ); ///< Move the cache line to the top of the invalid list.
     void remove      ( CacheLineBase *line ); ///< Remove the cache line from the cache lists.
     void deprioritize( CacheLineBase *line ); ///< Move the cache line to the bottom of the valid list.
+    void record_access( bool hit );           ///< Count a hit or a miss.
     
     
     
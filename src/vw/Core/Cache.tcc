@@ -80,15 +80,7 @@ typename Cache::CacheLine<GeneratorT>::value_type const& Cache::CacheLine<Genera
 
   m_mutex.lock_shared(); // Grab a shared lock
   bool hit = (bool)m_value;
-  { // Grab a temporary mutex to update our cache statistics
-    { // TODO: This should be abstracted into a call
-      Mutex::WriteLock cache_lock( cache().m_stats_mutex );
-      if (hit)
-        cache().m_hits++;
-      else
-        cache().m_misses++;
-    }
-  }
+  cache().record_access( hit ); // Update our cache statistics
   if( !hit ) { // Then we need to load the data into memory.
     VW_CACHE_DEBUG( VW_OUT(DebugMessage, "cache") << "Cache generating CacheLine " << info() << "\n"; );
     m_mutex.unlock_shared(); // Release shared
@@ -98,7 +90,11 @@ typename Cache::CacheLine<GeneratorT>::value_type const& Cache::CacheLine<Genera
 
     //TODO: Why allocate and then generate?
     m_generation_count++; // Update stats
-    m_value = core::detail::pointerish(m_generator)->generate();
+    {
+      ScopedTrace trace( "cache", "generate" );
+      trace.arg( "bytes", size() );
+      m_value = core::detail::pointerish(m_generator)->generate();
+    }
     // Downgrade from exclusive access down to shared access
     m_mutex.unlock_and_lock_upgrade();
     m_mutex.unlock_upgrade_and_lock_shared();
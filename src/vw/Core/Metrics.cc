@@ -0,0 +1,263 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <vw/Core/Metrics.h>
+#include <vw/Core/Condition.h>
+#include <vw/Core/Exception.h>
+#include <vw/Core/Log.h>
+
+#include <cstdio>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+namespace vw {
+
+  // ---------------------------------------------------
+  // MetricHistogram
+  // ---------------------------------------------------
+
+  MetricHistogram::MetricHistogram( std::vector<double> const& bounds )
+    : m_bounds( bounds ), m_buckets( new boost::atomic<uint64>[bounds.size()+1] ),
+      m_count( 0 ), m_sum( 0.0 ) {
+    for ( size_t i = 0; i + 1 < m_bounds.size(); i++ )
+      VW_ASSERT( m_bounds[i] < m_bounds[i+1], ArgumentErr() << "MetricHistogram: bounds must be increasing." );
+    for ( size_t i = 0; i <= m_bounds.size(); i++ )
+      m_buckets[i].store( 0 );
+  }
+
+  void MetricHistogram::observe( double value ) {
+    size_t i = 0;
+    while ( i < m_bounds.size() && value > m_bounds[i] )
+      i++;
+    m_buckets[i].fetch_add( 1, boost::memory_order_relaxed );
+    m_count.fetch_add( 1, boost::memory_order_relaxed );
+    double sum = m_sum.load( boost::memory_order_relaxed );
+    while ( !m_sum.compare_exchange_weak( sum, sum + value, boost::memory_order_relaxed ) ) {}
+  }
+
+  std::vector<double> exponential_buckets( double start, double factor, int32 count ) {
+    VW_ASSERT( start > 0 && factor > 1 && count > 0,
+               ArgumentErr() << "exponential_buckets: need start > 0, factor > 1 and count > 0." );
+    std::vector<double> bounds( count );
+    for ( int32 i = 0; i < count; i++, start *= factor )
+      bounds[i] = start;
+    return bounds;
+  }
+
+  std::string metric_label( std::string const& name, std::string const& value ) {
+    std::string result = name + "=\"";
+    for ( size_t i = 0; i < value.size(); i++ ) {
+      if      ( value[i] == '\\' ) result += "\\\\";
+      else if ( value[i] == '"'  ) result += "\\\"";
+      else if ( value[i] == '\n' ) result += "\\n";
+      else                         result += value[i];
+    }
+    return result + "\"";
+  }
+
+  // ---------------------------------------------------
+  // MetricsRegistry
+  // ---------------------------------------------------
+
+  MetricsRegistry::Series& MetricsRegistry::find( std::string const& name, std::string const& help,
+                                                  std::string const& type, std::string const& labels ) {
+    Family& family = m_families[name];
+    if ( family.type.empty() ) {
+      family.type = type;
+      family.help = help;
+    }
+    VW_ASSERT( family.type == type, LogicErr() << "MetricsRegistry: " << name << " is a "
+               << family.type << ", not a " << type << "." );
+    return family.series[labels];
+  }
+
+  MetricCounter& MetricsRegistry::counter( std::string const& name, std::string const& help,
+                                           std::string const& labels ) {
+    Mutex::Lock lock( m_mutex );
+    Series& series = find( name, help, "counter", labels );
+    if ( !series.counter )
+      series.counter.reset( new MetricCounter );
+    return *series.counter;
+  }
+
+  MetricGauge& MetricsRegistry::gauge( std::string const& name, std::string const& help,
+                                       std::string const& labels ) {
+    Mutex::Lock lock( m_mutex );
+    Series& series = find( name, help, "gauge", labels );
+    if ( !series.gauge )
+      series.gauge.reset( new MetricGauge );
+    return *series.gauge;
+  }
+
+  MetricHistogram& MetricsRegistry::histogram( std::string const& name, std::string const& help,
+                                               std::vector<double> const& bounds,
+                                               std::string const& labels ) {
+    Mutex::Lock lock( m_mutex );
+    Series& series = find( name, help, "histogram", labels );
+    if ( !series.histogram )
+      series.histogram.reset( new MetricHistogram( bounds ) );
+    return *series.histogram;
+  }
+
+  namespace {
+    // "name{labels}", leaving out empty braces
+    void write_series_name( std::ostream& os, std::string const& name,
+                            std::string const& labels, std::string const& extra = "" ) {
+      os << name;
+      if ( !labels.empty() || !extra.empty() )
+        os << "{" << labels << ( !labels.empty() && !extra.empty() ? "," : "" ) << extra << "}";
+    }
+  }
+
+  void MetricsRegistry::write_prometheus( std::ostream& os ) const {
+    Mutex::Lock lock( m_mutex );
+    std::streamsize precision = os.precision( std::numeric_limits<double>::digits10 );
+    typedef std::map<std::string, Family>::const_iterator family_iter;
+    typedef std::map<std::string, Series>::const_iterator series_iter;
+    for ( family_iter f = m_families.begin(); f != m_families.end(); ++f ) {
+      std::string const& name = f->first;
+      os << "# HELP " << name << " " << f->second.help << "\n"
+         << "# TYPE " << name << " " << f->second.type << "\n";
+      for ( series_iter s = f->second.series.begin(); s != f->second.series.end(); ++s ) {
+        std::string const& labels = s->first;
+        Series const& series = s->second;
+        if ( series.counter ) {
+          write_series_name( os, name, labels );
+          os << " " << series.counter->value() << "\n";
+        } else if ( series.gauge ) {
+          write_series_name( os, name, labels );
+          os << " " << series.gauge->value() << "\n";
+        } else if ( series.histogram ) {
+          MetricHistogram const& h = *series.histogram;
+          // Buckets are cumulative in this format
+          uint64 cumulative = 0;
+          for ( size_t i = 0; i <= h.bounds().size(); i++ ) {
+            cumulative += h.bucket( i );
+            std::ostringstream le;
+            le.precision( os.precision() );
+            if ( i < h.bounds().size() )
+              le << h.bounds()[i];
+            else
+              le << "+Inf";
+            write_series_name( os, name + "_bucket", labels, metric_label( "le", le.str() ) );
+            os << " " << cumulative << "\n";
+          }
+          write_series_name( os, name + "_sum", labels );
+          os << " " << h.sum() << "\n";
+          write_series_name( os, name + "_count", labels );
+          os << " " << h.count() << "\n";
+        }
+      }
+    }
+    os.precision( precision );
+  }
+
+  MetricsRegistry& vw_metrics() {
+    // Never destroyed, so that metrics can be updated from static
+    // destructors, such as the system cache's.
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+  }
+
+  // ---------------------------------------------------
+  // Periodic dumps
+  // ---------------------------------------------------
+
+  namespace {
+
+    void dump_metrics( std::string const& filename ) {
+      if ( filename.empty() ) {
+        std::ostringstream oss;
+        vw_metrics().write_prometheus( oss );
+        vw_out( InfoMessage, "metrics" ) << oss.str();
+        return;
+      }
+      // Write a new file and move it over the old one, so that whoever
+      // reads the file never sees half a dump.
+      std::string tmp = filename + ".tmp";
+      {
+        std::ofstream ofs( tmp.c_str() );
+        if ( !ofs ) {
+          vw_out( WarningMessage, "metrics" ) << "Could not write metrics to " << tmp << "\n";
+          return;
+        }
+        vw_metrics().write_prometheus( ofs );
+      }
+      if ( std::rename( tmp.c_str(), filename.c_str() ) != 0 )
+        vw_out( WarningMessage, "metrics" ) << "Could not replace " << filename << "\n";
+    }
+
+    class MetricsDumpTask {
+      std::string m_filename;
+      uint32      m_period_ms;
+      Mutex       m_mutex;
+      Condition   m_stop_event;
+      bool        m_stop;
+    public:
+      MetricsDumpTask( std::string const& filename, double period_seconds )
+        : m_filename( filename ), m_period_ms( uint32( period_seconds * 1000 ) ), m_stop( false ) {}
+
+      void operator()() {
+        Mutex::Lock lock( m_mutex );
+        while ( true ) {
+          if ( !m_stop )
+            m_stop_event.timed_wait( lock, m_period_ms );
+          bool stop = m_stop;
+          dump_metrics( m_filename );
+          if ( stop )
+            break;
+        }
+      }
+
+      void stop() {
+        Mutex::Lock lock( m_mutex );
+        m_stop = true;
+        m_stop_event.notify_all();
+      }
+    };
+
+    Mutex& dump_mutex() {
+      static Mutex* m = new Mutex();
+      return *m;
+    }
+
+    boost::shared_ptr<MetricsDumpTask> g_dump_task;
+    boost::shared_ptr<Thread>          g_dump_thread;
+
+  } // anonymous namespace
+
+  void start_metrics_dump( std::string const& filename, double period_seconds ) {
+    VW_ASSERT( period_seconds > 0, ArgumentErr() << "start_metrics_dump: the period must be positive." );
+    stop_metrics_dump();
+    Mutex::Lock lock( dump_mutex() );
+    g_dump_task.reset( new MetricsDumpTask( filename, period_seconds ) );
+    g_dump_thread.reset( new Thread( g_dump_task ) );
+  }
+
+  void stop_metrics_dump() {
+    Mutex::Lock lock( dump_mutex() );
+    if ( !g_dump_thread )
+      return;
+    g_dump_task->stop();
+    g_dump_thread->join();
+    g_dump_thread.reset();
+    g_dump_task.reset();
+  }
+
+} // namespace vw
@@ -0,0 +1,148 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file Metrics.h
+///
+/// Counters, gauges and histograms for watching a long run from the
+/// outside: how full the caches are, how deep the work queues are, how
+/// long the block writer stalls, and how many bytes each kind of image
+/// resource has read and written.  Updating a metric is a single atomic
+/// operation; only looking one up by name takes a lock, so hot paths
+/// look theirs up once and keep the reference.
+///
+/// The registry is written out in the Prometheus text format, either on
+/// demand with write_prometheus() or every few seconds by
+/// start_metrics_dump().
+///
+/// \code
+///   static MetricCounter& reads = vw_metrics().counter( "my_reads_total", "Reads so far" );
+///   reads.increment();
+/// \endcode
+///
+#ifndef __VW_CORE_METRICS_H__
+#define __VW_CORE_METRICS_H__
+
+#include <vw/Core/FundamentalTypes.h>
+#include <vw/Core/Thread.h>
+
+#include <iosfwd>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <boost/atomic.hpp>
+#include <boost/noncopyable.hpp>
+#include <boost/scoped_array.hpp>
+#include <boost/shared_ptr.hpp>
+
+namespace vw {
+
+  /// A count that only goes up, such as bytes read.
+  class MetricCounter : private boost::noncopyable {
+    boost::atomic<uint64> m_value;
+  public:
+    MetricCounter() : m_value(0) {}
+    void   increment( uint64 n = 1 ) { m_value.fetch_add( n, boost::memory_order_relaxed ); }
+    uint64 value() const             { return m_value.load( boost::memory_order_relaxed ); }
+  };
+
+  /// A value that goes up and down, such as the bytes held in a cache.
+  class MetricGauge : private boost::noncopyable {
+    boost::atomic<int64> m_value;
+  public:
+    MetricGauge() : m_value(0) {}
+    void  set( int64 value ) { m_value.store( value, boost::memory_order_relaxed ); }
+    void  add( int64 n )     { m_value.fetch_add( n, boost::memory_order_relaxed ); }
+    int64 value() const      { return m_value.load( boost::memory_order_relaxed ); }
+  };
+
+  /// Counts of observations falling at or below each of a set of bounds,
+  /// with their sum, such as how long each wait took.
+  class MetricHistogram : private boost::noncopyable {
+    std::vector<double> m_bounds;
+    boost::scoped_array<boost::atomic<uint64> > m_buckets; ///< One per bound, then one for the rest
+    boost::atomic<uint64> m_count;
+    boost::atomic<double> m_sum;
+  public:
+    /// The bounds must be increasing.
+    MetricHistogram( std::vector<double> const& bounds );
+
+    void observe( double value );
+
+    std::vector<double> const& bounds() const { return m_bounds; }
+    /// Observations in bucket i alone, i <= bounds().size()
+    uint64 bucket( size_t i ) const { return m_buckets[i].load( boost::memory_order_relaxed ); }
+    uint64 count() const { return m_count.load( boost::memory_order_relaxed ); }
+    double sum() const   { return m_sum.load( boost::memory_order_relaxed ); }
+  };
+
+  /// Bounds from start, multiplying by factor each time.
+  std::vector<double> exponential_buckets( double start, double factor, int32 count );
+
+  /// Format one label as name="value" for the labels arguments below,
+  /// escaping the value.  Join several with commas.
+  std::string metric_label( std::string const& name, std::string const& value );
+
+  /// Named metrics.  Asking for a name again returns the same metric;
+  /// metrics with the same name and different labels are written out
+  /// together.  Metrics are never removed, so references stay valid.
+  class MetricsRegistry : private boost::noncopyable {
+    struct Series {
+      boost::shared_ptr<MetricCounter>   counter;
+      boost::shared_ptr<MetricGauge>     gauge;
+      boost::shared_ptr<MetricHistogram> histogram;
+    };
+    struct Family {
+      std::string help, type;
+      std::map<std::string, Series> series; ///< By labels
+    };
+
+    mutable Mutex m_mutex;
+    std::map<std::string, Family> m_families;
+
+    Series& find( std::string const& name, std::string const& help,
+                  std::string const& type, std::string const& labels );
+  public:
+    MetricCounter&   counter  ( std::string const& name, std::string const& help,
+                                std::string const& labels = "" );
+    MetricGauge&     gauge    ( std::string const& name, std::string const& help,
+                                std::string const& labels = "" );
+    MetricHistogram& histogram( std::string const& name, std::string const& help,
+                                std::vector<double> const& bounds,
+                                std::string const& labels = "" );
+
+    /// Every metric, in the Prometheus text exposition format.
+    void write_prometheus( std::ostream& os ) const;
+  };
+
+  /// The registry the Vision Workbench records its own metrics in.
+  MetricsRegistry& vw_metrics();
+
+  /// Write vw_metrics() to filename every period seconds, from a
+  /// background thread, until stop_metrics_dump().  Each dump replaces
+  /// the file whole.  With an empty filename the dump goes to the log
+  /// instead, as an InfoMessage in the "metrics" namespace.  Starting a
+  /// dump stops any earlier one.
+  void start_metrics_dump( std::string const& filename, double period_seconds );
+
+  /// Stop the periodic dump, writing one last time.
+  void stop_metrics_dump();
+
+} // namespace vw
+
+#endif // __VW_CORE_METRICS_H__
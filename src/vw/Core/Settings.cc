@@ -20,6 +20,7 @@
 #include <vw/Core/Cache.h>
 #include <vw/Core/Settings.h>
 #include <vw/Core/ConfigParser.h>
+#include <vw/Core/Trace.h>
 
 #include <sys/stat.h>
 
@@ -179,6 +180,7 @@ Settings::Settings()
     _VW_SET1(write_pool_size, 21), // 21 threads is about 252MB of back data for RGB f32 1024x1024 blocks
     _VW_SET1(default_tile_size, 256),
     _VW_SET1(tmp_directory, default_tmp_dir()),
+    _VW_SET1(trace_enabled, false),
     m_rc_poll_period(5.0f)
 {
   set_rc_filename(default_vwrc(), false);
@@ -203,5 +205,6 @@ GETSET(system_cache_size, size_t, vw_system_cache().resize(x););
 GETSET(write_pool_size, uint32, ;);
 GETSET(default_tile_size, uint32, ;);
 GETSET(tmp_directory, std::string, ;);
+GETSET(trace_enabled, bool, vw::set_trace_enabled(x););
 
 } // namespace vw
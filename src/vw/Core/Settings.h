@@ -75,6 +75,9 @@ namespace vw {
     // The directory used to store temporary files.
     VW_DECLARE_SETTING(tmp_directory, std::string);
 
+    // Whether trace points record events (see Trace.h).
+    VW_DECLARE_SETTING(trace_enabled, bool);
+
 #undef VW_DECLARE_SETTING
 
     // Member variables assoc. with periodically polling the log
@@ -18,12 +18,33 @@
 #include <vw/config.h>
 #include <vw/Core/Exception.h>
 #include <vw/Core/Log.h>
+#include <vw/Core/Metrics.h>
+#include <vw/Core/Stopwatch.h>
 #include <vw/Core/ThreadPool.h>
+#include <vw/Core/Trace.h>
 
 #include <ostream>
 
 using namespace vw;
 
+namespace {
+  // Totals over every work queue, for vw_metrics()
+  MetricGauge& active_workers_metric() {
+    static MetricGauge& gauge = vw_metrics().gauge( "vw_workqueue_active_workers", "Worker threads running tasks" );
+    return gauge;
+  }
+  MetricGauge& queued_tasks_metric() {
+    static MetricGauge& gauge = vw_metrics().gauge( "vw_workqueue_queued_tasks", "Tasks waiting in work queues" );
+    return gauge;
+  }
+  MetricHistogram& task_seconds_metric() {
+    static MetricHistogram& histogram =
+      vw_metrics().histogram( "vw_workqueue_task_seconds", "Time taken by each work queue task",
+                              exponential_buckets( 0.001, 4, 10 ) );
+    return histogram;
+  }
+}
+
 //----------------------------------------------------
 // Task
 
@@ -59,13 +80,20 @@ void WorkQueue::WorkerThread::operator()() {
     VW_OUT(DebugMessage, "thread") << "ThreadPool: running worker thread "
                                    << m_thread_id << "\n";
     // Run the task and then signal that it is finished
-    (*m_task)();
+    {
+      ScopedTrace trace("workqueue", "task");
+      trace.arg("worker", m_thread_id);
+      uint64 start = Stopwatch::microtime();
+      (*m_task)();
+      task_seconds_metric().observe( (Stopwatch::microtime() - start) / 1e6 );
+    }
     m_task->signal_finished();
 
     {
       // We lock m_queue_mutex to prevent WorkQueue::notify() from running
       // until we either sucessfully have grabbed the next task, or we have
       // completely terminated the worker.
+      ScopedTrace trace("workqueue", "next_task_wait");
       Mutex::Lock lock(m_queue.m_queue_mutex);
       m_task = m_queue.get_next_task();
 
@@ -79,6 +107,7 @@ void WorkQueue::WorkerThread::operator()() {
 
 void WorkQueue::worker_thread_complete(int worker_id) {
   m_active_workers--;
+  active_workers_metric().add(-1);
   VW_OUT(DebugMessage, "thread") << "ThreadPool: terminating worker thread " << worker_id << ".  [ " << m_active_workers << " / " << m_max_workers << " now active ]\n";
 
   // Erase the worker thread from the list of active threads
@@ -115,6 +144,7 @@ void WorkQueue::notify() {
     boost::shared_ptr<Thread> thread(new Thread(next_worker));
     m_running_threads[next_available_thread_id] = thread;
     m_active_workers++;
+    active_workers_metric().add(1);
     VW_OUT(DebugMessage, "thread") << "ThreadPool: creating worker thread " << next_available_thread_id << ".  [ " << m_active_workers << " / " << m_max_workers << " now active ]\n";
   }
 }
@@ -133,6 +163,7 @@ int WorkQueue::active_threads() {
 
 // Join all currently running threads and wait for the task pool to be empty.
 void WorkQueue::join_all() {
+  ScopedTrace trace("workqueue", "join_all_wait");
   bool finished = false;
 
   // Wait for the threads to clean up the threadpool state and exit.
@@ -168,6 +199,7 @@ void FifoWorkQueue::add_task(boost::shared_ptr<Task> task) {
     Mutex::Lock lock(m_mutex);
     m_queued_tasks.push_back(task);
   }
+  queued_tasks_metric().add(1);
   this->notify();
 }
 
@@ -178,6 +210,7 @@ boost::shared_ptr<Task> FifoWorkQueue::get_next_task() {
 
   boost::shared_ptr<Task> task = m_queued_tasks.front();
   m_queued_tasks.pop_front();
+  queued_tasks_metric().add(-1);
   return task;
 }
 
@@ -199,6 +232,7 @@ void OrderedWorkQueue::add_task(boost::shared_ptr<Task> task, int index) {
     Mutex::Lock lock(m_mutex);
     m_queued_tasks[index] = task;
   }
+  queued_tasks_metric().add(1);
   this->notify();
 }
 
@@ -220,5 +254,6 @@ boost::shared_ptr<Task> OrderedWorkQueue::get_next_task() {
   boost::shared_ptr<Task> task = (*iter).second;
   m_queued_tasks.erase(m_queued_tasks.begin());
   m_next_index++;
+  queued_tasks_metric().add(-1);
   return task;
 }
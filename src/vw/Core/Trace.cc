@@ -0,0 +1,254 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <vw/Core/Trace.h>
+#include <vw/Core/Exception.h>
+#include <vw/Core/Thread.h>
+
+#include <fstream>
+#include <ostream>
+#include <vector>
+
+#include <boost/thread/tss.hpp>
+
+namespace vw {
+namespace core {
+namespace detail {
+
+  boost::atomic<bool> g_trace_enabled( false );
+
+  // Events are appended to fixed-size chunks, so that an event never
+  // moves once it is written and a reader can walk the chunks while
+  // the owning thread appends more.  The owner publishes each event and
+  // chunk with a release store of count or next; readers load them
+  // with acquire, so they only see events that are fully written.
+  struct TraceChunk {
+    static const size_t capacity = 1024;
+    TraceEvent                  events[capacity];
+    boost::atomic<size_t>       count;
+    boost::atomic<TraceChunk*>  next;
+    TraceChunk() : count(0), next(0) {}
+  };
+
+  // The events of one thread at a time.  Only that thread appends to
+  // it.  Once the thread exits, the buffer is handed on to the next new
+  // thread, so there are never more buffers than threads that were
+  // running at once, however many come and go.  The id numbers the
+  // buffer, and so the row it shows up on in the timeline.
+  struct TraceBuffer {
+    uint64      id;
+    TraceChunk* head;
+    TraceChunk* tail;
+    TraceBuffer( uint64 id ) : id(id), head(new TraceChunk), tail(head) {}
+  };
+
+  // The buffers outlive their threads, so that events can be written
+  // out after the workers are gone.  As in Thread.cc, these are
+  // constructed on first use and never destroyed, so that they are
+  // there for trace points in static destructors.
+  static Mutex& trace_mutex() {
+    static Mutex* m = new Mutex();
+    return *m;
+  }
+
+  static std::vector<TraceBuffer*>& trace_buffers() {
+    static std::vector<TraceBuffer*>* buffers = new std::vector<TraceBuffer*>();
+    return *buffers;
+  }
+
+  // Buffers whose threads have exited, waiting for new ones
+  static std::vector<TraceBuffer*>& free_trace_buffers() {
+    static std::vector<TraceBuffer*>* buffers = new std::vector<TraceBuffer*>();
+    return *buffers;
+  }
+
+  // Called as a thread exits.  Its events stay where they are.
+  static void release_buffer( TraceBuffer* buffer ) {
+    Mutex::Lock lock( trace_mutex() );
+    free_trace_buffers().push_back( buffer );
+  }
+
+  typedef boost::thread_specific_ptr<TraceBuffer> buffer_ptr_t;
+
+  static buffer_ptr_t& trace_buffer_ptr() {
+    static buffer_ptr_t* ptr = new buffer_ptr_t( &release_buffer );
+    return *ptr;
+  }
+
+  void trace_record( TraceEvent const& event ) {
+    TraceBuffer* buffer = trace_buffer_ptr().get();
+    if ( !buffer ) {
+      {
+        Mutex::Lock lock( trace_mutex() );
+        std::vector<TraceBuffer*>& free_buffers = free_trace_buffers();
+        if ( free_buffers.empty() ) {
+          buffer = new TraceBuffer( trace_buffers().size() );
+          trace_buffers().push_back( buffer );
+        } else {
+          buffer = free_buffers.back();
+          free_buffers.pop_back();
+        }
+      }
+      trace_buffer_ptr().reset( buffer );
+    }
+
+    // Only this thread writes the tail chunk, so its own count needs no
+    // ordering.
+    TraceChunk* chunk = buffer->tail;
+    size_t count = chunk->count.load( boost::memory_order_relaxed );
+    if ( count == TraceChunk::capacity ) {
+      TraceChunk* next = new TraceChunk;
+      chunk->next.store( next, boost::memory_order_release );
+      chunk = buffer->tail = next;
+      count = 0;
+    }
+    chunk->events[count] = event;
+    chunk->count.store( count + 1, boost::memory_order_release );
+  }
+
+  // Names are expected to be identifiers, but keep the JSON valid
+  // whatever they are.
+  static void write_json_string( std::ostream& os, const char* s ) {
+    os << '"';
+    for ( ; *s; s++ ) {
+      if ( *s == '"' || *s == '\\' )
+        os << '\\' << *s;
+      else if ( (unsigned char)*s >= 0x20 )
+        os << *s;
+    }
+    os << '"';
+  }
+
+}} // namespace core::detail
+
+  void set_trace_enabled( bool enabled ) {
+    core::detail::g_trace_enabled.store( enabled, boost::memory_order_relaxed );
+  }
+
+  void trace_instant( const char* category, const char* name,
+                      const char* arg_name, int64 arg_value ) {
+    if ( !trace_enabled() )
+      return;
+    TraceEvent event;
+    event.category = category;
+    event.name     = name;
+    event.start    = Stopwatch::microtime();
+    event.duration = 0;
+    event.instant  = true;
+    event.num_args = 0;
+    if ( arg_name ) {
+      event.arg_names [0] = arg_name;
+      event.arg_values[0] = arg_value;
+      event.num_args = 1;
+    }
+    core::detail::trace_record( event );
+  }
+
+  void write_trace( std::ostream& os ) {
+    using namespace core::detail;
+    Mutex::Lock lock( trace_mutex() );
+    std::vector<TraceBuffer*> const& buffers = trace_buffers();
+
+    // Times are written relative to the first event
+    uint64 epoch = 0;
+    bool found = false;
+    for ( size_t b = 0; b < buffers.size(); b++ )
+      for ( TraceChunk* chunk = buffers[b]->head; chunk;
+            chunk = chunk->next.load( boost::memory_order_acquire ) )
+        for ( size_t i = 0, n = chunk->count.load( boost::memory_order_acquire ); i < n; i++ )
+          if ( !found || chunk->events[i].start < epoch ) {
+            epoch = chunk->events[i].start;
+            found = true;
+          }
+
+    os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for ( size_t b = 0; b < buffers.size(); b++ ) {
+      uint64 tid = buffers[b]->id;
+      os << ( first ? "\n" : ",\n" )
+         << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << tid
+         << ",\"args\":{\"name\":\"vw thread " << tid << "\"}}";
+      first = false;
+
+      for ( TraceChunk* chunk = buffers[b]->head; chunk;
+            chunk = chunk->next.load( boost::memory_order_acquire ) )
+        for ( size_t i = 0, n = chunk->count.load( boost::memory_order_acquire ); i < n; i++ ) {
+          TraceEvent const& e = chunk->events[i];
+          os << ",\n{\"name\":";
+          write_json_string( os, e.name );
+          os << ",\"cat\":";
+          write_json_string( os, e.category );
+          if ( e.instant )
+            os << ",\"ph\":\"i\",\"s\":\"t\"";
+          else
+            os << ",\"ph\":\"X\",\"dur\":" << e.duration;
+          os << ",\"ts\":" << e.start - epoch << ",\"pid\":0,\"tid\":" << tid;
+          if ( e.num_args ) {
+            os << ",\"args\":{";
+            for ( int32 a = 0; a < e.num_args; a++ ) {
+              if ( a ) os << ",";
+              write_json_string( os, e.arg_names[a] );
+              os << ":" << e.arg_values[a];
+            }
+            os << "}";
+          }
+          os << "}";
+        }
+    }
+    os << "\n]}\n";
+  }
+
+  void write_trace( std::string const& filename ) {
+    std::ofstream ofs( filename.c_str() );
+    if ( !ofs )
+      vw_throw( IOErr() << "write_trace: could not open " << filename << " for writing." );
+    write_trace( ofs );
+    if ( !ofs )
+      vw_throw( IOErr() << "write_trace: failed writing " << filename << "." );
+  }
+
+  void clear_trace() {
+    using namespace core::detail;
+    Mutex::Lock lock( trace_mutex() );
+    std::vector<TraceBuffer*>& buffers = trace_buffers();
+    for ( size_t b = 0; b < buffers.size(); b++ ) {
+      TraceChunk* chunk = buffers[b]->head->next.load( boost::memory_order_acquire );
+      while ( chunk ) {
+        TraceChunk* next = chunk->next.load( boost::memory_order_acquire );
+        delete chunk;
+        chunk = next;
+      }
+      buffers[b]->head->next.store ( 0, boost::memory_order_release );
+      buffers[b]->head->count.store( 0, boost::memory_order_release );
+      buffers[b]->tail = buffers[b]->head;
+    }
+  }
+
+  uint64 trace_event_count() {
+    using namespace core::detail;
+    Mutex::Lock lock( trace_mutex() );
+    std::vector<TraceBuffer*> const& buffers = trace_buffers();
+    uint64 count = 0;
+    for ( size_t b = 0; b < buffers.size(); b++ )
+      for ( TraceChunk* chunk = buffers[b]->head; chunk;
+            chunk = chunk->next.load( boost::memory_order_acquire ) )
+        count += chunk->count.load( boost::memory_order_acquire );
+    return count;
+  }
+
+} // namespace vw
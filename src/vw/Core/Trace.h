@@ -0,0 +1,143 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file Trace.h
+///
+/// Tracing of what each thread spends its time on: which tile was
+/// rasterized when and for how long, cache generation and eviction,
+/// resource reads and writes, and waits on work queues.  Unlike the
+/// stopwatches in Stopwatch.h, which keep a total per name behind a
+/// mutex, every event is kept, in a buffer private to the thread that
+/// recorded it, so recording takes no locks.  The events are written
+/// out in the Chrome trace-event format, which chrome://tracing and
+/// Perfetto display as a timeline per thread.  A thread's buffer is
+/// handed on to the next new thread once it exits, so a timeline row
+/// can hold several short-lived threads one after another, and memory
+/// grows with the events recorded rather than the threads started.
+///
+/// Tracing is off by default and is turned on and off at run time with
+/// vw_settings().set_trace_enabled(), or "trace_enabled = 1" in the
+/// [general] section of ~/.vwrc.  While it is off a trace point costs
+/// one load and a branch.
+///
+/// \code
+///   ScopedTrace trace( "cache", "generate" );
+///   trace.arg( "bytes", size );
+/// \endcode
+///
+#ifndef __VW_CORE_TRACE_H__
+#define __VW_CORE_TRACE_H__
+
+#include <vw/Core/FundamentalTypes.h>
+#include <vw/Core/Stopwatch.h>
+
+#include <iosfwd>
+#include <string>
+
+#include <boost/atomic.hpp>
+
+namespace vw {
+
+  /// One recorded event.  Names must be string literals, or otherwise
+  /// outlive the trace, since only the pointers are kept.
+  struct TraceEvent {
+    static const int32 max_args = 4;
+
+    const char* category;
+    const char* name;
+    uint64      start;    ///< Stopwatch::microtime() at the start
+    uint64      duration; ///< In microseconds; unused for instant events
+    bool        instant;
+    int32       num_args;
+    const char* arg_names[max_args];
+    int64       arg_values[max_args];
+  };
+
+  namespace core {
+  namespace detail {
+    extern boost::atomic<bool> g_trace_enabled;
+    void trace_record( TraceEvent const& event );
+  }} // namespace core::detail
+
+  /// Whether trace points are recording.
+  inline bool trace_enabled() {
+    return core::detail::g_trace_enabled.load( boost::memory_order_relaxed );
+  }
+
+  /// Turn recording on or off.  Prefer vw_settings().set_trace_enabled(),
+  /// which calls this.
+  void set_trace_enabled( bool enabled );
+
+  /// Records the lifetime of the object as one event, if tracing was on
+  /// when it was constructed.
+  class ScopedTrace {
+    TraceEvent m_event;
+    bool       m_active;
+
+    ScopedTrace( ScopedTrace const& );
+    ScopedTrace& operator=( ScopedTrace const& );
+  public:
+    ScopedTrace( const char* category, const char* name ) : m_active( trace_enabled() ) {
+      if ( m_active ) {
+        m_event.category = category;
+        m_event.name     = name;
+        m_event.instant  = false;
+        m_event.num_args = 0;
+        m_event.start    = Stopwatch::microtime();
+      }
+    }
+
+    /// Attach a value to the event, such as a tile's position.  Values
+    /// past TraceEvent::max_args are dropped.
+    ScopedTrace& arg( const char* name, int64 value ) {
+      if ( m_active && m_event.num_args < TraceEvent::max_args ) {
+        m_event.arg_names [m_event.num_args] = name;
+        m_event.arg_values[m_event.num_args] = value;
+        m_event.num_args++;
+      }
+      return *this;
+    }
+
+    ~ScopedTrace() {
+      if ( m_active ) {
+        m_event.duration = Stopwatch::microtime() - m_event.start;
+        core::detail::trace_record( m_event );
+      }
+    }
+  };
+
+  /// Record a moment rather than a span, such as a cache eviction.
+  void trace_instant( const char* category, const char* name,
+                      const char* arg_name = 0, int64 arg_value = 0 );
+
+  /// Write every event recorded so far as Chrome trace-event JSON.  Call
+  /// this once the traced work is done; events recorded while it runs
+  /// may be left out, but the ones written are always complete.
+  void write_trace( std::ostream& os );
+  void write_trace( std::string const& filename );
+
+  /// Discard the recorded events.  Like write_trace(), only call this
+  /// while nothing is being traced.
+  void clear_trace();
+
+  /// The number of events recorded so far.
+  uint64 trace_event_count();
+
+} // namespace vw
+
+#endif // __VW_CORE_TRACE_H__
@@ -0,0 +1,105 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <gtest/gtest_VW.h>
+#include <test/Helpers.h>
+#include <vw/Core/Exception.h>
+#include <vw/Core/Metrics.h>
+#include <vw/Core/ThreadPool.h>
+
+#include <fstream>
+#include <sstream>
+
+using namespace vw;
+using namespace vw::test;
+
+class CountTask : public Task {
+  MetricCounter&   m_counter;
+  MetricHistogram& m_histogram;
+public:
+  CountTask( MetricCounter& counter, MetricHistogram& histogram )
+    : m_counter(counter), m_histogram(histogram) {}
+  void operator()() {
+    for ( int i = 0; i < 10000; i++ ) {
+      m_counter.increment();
+      m_histogram.observe( 0.5 );
+    }
+  }
+};
+
+TEST( Metrics, Counter ) {
+  MetricsRegistry registry;
+  MetricCounter& counter = registry.counter( "test_total", "Test counter" );
+  MetricHistogram& histogram = registry.histogram( "test_seconds", "Test histogram",
+                                                   exponential_buckets( 1, 2, 3 ) );
+  EXPECT_EQ( &counter, &registry.counter( "test_total", "Test counter" ) );
+  {
+    FifoWorkQueue queue( 4 );
+    for ( int i = 0; i < 8; i++ )
+      queue.add_task( boost::shared_ptr<Task>( new CountTask( counter, histogram ) ) );
+    queue.join_all();
+  }
+  EXPECT_EQ( 80000u, counter.value() );
+  EXPECT_EQ( 80000u, histogram.count() );
+  EXPECT_EQ( 80000u, histogram.bucket( 0 ) );
+  EXPECT_DOUBLE_EQ( 40000.0, histogram.sum() );
+
+  // A name keeps its kind
+  EXPECT_THROW( registry.gauge( "test_total", "Test gauge" ), LogicErr );
+}
+
+TEST( Metrics, Prometheus ) {
+  MetricsRegistry registry;
+  registry.gauge( "test_bytes", "Test gauge" ).set( 42 );
+  registry.gauge( "test_bytes", "Test gauge" ).add( -2 );
+  registry.counter( "test_total", "Test counter", metric_label( "resource", "PNG" ) ).increment( 3 );
+  registry.counter( "test_total", "Test counter", metric_label( "resource", "a\"b" ) ).increment();
+  MetricHistogram& histogram = registry.histogram( "test_seconds", "Test histogram",
+                                                   exponential_buckets( 1, 2, 3 ) );
+  histogram.observe( 0.5 );
+  histogram.observe( 2 );
+  histogram.observe( 3 );
+  histogram.observe( 100 );
+
+  std::ostringstream oss;
+  registry.write_prometheus( oss );
+  std::string s = oss.str();
+  EXPECT_NE( std::string::npos, s.find( "# HELP test_bytes Test gauge\n# TYPE test_bytes gauge\ntest_bytes 40\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "test_total{resource=\"PNG\"} 3\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "test_total{resource=\"a\\\"b\"} 1\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "# TYPE test_seconds histogram\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "test_seconds_bucket{le=\"1\"} 1\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "test_seconds_bucket{le=\"2\"} 2\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "test_seconds_bucket{le=\"4\"} 3\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "test_seconds_bucket{le=\"+Inf\"} 4\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "test_seconds_sum 105.5\n" ) );
+  EXPECT_NE( std::string::npos, s.find( "test_seconds_count 4\n" ) );
+}
+
+TEST( Metrics, Dump ) {
+  UnlinkName file( "test_metrics.prom" );
+  vw_metrics().counter( "test_dump_total", "Test counter" ).increment( 7 );
+  start_metrics_dump( file, 10 );
+  stop_metrics_dump(); // Writes once on the way out
+
+  std::ifstream ifs( file.c_str() );
+  ASSERT_TRUE( ifs.good() );
+  std::ostringstream oss;
+  oss << ifs.rdbuf();
+  EXPECT_NE( std::string::npos, oss.str().find( "test_dump_total 7\n" ) );
+}
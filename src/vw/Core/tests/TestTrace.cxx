@@ -0,0 +1,130 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <gtest/gtest_VW.h>
+#include <vw/Core/Trace.h>
+#include <vw/Core/Settings.h>
+#include <vw/Core/ThreadPool.h>
+
+#include <sstream>
+
+using namespace vw;
+
+class TraceTask : public Task {
+  int m_events;
+public:
+  TraceTask( int events ) : m_events(events) {}
+  void operator()() {
+    for ( int i = 0; i < m_events; i++ ) {
+      ScopedTrace trace( "test", "event" );
+      trace.arg( "i", i );
+    }
+  }
+};
+
+TEST( Trace, Disabled ) {
+  vw_settings().set_trace_enabled( false );
+  clear_trace();
+  {
+    ScopedTrace trace( "test", "event" );
+    trace.arg( "i", 1 );
+  }
+  trace_instant( "test", "instant" );
+  EXPECT_EQ( 0u, trace_event_count() );
+}
+
+TEST( Trace, Threads ) {
+  vw_settings().set_trace_enabled( true );
+  EXPECT_TRUE( trace_enabled() );
+  clear_trace();
+
+  // Enough events to fill several chunks on each thread
+  {
+    FifoWorkQueue queue( 4 );
+    for ( int i = 0; i < 8; i++ )
+      queue.add_task( boost::shared_ptr<Task>( new TraceTask( 1000 ) ) );
+    queue.join_all();
+  }
+  vw_settings().set_trace_enabled( false );
+
+  // Each task is itself traced by the work queue
+  std::ostringstream json;
+  write_trace( json );
+  std::string s = json.str();
+  size_t events = 0;
+  for ( size_t pos = s.find( "\"name\":\"event\"" ); pos != std::string::npos;
+        pos = s.find( "\"name\":\"event\"", pos + 1 ) )
+    events++;
+  EXPECT_EQ( 8000u, events );
+  EXPECT_LE( 8000u + 8, trace_event_count() );
+  EXPECT_NE( std::string::npos, s.find( "\"name\":\"task\"" ) );
+  EXPECT_NE( std::string::npos, s.find( "\"args\":{\"i\":999}" ) );
+  EXPECT_EQ( 0u, s.find( "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[" ) );
+
+  clear_trace();
+  EXPECT_EQ( 0u, trace_event_count() );
+}
+
+TEST( Trace, ThreadsComeAndGo ) {
+  vw_settings().set_trace_enabled( true );
+  clear_trace();
+
+  // Many threads, but never more than two at once, so their buffers
+  // are handed on rather than piling up
+  for ( int q = 0; q < 20; q++ ) {
+    FifoWorkQueue queue( 2 );
+    for ( int i = 0; i < 4; i++ )
+      queue.add_task( boost::shared_ptr<Task>( new TraceTask( 10 ) ) );
+    queue.join_all();
+  }
+  vw_settings().set_trace_enabled( false );
+
+  std::ostringstream json;
+  write_trace( json );
+  std::string s = json.str();
+  size_t rows = 0, events = 0;
+  for ( size_t pos = s.find( "\"thread_name\"" ); pos != std::string::npos;
+        pos = s.find( "\"thread_name\"", pos + 1 ) )
+    rows++;
+  for ( size_t pos = s.find( "\"name\":\"event\"" ); pos != std::string::npos;
+        pos = s.find( "\"name\":\"event\"", pos + 1 ) )
+    events++;
+  EXPECT_EQ( 800u, events );
+  EXPECT_LE( rows, 8u );
+  clear_trace();
+}
+
+TEST( Trace, Format ) {
+  vw_settings().set_trace_enabled( true );
+  clear_trace();
+  {
+    ScopedTrace trace( "io", "read" );
+    trace.arg( "a", 1 ).arg( "b", 2 ).arg( "c", 3 ).arg( "d", 4 ).arg( "e", 5 );
+  }
+  trace_instant( "cache", "evict", "bytes", 42 );
+  vw_settings().set_trace_enabled( false );
+
+  std::ostringstream json;
+  write_trace( json );
+  std::string s = json.str();
+  EXPECT_NE( std::string::npos, s.find( "\"name\":\"read\",\"cat\":\"io\",\"ph\":\"X\"" ) );
+  EXPECT_NE( std::string::npos, s.find( "\"args\":{\"a\":1,\"b\":2,\"c\":3,\"d\":4}" ) );
+  EXPECT_NE( std::string::npos, s.find( "\"name\":\"evict\",\"cat\":\"cache\",\"ph\":\"i\"" ) );
+  EXPECT_NE( std::string::npos, s.find( "\"args\":{\"bytes\":42}" ) );
+  clear_trace();
+}
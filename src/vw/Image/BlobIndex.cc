@@ -581,5 +581,185 @@ BlobIndexThreaded::bbox_end() { return m_blob_bbox.end(); }
 BlobIndexThreaded::const_bbox_iterator
 BlobIndexThreaded::bbox_end() const { return m_blob_bbox.end(); }
 
+// TiledBlobIndex
+///////////////////////////////////
+
+namespace {
+  // Union-find with path halving; the smaller index becomes the root,
+  // so roots are the first label of each component.
+  uint32 find_root( std::vector<uint32>& parent, uint32 x ) {
+    while ( parent[x] != x ) {
+      parent[x] = parent[parent[x]];
+      x = parent[x];
+    }
+    return x;
+  }
+
+  void unite( std::vector<uint32>& parent, uint32 a, uint32 b ) {
+    a = find_root( parent, a );
+    b = find_root( parent, b );
+    if ( a < b )      parent[b] = a;
+    else if ( b < a ) parent[a] = b;
+  }
+}
+
+BBox2i TiledBlobIndex::tile_bbox( int32 index ) const {
+  int32 col = index % m_tile_cols, row = index / m_tile_cols;
+  BBox2i bbox( col * m_tile_size, row * m_tile_size, m_tile_size, m_tile_size );
+  bbox.crop( BBox2i( 0, 0, m_size.x(), m_size.y() ) );
+  return bbox;
+}
+
+uint32 TiledBlobIndex::label_tile( ImageView<uint8> const& valid, ImageView<uint32>& labels ) {
+  int32 cols = valid.cols(), rows = valid.rows();
+  labels.set_size( cols, rows );
+  fill( labels, 0 );
+
+  // Provisional labels, joining any of the 4 earlier neighbors
+  std::vector<uint32> parent( 1, 0 );
+  for ( int32 j = 0; j < rows; j++ )
+    for ( int32 i = 0; i < cols; i++ ) {
+      if ( !valid(i,j) )
+        continue;
+      uint32 label = 0;
+      const int32 di[4] = { -1, -1, 0, 1 }, dj[4] = { 0, -1, -1, -1 };
+      for ( int32 n = 0; n < 4; n++ ) {
+        int32 ni = i + di[n], nj = j + dj[n];
+        if ( ni < 0 || ni >= cols || nj < 0 )
+          continue;
+        uint32 other = labels(ni,nj);
+        if ( !other )
+          continue;
+        if ( !label )
+          label = other;
+        else if ( other != label )
+          unite( parent, label, other );
+      }
+      if ( !label ) {
+        label = parent.size();
+        parent.push_back( label );
+      }
+      labels(i,j) = label;
+    }
+
+  // Number the components in order of their first pixel
+  std::vector<uint32> number( parent.size(), 0 );
+  uint32 count = 0;
+  for ( int32 j = 0; j < rows; j++ )
+    for ( int32 i = 0; i < cols; i++ ) {
+      uint32& label = labels(i,j);
+      if ( !label )
+        continue;
+      uint32 root = find_root( parent, label );
+      if ( !number[root] )
+        number[root] = ++count;
+      label = number[root];
+    }
+  return count;
+}
+
+void TiledBlobIndex::process_tile( ImageView<uint8> const& valid, BBox2i const& bbox, TileResult& result ) {
+  ImageView<uint32> labels;
+  result.stats.resize( label_tile( valid, labels ) );
+  for ( int32 j = 0; j < labels.rows(); j++ )
+    for ( int32 i = 0; i < labels.cols(); i++ ) {
+      if ( !labels(i,j) )
+        continue;
+      BlobStats& stats = result.stats[ labels(i,j) - 1 ];
+      BBox2i pixel( bbox.min().x() + i, bbox.min().y() + j, 1, 1 );
+      if ( stats.area == 0 )
+        stats.bbox = pixel;
+      else
+        stats.bbox.grow( pixel );
+      stats.area++;
+    }
+
+  int32 cols = labels.cols(), rows = labels.rows();
+  result.top   .resize( cols );
+  result.bottom.resize( cols );
+  result.left  .resize( rows );
+  result.right .resize( rows );
+  for ( int32 i = 0; i < cols; i++ ) {
+    result.top[i]    = labels(i,0);
+    result.bottom[i] = labels(i,rows-1);
+  }
+  for ( int32 j = 0; j < rows; j++ ) {
+    result.left[j]  = labels(0,j);
+    result.right[j] = labels(cols-1,j);
+  }
+}
+
+void TiledBlobIndex::merge( std::vector<TileResult> const& results ) {
+  // Tile labels are numbered consecutively across the tiles, from 0
+  m_offsets.resize( results.size() );
+  uint32 total = 0;
+  for ( size_t t = 0; t < results.size(); t++ ) {
+    m_offsets[t] = total;
+    total += results[t].stats.size();
+  }
+  std::vector<uint32> parent( total );
+  for ( uint32 i = 0; i < total; i++ )
+    parent[i] = i;
+
+  // Each pixel along a tile edge is joined to its neighbors across the
+  // edge, which includes those in diagonal tiles.
+  for ( int32 row = 1; row < m_tile_rows; row++ )
+    for ( int32 col = 0; col < m_tile_cols; col++ ) {
+      int32 above = (row-1) * m_tile_cols + col;
+      std::vector<uint32> const& bottom = results[above].bottom;
+      for ( int32 i = 0; i < int32(bottom.size()); i++ ) {
+        if ( !bottom[i] )
+          continue;
+        int32 x = col * m_tile_size + i;
+        for ( int32 nx = std::max( x-1, 0 ); nx <= std::min( x+1, m_size.x()-1 ); nx++ ) {
+          int32 below = row * m_tile_cols + nx / m_tile_size;
+          uint32 other = results[below].top[ nx % m_tile_size ];
+          if ( other )
+            unite( parent, m_offsets[above] + bottom[i] - 1, m_offsets[below] + other - 1 );
+        }
+      }
+    }
+  for ( int32 col = 1; col < m_tile_cols; col++ )
+    for ( int32 row = 0; row < m_tile_rows; row++ ) {
+      int32 left = row * m_tile_cols + col - 1;
+      std::vector<uint32> const& right_edge = results[left].right;
+      for ( int32 j = 0; j < int32(right_edge.size()); j++ ) {
+        if ( !right_edge[j] )
+          continue;
+        int32 y = row * m_tile_size + j;
+        for ( int32 ny = std::max( y-1, 0 ); ny <= std::min( y+1, m_size.y()-1 ); ny++ ) {
+          int32 right = ( ny / m_tile_size ) * m_tile_cols + col;
+          uint32 other = results[right].left[ ny % m_tile_size ];
+          if ( other )
+            unite( parent, m_offsets[left] + right_edge[j] - 1, m_offsets[right] + other - 1 );
+        }
+      }
+    }
+
+  // Roots are the first tile label of each blob, so numbering them in
+  // order numbers the blobs by their first tile.
+  m_final.resize( total );
+  m_stats.clear();
+  for ( uint32 i = 0; i < total; i++ ) {
+    uint32 root = find_root( parent, i );
+    if ( root == i ) {
+      m_stats.push_back( BlobStats() );
+      m_final[i] = m_stats.size();
+    } else {
+      m_final[i] = m_final[root];
+    }
+  }
+  for ( size_t t = 0; t < results.size(); t++ )
+    for ( size_t k = 0; k < results[t].stats.size(); k++ ) {
+      BlobStats const& tile_stats = results[t].stats[k];
+      BlobStats& stats = m_stats[ m_final[ m_offsets[t] + k ] - 1 ];
+      if ( stats.area == 0 )
+        stats.bbox = tile_stats.bbox;
+      else
+        stats.bbox.grow( tile_stats.bbox );
+      stats.area += tile_stats.area;
+    }
+}
+
 } // end namespace vw
 
@@ -502,6 +502,140 @@ class BlobIndexThreaded {
 
 
 
+/// Connected components of the valid pixels of an image, 8-connected
+/// like BlobIndex, found one tile at a time so that the image never has
+/// to fit in memory (e.g. a DiskImageView).
+///
+/// The first pass labels each tile on its own, in parallel, keeping just
+/// the labels along the tile edges and the area and bounding box of each
+/// tile blob.  Blobs that touch across tile edges are then merged with a
+/// union-find.  Labels are only produced on request by labels(), which
+/// labels the tiles again and maps them to the merged blobs.
+class TiledBlobIndex {
+public:
+  struct BlobStats {
+    uint64 area;
+    BBox2i bbox;
+    BlobStats() : area(0) {}
+  };
+
+  template <class SourceT>
+  TiledBlobIndex( ImageViewBase<SourceT> const& src,
+                  int32 tile_size   = vw_settings().default_tile_size(),
+                  int32 num_threads = vw_settings().default_num_threads() );
+
+  /// Blobs are labelled 1 to num_blobs(), in the order of their first
+  /// pixel in tile order.
+  uint32 num_blobs() const { return m_stats.size(); }
+  BlobStats const& stats( uint32 label ) const { return m_stats[label-1]; }
+
+  /// Label the pixels of 'bbox' of 'src', which must be the image given
+  /// to the constructor.  Invalid pixels get 0.
+  template <class SourceT>
+  void labels( ImageViewBase<SourceT> const& src, BBox2i const& bbox, ImageView<uint32>& dst ) const;
+
+private:
+  // What the first pass keeps of a tile
+  struct TileResult {
+    std::vector<uint32>    top, bottom, left, right; ///< Tile labels along the edges
+    std::vector<BlobStats> stats;                    ///< Of each tile label, in image coordinates
+  };
+
+  template <class SourceT> class LabelTask;
+
+  /// Labels the valid pixels of a tile 1, 2, ... in raster order of
+  /// their first pixel, and returns the number of labels.
+  static uint32 label_tile( ImageView<uint8> const& valid, ImageView<uint32>& labels );
+  static void   process_tile( ImageView<uint8> const& valid, BBox2i const& bbox, TileResult& result );
+
+  template <class SourceT>
+  static void valid_pixels( ImageViewBase<SourceT> const& src, BBox2i const& bbox, ImageView<uint8>& valid );
+
+  BBox2i tile_bbox( int32 index ) const;
+  void   merge( std::vector<TileResult> const& results );
+
+  Vector2i              m_size;
+  int32                 m_tile_size, m_tile_cols, m_tile_rows;
+  std::vector<uint32>   m_offsets; ///< Of each tile's labels in m_final
+  std::vector<uint32>   m_final;   ///< Blob label of each tile label
+  std::vector<BlobStats> m_stats;
+};
+
+template <class SourceT>
+class TiledBlobIndex::LabelTask : public Task {
+  ImageViewBase<SourceT> const& m_src;
+  BBox2i      m_bbox;
+  TileResult& m_result;
+public:
+  LabelTask( ImageViewBase<SourceT> const& src, BBox2i const& bbox, TileResult& result )
+    : m_src(src), m_bbox(bbox), m_result(result) {}
+
+  virtual void operator()() {
+    ImageView<uint8> valid;
+    valid_pixels( m_src, m_bbox, valid );
+    process_tile( valid, m_bbox, m_result );
+  }
+};
+
+template <class SourceT>
+void TiledBlobIndex::valid_pixels( ImageViewBase<SourceT> const& src, BBox2i const& bbox, ImageView<uint8>& valid ) {
+  ImageView<typename SourceT::pixel_type> tile = crop( src.impl(), bbox );
+  valid.set_size( tile.cols(), tile.rows() );
+  for ( int32 j = 0; j < tile.rows(); j++ )
+    for ( int32 i = 0; i < tile.cols(); i++ )
+      valid(i,j) = is_valid( tile(i,j) ) ? 1 : 0;
+}
+
+template <class SourceT>
+TiledBlobIndex::TiledBlobIndex( ImageViewBase<SourceT> const& src, int32 tile_size, int32 num_threads )
+  : m_size( src.impl().cols(), src.impl().rows() ), m_tile_size( tile_size ) {
+  VW_ASSERT( tile_size > 0, ArgumentErr() << "TiledBlobIndex: tile size must be positive." );
+  if ( src.impl().planes() > 1 )
+    vw_throw( NoImplErr() << "TiledBlobIndex only works with 2D images." );
+  m_tile_cols = ( m_size.x() + tile_size - 1 ) / tile_size;
+  m_tile_rows = ( m_size.y() + tile_size - 1 ) / tile_size;
+
+  std::vector<TileResult> results( m_tile_cols * m_tile_rows );
+  {
+    FifoWorkQueue queue( num_threads );
+    for ( size_t t = 0; t < results.size(); t++ )
+      queue.add_task( boost::shared_ptr<Task>( new LabelTask<SourceT>( src, tile_bbox(t), results[t] ) ) );
+    queue.join_all();
+  }
+  merge( results );
+}
+
+template <class SourceT>
+void TiledBlobIndex::labels( ImageViewBase<SourceT> const& src, BBox2i const& bbox, ImageView<uint32>& dst ) const {
+  VW_ASSERT( src.impl().cols() == m_size.x() && src.impl().rows() == m_size.y(),
+             ArgumentErr() << "TiledBlobIndex: not the indexed image." );
+  dst.set_size( bbox.width(), bbox.height() );
+  fill( dst, 0 );
+  if ( bbox.empty() )
+    return;
+  int32 col_end = std::min( ( bbox.max().x() + m_tile_size - 1 ) / m_tile_size, m_tile_cols );
+  int32 row_end = std::min( ( bbox.max().y() + m_tile_size - 1 ) / m_tile_size, m_tile_rows );
+  for ( int32 row = std::max( bbox.min().y() / m_tile_size, 0 ); row < row_end; row++ )
+    for ( int32 col = std::max( bbox.min().x() / m_tile_size, 0 ); col < col_end; col++ ) {
+      int32 t = row * m_tile_cols + col;
+      BBox2i tile = tile_bbox( t );
+      ImageView<uint8>  valid;
+      ImageView<uint32> tile_labels;
+      valid_pixels( src, tile, valid );
+      label_tile( valid, tile_labels );
+
+      BBox2i overlap = tile;
+      overlap.crop( bbox );
+      for ( int32 y = overlap.min().y(); y < overlap.max().y(); y++ )
+        for ( int32 x = overlap.min().x(); x < overlap.max().x(); x++ ) {
+          uint32 local = tile_labels( x - tile.min().x(), y - tile.min().y() );
+          if ( local )
+            dst( x - bbox.min().x(), y - bbox.min().y() ) = m_final[ m_offsets[t] + local - 1 ];
+        }
+    }
+}
+
+
 /// From a masked image, generate an image where each pixel has a value
 /// equal to the size of the blob that contains it (up to a size limit).
 template <class ImageT>
@@ -29,6 +29,7 @@
 #define __VW_IMAGE_BLOCKRASTERIZE_H__
 
 #include <vw/Core/Cache.h>
+#include <vw/Core/Trace.h>
 #include <vw/Image/ImageViewBase.h>
 #include <vw/Image/PixelAccessors.h>
 #include <vw/Image/Manipulation.h>
@@ -118,6 +119,9 @@ namespace vw {
 #if VW_DEBUG_LEVEL > 1
         VW_OUT(VerboseDebugMessage, "image") << "BlockRasterizeView::RasterizeFunctor( " << bbox << " )" << std::endl;
 #endif
+        ScopedTrace trace( "tile", "rasterize" );
+        trace.arg( "x", bbox.min().x() ).arg( "y", bbox.min().y() )
+             .arg( "cols", bbox.width() ).arg( "rows", bbox.height() );
         if( m_view.m_cache_ptr ) {
           int32 ix=bbox.min().x()/m_view.m_block_size.x(), // Compute the block
                 iy=bbox.min().y()/m_view.m_block_size.y();
@@ -15,7 +15,12 @@
 //  limitations under the License.
 // __END_LICENSE__
 
+#ifndef __VW_IMAGE_CENSUS_TRANSFORM_H__
+#define __VW_IMAGE_CENSUS_TRANSFORM_H__
+
 #include <vw/Image/ImageView.h>
+#include <vw/Image/EdgeExtension.h>
+#include <vw/Image/Manipulation.h>
 
 // TODO: Use SSE to accelerate this operation
 //#if defined(VW_ENABLE_SSE) && (VW_ENABLE_SSE==1)
@@ -41,11 +46,14 @@ namespace vw {
 ///   by Han Hu,Chongtai Chen, Bo Wu, Xiaoxia Yang, Qing Zhu, Yulin Ding
 // TODO: Move them somewhere, optimize the speed.
 inline uint8  get_census_value_3x3        (ImageView<uint8> const& image, int col, int row);
-inline uint32 get_census_value_5x5        (ImageView<uint8> const& image, int col, int row);
+template <class PixelT>
+inline uint32 get_census_value_5x5        (ImageView<PixelT> const& image, int col, int row);
 inline uint64 get_census_value_7x7        (ImageView<uint8> const& image, int col, int row);
 inline uint32 get_census_value_9x9        (ImageView<uint8> const& image, int col, int row);
 inline uint16 get_census_value_ternary_3x3(ImageView<uint8> const& image, int col, int row, int diff_threshold=2);
-inline uint64 get_census_value_ternary_5x5(ImageView<uint8> const& image, int col, int row, int diff_threshold=2);
+template <class PixelT>
+inline uint64 get_census_value_ternary_5x5(ImageView<PixelT> const& image, int col, int row,
+                                           typename AccumulatorType<PixelT>::type diff_threshold=2);
 inline uint64 get_census_value_ternary_7x7(ImageView<uint8> const& image, int col, int row, int diff_threshold=2);
 inline uint64 get_census_value_ternary_9x9(ImageView<uint8> const& image, int col, int row, int diff_threshold=2);
 
@@ -57,8 +65,15 @@ inline size_t hamming_distance(uint16 a, uint16 b);
 inline size_t hamming_distance(uint32 a, uint32 b);
 inline size_t hamming_distance(uint64 a, uint64 b);
 
-// If we need a function to compute the costs of an entire image, this is a good
-//  location for it!
+/// Census descriptors of every pixel in an image, using the 5x5 transforms
+/// above.  The image edges are extended with their constant value.  The
+/// pixels are compared as they are, so the ternary threshold is in the
+/// image's own units.
+template <class PixelT>
+inline void census_transform_5x5        (ImageView<PixelT> const& image, ImageView<uint32>& output);
+template <class PixelT>
+inline void ternary_census_transform_5x5(ImageView<PixelT> const& image, ImageView<uint64>& output,
+                                         typename AccumulatorType<PixelT>::type diff_threshold=2);
 
 
 //============================================================================
@@ -81,11 +96,12 @@ uint8 get_census_value_3x3(ImageView<uint8> const& image, int col, int row) {
   if (image(col+1, row+1) > center) output +=   1;
   return output;
 }
-uint32 get_census_value_5x5(ImageView<uint8> const& image, int col, int row) {
+template <class PixelT>
+uint32 get_census_value_5x5(ImageView<PixelT> const& image, int col, int row) {
   // This will be a 24 bit sequence.
   uint32 output = 0;
   uint32 addend = 1;
-  uint8 center = image(col, row);
+  PixelT center = image(col, row);
   for (int r=row+2; r>=row-2; --r) {
     for (int c=col+2; c>=col-2; --c) {
       if ((r == row) && (c==col)) // Skip the central pixel
@@ -197,19 +213,21 @@ uint16 get_census_value_ternary_3x3(ImageView<uint8> const& image, int col, int
   return output;
 }
 
-uint64 get_census_value_ternary_5x5(ImageView<uint8> const& image, int col, int row,
-                                    int diff_threshold) {
+template <class PixelT>
+uint64 get_census_value_ternary_5x5(ImageView<PixelT> const& image, int col, int row,
+                                    typename AccumulatorType<PixelT>::type diff_threshold) {
+  typedef typename AccumulatorType<PixelT>::type accum_type;
   // This will be a 48 bit sequence.
   uint64 output = 0;
   uint64 addend = 1;
-  const int center = image(col, row);
-  const int low_thresh  = center - diff_threshold;
-  const int high_thresh = center + diff_threshold;
+  const accum_type center = image(col, row);
+  const accum_type low_thresh  = center - diff_threshold;
+  const accum_type high_thresh = center + diff_threshold;
   for (int r=row+2; r>=row-2; --r) {
     for (int c=col+2; c>=col-2; --c) {
       if ((r == row) && (c==col)) // Skip the central pixel
         continue;
-      int val = image(c,r);
+      accum_type val = image(c,r);
       if (val >= low_thresh) {
         output += addend;
         if (val > high_thresh) // Greater, += 11
@@ -343,6 +361,28 @@ uint64 get_census_value_ternary_9x9(ImageView<uint8> const& image, int col, int
 }
 
 
+template <class PixelT>
+void census_transform_5x5(ImageView<PixelT> const& image, ImageView<uint32>& output) {
+  ImageView<PixelT> padded = crop(edge_extend(image, ConstantEdgeExtension()),
+                                  -2, -2, image.cols()+4, image.rows()+4);
+  output.set_size(image.cols(), image.rows());
+  for (int r=0; r<image.rows(); ++r)
+    for (int c=0; c<image.cols(); ++c)
+      output(c,r) = get_census_value_5x5(padded, c+2, r+2);
+}
+
+template <class PixelT>
+void ternary_census_transform_5x5(ImageView<PixelT> const& image, ImageView<uint64>& output,
+                                  typename AccumulatorType<PixelT>::type diff_threshold) {
+  ImageView<PixelT> padded = crop(edge_extend(image, ConstantEdgeExtension()),
+                                  -2, -2, image.cols()+4, image.rows()+4);
+  output.set_size(image.cols(), image.rows());
+  for (int r=0; r<image.rows(); ++r)
+    for (int c=0; c<image.cols(); ++c)
+      output(c,r) = get_census_value_ternary_5x5(padded, c+2, r+2, diff_threshold);
+}
+
+
 // TODO: Consolidate with code in Matcher.h!
 
 
@@ -372,20 +412,35 @@ size_t hamming_distance(uint16 a, uint16 b) {
   return static_cast<size_t>(dist); // Return the number of differing bits
 }
 
+// Without the popcnt instruction __builtin_popcount is a library call,
+//  so count the bits in parallel instead.  This form also lets the compiler
+//  vectorize loops over many descriptors.
+#if defined(__POPCNT__)
 size_t hamming_distance(uint32 a, uint32 b) {
-  uint32 dist = 0;
-  uint32 val = a ^ b; // XOR
+  return __builtin_popcount(a ^ b); // Use GCC compiler function to count the set bits
+}
 
-  return __builtin_popcount(val); // Use GCC compiler function to count the set bits
+size_t hamming_distance(uint64 a, uint64 b) {
+  return __builtin_popcountll(a ^ b);
+}
+#else
+size_t hamming_distance(uint32 a, uint32 b) {
+  uint32 val = a ^ b; // XOR
+  val = val - ((val >> 1) & 0x55555555u);
+  val = (val & 0x33333333u) + ((val >> 2) & 0x33333333u);
+  val = (val + (val >> 4)) & 0x0F0F0F0Fu;
+  return static_cast<size_t>((val * 0x01010101u) >> 24);
 }
 
 size_t hamming_distance(uint64 a, uint64 b) {
-  uint64 dist = 0;
   uint64 val = a ^ b; // XOR
-
-  return __builtin_popcountl(val); // Use GCC compiler function to count the set bits
+  val = val - ((val >> 1) & 0x5555555555555555ull);
+  val = (val & 0x3333333333333333ull) + ((val >> 2) & 0x3333333333333333ull);
+  val = (val + (val >> 4)) & 0x0F0F0F0F0F0F0F0Full;
+  return static_cast<size_t>((val * 0x0101010101010101ull) >> 56);
 }
-
+#endif
 
 } // end namespace vw
 
+#endif // __VW_IMAGE_CENSUS_TRANSFORM_H__
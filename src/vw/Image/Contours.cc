@@ -0,0 +1,342 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <vw/Image/Contours.h>
+#include <vw/Core/Exception.h>
+#include <vw/Core/Log.h>
+#include <vw/Core/ThreadPool.h>
+#include <vw/Image/ImageView.h>
+#include <vw/Image/Manipulation.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <boost/functional/hash.hpp>
+
+namespace vw {
+
+  std::size_t hash_value( ContourEdgeKey const& k ) {
+    std::size_t seed = 0;
+    boost::hash_combine( seed, k.level );
+    boost::hash_combine( seed, k.x );
+    boost::hash_combine( seed, k.y );
+    boost::hash_combine( seed, k.vertical );
+    return seed;
+  }
+
+  void ContourFragment::reverse() {
+    points.reverse();
+    std::swap( front, back );
+  }
+
+  // ---------------------------------------------------
+  // ContourStitcher
+  // ---------------------------------------------------
+
+  ContourStitcher::iterator ContourStitcher::find( ContourEdgeKey const& key ) {
+    EndMap::iterator end = m_ends.find( key );
+    return end == m_ends.end() ? m_fragments.end() : end->second;
+  }
+
+  void ContourStitcher::erase( iterator f ) {
+    if ( !f->closed() ) {
+      m_ends.erase( f->front );
+      m_ends.erase( f->back );
+    }
+    m_fragments.erase( f );
+  }
+
+  ContourStitcher::iterator ContourStitcher::add( ContourFragment const& fragment ) {
+    iterator f = m_fragments.insert( m_fragments.end(), fragment );
+    extend_back( f );
+    if ( !f->closed() ) {
+      f->reverse();
+      extend_back( f );
+    }
+    if ( !f->closed() ) {
+      m_ends[f->front] = f;
+      m_ends[f->back ] = f;
+    }
+    return f;
+  }
+
+  void ContourStitcher::extend_back( iterator f ) {
+    while ( !f->closed() ) {
+      EndMap::iterator end = m_ends.find( f->back );
+      if ( end == m_ends.end() )
+        break;
+      iterator other = end->second;
+      m_ends.erase( other->front );
+      m_ends.erase( other->back );
+      if ( other->back == f->back )
+        other->reverse();
+      // Both fragments computed the shared crossing
+      other->points.pop_front();
+      f->points.splice( f->points.end(), other->points );
+      f->back = other->back;
+      m_fragments.erase( other );
+    }
+  }
+
+  // ---------------------------------------------------
+  // tiled_contours
+  // ---------------------------------------------------
+
+  namespace {
+
+    class TiledContourer {
+    public:
+      TiledContourer( ImageViewRef<float> const& dem, ContourSink const& sink,
+                      int interval, float nodata_value, int32 tile_size )
+        : m_dem(dem), m_sink(sink), m_interval(interval), m_nodata_value(nodata_value),
+          m_tile_size(tile_size),
+          m_cell_cols( std::max( dem.cols()-1, 0 ) ), m_cell_rows( std::max( dem.rows()-1, 0 ) ),
+          m_tile_cols( (m_cell_cols + tile_size - 1) / tile_size ),
+          m_tile_rows( (m_cell_rows + tile_size - 1) / tile_size ),
+          m_done( m_tile_cols * m_tile_rows, false ),
+          m_waiting( m_tile_cols * m_tile_rows ) {}
+
+      int num_tiles() const { return m_tile_cols * m_tile_rows; }
+
+      // Run marching squares on one tile of cells, then stitch its
+      // fragments to the others.
+      void contour_tile( int tile ) {
+        BBox2i cells( Vector2i( tile % m_tile_cols, tile / m_tile_cols ) * m_tile_size,
+                      Vector2i( tile % m_tile_cols + 1, tile / m_tile_cols + 1 ) * m_tile_size );
+        cells.crop( BBox2i( 0, 0, m_cell_cols, m_cell_rows ) );
+        BBox2i pixels( cells.min(), cells.max() + Vector2i(1,1) );
+        ImageView<float> dem = crop( m_dem, pixels );
+
+        ContourStitcher local;
+        for ( int32 y = cells.min().y(); y < cells.max().y(); y++ )
+          for ( int32 x = cells.min().x(); x < cells.max().x(); x++ )
+            contour_cell( dem, x, y, pixels.min(), local );
+
+        // Lines are handed to the sink after the lock is released, so
+        // a slow sink doesn't hold up the other tiles.
+        std::vector<ContourFragment> lines;
+        stitch( tile, local, lines );
+        for ( size_t i = 0; i < lines.size(); i++ )
+          m_sink( lines[i].level, lines[i].points );
+      }
+
+      // Pass on anything left over. Every tile is done by now, so there
+      // should be nothing, but nothing is ever dropped either.
+      void flush() {
+        ContourStitcher::FragmentList& fragments = m_stitcher.fragments();
+        while ( !fragments.empty() ) {
+          m_sink( fragments.front().level, fragments.front().points );
+          m_stitcher.erase( fragments.begin() );
+        }
+      }
+
+    private:
+      // Join the fragments of a tile to the rest and move every line
+      // that can no longer grow into 'lines'.
+      void stitch( int tile, ContourStitcher& local, std::vector<ContourFragment>& lines ) {
+        // Everything from this tile is joined before it is marked done,
+        // so no end it could still meet looks finished in the meantime.
+        Mutex::Lock lock( m_mutex );
+        std::vector<ContourEdgeKey> ends;
+        ends.swap( m_waiting[tile] );
+        ContourStitcher::FragmentList& fragments = local.fragments();
+        for ( ContourStitcher::iterator f = fragments.begin(); f != fragments.end(); ++f ) {
+          if ( f->closed() ) {
+            take( *f, lines );
+            continue;
+          }
+          ContourStitcher::iterator joined = m_stitcher.add( *f );
+          if ( joined->closed() ) {
+            take( *joined, lines );
+            m_stitcher.erase( joined );
+            continue;
+          }
+          ends.push_back( joined->front );
+          ends.push_back( joined->back );
+        }
+        m_done[tile] = true;
+
+        // The rest waits on the tiles still to come
+        for ( size_t i = 0; i < ends.size(); i++ ) {
+          ContourStitcher::iterator f = m_stitcher.find( ends[i] );
+          if ( f == m_stitcher.fragments().end() )
+            continue;
+          if ( finished( f->front ) && finished( f->back ) ) {
+            take( *f, lines );
+            m_stitcher.erase( f );
+          } else {
+            wait( f->front );
+            wait( f->back );
+          }
+        }
+      }
+
+      static void take( ContourFragment& f, std::vector<ContourFragment>& lines ) {
+        lines.push_back( ContourFragment() );
+        lines.back().level = f.level;
+        lines.back().points.swap( f.points );
+      }
+
+      // The tile holding each cell on either side of an edge, or -1
+      // where that side is off the grid.
+      void edge_tiles( ContourEdgeKey const& key, int tiles[2] ) const {
+        int32 x0 = key.vertical ? key.x - 1 : key.x;
+        int32 y0 = key.vertical ? key.y : key.y - 1;
+        tiles[0] = cell_tile( x0, y0 );
+        tiles[1] = cell_tile( key.x, key.y );
+      }
+
+      int cell_tile( int32 x, int32 y ) const {
+        if ( x < 0 || y < 0 || x >= m_cell_cols || y >= m_cell_rows )
+          return -1;
+        return (y / m_tile_size) * m_tile_cols + x / m_tile_size;
+      }
+
+      // No tile still to come can continue a contour through this edge
+      bool finished( ContourEdgeKey const& key ) const {
+        int tiles[2];
+        edge_tiles( key, tiles );
+        for ( int i = 0; i < 2; i++ )
+          if ( tiles[i] >= 0 && !m_done[tiles[i]] )
+            return false;
+        return true;
+      }
+
+      void wait( ContourEdgeKey const& key ) {
+        int tiles[2];
+        edge_tiles( key, tiles );
+        for ( int i = 0; i < 2; i++ )
+          if ( tiles[i] >= 0 && !m_done[tiles[i]] )
+            m_waiting[tiles[i]].push_back( key );
+      }
+
+      void contour_cell( ImageView<float> const& dem, int32 x, int32 y,
+                         Vector2i const& origin, ContourStitcher& local ) const {
+        // Corners go round the cell: (x,y), (x+1,y), (x+1,y+1), (x,y+1).
+        // Edge e runs from corner edge_from[e] to corner edge_to[e].
+        static const int corner_dx[4] = {0, 1, 1, 0}, corner_dy[4] = {0, 0, 1, 1};
+        static const int edge_from[4] = {0, 1, 3, 0}, edge_to[4] = {1, 2, 2, 3};
+        // The two edges that cut off each corner
+        static const int corner_edges[4][2] = { {3,0}, {0,1}, {1,2}, {2,3} };
+
+        float z[4];
+        for ( int k = 0; k < 4; k++ ) {
+          z[k] = dem( x + corner_dx[k] - origin.x(), y + corner_dy[k] - origin.y() );
+          if ( z[k] == m_nodata_value || std::isnan( z[k] ) )
+            return;
+        }
+        float zmin = std::min( std::min( z[0], z[1] ), std::min( z[2], z[3] ) );
+        float zmax = std::max( std::max( z[0], z[1] ), std::max( z[2], z[3] ) );
+
+        int cmin = int( ceil ( zmin / m_interval ) ) * m_interval;
+        int cmax = int( floor( zmax / m_interval ) ) * m_interval;
+        for ( int c = cmin; c <= cmax; c += m_interval ) {
+          bool above[4];
+          int num_above = 0;
+          for ( int k = 0; k < 4; k++ ) {
+            above[k] = z[k] >= c;
+            num_above += above[k];
+          }
+          if ( num_above == 0 || num_above == 4 )
+            continue;
+
+          ContourEdgeKey keys[4] = { ContourEdgeKey( c, x,   y,   false ),
+                                     ContourEdgeKey( c, x+1, y,   true  ),
+                                     ContourEdgeKey( c, x,   y+1, false ),
+                                     ContourEdgeKey( c, x,   y,   true  ) };
+          Vector2 points[4];
+          int crossed[4], num_crossed = 0;
+          for ( int e = 0; e < 4; e++ ) {
+            int a = edge_from[e], b = edge_to[e];
+            if ( above[a] == above[b] )
+              continue;
+            double t = (c - z[a]) / (z[b] - z[a]);
+            points[e] = Vector2( x + corner_dx[a] + t * (corner_dx[b] - corner_dx[a]),
+                                 y + corner_dy[a] + t * (corner_dy[b] - corner_dy[a]) );
+            crossed[num_crossed++] = e;
+          }
+
+          if ( num_crossed == 2 ) {
+            add_cell_segment( local, c, keys, points, crossed[0], crossed[1] );
+          } else {
+            // A saddle: the cell centre decides which way the contour
+            // goes, cutting off the corners unlike it.
+            bool centre = (z[0] + z[1] + z[2] + z[3]) / 4 >= c;
+            for ( int k = 0; k < 4; k++ )
+              if ( above[k] != centre )
+                add_cell_segment( local, c, keys, points,
+                                  corner_edges[k][0], corner_edges[k][1] );
+          }
+        }
+      }
+
+      static void add_cell_segment( ContourStitcher& local, int level,
+                                    ContourEdgeKey const* keys, Vector2 const* points,
+                                    int e0, int e1 ) {
+        ContourFragment f;
+        f.level = level;
+        f.points.push_back( points[e0] );
+        f.points.push_back( points[e1] );
+        f.front = keys[e0];
+        f.back  = keys[e1];
+        local.add( f );
+      }
+
+      ImageViewRef<float> m_dem;
+      ContourSink         m_sink;
+      int                 m_interval;
+      float               m_nodata_value;
+      int32               m_tile_size;
+      int32               m_cell_cols, m_cell_rows;
+      int                 m_tile_cols, m_tile_rows;
+
+      Mutex                                    m_mutex;
+      std::vector<bool>                        m_done;
+      std::vector<std::vector<ContourEdgeKey> > m_waiting;
+      ContourStitcher                          m_stitcher;
+    };
+
+    class ContourTileTask : public Task {
+      TiledContourer& m_contourer;
+      int             m_tile;
+    public:
+      ContourTileTask( TiledContourer& contourer, int tile )
+        : m_contourer(contourer), m_tile(tile) {}
+      virtual void operator()() { m_contourer.contour_tile( m_tile ); }
+    };
+
+  } // anonymous namespace
+
+  void tiled_contours( ImageViewRef<float> const& dem, ContourSink const& sink,
+                       int interval, float nodata_value, int32 tile_size, int num_threads ) {
+    VW_ASSERT( interval > 0,    ArgumentErr() << "tiled_contours: contour interval must be positive." );
+    VW_ASSERT( tile_size > 0,   ArgumentErr() << "tiled_contours: tile size must be positive." );
+    VW_ASSERT( num_threads > 0, ArgumentErr() << "tiled_contours: need at least one thread." );
+
+    TiledContourer contourer( dem, sink, interval, nodata_value, tile_size );
+    vw_out(DebugMessage, "image") << "tiled_contours: " << contourer.num_tiles()
+                                  << " tiles on " << num_threads << " thread(s)\n";
+    FifoWorkQueue queue( num_threads );
+    for ( int tile = 0; tile < contourer.num_tiles(); tile++ )
+      queue.add_task( boost::shared_ptr<Task>( new ContourTileTask( contourer, tile ) ) );
+    queue.join_all();
+    contourer.flush();
+  }
+
+} // namespace vw
@@ -0,0 +1,119 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+/// \file Contours.h
+///
+/// Contour lines of an elevation image, found with marching squares one
+/// tile at a time so the image never has to be in memory all at once.
+///
+/// Each tile of cells yields short fragments.  The ends of a fragment
+/// lie on grid edges, and a contour crosses a grid edge at most once
+/// per level, so fragments are joined by looking up the edges their
+/// ends lie on: first within a tile, then across tiles as they finish.
+/// A polyline is passed on as soon as every tile it could continue
+/// into is done.
+///
+#ifndef __VW_IMAGE_CONTOURS_H__
+#define __VW_IMAGE_CONTOURS_H__
+
+#include <vw/Core/FundamentalTypes.h>
+#include <vw/Core/Settings.h>
+#include <vw/Image/ImageViewRef.h>
+#include <vw/Math/Vector.h>
+
+#include <cstddef>
+#include <list>
+
+#include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
+
+namespace vw {
+
+  /// The grid edge a contour of the given level crosses.  The edge
+  /// runs from pixel (x,y) to (x+1,y), or to (x,y+1) if vertical.
+  struct ContourEdgeKey {
+    int   level;
+    int32 x, y;
+    bool  vertical;
+
+    ContourEdgeKey() : level(0), x(0), y(0), vertical(false) {}
+    ContourEdgeKey( int level, int32 x, int32 y, bool vertical )
+      : level(level), x(x), y(y), vertical(vertical) {}
+
+    bool operator==( ContourEdgeKey const& k ) const {
+      return level == k.level && x == k.x && y == k.y && vertical == k.vertical;
+    }
+    bool operator!=( ContourEdgeKey const& k ) const { return !(*this == k); }
+  };
+
+  std::size_t hash_value( ContourEdgeKey const& k );
+
+  /// A piece of a contour, with the edges its two ends lie on.  It is
+  /// closed once both ends are on the same edge, in which case its
+  /// first point is repeated at the end.
+  struct ContourFragment {
+    int                level;
+    std::list<Vector2> points;
+    ContourEdgeKey     front, back;
+
+    bool closed() const { return front == back; }
+    void reverse();
+  };
+
+  /// Joins fragments that end on the same edge.  Open fragments are
+  /// indexed by both of their ends; closed ones are not indexed.
+  class ContourStitcher {
+  public:
+    typedef std::list<ContourFragment> FragmentList;
+    typedef FragmentList::iterator     iterator;
+
+    FragmentList& fragments() { return m_fragments; }
+
+    /// The open fragment with an end on 'key', or fragments().end().
+    iterator find( ContourEdgeKey const& key );
+
+    void erase( iterator f );
+
+    /// Add a fragment, joining it to any others it meets at either end,
+    /// and return the result.
+    iterator add( ContourFragment const& fragment );
+
+  private:
+    typedef boost::unordered_map<ContourEdgeKey, iterator> EndMap;
+
+    void extend_back( iterator f );
+
+    FragmentList m_fragments;
+    EndMap       m_ends;
+  };
+
+  /// Called with the level and points of each finished contour line.
+  /// It may be called from several threads at once.
+  typedef boost::function<void (int, std::list<Vector2> const&)> ContourSink;
+
+  /// Find the contours of 'dem' at every multiple of 'interval',
+  /// contouring tile_size x tile_size blocks of cells on num_threads
+  /// threads.  Cells with a corner equal to 'nodata_value' (or NaN) are
+  /// skipped.  Saddle cells are resolved with the average of their
+  /// corners.  Lines are passed to 'sink' in no particular order.
+  void tiled_contours( ImageViewRef<float> const& dem, ContourSink const& sink,
+                       int interval, float nodata_value, int32 tile_size = 256,
+                       int num_threads = vw_settings().default_num_threads() );
+
+} // namespace vw
+
+#endif // __VW_IMAGE_CONTOURS_H__
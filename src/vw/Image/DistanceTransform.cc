@@ -0,0 +1,61 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <vw/Image/DistanceTransform.h>
+
+#include <limits>
+
+namespace vw {
+
+  // The lower envelope of the parabolas rooted at (p, f[p]): v holds
+  // the roots of the parabolas in the envelope, and z the boundaries
+  // between them.
+  void squared_distance_transform_1d( const double* f, double* d, int32 n, int32* v, double* z ) {
+    if ( n <= 0 )
+      return;
+    const double infinity = std::numeric_limits<double>::infinity();
+    int32 k = 0;
+    v[0] = 0;
+    z[0] = -infinity;
+    z[1] =  infinity;
+    for ( int32 q = 1; q < n; q++ ) {
+      // z[0] is -infinity, so this stops at the first parabola
+      double s;
+      while ( true ) {
+        int32 p = v[k];
+        s = ( ( f[q] + double(q)*q ) - ( f[p] + double(p)*p ) ) / ( 2.0*q - 2.0*p );
+        if ( s > z[k] )
+          break;
+        k--;
+      }
+      k++;
+      v[k] = q;
+      z[k] = s;
+      z[k+1] = infinity;
+    }
+
+    k = 0;
+    for ( int32 q = 0; q < n; q++ ) {
+      while ( z[k+1] < q )
+        k++;
+      double offset = double(q) - v[k];
+      d[q] = offset*offset + f[v[k]];
+    }
+  }
+
+} // namespace vw
@@ -0,0 +1,285 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file DistanceTransform.h
+///
+/// An exact Euclidean distance transform that is computed one block at
+/// a time, so it can replace grassfire() for images that don't fit in
+/// memory and be written out with block_write_image().
+///
+/// Each block is transformed with the separable algorithm of
+/// Felzenszwalb & Huttenlocher, "Distance Transforms of Sampled
+/// Functions," 2012: a pass down each column for the distance to the
+/// nearest background pixel in that column, then a lower envelope of
+/// parabolas along each row.
+///
+/// The columns need to know about background pixels above and below
+/// the block.  When the distance is capped (as for feathering) it is
+/// enough to read the block grown by the cap.  Otherwise the
+/// constructor makes one pass over the image in tiles, in parallel,
+/// and keeps the nearest background row above and below each row of
+/// tiles in every column.  That is two integers per column per tile
+/// row.  A block then reads its own rows, widened by the farthest its
+/// pixels can be from a background pixel.
+///
+#ifndef __VW_IMAGE_DISTANCETRANSFORM_H__
+#define __VW_IMAGE_DISTANCETRANSFORM_H__
+
+#include <vw/Core/Exception.h>
+#include <vw/Core/Settings.h>
+#include <vw/Core/ThreadPool.h>
+#include <vw/Image/ImageView.h>
+#include <vw/Image/ImageViewBase.h>
+#include <vw/Image/Manipulation.h>
+#include <vw/Image/PixelAccessors.h>
+#include <vw/Image/PixelMask.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace vw {
+
+  /// The squared distance transform of a sampled function:
+  /// d[q] = min over p of (q-p)^2 + f[p], for n samples.  'v' and 'z'
+  /// are workspaces of n and n+1 elements.
+  void squared_distance_transform_1d( const double* f, double* d, int32 n, int32* v, double* z );
+
+  /// Pixels of masked images are foreground where they are valid,
+  /// others where they are not zero, as for grassfire().
+  template <class PixelT>
+  inline bool is_distance_foreground( PixelT const& pixel ) { return pixel != PixelT(); }
+  template <class ChildT>
+  inline bool is_distance_foreground( PixelMask<ChildT> const& pixel ) { return is_valid(pixel); }
+
+  /// The Euclidean distance from each foreground pixel to the nearest
+  /// background pixel, taking everything outside the image to be
+  /// background (so border pixels are 1 away, as in grassfire()).
+  /// Background pixels are 0.  If 'max_distance' is positive,
+  /// distances are capped there, and blocks are cheaper to compute.
+  template <class ImageT>
+  class EuclideanDistanceView : public ImageViewBase<EuclideanDistanceView<ImageT> > {
+  public:
+    typedef float32 pixel_type;
+    typedef float32 result_type;
+    typedef ProceduralPixelAccessor<EuclideanDistanceView> pixel_accessor;
+
+    EuclideanDistanceView( ImageT const& image, float32 max_distance = 0,
+                           int32 tile_size   = vw_settings().default_tile_size(),
+                           int32 num_threads = vw_settings().default_num_threads() );
+
+    inline int32 cols  () const { return m_image.cols(); }
+    inline int32 rows  () const { return m_image.rows(); }
+    inline int32 planes() const { return 1; }
+
+    inline pixel_accessor origin() const { return pixel_accessor( *this, 0, 0 ); }
+
+    inline result_type operator()( int32 i, int32 j, int32 /*p*/ = 0 ) const {
+      return prerasterize( BBox2i(i, j, 1, 1) )( i, j );
+    }
+
+    typedef CropView<ImageView<pixel_type> > prerasterize_type;
+    prerasterize_type prerasterize( BBox2i const& bbox ) const;
+
+    template <class DestT>
+    inline void rasterize( DestT const& dest, BBox2i const& bbox ) const {
+      vw::rasterize( prerasterize(bbox), dest, bbox );
+    }
+
+  private:
+    // Nearest background row above each row of tiles, and below it,
+    // per column (-1 and rows() for the image edges).
+    struct Bounds {
+      int32 tile_size;
+      std::vector<int32> above, below;
+    };
+
+    class BoundsTask;
+
+    ImageT  m_image;
+    float32 m_max_distance;
+    boost::shared_ptr<Bounds const> m_bounds;
+  };
+
+
+  /// Finds the first and last background rows of each column of a tile.
+  template <class ImageT>
+  class EuclideanDistanceView<ImageT>::BoundsTask : public Task {
+    ImageT const& m_image;
+    BBox2i        m_bbox;
+    int32*        m_first;
+    int32*        m_last;
+  public:
+    BoundsTask( ImageT const& image, BBox2i const& bbox, int32* first, int32* last )
+      : m_image(image), m_bbox(bbox), m_first(first), m_last(last) {}
+
+    virtual void operator()() {
+      ImageView<typename ImageT::pixel_type> tile = crop( m_image, m_bbox );
+      for ( int32 i = 0; i < tile.cols(); i++ )
+        for ( int32 j = 0; j < tile.rows(); j++ )
+          if ( !is_distance_foreground( tile(i,j) ) ) {
+            if ( m_first[i] < 0 )
+              m_first[i] = m_bbox.min().y() + j;
+            m_last[i] = m_bbox.min().y() + j;
+          }
+    }
+  };
+
+  template <class ImageT>
+  EuclideanDistanceView<ImageT>::EuclideanDistanceView( ImageT const& image, float32 max_distance,
+                                                        int32 tile_size, int32 num_threads )
+    : m_image(image), m_max_distance(max_distance) {
+    VW_ASSERT( max_distance >= 0, ArgumentErr() << "EuclideanDistanceView: max distance must not be negative." );
+    VW_ASSERT( tile_size > 0, ArgumentErr() << "EuclideanDistanceView: tile size must be positive." );
+    if ( max_distance > 0 )
+      return;
+
+    boost::shared_ptr<Bounds> bounds( new Bounds );
+    bounds->tile_size = tile_size;
+    int32 cols = image.cols(), rows = image.rows();
+    int32 tile_rows = ( rows + tile_size - 1 ) / tile_size;
+    std::vector<int32> first( size_t(tile_rows) * cols, -1 ), last( size_t(tile_rows) * cols, -1 );
+    {
+      FifoWorkQueue queue( num_threads );
+      for ( int32 r = 0; r < tile_rows; r++ )
+        for ( int32 x = 0; x < cols; x += tile_size ) {
+          BBox2i tile( x, r*tile_size, std::min( tile_size, cols - x ), std::min( tile_size, rows - r*tile_size ) );
+          size_t offset = size_t(r) * cols + x;
+          queue.add_task( boost::shared_ptr<Task>( new BoundsTask( m_image, tile, &first[offset], &last[offset] ) ) );
+        }
+      queue.join_all();
+    }
+
+    bounds->above.resize( first.size() );
+    bounds->below.resize( first.size() );
+    for ( int32 x = 0; x < cols; x++ ) {
+      int32 above = -1, below = rows;
+      for ( int32 r = 0; r < tile_rows; r++ ) {
+        bounds->above[size_t(r)*cols + x] = above;
+        if ( last[size_t(r)*cols + x] >= 0 )
+          above = last[size_t(r)*cols + x];
+      }
+      for ( int32 r = tile_rows - 1; r >= 0; r-- ) {
+        bounds->below[size_t(r)*cols + x] = below;
+        if ( first[size_t(r)*cols + x] >= 0 )
+          below = first[size_t(r)*cols + x];
+      }
+    }
+    m_bounds = bounds;
+  }
+
+  template <class ImageT>
+  typename EuclideanDistanceView<ImageT>::prerasterize_type
+  EuclideanDistanceView<ImageT>::prerasterize( BBox2i const& bbox ) const {
+    const int32 cols = m_image.cols(), rows = m_image.rows();
+    const int32 none = std::numeric_limits<int32>::max() / 4;
+    const double infinity = 1e20;
+    if ( bbox.empty() )
+      return prerasterize_type( ImageView<pixel_type>(), -bbox.min().x(), -bbox.min().y(), cols, rows );
+
+    // The region of the image that can affect the block, and the
+    // nearest background rows above and below it in each column.
+    BBox2i region = bbox;
+    std::vector<int32> above, below;
+    if ( m_max_distance > 0 ) {
+      region.expand( int32( std::ceil( m_max_distance ) ) );
+      region.crop( bounding_box( m_image ) );
+      above.resize( region.width(), region.min().y() == 0    ? -1   : -none );
+      below.resize( region.width(), region.max().y() == rows ? rows :  none );
+    } else {
+      int32 tile_size = m_bounds->tile_size;
+      int32 first_row = bbox.min().y() / tile_size, last_row = ( bbox.max().y() - 1 ) / tile_size;
+      region.min().y() = first_row * tile_size;
+      region.max().y() = std::min( ( last_row + 1 ) * tile_size, rows );
+
+      // No pixel of the block is farther from a background pixel than
+      // the nearest ones in its own column.
+      int32 reach = 0;
+      for ( int32 x = bbox.min().x(); x < bbox.max().x(); x++ ) {
+        int32 a = m_bounds->above[size_t(first_row)*cols + x], b = m_bounds->below[size_t(last_row)*cols + x];
+        int32 y = std::min( std::max( ( a + b ) / 2, bbox.min().y() ), bbox.max().y() - 1 );
+        reach = std::max( reach, std::min( y - a, b - y ) );
+      }
+      region.min().x() = std::max( bbox.min().x() - reach, 0 );
+      region.max().x() = std::min( bbox.max().x() + reach, cols );
+      above.resize( region.width() );
+      below.resize( region.width() );
+      for ( int32 x = region.min().x(); x < region.max().x(); x++ ) {
+        above[x - region.min().x()] = m_bounds->above[size_t(first_row)*cols + x];
+        below[x - region.min().x()] = m_bounds->below[size_t(last_row)*cols + x];
+      }
+    }
+
+    // Distance to the nearest background pixel in each column
+    ImageView<typename ImageT::pixel_type> source = crop( m_image, region );
+    ImageView<double> column( region.width(), bbox.height() );
+    std::vector<int32> nearest( region.height() );
+    for ( int32 i = 0; i < region.width(); i++ ) {
+      int32 zero = above[i];
+      for ( int32 j = 0; j < region.height(); j++ ) {
+        if ( !is_distance_foreground( source(i,j) ) )
+          zero = region.min().y() + j;
+        nearest[j] = region.min().y() + j - zero;
+      }
+      zero = below[i];
+      for ( int32 j = region.height() - 1; j >= 0; j-- ) {
+        if ( !is_distance_foreground( source(i,j) ) )
+          zero = region.min().y() + j;
+        int32 y = region.min().y() + j;
+        if ( y >= bbox.min().y() && y < bbox.max().y() ) {
+          int32 distance = std::min( nearest[j], zero - y );
+          column(i, y - bbox.min().y()) = distance >= none / 2 ? infinity : double(distance) * distance;
+        }
+      }
+    }
+
+    // Then along the rows, with the background just outside the image
+    // as extra samples where the region reaches its edge.
+    int32 left  = region.min().x() == 0    ? 1 : 0;
+    int32 right = region.max().x() == cols ? 1 : 0;
+    int32 n = region.width() + left + right;
+    std::vector<double> f( n, 0.0 ), d( n ), z( n + 1 );
+    std::vector<int32>  v( n );
+    ImageView<pixel_type> result( bbox.width(), bbox.height() );
+    for ( int32 j = 0; j < bbox.height(); j++ ) {
+      for ( int32 i = 0; i < region.width(); i++ )
+        f[i + left] = column(i, j);
+      squared_distance_transform_1d( &f[0], &d[0], n, &v[0], &z[0] );
+      for ( int32 i = 0; i < bbox.width(); i++ ) {
+        float32 distance = float32( std::sqrt( d[bbox.min().x() - region.min().x() + left + i] ) );
+        if ( m_max_distance > 0 && distance > m_max_distance )
+          distance = m_max_distance;
+        result(i, j) = distance;
+      }
+    }
+    return prerasterize_type( result, -bbox.min().x(), -bbox.min().y(), cols, rows );
+  }
+
+  /// Lazy exact Euclidean distance transform of an image; see
+  /// EuclideanDistanceView.
+  template <class ImageT>
+  EuclideanDistanceView<ImageT> euclidean_distance( ImageViewBase<ImageT> const& image, float32 max_distance = 0 ) {
+    return EuclideanDistanceView<ImageT>( image.impl(), max_distance );
+  }
+
+} // namespace vw
+
+#endif // __VW_IMAGE_DISTANCETRANSFORM_H__
@@ -24,8 +24,11 @@
 #ifndef __VW_IMAGE_IMAGEIO_H__
 #define __VW_IMAGE_IMAGEIO_H__
 
+#include <vw/Core/Metrics.h>
 #include <vw/Core/ProgressCallback.h>
+#include <vw/Core/Stopwatch.h>
 #include <vw/Core/ThreadPool.h>
+#include <vw/Core/Trace.h>
 #include <vw/Image/ImageResource.h>
 #include <vw/Image/ImageView.h>
 
@@ -35,6 +38,14 @@ namespace vw {
   // Image view reading and writing functions.
   // *******************************************************************
 
+  /// Every block read from or written to a resource goes through the
+  /// functions below, which trace it as an "io" event and count its
+  /// bytes in vw_metrics().
+  inline void trace_block( ScopedTrace& trace, BBox2i const& bbox ) {
+    trace.arg( "x", bbox.min().x() ).arg( "y", bbox.min().y() )
+         .arg( "cols", bbox.width() ).arg( "rows", bbox.height() );
+  }
+
   template <class PixelT>
   inline void read_image( ImageView<PixelT>& dst, SrcImageResource const& src, BBox2i const& bbox ) {
     int32 planes = 1;
@@ -45,7 +56,10 @@ namespace vw {
       planes = (std::max)( src.planes(), src.channels() );
     }
     dst.set_size( bbox.width(), bbox.height(), planes );
+    ScopedTrace trace( "io", "read" );
+    trace_block( trace, bbox );
     src.read( dst.buffer(), bbox );
+    record_resource_read( src, dst.buffer() );
   }
 
   template <class PixelT>
@@ -55,7 +69,10 @@ namespace vw {
 
   template <class PixelT>
   inline void read_image( ImageView<PixelT> const& dst, SrcImageResource const& src, BBox2i const& bbox ) {
+    ScopedTrace trace( "io", "read" );
+    trace_block( trace, bbox );
     src.read( dst.buffer(), bbox );
+    record_resource_read( src, dst.buffer() );
   }
 
   template <class PixelT>
@@ -77,7 +94,10 @@ namespace vw {
 
   template <class PixelT>
   inline void write_image( DstImageResource &dst, ImageView<PixelT> const& src, BBox2i const& bbox ) {
+    ScopedTrace trace( "io", "write" );
+    trace_block( trace, bbox );
     dst.write( src.buffer(), bbox );
+    record_resource_write( dst, src.buffer() );
   }
 
   template <class PixelT>
@@ -127,9 +147,20 @@ namespace vw {
     // decrements.
     void wait( int job_index ) {
       Mutex::Lock lock(m_mutex);
+      if ( job_index <= m_last_job_index + m_max )
+        return;
+      // Blocked behind the writer; count how often and for how long.
+      static MetricCounter& waits =
+        vw_metrics().counter( "vw_block_writer_waits_total", "Times a block waited for the writer to catch up" );
+      static MetricHistogram& wait_seconds =
+        vw_metrics().histogram( "vw_block_writer_wait_seconds", "Time blocks spent waiting for the writer",
+                                exponential_buckets( 0.001, 4, 10 ) );
+      uint64 start = Stopwatch::microtime();
       while ( job_index > m_last_job_index + m_max ) {
         m_block_condition.wait(lock);
       }
+      waits.increment();
+      wait_seconds.observe( ( Stopwatch::microtime() - start ) / 1e6 );
     }
 
     // Please call when ever a process finishes it's turn
@@ -171,7 +202,7 @@ namespace vw {
       virtual ~WriteBlockTask() {}
       virtual void operator() () {
         VW_OUT(DebugMessage, "image") << "Writing block " << m_idx << " at " << m_bbox << "\n";
-        m_resource.write( m_image_block.buffer(), m_bbox );
+        write_image( m_resource, m_image_block, m_bbox );
         m_write_finish_event.notify();
       }
     };
@@ -201,11 +232,19 @@ namespace vw {
       virtual ~RasterizeBlockTask() {}
       virtual void operator()() {
 
-        m_write_finish_event.wait(m_index);
+        {
+          ScopedTrace trace( "workqueue", "write_queue_wait" );
+          m_write_finish_event.wait(m_index);
+        }
 
         VW_OUT(DebugMessage, "image") << "Rasterizing block " << m_index << " at " << m_bbox << "\n";
         // Rasterize the block
-        ImageView<typename ViewT::pixel_type> image_block( crop(m_image, m_bbox) );
+        ImageView<typename ViewT::pixel_type> image_block;
+        {
+          ScopedTrace trace( "tile", "rasterize" );
+          trace_block( trace, m_bbox );
+          image_block = crop(m_image, m_bbox);
+        }
 
         // Report progress
         m_progress_callback.report_incremental_progress(1.0);
@@ -282,7 +321,7 @@ namespace vw {
     // Early out for easy case
     if (total_num_blocks == 1) {
       ImageView<typename ImageT::pixel_type> image_block = image.impl();
-      resource.write( image_block.buffer(), BBox2i(0,0,image_block.cols(),image_block.rows()) );
+      write_image( resource, image_block, BBox2i(0,0,image_block.cols(),image_block.rows()) );
     } else {
       // Set up the threaded block writer object, which will manage rasterizing
       // and writing images to disk one block (and one thread) at a time.
@@ -341,7 +380,7 @@ namespace vw {
     // Early out for easy case
     if (total_num_blocks == 1) {
       ImageView<typename ImageT::pixel_type> image_block = image.impl();
-      resource.write( image_block.buffer(), BBox2i(0,0,image_block.cols(),image_block.rows()) );
+      write_image( resource, image_block, BBox2i(0,0,image_block.cols(),image_block.rows()) );
     } else {
       for (int32 j = 0; j < rows; j+= block_size.y()) {
         for (int32 i = 0; i < cols; i+= block_size.x()) {
@@ -358,8 +397,7 @@ namespace vw {
 
           // Rasterize this image block
           ImageView<typename ImageT::pixel_type> image_block( crop(image.impl(), current_bbox) );
-          ImageBuffer buf = image_block.buffer();
-          resource.write( buf, current_bbox );
+          write_image( resource, image_block, current_bbox );
 
         }
       }
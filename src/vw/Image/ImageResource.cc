@@ -22,6 +22,8 @@
 ///
 #include <vw/Core/Exception.h>
 #include <vw/Core/FundamentalTypes.h>
+#include <vw/Core/Metrics.h>
+#include <vw/Core/Thread.h>
 #include <vw/Math/BBox.h>
 #include <vw/Image/ImageResource.h>
 
@@ -32,8 +34,11 @@
 #include <vector>
 #endif
 #include <map>
+#include <typeinfo>
 #include <cmath>
 
+#include <boost/atomic.hpp>
+#include <boost/core/demangle.hpp>
 #include <boost/integer_traits.hpp>
 #include <boost/smart_ptr/scoped_array.hpp>
 #include <boost/smart_ptr/shared_array.hpp>
@@ -675,3 +680,57 @@ boost::shared_array<const uint8> SrcImageResource::native_ptr() const {
 size_t SrcImageResource::native_size() const {
   return channel_size(channel_type()) * num_channels(pixel_format()) * cols() * rows() * planes();
 }
+
+namespace {
+  // One counter per resource type and direction.  These are found on
+  // every read and write, so they are kept in a list that only ever
+  // grows at the front and is walked without a lock; the lock is
+  // taken only to add a type seen for the first time.
+  struct ResourceMetric {
+    std::type_info const* type;
+    bool                  write;
+    vw::MetricCounter*    counter;
+    ResourceMetric*       next;
+  };
+
+  ResourceMetric* find_resource_metric( ResourceMetric* metric, std::type_info const& type, bool write ) {
+    for ( ; metric; metric = metric->next )
+      if ( metric->write == write && *metric->type == type )
+        return metric;
+    return 0;
+  }
+
+  vw::MetricCounter& resource_bytes_metric( std::type_info const& type, bool write ) {
+    static boost::atomic<ResourceMetric*> metrics( 0 );
+    if ( ResourceMetric* metric = find_resource_metric( metrics.load( boost::memory_order_acquire ), type, write ) )
+      return *metric->counter;
+
+    static vw::Mutex* mutex = new vw::Mutex();
+    vw::Mutex::Lock lock( *mutex );
+    ResourceMetric* head = metrics.load( boost::memory_order_relaxed );
+    if ( ResourceMetric* metric = find_resource_metric( head, type, write ) )
+      return *metric->counter;
+
+    std::string name = boost::core::demangle( type.name() );
+    if ( name.compare( 0, 4, "vw::" ) == 0 )
+      name.erase( 0, 4 );
+    std::string label = vw::metric_label( "resource", name );
+    ResourceMetric* metric = new ResourceMetric;
+    metric->type    = &type;
+    metric->write   = write;
+    metric->counter = write
+      ? &vw::vw_metrics().counter( "vw_resource_written_bytes_total", "Bytes written to image resources", label )
+      : &vw::vw_metrics().counter( "vw_resource_read_bytes_total", "Bytes read from image resources", label );
+    metric->next    = head;
+    metrics.store( metric, boost::memory_order_release );
+    return *metric->counter;
+  }
+}
+
+void vw::record_resource_read( SrcImageResource const& resource, ImageBuffer const& buf ) {
+  resource_bytes_metric( typeid(resource), false ).increment( buf.format.byte_size() );
+}
+
+void vw::record_resource_write( DstImageResource const& resource, ImageBuffer const& buf ) {
+  resource_bytes_metric( typeid(resource), true ).increment( buf.format.byte_size() );
+}
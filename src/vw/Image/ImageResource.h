@@ -253,6 +253,12 @@ namespace vw {
 
   };
 
+  /// Count the bytes in buf towards the vw_metrics() totals read from or
+  /// written to resources of this resource's type.  Called by read_image()
+  /// and write_image().
+  void record_resource_read ( SrcImageResource const& resource, ImageBuffer const& buf );
+  void record_resource_write( DstImageResource const& resource, ImageBuffer const& buf );
+
 } // namespace vw
 
 #endif // __VW_IMAGE_IMAGERESOURCE_H__
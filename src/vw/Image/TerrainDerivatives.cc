@@ -0,0 +1,81 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <vw/Image/TerrainDerivatives.h>
+
+#include <cmath>
+
+namespace vw {
+
+  // The loops below are kept free of branches and calls where they
+  // can be, so that they vectorize.
+  void terrain_gradient_row( TerrainStencil stencil, const float* above, const float* centre,
+                             const float* below, int32 n, float* dzdx, float* dzdy ) {
+    if ( stencil == HornStencil ) {
+      for ( int32 i = 0; i < n; i++ ) {
+        dzdx[i] = ( ( above[i+2] + 2*centre[i+2] + below[i+2] ) -
+                    ( above[i]   + 2*centre[i]   + below[i]   ) ) * 0.125f;
+        dzdy[i] = ( ( below[i] + 2*below[i+1] + below[i+2] ) -
+                    ( above[i] + 2*above[i+1] + above[i+2] ) ) * 0.125f;
+      }
+    } else {
+      for ( int32 i = 0; i < n; i++ ) {
+        dzdx[i] = ( centre[i+2] - centre[i] ) * 0.5f;
+        dzdy[i] = ( below[i+1]  - above[i+1] ) * 0.5f;
+      }
+    }
+  }
+
+  void terrain_derivative_row( TerrainDerivative derivative, const float* dzdx, const float* dzdy,
+                               int32 n, double x_spacing, double y_spacing,
+                               Vector3 const& light, float* result ) {
+    // Gradients east and north
+    const float east = float( 1.0 / x_spacing ), north = float( 1.0 / y_spacing );
+    switch ( derivative ) {
+    case TerrainSlope:
+      for ( int32 i = 0; i < n; i++ ) {
+        float gx = dzdx[i] * east, gy = dzdy[i] * north;
+        result[i] = std::atan( std::sqrt( gx*gx + gy*gy ) );
+      }
+      break;
+    case TerrainAspect:
+      for ( int32 i = 0; i < n; i++ ) {
+        float aspect = std::atan2( -dzdx[i] * east, -dzdy[i] * north );
+        result[i] = aspect < 0 ? aspect + float( 2*M_PI ) : aspect;
+      }
+      break;
+    case TerrainHillshade: {
+      // The normal of the plane through the gradient, as in compute_normals()
+      const float u = float( x_spacing ), v = float( y_spacing );
+      const float lx = float( light[0] ), ly = float( light[1] ), lz = float( light[2] );
+      for ( int32 i = 0; i < n; i++ ) {
+        float nx = -dzdx[i] * v, ny = -dzdy[i] * u, nz = u * v;
+        result[i] = ( nx*lx + ny*ly + nz*lz ) / std::sqrt( nx*nx + ny*ny + nz*nz );
+      }
+      break;
+    }
+    case TerrainCurvature:
+      for ( int32 i = 0; i < n; i++ )
+        result[i] = -( dzdx[i] * east * east + dzdy[i] * north * north );
+      break;
+    default:
+      vw_throw( ArgumentErr() << "terrain_derivative_row: unknown derivative." );
+    }
+  }
+
+} // namespace vw
@@ -0,0 +1,196 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file TerrainDerivatives.h
+///
+/// Slope, aspect, hillshade and curvature of a DEM, computed a block
+/// at a time from 3x3 stencils so they can be written out with
+/// block_write_image().
+///
+/// Ground spacing is given per row, since for a DEM in geographic
+/// coordinates the east-west size of a pixel shrinks with latitude.
+/// It is signed: x spacing is the eastward distance from a pixel to
+/// the next one in its row, y spacing the northward distance to the
+/// next one in its column (negative for a north-up image).  See
+/// cartography::dem_pixel_spacing() for finding it from a
+/// georeference.
+///
+/// Each block is copied into float rows once, and the stencils are
+/// then evaluated a whole row at a time in plain loops with no
+/// branches, which the compiler vectorizes.
+///
+#ifndef __VW_IMAGE_TERRAINDERIVATIVES_H__
+#define __VW_IMAGE_TERRAINDERIVATIVES_H__
+
+#include <vw/Core/Exception.h>
+#include <vw/Image/EdgeExtension.h>
+#include <vw/Image/ImageView.h>
+#include <vw/Image/ImageViewBase.h>
+#include <vw/Image/Manipulation.h>
+#include <vw/Image/PixelAccessors.h>
+#include <vw/Image/PixelMask.h>
+#include <vw/Math/Vector.h>
+
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+namespace vw {
+
+  enum TerrainDerivative {
+    TerrainSlope,      ///< Angle from horizontal, in radians
+    TerrainAspect,     ///< Downslope direction, in radians clockwise from north
+    TerrainHillshade,  ///< Dot product of the surface normal with a light direction
+    TerrainCurvature   ///< Zevenbergen-Thorne curvature, in 1/meters; positive is convex
+  };
+
+  /// How the first derivatives are estimated.  Horn's weighted 3x3
+  /// differences smooth noise; Zevenbergen and Thorne's use only the
+  /// four direct neighbours.  Curvature always uses the latter.
+  enum TerrainStencil { HornStencil, ZevenbergenThorneStencil };
+
+  /// Height differences per pixel, dz/dx along a row and dz/dy down a
+  /// column, at the n pixels of the middle row.  Each row holds n+2
+  /// heights, one more on either side.
+  void terrain_gradient_row( TerrainStencil stencil, const float* above, const float* centre,
+                             const float* below, int32 n, float* dzdx, float* dzdy );
+
+  /// The chosen derivative from the per-pixel height differences of a
+  /// row, with ground spacing x_spacing and y_spacing.  For curvature
+  /// dzdx and dzdy must hold the second differences, d2z/dx2 and
+  /// d2z/dy2.
+  void terrain_derivative_row( TerrainDerivative derivative, const float* dzdx, const float* dzdy,
+                               int32 n, double x_spacing, double y_spacing,
+                               Vector3 const& light, float* result );
+
+  /// A DEM's terrain derivative as a masked float32 image.  Pixels are
+  /// invalid wherever the 3x3 stencil touches an invalid height, and
+  /// aspect is invalid on flat ground.  Heights past the edge of the
+  /// DEM repeat the edge.  'x_spacing' and 'y_spacing' have one entry
+  /// per row.  'light' is only used for hillshade; it points towards
+  /// the light, in (x, y, up) image coordinates like compute_normals().
+  template <class ImageT>
+  class TerrainDerivativeView : public ImageViewBase<TerrainDerivativeView<ImageT> > {
+  public:
+    typedef PixelMask<float32> pixel_type;
+    typedef PixelMask<float32> result_type;
+    typedef ProceduralPixelAccessor<TerrainDerivativeView> pixel_accessor;
+
+    TerrainDerivativeView( ImageT const& image, TerrainDerivative derivative,
+                           std::vector<double> const& x_spacing, std::vector<double> const& y_spacing,
+                           TerrainStencil stencil = HornStencil, Vector3 const& light = Vector3(0,0,1) )
+      : m_image(image), m_derivative(derivative), m_stencil(stencil), m_light(light),
+        m_x_spacing( new std::vector<double>( x_spacing ) ),
+        m_y_spacing( new std::vector<double>( y_spacing ) ) {
+      VW_ASSERT( int32(x_spacing.size()) == image.rows() && int32(y_spacing.size()) == image.rows(),
+                 ArgumentErr() << "TerrainDerivativeView: need one pixel spacing per row." );
+      if ( derivative == TerrainHillshade )
+        m_light = normalize( light );
+    }
+
+    inline int32 cols  () const { return m_image.cols(); }
+    inline int32 rows  () const { return m_image.rows(); }
+    inline int32 planes() const { return 1; }
+
+    inline pixel_accessor origin() const { return pixel_accessor( *this, 0, 0 ); }
+
+    inline result_type operator()( int32 i, int32 j, int32 /*p*/ = 0 ) const {
+      return prerasterize( BBox2i(i, j, 1, 1) )( i, j );
+    }
+
+    typedef CropView<ImageView<pixel_type> > prerasterize_type;
+    prerasterize_type prerasterize( BBox2i const& bbox ) const;
+
+    template <class DestT>
+    inline void rasterize( DestT const& dest, BBox2i const& bbox ) const {
+      vw::rasterize( prerasterize(bbox), dest, bbox );
+    }
+
+  private:
+    ImageT            m_image;
+    TerrainDerivative m_derivative;
+    TerrainStencil    m_stencil;
+    Vector3           m_light;
+    // Shared, since views are copied freely
+    boost::shared_ptr<std::vector<double> const> m_x_spacing, m_y_spacing;
+  };
+
+  template <class ImageT>
+  typename TerrainDerivativeView<ImageT>::prerasterize_type
+  TerrainDerivativeView<ImageT>::prerasterize( BBox2i const& bbox ) const {
+    const int32 width = bbox.width();
+    ImageView<pixel_type> result( width, bbox.height() );
+    if ( bbox.empty() )
+      return prerasterize_type( result, -bbox.min().x(), -bbox.min().y(), cols(), rows() );
+
+    // Heights of the block and a one pixel border, as float rows, and
+    // a count of the invalid heights in each pixel's 3x3 stencil.
+    BBox2i region = bbox;
+    region.expand( 1 );
+    ImageView<typename ImageT::pixel_type> source = crop( edge_extend( m_image, ConstantEdgeExtension() ), region );
+    ImageView<float> heights( region.width(), region.height() );
+    ImageView<uint8> invalid( region.width(), region.height() );
+    for ( int32 j = 0; j < region.height(); j++ )
+      for ( int32 i = 0; i < region.width(); i++ ) {
+        bool valid = is_valid( source(i,j) );
+        heights(i,j) = valid ? float( remove_mask( source(i,j) ) ) : 0.0f;
+        invalid(i,j) = !valid;
+      }
+    std::vector<uint8> column_invalid( region.width() );
+
+    std::vector<float> dzdx( width ), dzdy( width ), values( width );
+    for ( int32 j = 0; j < bbox.height(); j++ ) {
+      const float *above = &heights(0, j), *centre = &heights(0, j+1), *below = &heights(0, j+2);
+      if ( m_derivative == TerrainCurvature ) {
+        // Second differences with the Zevenbergen-Thorne stencil
+        for ( int32 i = 0; i < width; i++ ) {
+          dzdx[i] = centre[i] - 2*centre[i+1] + centre[i+2];
+          dzdy[i] = above[i+1] - 2*centre[i+1] + below[i+1];
+        }
+      } else {
+        terrain_gradient_row( m_stencil, above, centre, below, width, &dzdx[0], &dzdy[0] );
+      }
+      int32 row = bbox.min().y() + j;
+      terrain_derivative_row( m_derivative, &dzdx[0], &dzdy[0], width,
+                              (*m_x_spacing)[row], (*m_y_spacing)[row], m_light, &values[0] );
+
+      for ( int32 i = 0; i < region.width(); i++ )
+        column_invalid[i] = invalid(i, j) | invalid(i, j+1) | invalid(i, j+2);
+      for ( int32 i = 0; i < width; i++ ) {
+        result(i, j) = values[i];
+        if ( column_invalid[i] | column_invalid[i+1] | column_invalid[i+2] )
+          result(i, j).invalidate();
+        else if ( m_derivative == TerrainAspect && dzdx[i] == 0 && dzdy[i] == 0 )
+          result(i, j).invalidate();
+      }
+    }
+    return prerasterize_type( result, -bbox.min().x(), -bbox.min().y(), cols(), rows() );
+  }
+
+  /// Lazy terrain derivative of a DEM; see TerrainDerivativeView.
+  template <class ImageT>
+  TerrainDerivativeView<ImageT>
+  terrain_derivative( ImageViewBase<ImageT> const& dem, TerrainDerivative derivative,
+                      std::vector<double> const& x_spacing, std::vector<double> const& y_spacing,
+                      TerrainStencil stencil = HornStencil, Vector3 const& light = Vector3(0,0,1) ) {
+    return TerrainDerivativeView<ImageT>( dem.impl(), derivative, x_spacing, y_spacing, stencil, light );
+  }
+
+} // namespace vw
+
+#endif // __VW_IMAGE_TERRAINDERIVATIVES_H__
@@ -396,6 +396,19 @@ namespace vw {
       return Vector2( ( m_H(0,0) * p(0) + m_H(0,1) * p(1) + m_H(0,2) ) / w,
                       ( m_H(1,0) * p(0) + m_H(1,1) * p(1) + m_H(1,2) ) / w);
     }
+    /// Reverse of a row of n pixels starting at 'start'. The
+    /// homogeneous coordinates are linear along the row, so only the
+    /// divide is done per pixel.
+    inline void reverse_row( Vector2 const& start, int32 n, std::vector<Vector2>& out ) const {
+      out.resize( n );
+      double x = m_H_inverse(0,0) * start(0) + m_H_inverse(0,1) * start(1) + m_H_inverse(0,2);
+      double y = m_H_inverse(1,0) * start(0) + m_H_inverse(1,1) * start(1) + m_H_inverse(1,2);
+      double w = m_H_inverse(2,0) * start(0) + m_H_inverse(2,1) * start(1) + m_H_inverse(2,2);
+      for ( int32 i = 0; i < n; i++ )
+        out[i] = Vector2( ( x + i * m_H_inverse(0,0) ) / ( w + i * m_H_inverse(2,0) ),
+                          ( y + i * m_H_inverse(1,0) ) / ( w + i * m_H_inverse(2,0) ) );
+    }
+
     friend std::ostream& operator<<(std::ostream&, const HomographyTransform&);
   };
   std::ostream& operator<<(std::ostream& os, const HomographyTransform& trans);
@@ -592,6 +605,90 @@ namespace vw {
   }
 
 
+  /// Applies transform.reverse() to every point. Transforms that can
+  /// do a batch faster than one point at a time (like
+  /// cartography::GeoTransform) overload this in their own namespace.
+  /// The call is qualified because reverse() is virtual, and while an
+  /// ApproximateTransform is being built it must reach the exact
+  /// transform rather than the half filled lookup table.
+  template <class TransformT>
+  inline void reverse_transform_points( TransformT const& transform,
+                                        std::vector<Vector2> const& in,
+                                        std::vector<Vector2>& out ) {
+    out.resize( in.size() );
+    for ( size_t i = 0; i < in.size(); i++ )
+      out[i] = transform.TransformT::reverse( in[i] );
+  }
+
+  /// Builds an n x n table of transform.reverse() at evenly spaced
+  /// points from bbox.min() to bbox.max(), doubling the density until
+  /// bilinear interpolation of the table is within 'tolerance' pixels
+  /// of the transform.  Returns false, with an empty table, if the
+  /// transform could not be approximated before the table got as
+  /// dense as the pixels of the bbox.
+  template <class TransformT>
+  bool approximate_reverse_table( TransformT const& transform, BBox2i const& bbox,
+                                  double tolerance, ImageView<Vector2>& table ) {
+    // Initialize with a simple 2x2 lookup table
+    int32 n=2;
+    std::vector<Vector2> points(4), reversed;
+    points[0] = bbox.min();
+    points[1] = Vector2(bbox.max().x(),bbox.min().y());
+    points[2] = Vector2(bbox.min().x(),bbox.max().y());
+    points[3] = bbox.max();
+    reverse_transform_points( transform, points, reversed );
+    table.set_size(2,2);
+    table(0,0) = reversed[0];
+    table(1,0) = reversed[1];
+    table(0,1) = reversed[2];
+    table(1,1) = reversed[3];
+
+    // Double the grid density until the worst (squared) approximation error
+    // is less than the allowed (squared) tolerance.
+    double max_sqr_err = 0;
+    double tol_sqr = tolerance * tolerance;
+    Vector2 origin = bbox.min(), diag = bbox.size();
+    do {
+      n = 2*n-1;
+      // Fall back for unapproximatably crazy transform functions.
+      if( n>=bbox.width()|| n>=bbox.height() ) {
+        table.reset();
+        return false;
+      }
+      ImageView<Vector2> prev = table;
+      table.set_size(n,n);
+
+      // Evaluate all the new grid points in one batch
+      points.clear();
+      points.reserve( n*n - prev.cols()*prev.rows() );
+      for( int y=0; y<n; ++y )
+        for( int x=0; x<n; ++x )
+          if( (y%2)!=0 || (x%2)!=0 )
+            points.push_back( origin+elem_prod(Vector2(x,y)/(n-1),diag) );
+      reverse_transform_points( transform, points, reversed );
+
+      max_sqr_err = 0;
+      size_t next = 0;
+      for( int y=0; y<n; ++y ) {
+        for( int x=0; x<n; ++x ) {
+          if( (y%2)==0 && (x%2==0) ) {
+            table(x,y) = prev(x/2,y/2);
+          }
+          else {
+            table(x,y) = reversed[next++];
+            Vector2 interp;
+            if( (y%2)==0 ) interp = (prev(x/2,y/2) + prev(x/2+1,y/2)) / 2.0;
+            else if( (x%2)==0 ) interp = (prev(x/2,y/2) + prev(x/2,y/2+1)) / 2.0;
+            else interp = (prev(x/2,y/2) + prev(x/2,y/2+1) + prev(x/2+1,y/2) + prev(x/2+1,y/2+1)) / 4.0;
+            double sqr_err = norm_2_sqr( table(x,y) - interp );
+            if( sqr_err > max_sqr_err ) max_sqr_err = sqr_err;
+          }
+        }
+      }
+    } while( max_sqr_err > tol_sqr );
+    return true;
+  }
+
   // ApproximateTransform image transform functor template.
   //
   // Mimics the behavior of a given transform functor, but attempts to
@@ -604,48 +701,9 @@ namespace vw {
     ImageView<Vector2> m_table;
   public:
     ApproximateTransform( TransformT const& transform, BBox2i const& bbox )
-      : TransformT( transform ), m_bbox( bbox ), m_table(2,2)
-    {
-      // Initialize with a simple 2x2 lookup table
-      int32 n=2;
-      m_table(0,0) = TransformT::reverse(bbox.min());
-      m_table(1,0) = TransformT::reverse(Vector2(bbox.max().x(),bbox.min().y()));
-      m_table(0,1) = TransformT::reverse(Vector2(bbox.min().x(),bbox.max().y()));
-      m_table(1,1) = TransformT::reverse(bbox.max());
-
-      // Double the grid density until the worst (squared) approximation error
-      // is less than the allowed (squared) tolerance.
-      double max_sqr_err = 0;
-      double tol_sqr = TransformT::tolerance() * TransformT::tolerance();
-      Vector2 origin = bbox.min(), diag = bbox.size();
-      do {
-        n = 2*n-1;
-        // Fall back for unapproximatably crazy transform functions.
-        if( n>=bbox.width()|| n>=bbox.height() ) {
-          m_table.reset();
-          return;
-        }
-        ImageView<Vector2> prev = m_table;
-        m_table.set_size(n,n);
-        max_sqr_err = 0;
-        for( int y=0; y<n; ++y ) {
-          for( int x=0; x<n; ++x ) {
-            if( (y%2)==0 && (x%2==0) ) {
-              m_table(x,y) = prev(x/2,y/2);
-            }
-            else {
-              Vector2 pos = Vector2(x,y)/(n-1);
-              m_table(x,y) = TransformT::reverse(origin+elem_prod(pos,diag));
-              Vector2 interp;
-              if( (y%2)==0 ) interp = (prev(x/2,y/2) + prev(x/2+1,y/2)) / 2.0;
-              else if( (x%2)==0 ) interp = (prev(x/2,y/2) + prev(x/2,y/2+1)) / 2.0;
-              else interp = (prev(x/2,y/2) + prev(x/2,y/2+1) + prev(x/2+1,y/2) + prev(x/2+1,y/2+1)) / 4.0;
-              double sqr_err = norm_2_sqr( m_table(x,y) - interp );
-              if( sqr_err > max_sqr_err ) max_sqr_err = sqr_err;
-            }
-          }
-        }
-      } while( max_sqr_err > tol_sqr );
+      : TransformT( transform ), m_bbox( bbox ) {
+      approximate_reverse_table( static_cast<TransformT const&>(*this), bbox,
+                                 TransformT::tolerance(), m_table );
     }
 
     inline Vector2 reverse( Vector2 const& p ) const {
@@ -683,6 +741,159 @@ namespace vw {
   };
 
 
+  // ------------------------
+  // Row-wise rasterization
+  // ------------------------
+
+  /// Fills 'out' with transform.reverse() of the n output pixels
+  /// start, start+(1,0), ... along a row.  TransformView rasterizes
+  /// one row of source coordinates at a time through this function.
+  /// Transforms with a closed form step along the row instead of
+  /// evaluating every pixel, and slow transforms (like
+  /// cartography::GeoTransform) can overload it to batch the row.
+  template <class TransformT>
+  inline void reverse_transform_row( TransformT const& transform, Vector2 const& start,
+                                     int32 n, std::vector<Vector2>& out ) {
+    out.resize( n );
+    for ( int32 i = 0; i < n; i++ )
+      out[i] = transform.reverse( start + Vector2(i,0) );
+  }
+
+  /// For transforms that are affine in the output coordinates the
+  /// reversed row is a line, so only two points are evaluated.
+  template <class TransformT>
+  inline void reverse_transform_row_affine( TransformT const& transform, Vector2 const& start,
+                                            int32 n, std::vector<Vector2>& out ) {
+    out.resize( n );
+    if ( n == 0 ) return;
+    Vector2 first = transform.reverse( start );
+    Vector2 step  = transform.reverse( start + Vector2(1,0) ) - first;
+    for ( int32 i = 0; i < n; i++ )
+      out[i] = first + double(i) * step;
+  }
+
+  inline void reverse_transform_row( AffineTransform const& transform, Vector2 const& start,
+                                     int32 n, std::vector<Vector2>& out ) {
+    reverse_transform_row_affine( transform, start, n, out );
+  }
+
+  inline void reverse_transform_row( RotateTransform const& transform, Vector2 const& start,
+                                     int32 n, std::vector<Vector2>& out ) {
+    reverse_transform_row_affine( transform, start, n, out );
+  }
+
+  inline void reverse_transform_row( ResampleTransform const& transform, Vector2 const& start,
+                                     int32 n, std::vector<Vector2>& out ) {
+    reverse_transform_row_affine( transform, start, n, out );
+  }
+
+  inline void reverse_transform_row( TranslateTransform const& transform, Vector2 const& start,
+                                     int32 n, std::vector<Vector2>& out ) {
+    reverse_transform_row_affine( transform, start, n, out );
+  }
+
+  inline void reverse_transform_row( HomographyTransform const& transform, Vector2 const& start,
+                                     int32 n, std::vector<Vector2>& out ) {
+    transform.reverse_row( start, n, out );
+  }
+
+
+  /// Evaluates a floating point indexable view at the source
+  /// coordinates produced by reverse_transform_row().
+  template <class ViewT>
+  class TransformRowSampler {
+    ViewT const& m_view;
+  public:
+    typedef typename ViewT::pixel_type result_type;
+    TransformRowSampler( ViewT const& view ) : m_view( view ) {}
+    inline result_type operator()( double x, double y, int32 p ) const { return m_view( x, y, p ); }
+  };
+
+  /// For the usual interpolated, edge extended source, coordinates
+  /// whose interpolation footprint lies inside the source interpolate
+  /// the rasterized tile directly and skip the per-tap edge checks.
+  template <class ChildT, class EdgeT, class InterpT>
+  class TransformRowInteriorSampler {
+    typedef InterpolationView<EdgeExtensionView<ChildT, EdgeT>, InterpT> view_type;
+    typedef typename InterpT::template Interpolator<ChildT>::type interp_type;
+    view_type   const& m_view;
+    ChildT      const& m_child;
+    interp_type        m_interp;
+    int32              m_xoffset, m_yoffset;
+    double             m_xmin, m_xmax, m_ymin, m_ymax;
+  public:
+    typedef typename view_type::pixel_type result_type;
+    TransformRowInteriorSampler( view_type const& view )
+      : m_view( view ), m_child( view.child().child() ), m_interp( InterpT::interpolator( m_child ) ),
+        m_xoffset( view.child().xoffset() ), m_yoffset( view.child().yoffset() ) {
+      // One pixel of slack on each side of the footprint covers the
+      // rounding in nearest pixel interpolation.
+      int32 b = InterpT::pixel_buffer;
+      m_xmin = b - m_xoffset;
+      m_ymin = b - m_yoffset;
+      m_xmax = m_child.cols() - b - 1 - m_xoffset;
+      m_ymax = m_child.rows() - b - 1 - m_yoffset;
+    }
+    inline result_type operator()( double x, double y, int32 p ) const {
+      if ( x >= m_xmin && x < m_xmax && y >= m_ymin && y < m_ymax )
+        return m_interp( m_child, x + m_xoffset, y + m_yoffset, p );
+      return m_view( x, y, p );
+    }
+  };
+
+  template <class ChildT, class EdgeT>
+  class TransformRowSampler<InterpolationView<EdgeExtensionView<ChildT, EdgeT>, BilinearInterpolation> >
+    : public TransformRowInteriorSampler<ChildT, EdgeT, BilinearInterpolation> {
+  public:
+    TransformRowSampler( InterpolationView<EdgeExtensionView<ChildT, EdgeT>, BilinearInterpolation> const& view )
+      : TransformRowInteriorSampler<ChildT, EdgeT, BilinearInterpolation>( view ) {}
+  };
+
+  template <class ChildT, class EdgeT>
+  class TransformRowSampler<InterpolationView<EdgeExtensionView<ChildT, EdgeT>, BicubicInterpolation> >
+    : public TransformRowInteriorSampler<ChildT, EdgeT, BicubicInterpolation> {
+  public:
+    TransformRowSampler( InterpolationView<EdgeExtensionView<ChildT, EdgeT>, BicubicInterpolation> const& view )
+      : TransformRowInteriorSampler<ChildT, EdgeT, BicubicInterpolation>( view ) {}
+  };
+
+  template <class ChildT, class EdgeT>
+  class TransformRowSampler<InterpolationView<EdgeExtensionView<ChildT, EdgeT>, NearestPixelInterpolation> >
+    : public TransformRowInteriorSampler<ChildT, EdgeT, NearestPixelInterpolation> {
+  public:
+    TransformRowSampler( InterpolationView<EdgeExtensionView<ChildT, EdgeT>, NearestPixelInterpolation> const& view )
+      : TransformRowInteriorSampler<ChildT, EdgeT, NearestPixelInterpolation>( view ) {}
+  };
+
+  /// Rasterizes the transform of an already prerasterized source one
+  /// output row at a time: the source coordinates of the row come
+  /// from reverse_transform_row() and are then sampled from 'src'.
+  template <class SrcT, class TransformT, class DestT>
+  void rasterize_transform_rows( SrcT const& src, TransformT const& transform,
+                                 DestT const& dest, BBox2i const& bbox ) {
+    typedef typename DestT::pixel_type     DestPixelT;
+    typedef typename DestT::pixel_accessor DestAccT;
+    VW_ASSERT( int(dest.cols())==bbox.width() && int(dest.rows())==bbox.height() && dest.planes()==src.planes(),
+               ArgumentErr() << "rasterize: Source and destination must have same dimensions." );
+    TransformRowSampler<SrcT> sampler( src );
+    std::vector<Vector2> coords;
+    DestAccT drow = dest.origin();
+    for( int32 row=0; row<bbox.height(); ++row ) {
+      reverse_transform_row( transform, Vector2(bbox.min().x(), bbox.min().y()+row), bbox.width(), coords );
+      DestAccT dplane = drow;
+      for( int32 plane=0; plane<src.planes(); ++plane ) {
+        DestAccT dcol = dplane;
+        for( int32 col=0; col<bbox.width(); ++col ) {
+          *dcol = DestPixelT( sampler( coords[col][0], coords[col][1], plane ) );
+          dcol.next_col();
+        }
+        dplane.next_plane();
+      }
+      drow.next_row();
+    }
+  }
+
+
   // TransformRef virtualized image transform functor adaptor
   class TransformRef : public TransformBase<TransformRef> {
     boost::shared_ptr<Transform> m_transform;
@@ -752,11 +963,10 @@ namespace vw {
     template <class DestT> inline void rasterize( DestT const& dest, BBox2i const& bbox ) const {
       if( m_mapper.tolerance() > 0.0 ) {
         ApproximateTransform<TransformT> approx_transform( m_mapper, bbox );
-        TransformView<ImageT, ApproximateTransform<TransformT> > approx_view( m_image, approx_transform, m_width, m_height );
-        vw::rasterize( approx_view.prerasterize(bbox), dest, bbox );
+        rasterize_transform_rows( m_image.prerasterize(approx_transform.reverse_bbox(bbox)), approx_transform, dest, bbox );
       }
       else {
-        vw::rasterize( prerasterize(bbox), dest, bbox );
+        rasterize_transform_rows( m_image.prerasterize(m_mapper.reverse_bbox(bbox)), m_mapper, dest, bbox );
       }
     }
     // \endcond
@@ -0,0 +1,238 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <vw/Image/TransformGrid.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace {
+  const char       GRID_MAGIC[8] = { 'V','W','T','G','R','I','D','\0' };
+  const vw::uint32 GRID_VERSION = 1;
+
+  template <class T>
+  void write_value( std::ostream& os, T const& value ) {
+    os.write( reinterpret_cast<const char*>(&value), sizeof(T) );
+  }
+
+  template <class T>
+  void read_value( std::istream& is, T& value ) {
+    is.read( reinterpret_cast<char*>(&value), sizeof(T) );
+  }
+}
+
+namespace vw {
+
+  void TransformGrid::init_cells( BBox2i const& bbox, double tolerance, int32 cell_size ) {
+    m_bbox      = bbox;
+    m_tolerance = tolerance;
+    m_cell_size = cell_size;
+    // The last cell of a row or column takes up the remainder, so no
+    // cell is too thin to be approximated.
+    m_cols = bbox.empty() ? 0 : std::max( bbox.width () / cell_size, 1 );
+    m_rows = bbox.empty() ? 0 : std::max( bbox.height() / cell_size, 1 );
+    m_cells.resize( size_t(m_cols) * m_rows );
+    m_values.clear();
+  }
+
+  BBox2i TransformGrid::cell_bbox( int32 col, int32 row ) const {
+    BBox2i cell( m_bbox.min().x() + col*m_cell_size, m_bbox.min().y() + row*m_cell_size,
+                 m_cell_size, m_cell_size );
+    if ( col == m_cols - 1 ) cell.max().x() = m_bbox.max().x();
+    if ( row == m_rows - 1 ) cell.max().y() = m_bbox.max().y();
+    return cell;
+  }
+
+  void TransformGrid::pack_tables( std::vector<ImageView<Vector2> > const& tables ) {
+    size_t total = 0;
+    for ( size_t i = 0; i < tables.size(); i++ )
+      total += 2 * size_t(tables[i].cols()) * tables[i].rows();
+    m_values.resize( total );
+
+    uint64 offset = 0;
+    for ( size_t i = 0; i < tables.size(); i++ ) {
+      ImageView<Vector2> const& table = tables[i];
+      Cell& cell = m_cells[i];
+      cell.offset = offset;
+      if ( !table.is_valid_image() ) {
+        cell.n    = 0;
+        cell.base = Vector2();
+        continue;
+      }
+      cell.n    = table.cols();
+      cell.base = table(0,0);
+      for ( int32 y = 0; y < table.rows(); y++ )
+        for ( int32 x = 0; x < table.cols(); x++ ) {
+          Vector2 delta = table(x,y) - cell.base;
+          m_values[offset++] = float(delta.x());
+          m_values[offset++] = float(delta.y());
+        }
+    }
+  }
+
+  size_t TransformGrid::num_approximated_cells() const {
+    size_t count = 0;
+    for ( size_t i = 0; i < m_cells.size(); i++ )
+      if ( m_cells[i].n > 0 )
+        count++;
+    return count;
+  }
+
+  bool TransformGrid::reverse( Vector2 const& p, Vector2& result ) const {
+    if ( m_cells.empty() ||
+         p.x() < m_bbox.min().x() || p.x() > m_bbox.max().x() ||
+         p.y() < m_bbox.min().y() || p.y() > m_bbox.max().y() )
+      return false;
+
+    // Points on the max edge belong to the last cell
+    int32 col = int32( (p.x() - m_bbox.min().x()) / m_cell_size );
+    int32 row = int32( (p.y() - m_bbox.min().y()) / m_cell_size );
+    if ( col >= m_cols ) col = m_cols - 1;
+    if ( row >= m_rows ) row = m_rows - 1;
+    Cell const& cell = m_cells[row*m_cols+col];
+    if ( cell.n == 0 )
+      return false;
+
+    // Same bilinear lookup as ApproximateTransform::reverse()
+    BBox2i bbox = cell_bbox( col, row );
+    int32 n = cell.n - 1;
+    double px = n * (p.x() - bbox.min().x()) / (bbox.max().x() - bbox.min().x());
+    double py = n * (p.y() - bbox.min().y()) / (bbox.max().y() - bbox.min().y());
+    int32 ix = math::impl::_floor(px);
+    if( ix < 0 ) ix = 0;
+    if( ix >= n ) ix = n-1;
+    int32 iy = math::impl::_floor(py);
+    if( iy < 0 ) iy = 0;
+    if( iy >= n ) iy = n-1;
+    double normx = px-ix, normy = py-iy;
+
+    const float* m00 = &m_values[cell.offset + 2*(iy*cell.n + ix)];
+    const float* m10 = m00 + 2;
+    const float* m01 = m00 + 2*cell.n;
+    const float* m11 = m01 + 2;
+
+    result = cell.base +
+      Vector2( (m00[0]*(1-normy)+m01[0]*normy)*(1-normx) +
+               (m10[0]*(1-normy)+m11[0]*normy)*normx,
+               (m00[1]*(1-normy)+m01[1]*normy)*(1-normx) +
+               (m10[1]*(1-normy)+m11[1]*normy)*normx );
+    return true;
+  }
+
+  bool TransformGrid::matches( BBox2i const& bbox, double tolerance, std::string const& key ) const {
+    return m_cell_size > 0 && m_bbox == bbox && m_tolerance <= tolerance && m_key == key;
+  }
+
+  void TransformGrid::write( std::string const& filename ) const {
+    std::ofstream os( filename.c_str(), std::ios::binary );
+    if ( !os )
+      vw_throw( IOErr() << "TransformGrid: could not open " << filename << " for writing." );
+    write( os );
+  }
+
+  void TransformGrid::write( std::ostream& os ) const {
+    os.write( GRID_MAGIC, sizeof(GRID_MAGIC) );
+    write_value( os, GRID_VERSION );
+    write_value( os, int32(m_bbox.min().x()) );
+    write_value( os, int32(m_bbox.min().y()) );
+    write_value( os, int32(m_bbox.width()) );
+    write_value( os, int32(m_bbox.height()) );
+    write_value( os, m_tolerance );
+    write_value( os, m_cell_size );
+    write_value( os, uint32(m_key.size()) );
+    os.write( m_key.data(), m_key.size() );
+    for ( size_t i = 0; i < m_cells.size(); i++ ) {
+      write_value( os, m_cells[i].n );
+      write_value( os, m_cells[i].base.x() );
+      write_value( os, m_cells[i].base.y() );
+    }
+    write_value( os, uint64(m_values.size()) );
+    if ( !m_values.empty() )
+      os.write( reinterpret_cast<const char*>(&m_values[0]), m_values.size()*sizeof(float) );
+    if ( !os )
+      vw_throw( IOErr() << "TransformGrid: failed to write the grid." );
+  }
+
+  void TransformGrid::read( std::string const& filename ) {
+    std::ifstream is( filename.c_str(), std::ios::binary );
+    if ( !is )
+      vw_throw( IOErr() << "TransformGrid: could not open " << filename << "." );
+    read( is );
+  }
+
+  void TransformGrid::read( std::istream& is ) {
+    char magic[8];
+    uint32 version = 0;
+    is.read( magic, sizeof(magic) );
+    read_value( is, version );
+    if ( !is || std::memcmp( magic, GRID_MAGIC, sizeof(magic) ) != 0 || version != GRID_VERSION )
+      vw_throw( IOErr() << "TransformGrid: not a transform grid." );
+
+    int32 x = 0, y = 0, width = 0, height = 0, cell_size = 0;
+    double tolerance = 0;
+    uint32 key_size = 0;
+    read_value( is, x );
+    read_value( is, y );
+    read_value( is, width );
+    read_value( is, height );
+    read_value( is, tolerance );
+    read_value( is, cell_size );
+    read_value( is, key_size );
+    if ( !is || cell_size < 2 || width < 0 || height < 0 || key_size > (1u << 20) )
+      vw_throw( IOErr() << "TransformGrid: bad header." );
+    std::string key( key_size, '\0' );
+    if ( key_size )
+      is.read( &key[0], key_size );
+
+    init_cells( BBox2i(x, y, width, height), tolerance, cell_size );
+    m_key = key;
+    uint64 expected = 0;
+    for ( size_t i = 0; i < m_cells.size(); i++ ) {
+      Cell& cell = m_cells[i];
+      read_value( is, cell.n );
+      read_value( is, cell.base.x() );
+      read_value( is, cell.base.y() );
+      // approximate_reverse_table() keeps tables smaller than the cell,
+      // and the last cell of a row or column can be almost twice as big
+      // as the others.
+      BBox2i bbox = cell_bbox( int32(i % m_cols), int32(i / m_cols) );
+      if ( !is || cell.n < 0 || cell.n == 1 ||
+           cell.n >= std::min( bbox.width(), bbox.height() ) ) {
+        *this = TransformGrid();
+        vw_throw( IOErr() << "TransformGrid: bad cell table." );
+      }
+      cell.offset = expected;
+      expected += 2 * uint64(cell.n) * cell.n;
+    }
+    uint64 num_values = 0;
+    read_value( is, num_values );
+    if ( !is || num_values != expected ) {
+      *this = TransformGrid();
+      vw_throw( IOErr() << "TransformGrid: truncated grid." );
+    }
+    m_values.resize( num_values );
+    if ( num_values )
+      is.read( reinterpret_cast<char*>(&m_values[0]), num_values*sizeof(float) );
+    if ( !is ) {
+      *this = TransformGrid();
+      vw_throw( IOErr() << "TransformGrid: truncated grid." );
+    }
+  }
+
+} // namespace vw
@@ -0,0 +1,234 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file TransformGrid.h
+///
+/// A lookup table approximating the reverse() of an expensive
+/// transform over a whole output image.
+///
+/// TransformView builds an ApproximateTransform for every tile it
+/// rasterizes and throws it away afterwards.  For slow transforms
+/// (GeoTransform, Map2CamTrans, camera transforms) it is much cheaper
+/// to build one TransformGrid for the entire output, share it between
+/// all tiles with GridApproximateTransform, and optionally keep it on
+/// disk for the next run over the same output.
+///
+/// The output bbox is split into cells of about cell_size pixels, and
+/// each cell gets its own lookup table refined until it is within the
+/// transform's tolerance (see approximate_reverse_table()).  Cells that
+/// can't be approximated that way fall back to the exact transform.
+///
+#ifndef __VW_IMAGE_TRANSFORMGRID_H__
+#define __VW_IMAGE_TRANSFORMGRID_H__
+
+#include <iosfwd>
+#include <string>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include <vw/Core/Exception.h>
+#include <vw/Core/Log.h>
+#include <vw/Core/Settings.h>
+#include <vw/Core/ThreadPool.h>
+#include <vw/Image/Transform.h>
+
+namespace vw {
+
+  class TransformGrid {
+  public:
+    /// An empty grid, which approximates nothing.
+    TransformGrid() : m_tolerance(0), m_cell_size(0), m_cols(0), m_rows(0) {}
+
+    /// Build the grid for transform.reverse() over the output 'bbox'.
+    /// Cells are evaluated in parallel, each with its own copy of the
+    /// transform, so transforms that are not thread safe but are safe
+    /// to copy (like Map2CamTrans) are fine.
+    template <class TransformT>
+    TransformGrid( TransformT const& transform, BBox2i const& bbox, double tolerance,
+                   int32 cell_size = 256,
+                   int num_threads = vw_settings().default_num_threads() );
+
+    BBox2i const& bbox     () const { return m_bbox;      }
+    double        tolerance() const { return m_tolerance; }
+    int32         cell_size() const { return m_cell_size; }
+
+    /// An identifier for the transform the grid was built from. Grids
+    /// read back from disk are only reused if the key matches.
+    std::string const& key() const { return m_key; }
+    void set_key( std::string const& key ) { m_key = key; }
+
+    /// Number of cells, and how many of them could be approximated.
+    size_t num_cells() const { return m_cells.size(); }
+    size_t num_approximated_cells() const;
+
+    /// Interpolated reverse() of p.  Returns false if p is outside the
+    /// grid or in a cell that could not be approximated.
+    bool reverse( Vector2 const& p, Vector2& result ) const;
+
+    /// True if this grid was built over 'bbox' to within 'tolerance'
+    /// for a transform with the given key.
+    bool matches( BBox2i const& bbox, double tolerance, std::string const& key ) const;
+
+    /// Save the grid to a binary file (in native byte order).
+    void write( std::string const& filename ) const;
+    void write( std::ostream& os ) const;
+
+    /// Load a grid written by write(). Throws IOErr if the file can't
+    /// be read or is not a transform grid.
+    void read( std::string const& filename );
+    void read( std::istream& is );
+
+  private:
+    // The table of a cell is n x n samples stored as float offsets from
+    // its first sample, which keeps them precise for large coordinates.
+    struct Cell {
+      int32   n;      ///< Table size, 0 if the cell is not approximated
+      Vector2 base;   ///< reverse() at the cell's first corner
+      uint64  offset; ///< Start of the table in m_values
+    };
+
+    template <class TransformT> class BuildTask;
+
+    BBox2i cell_bbox( int32 col, int32 row ) const;
+    void   init_cells( BBox2i const& bbox, double tolerance, int32 cell_size );
+    void   pack_tables( std::vector<ImageView<Vector2> > const& tables );
+
+    BBox2i             m_bbox;
+    double             m_tolerance;
+    int32              m_cell_size, m_cols, m_rows;
+    std::string        m_key;
+    std::vector<Cell>  m_cells;
+    std::vector<float> m_values;
+  };
+
+
+  /// Builds the table of one cell. An exception from the transform
+  /// just leaves that cell to the exact transform.
+  template <class TransformT>
+  class TransformGrid::BuildTask : public Task {
+    TransformT                       m_transform;
+    BBox2i                           m_bbox;
+    double                           m_tolerance;
+    ImageView<Vector2>&              m_table;
+  public:
+    BuildTask( TransformT const& transform, BBox2i const& bbox, double tolerance,
+               ImageView<Vector2>& table )
+      : m_transform(transform), m_bbox(bbox), m_tolerance(tolerance), m_table(table) {}
+
+    virtual void operator()() {
+      try {
+        approximate_reverse_table( m_transform, m_bbox, m_tolerance, m_table );
+      } catch ( const std::exception& e ) {
+        VW_OUT(DebugMessage, "image") << "TransformGrid: cell " << m_bbox
+                                      << " not approximated: " << e.what() << "\n";
+        m_table.reset();
+      }
+    }
+  };
+
+  template <class TransformT>
+  TransformGrid::TransformGrid( TransformT const& transform, BBox2i const& bbox, double tolerance,
+                                int32 cell_size, int num_threads ) {
+    VW_ASSERT( cell_size > 1, ArgumentErr() << "TransformGrid: cell size must be at least 2." );
+    VW_ASSERT( tolerance > 0, ArgumentErr() << "TransformGrid: tolerance must be positive." );
+    init_cells( bbox, tolerance, cell_size );
+
+    std::vector<ImageView<Vector2> > tables( m_cells.size() );
+    {
+      FifoWorkQueue queue( num_threads );
+      for ( int32 row = 0; row < m_rows; row++ )
+        for ( int32 col = 0; col < m_cols; col++ )
+          queue.add_task( boost::shared_ptr<Task>
+                          ( new BuildTask<TransformT>( transform, cell_bbox(col, row), tolerance,
+                                                       tables[row*m_cols+col] ) ) );
+      queue.join_all();
+    }
+    pack_tables( tables );
+  }
+
+
+  /// A transform that looks up reverse() in a shared TransformGrid and
+  /// falls back to the wrapped transform outside the grid.  Copies
+  /// share the grid, so every tile of a TransformView uses the same
+  /// one.  Its tolerance is 0, so TransformView does not approximate it
+  /// again.
+  template <class TransformT>
+  class GridApproximateTransform : public TransformT {
+    boost::shared_ptr<TransformGrid const> m_grid;
+  public:
+    GridApproximateTransform( TransformT const& transform,
+                              boost::shared_ptr<TransformGrid const> grid )
+      : TransformT( transform ), m_grid( grid ) {}
+
+    inline Vector2 reverse( Vector2 const& p ) const {
+      Vector2 result;
+      if ( m_grid && m_grid->reverse( p, result ) )
+        return result;
+      return TransformT::reverse( p );
+    }
+
+    boost::shared_ptr<TransformGrid const> const& grid() const { return m_grid; }
+
+    virtual double tolerance() const { return 0; }
+  };
+
+  /// Approximate 'transform' over the output 'bbox' with a single
+  /// TransformGrid, to within transform.tolerance().  If 'cache_file'
+  /// is given and holds a grid for the same bbox, tolerance and 'key',
+  /// that grid is used.  Otherwise a new grid is built and written
+  /// there.  The key should identify the transform, e.g. the two
+  /// georeferences of a GeoTransform written out with operator<<, and
+  /// must not be empty when a cache file is used, so that one
+  /// transform never picks up another's grid.
+  template <class TransformT>
+  GridApproximateTransform<TransformT>
+  grid_approximate( TransformT const& transform, BBox2i const& bbox,
+                    std::string const& cache_file = "", std::string const& key = "",
+                    int32 cell_size = 256 ) {
+    VW_ASSERT( transform.tolerance() > 0,
+               ArgumentErr() << "grid_approximate: the transform has no tolerance set." );
+    VW_ASSERT( cache_file.empty() || !key.empty(),
+               ArgumentErr() << "grid_approximate: a cache file needs a key identifying the transform." );
+    boost::shared_ptr<TransformGrid> grid;
+    if ( !cache_file.empty() ) {
+      try {
+        grid.reset( new TransformGrid() );
+        grid->read( cache_file );
+        if ( grid->matches( bbox, transform.tolerance(), key ) ) {
+          VW_OUT(DebugMessage, "image") << "Using transform grid " << cache_file << "\n";
+          return GridApproximateTransform<TransformT>( transform, grid );
+        }
+      } catch ( const IOErr& ) {}
+    }
+
+    grid.reset( new TransformGrid( transform, bbox, transform.tolerance(), cell_size ) );
+    grid->set_key( key );
+    if ( !cache_file.empty() ) {
+      try {
+        grid->write( cache_file );
+      } catch ( const IOErr& e ) {
+        VW_OUT(WarningMessage, "image") << "Could not save transform grid: " << e.what() << "\n";
+      }
+    }
+    return GridApproximateTransform<TransformT>( transform, grid );
+  }
+
+} // namespace vw
+
+#endif // __VW_IMAGE_TRANSFORMGRID_H__
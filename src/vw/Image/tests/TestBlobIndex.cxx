@@ -34,6 +34,9 @@
 
 #include <boost/assign/std/vector.hpp>
 #include <boost/assign/list_of.hpp>
+#include <boost/random/linear_congruential.hpp>
+
+#include <map>
 
 using namespace vw;
 using namespace boost::assign;
@@ -123,3 +126,77 @@ TEST( BlobIndex, BlobSizesView ) {
 
 
 
+
+// Reference 8-connected labelling by flood fill
+uint32 flood_fill_labels(ImageView<PixelMask<uint8> > const& image, ImageView<uint32>& labels) {
+  labels.set_size(image.cols(), image.rows());
+  fill(labels, 0);
+  uint32 count = 0;
+  for (int32 j = 0; j < image.rows(); j++)
+    for (int32 i = 0; i < image.cols(); i++) {
+      if (!is_valid(image(i,j)) || labels(i,j)) continue;
+      labels(i,j) = ++count;
+      std::vector<Vector2i> stack(1, Vector2i(i,j));
+      while (!stack.empty()) {
+        Vector2i p = stack.back();
+        stack.pop_back();
+        for (int32 dj = -1; dj <= 1; dj++)
+          for (int32 di = -1; di <= 1; di++) {
+            Vector2i n = p + Vector2i(di,dj);
+            if (bounding_box(image).contains(n) && is_valid(image(n.x(),n.y())) && !labels(n.x(),n.y())) {
+              labels(n.x(),n.y()) = count;
+              stack.push_back(n);
+            }
+          }
+      }
+    }
+  return count;
+}
+
+TEST( BlobIndex, TiledBlobIndex ) {
+  // Random blobs, some spanning many tiles and touching only diagonally
+  ImageView<PixelMask<uint8> > image(53, 41);
+  boost::rand48 gen(7);
+  for (int32 j = 0; j < image.rows(); j++)
+    for (int32 i = 0; i < image.cols(); i++)
+      if (gen() % 100 < 45)
+        image(i,j) = PixelMask<uint8>(1);
+  ImageView<uint32> expected;
+  uint32 num_expected = flood_fill_labels(image, expected);
+
+  for (int32 tile_size = 1; tile_size <= 64; tile_size *= 4) {
+    TiledBlobIndex index(image, tile_size, 3);
+    ImageView<uint32> labels;
+    index.labels(image, bounding_box(image), labels);
+    ASSERT_EQ(num_expected, index.num_blobs());
+
+    // Same partition as BlobIndex, with matching stats
+    std::map<uint32, uint32> to_expected;
+    std::vector<TiledBlobIndex::BlobStats> stats(index.num_blobs());
+    for (int32 j = 0; j < image.rows(); j++)
+      for (int32 i = 0; i < image.cols(); i++) {
+        ASSERT_EQ(expected(i,j) == 0, labels(i,j) == 0);
+        if (!labels(i,j)) continue;
+        if (to_expected.count(labels(i,j)))
+          EXPECT_EQ(to_expected[labels(i,j)], expected(i,j));
+        else
+          to_expected[labels(i,j)] = expected(i,j);
+        TiledBlobIndex::BlobStats& s = stats[labels(i,j)-1];
+        if (s.area == 0) s.bbox = BBox2i(i, j, 1, 1);
+        else s.bbox.grow(BBox2i(i, j, 1, 1));
+        s.area++;
+      }
+    EXPECT_EQ(size_t(index.num_blobs()), to_expected.size());
+    for (uint32 b = 1; b <= index.num_blobs(); b++) {
+      EXPECT_EQ(stats[b-1].area, index.stats(b).area);
+      EXPECT_EQ(stats[b-1].bbox, index.stats(b).bbox);
+    }
+
+    // Labels of part of the image
+    ImageView<uint32> part;
+    index.labels(image, BBox2i(5, 7, 30, 20), part);
+    for (int32 j = 0; j < part.rows(); j++)
+      for (int32 i = 0; i < part.cols(); i++)
+        EXPECT_EQ(labels(i+5, j+7), part(i,j));
+  }
+}
@@ -20,6 +20,8 @@
 #include <gtest/gtest_VW.h>
 #include <vw/Image/CensusTransform.h>
 
+#include <boost/random/linear_congruential.hpp>
+
 using namespace vw;
 
 TEST( CensusTransform, PointTests ) {
@@ -45,6 +47,36 @@ TEST( CensusTransform, PointTests ) {
 
 }
 
+TEST( CensusTransform, NativeValues ) {
+  // A float image and the same image in uint8 steps give the same
+  // descriptors once the threshold is scaled the same way, whatever
+  // part of the range the pixels use.
+  boost::rand48 gen(5);
+  ImageView<uint8> image8(12,10);
+  ImageView<float> image32(12,10);
+  for (int r=0; r<image8.rows(); ++r)
+    for (int c=0; c<image8.cols(); ++c) {
+      image8 (c,r) = uint8(100 + gen() % 20);
+      image32(c,r) = image8(c,r) / 255.0f;
+    }
+
+  ImageView<uint32> census8, census32;
+  census_transform_5x5(image8,  census8 );
+  census_transform_5x5(image32, census32);
+  ImageView<uint64> ternary8, ternary32;
+  ternary_census_transform_5x5(image8,  ternary8,  5);
+  ternary_census_transform_5x5(image32, ternary32, 5.5/255.0);
+  for (int r=0; r<image8.rows(); ++r)
+    for (int c=0; c<image8.cols(); ++c) {
+      EXPECT_EQ(census8 (c,r), census32 (c,r));
+      EXPECT_EQ(ternary8(c,r), ternary32(c,r));
+    }
+
+  // Interior pixels match the single pixel version
+  EXPECT_EQ(get_census_value_5x5(image8, 4,5), census8(4,5));
+  EXPECT_EQ(get_census_value_ternary_5x5(image8, 4,5, 5), ternary8(4,5));
+}
+
 TEST( HammingDist, Tests) {
 
   EXPECT_EQ(hamming_distance(uint8(0x01), uint8(0x00)), 1);
@@ -0,0 +1,204 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <gtest/gtest_VW.h>
+#include <test/Helpers.h>
+#include <vw/Core/Thread.h>
+#include <vw/Image/Contours.h>
+#include <vw/Image/ImageView.h>
+
+#include <map>
+#include <vector>
+
+using namespace vw;
+
+typedef std::list<Vector2> Line;
+
+// Collects every line it is handed, from however many threads
+struct LineCollector {
+  boost::shared_ptr<Mutex> mutex;
+  boost::shared_ptr<std::multimap<int, Line> > lines;
+
+  LineCollector() : mutex( new Mutex ), lines( new std::multimap<int, Line> ) {}
+  void operator()( int level, Line const& line ) const {
+    Mutex::Lock lock( *mutex );
+    lines->insert( std::make_pair( level, line ) );
+  }
+};
+
+// Distance from (cx,cy), so that each level is a circle
+ImageView<float> cone( int32 cols, int32 rows, double cx, double cy ) {
+  ImageView<float> dem( cols, rows );
+  for ( int32 y = 0; y < rows; y++ )
+    for ( int32 x = 0; x < cols; x++ )
+      dem(x,y) = float( norm_2( Vector2( x - cx, y - cy ) ) );
+  return dem;
+}
+
+bool on_border( Vector2 const& p, int32 cols, int32 rows ) {
+  return p.x() < 1e-6 || p.y() < 1e-6 || p.x() > cols - 1 - 1e-6 || p.y() > rows - 1 - 1e-6;
+}
+
+ContourFragment fragment( int level, ContourEdgeKey const& front, ContourEdgeKey const& back,
+                          Vector2 const& a, Vector2 const& b ) {
+  ContourFragment f;
+  f.level = level;
+  f.front = front;
+  f.back  = back;
+  f.points.push_back( a );
+  f.points.push_back( b );
+  return f;
+}
+
+TEST( ContourStitcher, JoinsAtEitherEnd ) {
+  ContourEdgeKey k0( 10, 0, 0, false ), k1( 10, 1, 0, true ),
+                 k2( 10, 0, 1, false ), k3( 10, 0, 0, true );
+  Vector2 p0( 0.5, 0 ), p1( 1, 0.5 ), p2( 0.5, 1 ), p3( 0, 0.5 );
+
+  ContourStitcher stitcher;
+  stitcher.add( fragment( 10, k0, k1, p0, p1 ) );
+  // Meets the first at its back, but runs the other way
+  stitcher.add( fragment( 10, k2, k1, p2, p1 ) );
+  ASSERT_EQ( 1u, stitcher.fragments().size() );
+  ContourStitcher::iterator f = stitcher.fragments().begin();
+  EXPECT_FALSE( f->closed() );
+  EXPECT_EQ( 3u, f->points.size() );
+  EXPECT_TRUE( stitcher.find( k1 ) == stitcher.fragments().end() );
+  EXPECT_TRUE( stitcher.find( k0 ) == f );
+  EXPECT_TRUE( stitcher.find( k2 ) == f );
+
+  // A fragment at another level doesn't join in
+  stitcher.add( fragment( 20, ContourEdgeKey( 20, 0, 1, false ), ContourEdgeKey( 20, 0, 0, true ), p2, p3 ) );
+  EXPECT_EQ( 2u, stitcher.fragments().size() );
+
+  // This one meets both ends and closes the loop
+  f = stitcher.add( fragment( 10, k2, k3, p2, p3 ) );
+  EXPECT_EQ( 2u, stitcher.fragments().size() );
+  EXPECT_FALSE( f->closed() );
+  f = stitcher.add( fragment( 10, k3, k0, p3, p0 ) );
+  ASSERT_TRUE( f->closed() );
+  EXPECT_EQ( 5u, f->points.size() );
+  EXPECT_VECTOR_NEAR( f->points.front(), f->points.back(), 1e-12 );
+  EXPECT_TRUE( stitcher.find( k0 ) == stitcher.fragments().end() );
+
+  stitcher.erase( f );
+  EXPECT_EQ( 1u, stitcher.fragments().size() );
+}
+
+TEST( TiledContours, ClosedAcrossTiles ) {
+  // Circles of radius 5, 10 and 15 lie inside the image and cross
+  // many 8x8 tiles.  Larger ones are cut open by the image border.
+  ImageView<float> dem = cone( 40, 40, 19.5, 20.3 );
+  LineCollector lines;
+  tiled_contours( dem, lines, 5, -9999, 8, 4 );
+
+  for ( int level = 5; level <= 15; level += 5 ) {
+    ASSERT_EQ( 1u, lines.lines->count( level ) ) << "level " << level;
+    Line const& line = lines.lines->find( level )->second;
+    EXPECT_GT( line.size(), size_t(4 * level) );
+    EXPECT_VECTOR_NEAR( line.front(), line.back(), 1e-12 );
+    for ( Line::const_iterator p = line.begin(); p != line.end(); ++p )
+      EXPECT_NEAR( double(level), norm_2( *p - Vector2( 19.5, 20.3 ) ), 0.05 );
+  }
+  for ( std::multimap<int, Line>::const_iterator l = lines.lines->begin();
+        l != lines.lines->end(); ++l ) {
+    if ( l->first <= 15 )
+      continue;
+    EXPECT_TRUE( on_border( l->second.front(), 40, 40 ) ) << "level " << l->first;
+    EXPECT_TRUE( on_border( l->second.back(),  40, 40 ) ) << "level " << l->first;
+  }
+}
+
+TEST( TiledContours, OpenAcrossTiles ) {
+  // A tilted plane: each level is one straight line from the top
+  // border to the bottom one, through a column of tiles.
+  ImageView<float> dem( 50, 30 );
+  for ( int32 y = 0; y < dem.rows(); y++ )
+    for ( int32 x = 0; x < dem.cols(); x++ )
+      dem(x,y) = float( 2*x + 0.5*y ) + 0.25f;
+  LineCollector lines;
+  tiled_contours( dem, lines, 7, -9999, 6, 3 );
+
+  for ( int level = 21; level <= 91; level += 7 ) {
+    ASSERT_EQ( 1u, lines.lines->count( level ) ) << "level " << level;
+    Line line = lines.lines->find( level )->second;
+    EXPECT_GE( line.size(), size_t(dem.rows()) );
+    if ( line.front().y() > line.back().y() )
+      line.reverse();
+    EXPECT_NEAR( 0.0, line.front().y(), 1e-6 );
+    EXPECT_NEAR( dem.rows() - 1, line.back().y(), 1e-6 );
+    for ( Line::const_iterator p = line.begin(); p != line.end(); ++p )
+      EXPECT_NEAR( double(level), 2*p->x() + 0.5*p->y() + 0.25, 1e-4 );
+  }
+}
+
+TEST( TiledContours, TilingDoesNotMatter ) {
+  ImageView<float> dem = cone( 37, 45, 12.2, 30.7 );
+  dem( 20, 20 ) = -9999;   // a nodata pixel splits some lines
+
+  LineCollector whole, tiled;
+  tiled_contours( dem, whole, 3, -9999, 64, 1 );
+  tiled_contours( dem, tiled, 3, -9999, 5, 4 );
+
+  ASSERT_EQ( whole.lines->size(), tiled.lines->size() );
+  std::map<int, size_t> whole_points, tiled_points;
+  for ( std::multimap<int, Line>::const_iterator l = whole.lines->begin(); l != whole.lines->end(); ++l )
+    whole_points[l->first] += l->second.size();
+  for ( std::multimap<int, Line>::const_iterator l = tiled.lines->begin(); l != tiled.lines->end(); ++l )
+    tiled_points[l->first] += l->second.size();
+  EXPECT_TRUE( whole_points == tiled_points );
+}
+
+// Notes which lines were handed over by the calling thread, which only
+// happens for lines left over once every tile is done
+struct CallerCounter {
+  uint64 caller;
+  boost::shared_ptr<Mutex> mutex;
+  boost::shared_ptr<int> lines, from_caller;
+
+  CallerCounter() : caller( Thread::id() ), mutex( new Mutex ),
+                    lines( new int(0) ), from_caller( new int(0) ) {}
+  void operator()( int, Line const& ) const {
+    Mutex::Lock lock( *mutex );
+    (*lines)++;
+    if ( Thread::id() == caller )
+      (*from_caller)++;
+  }
+};
+
+TEST( TiledContours, StreamsEveryLine ) {
+  // Lines that join fragments from earlier tiles at both ends must still
+  // be passed on as soon as their last tile is done
+  ImageView<float> dem = cone( 40, 40, 0, 0 );
+  CallerCounter counter;
+  tiled_contours( dem, counter, 1, -9999, 20, 1 );
+  EXPECT_GT( *counter.lines, 40 );
+  EXPECT_EQ( 0, *counter.from_caller );
+
+  CallerCounter threaded;
+  tiled_contours( dem, threaded, 1, -9999, 7, 4 );
+  EXPECT_EQ( 0, *threaded.from_caller );
+}
+
+TEST( TiledContours, BadArguments ) {
+  ImageView<float> dem = cone( 10, 10, 4.5, 4.5 );
+  LineCollector lines;
+  EXPECT_THROW( tiled_contours( dem, lines, 0, -9999 ),        ArgumentErr );
+  EXPECT_THROW( tiled_contours( dem, lines, 1, -9999, 0 ),     ArgumentErr );
+  EXPECT_THROW( tiled_contours( dem, lines, 1, -9999, 8, 0 ),  ArgumentErr );
+}
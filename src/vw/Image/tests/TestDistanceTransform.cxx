@@ -0,0 +1,122 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <gtest/gtest_VW.h>
+#include <vw/Image/DistanceTransform.h>
+#include <vw/Image/ImageView.h>
+#include <vw/Image/Manipulation.h>
+
+#include <boost/random/linear_congruential.hpp>
+
+using namespace vw;
+
+// Distance to the nearest background pixel, with a background frame
+// around the image
+ImageView<float> brute_force( ImageView<uint8> const& image ) {
+  ImageView<float> result( image.cols(), image.rows() );
+  for ( int32 y = 0; y < image.rows(); y++ )
+    for ( int32 x = 0; x < image.cols(); x++ ) {
+      if ( !image(x,y) )
+        continue;
+      double best = std::min( std::min( x+1, image.cols()-x ), std::min( y+1, image.rows()-y ) );
+      for ( int32 j = 0; j < image.rows(); j++ )
+        for ( int32 i = 0; i < image.cols(); i++ )
+          if ( !image(i,j) )
+            best = std::min( best, std::sqrt( double(i-x)*(i-x) + double(j-y)*(j-y) ) );
+      result(x,y) = float(best);
+    }
+  return result;
+}
+
+// A few background specks in a big foreground, so that the nearest
+// background is often several tiles away
+ImageView<uint8> test_image( int32 cols, int32 rows, int32 specks ) {
+  boost::rand48 gen(3);
+  ImageView<uint8> image( cols, rows );
+  fill( image, 1 );
+  for ( int32 k = 0; k < specks; k++ )
+    image( gen() % cols, gen() % rows ) = 0;
+  return image;
+}
+
+TEST( DistanceTransform, OneDimensional ) {
+  double f[6] = { 1e20, 0, 1e20, 1e20, 1e20, 2 };
+  double d[6], z[7];
+  int32 v[6];
+  squared_distance_transform_1d( f, d, 6, v, z );
+  EXPECT_EQ( 1, d[0] );
+  EXPECT_EQ( 0, d[1] );
+  EXPECT_EQ( 1, d[2] );
+  EXPECT_EQ( 4, d[3] );
+  EXPECT_EQ( 3, d[4] );
+  EXPECT_EQ( 2, d[5] );
+}
+
+TEST( DistanceTransform, Exact ) {
+  ImageView<uint8> image = test_image( 67, 45, 6 );
+  ImageView<float> expected = brute_force( image );
+
+  for ( int32 tile_size = 5; tile_size <= 80; tile_size *= 4 ) {
+    EuclideanDistanceView<ImageView<uint8> > distance( image, 0, tile_size, 2 );
+    ImageView<float> whole = distance;
+    for ( int32 y = 0; y < image.rows(); y++ )
+      for ( int32 x = 0; x < image.cols(); x++ )
+        EXPECT_NEAR( expected(x,y), whole(x,y), 1e-5 ) << "at " << x << "," << y;
+
+    // Blocks that don't line up with the tiles
+    for ( int32 y = 0; y < image.rows(); y += 13 )
+      for ( int32 x = 0; x < image.cols(); x += 13 ) {
+        BBox2i bbox( x, y, 13, 13 );
+        bbox.crop( bounding_box(image) );
+        ImageView<float> block = crop( distance, bbox );
+        for ( int32 j = 0; j < bbox.height(); j++ )
+          for ( int32 i = 0; i < bbox.width(); i++ )
+            EXPECT_NEAR( expected(x+i,y+j), block(i,j), 1e-5 );
+      }
+  }
+}
+
+TEST( DistanceTransform, Capped ) {
+  ImageView<uint8> image = test_image( 50, 40, 4 );
+  ImageView<float> expected = brute_force( image );
+
+  EuclideanDistanceView<ImageView<uint8> > distance( image, 4.5 );
+  for ( int32 y = 0; y < image.rows(); y += 10 )
+    for ( int32 x = 0; x < image.cols(); x += 10 ) {
+      ImageView<float> block = crop( distance, BBox2i(x, y, 10, 10) );
+      for ( int32 j = 0; j < 10; j++ )
+        for ( int32 i = 0; i < 10; i++ )
+          EXPECT_NEAR( std::min( expected(x+i,y+j), 4.5f ), block(i,j), 1e-5 );
+    }
+
+  EXPECT_THROW( euclidean_distance( image, -1 ), ArgumentErr );
+}
+
+TEST( DistanceTransform, Masked ) {
+  // Invalid pixels are the background
+  ImageView<PixelMask<float> > image( 5, 5 );
+  for ( int32 y = 0; y < 5; y++ )
+    for ( int32 x = 0; x < 5; x++ )
+      image(x,y) = PixelMask<float>( 0 );
+  invalidate( image(0,0) );
+  ImageView<float> distance = euclidean_distance( image );
+  EXPECT_EQ( 0, distance(0,0) );
+  EXPECT_NEAR( std::sqrt(2.0), distance(1,1), 1e-6 );
+  EXPECT_NEAR( std::sqrt(8.0), distance(2,2), 1e-6 );
+  EXPECT_EQ( 1, distance(4,4) );
+}
@@ -20,6 +20,7 @@
 
 #include <vw/Core/Functors.h>
 #include <vw/Core/FundamentalTypes.h>
+#include <vw/Core/Metrics.h>
 #include <vw/Math/BBox.h>
 #include <vw/Image/ImageResource.h>
 #include <vw/Image/ImageResourceStream.h>
@@ -185,6 +186,26 @@ TEST_F(TestStream, Read) {
   CHECK(src_data, dst_buf);
 }
 
+TEST_F(TestStream, Metrics) {
+  io::stream<io::array_source> s1(src_data, size());
+  SrcImageResourceStream r(&s1);
+  io::stream<io::array_sink> s2(dst_buf, size());
+  DstImageResourceStream w(&s2);
+
+  MetricCounter& reads  = vw_metrics().counter( "vw_resource_read_bytes_total", "Bytes read from image resources",
+                                                metric_label( "resource", "SrcImageResourceStream" ) );
+  MetricCounter& writes = vw_metrics().counter( "vw_resource_written_bytes_total", "Bytes written to image resources",
+                                                metric_label( "resource", "DstImageResourceStream" ) );
+  uint64 read0 = reads.value(), write0 = writes.value();
+
+  ImageBuffer buf(fmt, dst_buf);
+  record_resource_read ( r, buf );
+  record_resource_read ( r, buf );
+  record_resource_write( w, buf );
+  EXPECT_EQ( read0  + 2*size(), reads.value()  );
+  EXPECT_EQ( write0 +   size(), writes.value() );
+}
+
 TEST_F(TestStream, Write) {
   const BBox2i box(0,0,WIDTH,HEIGHT);
   io::stream<io::array_sink> s1(dst_buf, size());
@@ -0,0 +1,162 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <gtest/gtest_VW.h>
+#include <vw/Image/TerrainDerivatives.h>
+#include <vw/Image/ImageView.h>
+#include <vw/Image/Manipulation.h>
+
+using namespace vw;
+
+// z = a*x + b*y + c*(x^2 + y^2), in pixels
+ImageView<PixelMask<float> > surface( int32 cols, int32 rows, float a, float b, float c ) {
+  ImageView<PixelMask<float> > dem( cols, rows );
+  for ( int32 y = 0; y < rows; y++ )
+    for ( int32 x = 0; x < cols; x++ )
+      dem(x,y) = a*x + b*y + c*(x*x + y*y);
+  return dem;
+}
+
+TEST( TerrainDerivatives, Plane ) {
+  // North-up, 10m pixels: z rises 2 per pixel east and 3 per pixel south
+  ImageView<PixelMask<float> > dem = surface( 12, 9, 2, 3, 0 );
+  std::vector<double> dx( 9, 10.0 ), dy( 9, -10.0 );
+  double slope  = std::atan( std::sqrt( 0.2*0.2 + 0.3*0.3 ) );
+  double aspect = std::atan2( -0.2, 0.3 ) + 2*M_PI;
+
+  TerrainStencil stencils[2] = { HornStencil, ZevenbergenThorneStencil };
+  for ( int32 s = 0; s < 2; s++ ) {
+    ImageView<PixelMask<float> > slopes    = terrain_derivative( dem, TerrainSlope,     dx, dy, stencils[s] );
+    ImageView<PixelMask<float> > aspects   = terrain_derivative( dem, TerrainAspect,    dx, dy, stencils[s] );
+    ImageView<PixelMask<float> > curvature = terrain_derivative( dem, TerrainCurvature, dx, dy, stencils[s] );
+    for ( int32 y = 1; y < 8; y++ )
+      for ( int32 x = 1; x < 11; x++ ) {
+        ASSERT_TRUE( is_valid( slopes(x,y) ) );
+        EXPECT_NEAR( slope,  slopes(x,y).child(),  1e-5 );
+        EXPECT_NEAR( aspect, aspects(x,y).child(), 1e-5 );
+        EXPECT_NEAR( 0, curvature(x,y).child(), 1e-5 );
+      }
+  }
+
+  // The light straight above: the cosine of the slope
+  ImageView<PixelMask<float> > shade = terrain_derivative( dem, TerrainHillshade, dx, dy, HornStencil, Vector3(0,0,1) );
+  EXPECT_NEAR( std::cos( slope ), std::fabs( shade(5,5).child() ), 1e-5 );
+}
+
+TEST( TerrainDerivatives, Curvature ) {
+  // A dome is convex; spacing of 2m east-west and 4m north-south
+  ImageView<PixelMask<float> > dem = surface( 10, 10, 0, 0, -0.5 );
+  std::vector<double> dx( 10, 2.0 ), dy( 10, -4.0 );
+  ImageView<PixelMask<float> > curvature = terrain_derivative( dem, TerrainCurvature, dx, dy );
+  for ( int32 y = 1; y < 9; y++ )
+    for ( int32 x = 1; x < 9; x++ )
+      EXPECT_NEAR( 1.0/4 + 1.0/16, curvature(x,y).child(), 1e-5 );
+
+  // Flat ground has no aspect
+  ImageView<PixelMask<float> > flat = surface( 5, 5, 0, 0, 0 );
+  std::vector<double> ones( 5, 1.0 );
+  ImageView<PixelMask<float> > aspect = terrain_derivative( flat, TerrainAspect, ones, ones );
+  EXPECT_FALSE( is_valid( aspect(2,2) ) );
+}
+
+TEST( TerrainDerivatives, RowSpacing ) {
+  // Pixels get narrower with each row, as they do towards the poles
+  ImageView<PixelMask<float> > dem = surface( 6, 20, 1, 0, 0 );
+  std::vector<double> dx( 20 ), dy( 20, -1.0 );
+  for ( int32 y = 0; y < 20; y++ )
+    dx[y] = 1.0 / ( y + 1 );
+  ImageView<PixelMask<float> > slopes = terrain_derivative( dem, TerrainSlope, dx, dy );
+  for ( int32 y = 1; y < 19; y++ )
+    EXPECT_NEAR( std::atan( double( y + 1 ) ), slopes(3,y).child(), 1e-5 );
+
+  EXPECT_THROW( terrain_derivative( dem, TerrainSlope, std::vector<double>( 3, 1.0 ), dy ), ArgumentErr );
+}
+
+TEST( TerrainDerivatives, Masking ) {
+  ImageView<PixelMask<float> > dem = surface( 10, 8, 1, 1, 0.1f );
+  dem(4,3).invalidate();
+  std::vector<double> ones( 8, 1.0 );
+  ImageView<PixelMask<float> > slopes = terrain_derivative( dem, TerrainSlope, ones, ones );
+  for ( int32 y = 0; y < 8; y++ )
+    for ( int32 x = 0; x < 10; x++ )
+      EXPECT_EQ( std::abs( x - 4 ) > 1 || std::abs( y - 3 ) > 1, is_valid( slopes(x,y) ) )
+        << "at (" << x << "," << y << ")";
+
+  // Edges repeat the edge heights, so they are valid
+  EXPECT_TRUE( is_valid( slopes(0,0) ) );
+}
+
+TEST( TerrainDerivatives, Blocks ) {
+  // Blocks agree with the whole, however the DEM is cut up
+  ImageView<PixelMask<float> > dem = surface( 23, 17, 0.3f, -0.7f, 0.05f );
+  dem(11,8).invalidate();
+  std::vector<double> dx( 17, 3.0 ), dy( 17, -2.0 );
+  TerrainDerivative derivatives[4] = { TerrainSlope, TerrainAspect, TerrainHillshade, TerrainCurvature };
+  for ( int32 d = 0; d < 4; d++ ) {
+    TerrainDerivativeView<ImageView<PixelMask<float> > > view( dem, derivatives[d], dx, dy, HornStencil, Vector3(1,1,1) );
+    ImageView<PixelMask<float> > whole = view;
+    for ( int32 size = 1; size <= 16; size *= 4 )
+      for ( int32 y = 0; y < 17; y += size )
+        for ( int32 x = 0; x < 23; x += size ) {
+          BBox2i bbox( x, y, std::min( size, 23 - x ), std::min( size, 17 - y ) );
+          ImageView<PixelMask<float> > block = crop( view, bbox );
+          for ( int32 j = 0; j < bbox.height(); j++ )
+            for ( int32 i = 0; i < bbox.width(); i++ ) {
+              EXPECT_EQ( is_valid( whole(x+i, y+j) ), is_valid( block(i,j) ) );
+              if ( is_valid( block(i,j) ) )
+                EXPECT_EQ( whole(x+i, y+j).child(), block(i,j).child() );
+            }
+        }
+  }
+}
+
+TEST( TerrainDerivatives, Regression ) {
+  // Pins the values slopemap and hillshade now write, border included
+  float heights[4][4] = { { 10, 12, 15, 13 },
+                          { 11, 14, 18, 16 },
+                          {  9, 13, 20, 21 },
+                          {  8, 10, 17, 25 } };
+  ImageView<PixelMask<float> > dem( 4, 4 );
+  for ( int32 y = 0; y < 4; y++ )
+    for ( int32 x = 0; x < 4; x++ )
+      dem(x,y) = heights[y][x];
+  std::vector<double> dx( 4, 2.0 ), dy( 4, -2.0 );
+
+  ImageView<PixelMask<float> > slopes  = terrain_derivative( dem, TerrainSlope,  dx, dy, HornStencil );
+  ImageView<PixelMask<float> > aspects = terrain_derivative( dem, TerrainAspect, dx, dy, HornStencil );
+  ImageView<PixelMask<float> > shade   = terrain_derivative( dem, TerrainHillshade, dx, dy, HornStencil,
+                                                             Vector3(-1,-1,1) );
+  ImageView<PixelMask<float> > fh      = terrain_derivative( dem, TerrainSlope,  dx, dy,
+                                                             ZevenbergenThorneStencil );
+  // At (1,2) Horn's dz/dx is 38/8 per pixel east and 12/8 per pixel
+  // north, over 2m pixels
+  EXPECT_NEAR( 1.188990, slopes(1,2).child(),  1e-5 );
+  EXPECT_NEAR( 4.406510, aspects(1,2).child(), 1e-5 );
+  EXPECT_NEAR( -0.887366, shade(1,2).child(),  1e-5 );
+  EXPECT_NEAR( 1.241496, fh(1,2).child(),      1e-5 );
+
+  // Corners see the edge-extended DEM
+  EXPECT_NEAR( 0.571776, slopes(0,0).child(),  1e-5 );
+  EXPECT_NEAR( 5.219488, aspects(0,0).child(), 1e-5 );
+  EXPECT_NEAR( -0.606897, shade(0,0).child(),  1e-5 );
+  EXPECT_NEAR( 0.509740, fh(0,0).child(),      1e-5 );
+  EXPECT_NEAR( 1.028784, slopes(3,3).child(),  1e-5 );
+  EXPECT_NEAR( 5.057945, aspects(3,3).child(), 1e-5 );
+  EXPECT_NEAR( -0.595665, shade(3,3).child(),  1e-5 );
+  EXPECT_NEAR( 1.150262, fh(3,3).child(),      1e-5 );
+}
@@ -202,3 +202,68 @@ TEST( Transform, FreeForward ) {
                         tx.forward(tx.reverse(Vector2(i*i,i))), 1e-3 );
   }
 }
+
+// Rasterizes 'view' over 'bbox' both through its row-wise rasterize()
+// and pixel by pixel, and checks that they agree.
+template <class ViewT>
+static void check_row_rasterize( ViewT const& view, BBox2i const& bbox, double tol ) {
+  ImageView<float> rows( bbox.width(), bbox.height() ), pixels( bbox.width(), bbox.height() );
+  view.rasterize( rows, bbox );
+  vw::rasterize( view.prerasterize(bbox), pixels, bbox );
+  for ( int32 j = 0; j < bbox.height(); j++ )
+    for ( int32 i = 0; i < bbox.width(); i++ )
+      EXPECT_NEAR( pixels(i,j), rows(i,j), tol ) << "at " << i << "," << j;
+}
+
+TEST( Transform, RowRasterize ) {
+  ImageView<float> im(40,30);
+  for ( int32 j = 0; j < im.rows(); j++ )
+    for ( int32 i = 0; i < im.cols(); i++ )
+      im(i,j) = float( (i*7 + j*13) % 17 ) + 0.25f*i;
+
+  // Covers the image edges and a block inside it
+  BBox2i full( -5, -4, 50, 38 ), inner( 6, 9, 17, 11 );
+
+  Matrix3x3 H( 0.9, 0.15, 3, -0.1, 1.05, -2, 0.001, -0.002, 1 );
+  AffineTransform affine( Matrix2x2( 0.8, -0.3, 0.25, 1.1 ), Vector2( 2.5, -1.5 ) );
+  RotateTransform rotate( 0.3, Vector2( 20, 15 ) );
+
+  for ( int k = 0; k < 2; k++ ) {
+    BBox2i bbox = k ? inner : full;
+    check_row_rasterize( transform( im, affine ), bbox, 1e-4 );
+    check_row_rasterize( transform( im, rotate, ConstantEdgeExtension() ), bbox, 1e-4 );
+    check_row_rasterize( transform( im, HomographyTransform(H), ZeroEdgeExtension(), BicubicInterpolation() ), bbox, 1e-4 );
+    check_row_rasterize( transform( im, ResampleTransform(2,2), ConstantEdgeExtension(), NearestPixelInterpolation() ), bbox, 0 );
+    check_row_rasterize( transform( im, compose( TranslateTransform(1.5,0.5), ResampleTransform(0.7,1.3) ) ), bbox, 1e-4 );
+  }
+
+  // A tolerance switches rasterize() to the approximated transform
+  HomographyTransform approx_H(H);
+  approx_H.set_tolerance( 0.01 );
+  check_row_rasterize( transform( im, approx_H ), inner, 0.2 );
+}
+
+// Homography that counts how often it is evaluated
+class CountingHomography : public HomographyTransform {
+public:
+  mutable int count;
+  CountingHomography( Matrix3x3 const& H ) : HomographyTransform(H), count(0) {}
+  inline Vector2 reverse( Vector2 const& p ) const {
+    count++;
+    return HomographyTransform::reverse(p);
+  }
+};
+
+TEST( Transform, Approximate ) {
+  Matrix3x3 H( 0.9, 0.15, 3, -0.1, 1.05, -2, 0.0002, -0.0003, 1 );
+  CountingHomography exact(H);
+  exact.set_tolerance( 0.01 );
+  ApproximateTransform<CountingHomography> approx( exact, BBox2i(0,0,300,200) );
+  int built = approx.count;
+  EXPECT_LT( built, 300*200 );
+  for ( double y = 0.5; y < 200; y += 13.3 )
+    for ( double x = 0.25; x < 300; x += 17.1 )
+      EXPECT_VECTOR_NEAR( exact.reverse(Vector2(x,y)), approx.reverse(Vector2(x,y)), 0.02 );
+  // Lookups come from the table, not the exact transform
+  EXPECT_EQ( built, approx.count );
+}
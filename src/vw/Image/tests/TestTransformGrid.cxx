@@ -0,0 +1,145 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <gtest/gtest_VW.h>
+#include <test/Helpers.h>
+
+#include <vw/Image/ImageView.h>
+#include <vw/Image/TransformGrid.h>
+
+using namespace vw;
+using namespace vw::test;
+
+static HomographyTransform test_transform() {
+  Matrix3x3 H( 0.9, 0.15, 3, -0.1, 1.05, -2, 0.0002, -0.0003, 1 );
+  HomographyTransform tx(H);
+  tx.set_tolerance( 0.01 );
+  return tx;
+}
+
+// Throws for part of its domain, like a map projection outside its zone
+class PartialTransform : public TransformHelper<PartialTransform,ContinuousFunction,ContinuousFunction> {
+public:
+  inline Vector2 reverse( Vector2 const& p ) const {
+    if ( p.x() > 300 )
+      vw_throw( ArgumentErr() << "Out of domain" );
+    return Vector2( p.x() + 0.001*p.y()*p.y(), p.y() );
+  }
+};
+
+TEST( TransformGrid, Build ) {
+  HomographyTransform tx = test_transform();
+  BBox2i bbox( -20, 10, 700, 500 );
+  TransformGrid grid( tx, bbox, tx.tolerance(), 128, 4 );
+
+  EXPECT_EQ( 5u*3u, grid.num_cells() );
+  EXPECT_EQ( grid.num_cells(), grid.num_approximated_cells() );
+  for ( double y = 10; y <= 510; y += 23.7 )
+    for ( double x = -20; x <= 680; x += 31.3 ) {
+      Vector2 approx;
+      ASSERT_TRUE( grid.reverse( Vector2(x,y), approx ) );
+      EXPECT_VECTOR_NEAR( tx.reverse(Vector2(x,y)), approx, 0.02 );
+    }
+
+  Vector2 result;
+  EXPECT_FALSE( grid.reverse( Vector2(-21, 50), result ) );
+  EXPECT_FALSE( grid.reverse( Vector2(50, 511), result ) );
+}
+
+TEST( TransformGrid, PartialDomain ) {
+  PartialTransform tx;
+  TransformGrid grid( tx, BBox2i(0,0,512,256), 0.05, 128 );
+  ASSERT_EQ( 8u, grid.num_cells() );
+  EXPECT_EQ( 4u, grid.num_approximated_cells() );
+
+  GridApproximateTransform<PartialTransform> approx( tx, boost::shared_ptr<TransformGrid const>( new TransformGrid(grid) ) );
+  EXPECT_VECTOR_NEAR( tx.reverse(Vector2(100.5,200.5)), approx.reverse(Vector2(100.5,200.5)), 0.05 );
+  EXPECT_THROW( approx.reverse(Vector2(400,100)), ArgumentErr );
+}
+
+TEST( TransformGrid, ReadWrite ) {
+  HomographyTransform tx = test_transform();
+  BBox2i bbox( 0, 0, 300, 200 );
+  TransformGrid grid( tx, bbox, tx.tolerance(), 64 );
+  grid.set_key( "homography" );
+
+  UnlinkName file( "grid.vwtg" );
+  grid.write( file );
+
+  TransformGrid loaded;
+  loaded.read( file );
+  EXPECT_TRUE ( loaded.matches( bbox, 0.01, "homography" ) );
+  EXPECT_TRUE ( loaded.matches( bbox, 0.1,  "homography" ) );
+  EXPECT_FALSE( loaded.matches( bbox, 0.001, "homography" ) );
+  EXPECT_FALSE( loaded.matches( bbox, 0.01, "other" ) );
+  EXPECT_FALSE( loaded.matches( BBox2i(0,0,300,201), 0.01, "homography" ) );
+  ASSERT_EQ( grid.num_cells(), loaded.num_cells() );
+
+  for ( double y = 0; y <= 200; y += 7.7 )
+    for ( double x = 0; x <= 300; x += 9.1 ) {
+      Vector2 a, b;
+      ASSERT_TRUE( grid.reverse( Vector2(x,y), a ) );
+      ASSERT_TRUE( loaded.reverse( Vector2(x,y), b ) );
+      EXPECT_VECTOR_EQ( a, b );
+    }
+
+  EXPECT_THROW( loaded.read( "does-not-exist.vwtg" ), IOErr );
+}
+
+TEST( TransformGrid, ReadRemainderCells ) {
+  // The last cell takes up the remainder, so its table can be bigger
+  // than cell_size+1.  Tighten the tolerance until the tables are as
+  // big as they get and check every grid reads back.
+  HomographyTransform tx = test_transform();
+  BBox2i bbox( 0, 0, 29, 29 );
+  UnlinkName file( "remainder.vwtg" );
+  for ( double tolerance = 0.1; tolerance > 1e-7; tolerance /= 10 ) {
+    TransformGrid grid( tx, bbox, tolerance, 10 );
+    grid.write( file );
+    TransformGrid loaded;
+    ASSERT_NO_THROW( loaded.read( file ) ) << "tolerance " << tolerance;
+    EXPECT_EQ( grid.num_approximated_cells(), loaded.num_approximated_cells() );
+  }
+}
+
+TEST( TransformGrid, TransformView ) {
+  ImageView<float> im(80,60);
+  for ( int32 j = 0; j < im.rows(); j++ )
+    for ( int32 i = 0; i < im.cols(); i++ )
+      im(i,j) = float( i ) + 0.5f*j;
+
+  HomographyTransform tx = test_transform();
+  BBox2i bbox( 0, 0, 90, 70 );
+  UnlinkName file( "view.vwtg" );
+  GridApproximateTransform<HomographyTransform> approx = grid_approximate( tx, bbox, file, "H", 32 );
+  EXPECT_EQ( 0.0, approx.tolerance() );
+
+  // The second call loads the grid written by the first
+  GridApproximateTransform<HomographyTransform> cached = grid_approximate( tx, bbox, file, "H", 32 );
+  ASSERT_TRUE( cached.grid().get() != 0 );
+  EXPECT_TRUE( cached.grid()->matches( bbox, 0.01, "H" ) );
+
+  // Without a key the cache could hold any transform's grid
+  EXPECT_THROW( grid_approximate( tx, bbox, file, "", 32 ), ArgumentErr );
+
+  ImageView<float> exact = crop( transform( im, tx, ConstantEdgeExtension() ), bbox );
+  ImageView<float> grid  = crop( transform( im, cached, ConstantEdgeExtension() ), bbox );
+  for ( int32 j = 0; j < bbox.height(); j++ )
+    for ( int32 i = 0; i < bbox.width(); i++ )
+      EXPECT_NEAR( exact(i,j), grid(i,j), 0.05 );
+}
@@ -69,11 +69,17 @@
 /// which may be buggy and certainly is underperforming Armijo
 /// for me at the moment.  I also provide a steepest_descent()
 /// method for comparison to conjugate_gradient().
+///
+/// Finally, preconditioned_conjugate_gradient() solves the linear
+/// system A*x=b for a symmetric positive definite A that is only
+/// available as an operator.  This is what bundle adjustment uses
+/// to solve the reduced camera system without ever forming it.
 
 #ifndef __VW_MATH_CONJUGATEGRADIENT_H__
 #define __VW_MATH_CONJUGATEGRADIENT_H__
 
 #include <vw/Core/Log.h>
+#include <vw/Math/Vector.h>
 
 #define VW_CONJGRAD_MAX_ITERS_BETWEEN_SPACER_STEPS 20
 
@@ -240,6 +246,82 @@ namespace math{
     return pos;
   }
 
+
+  // Preconditioner that does nothing, which reduces
+  // preconditioned_conjugate_gradient() to plain linear CG.
+  struct IdentityPreconditioner {
+    template <class VectorT>
+    VectorT operator()( VectorT const& r ) const { return r; }
+  };
+
+  /// How preconditioned_conjugate_gradient() stopped.
+  enum PCGStatus {
+    PCG_CONVERGED,             ///< The residual fell below the threshold
+    PCG_MAX_ITERATIONS,        ///< It ran out of iterations first
+    PCG_NOT_POSITIVE_DEFINITE  ///< A step found p'Ap <= 0
+  };
+
+  /// Solve A*x=b with the preconditioned conjugate gradient method.
+  ///
+  /// OperatorT must define: VectorT operator()( VectorT const& x ) const;
+  /// that returns A*x, where A is symmetric positive definite.
+  /// PreconditionerT has the same signature and should return an
+  /// approximation of inverse(A)*r.  On entry x holds the initial
+  /// guess.  Iteration stops once the residual norm falls below
+  /// tolerance*norm_2(b) or after max_iterations steps.  Returns the
+  /// number of iterations performed; if status is given, it is set to
+  /// why the iteration stopped.
+  template <class OperatorT, class PreconditionerT, class VectorT>
+  int preconditioned_conjugate_gradient( OperatorT const& A,
+                                         PreconditionerT const& M,
+                                         VectorT const& b, VectorT& x,
+                                         double tolerance, int max_iterations,
+                                         PCGStatus* status = 0 ) {
+    double b_norm = norm_2(b);
+    if ( b_norm == 0 ) {
+      x = b;
+      if ( status )
+        *status = PCG_CONVERGED;
+      return 0;
+    }
+    double threshold = tolerance * b_norm;
+
+    VectorT r = b - A(x);
+    VectorT z = M(r);
+    VectorT p = z;
+    double rz = dot_prod(r,z);
+
+    PCGStatus result = PCG_MAX_ITERATIONS;
+    int i = 0;
+    for ( ; i < max_iterations; ++i ) {
+      if ( norm_2(r) <= threshold )
+        break;
+      VectorT Ap = A(p);
+      double pAp = dot_prod(p,Ap);
+      if ( !(pAp > 0) ) {
+        VW_OUT(DebugMessage, "math") << "PCG: operator is not positive definite, stopping at step "
+                                     << i << std::endl;
+        result = PCG_NOT_POSITIVE_DEFINITE;
+        break;
+      }
+      double alpha = rz / pAp;
+      x += alpha * p;
+      r -= alpha * Ap;
+      z = M(r);
+      double rz_new = dot_prod(r,z);
+      p = z + (rz_new/rz) * p;
+      rz = rz_new;
+    }
+    // The last step may have been the one that converged
+    if ( result != PCG_NOT_POSITIVE_DEFINITE && norm_2(r) <= threshold )
+      result = PCG_CONVERGED;
+    VW_OUT(DebugMessage, "math") << "PCG: " << i << " iterations, residual "
+                                 << norm_2(r) << std::endl;
+    if ( status )
+      *status = result;
+    return i;
+  }
+
 } } // namespace vw::math
 
 #endif // #ifndef __VW_MATH_CONJUGATEGRADIENT_H__
@@ -0,0 +1,623 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file MatrixSparseBlock.h
+///
+/// Provides a block compressed sparse row matrix for symmetric
+/// systems made of fixed size square blocks, like the reduced camera
+/// system in bundle adjustment. Unlike MatrixSparseSkyline, the
+/// nonzero structure is declared up front and stored contiguously,
+/// and the symbolic analysis of the factorization (fill reducing
+/// ordering and the structure of L) is kept with the matrix so that
+/// it can be reused every time only the values change.
+///
+
+#ifndef __VW_MATH_SPARSE_BLOCK_MATRIX_H__
+#define __VW_MATH_SPARSE_BLOCK_MATRIX_H__
+
+// Standard
+#include <vector>
+#include <set>
+#include <algorithm>
+
+// Vision Workbench
+#include <vw/Core/Log.h>
+#include <vw/Math/Vector.h>
+#include <vw/Math/Matrix.h>
+
+// Boost
+#include <boost/shared_ptr.hpp>
+#include <boost/graph/adjacency_list.hpp>
+#include <boost/graph/minimum_degree_ordering.hpp>
+
+namespace vw {
+namespace math {
+
+  //------------------------------------------------------------------
+  //                 Symbolic Block Factorization
+  //
+  // Everything about the block LDL^T factorization that depends only
+  // on the nonzero structure of the matrix: the fill reducing
+  // ordering and the block structure of L, stored by column in
+  // permuted indices.
+  //------------------------------------------------------------------
+  struct SparseBlockSymbolic {
+    std::vector<size_t> order;    // order[k] = original block eliminated k-th
+    std::vector<size_t> position; // position[order[k]] = k
+    std::vector<size_t> L_col_ptr; // Block column k of L is
+    std::vector<size_t> L_row_idx; // L_row_idx[L_col_ptr[k]..L_col_ptr[k+1]), sorted
+
+    // For every stored block of A, where it lands in the factor:
+    // -1 for the diagonal, otherwise the index of its L slot.
+    std::vector<ssize_t> A_to_L;
+    std::vector<bool> A_transposed;
+
+    size_t nonzero_blocks() const { return L_row_idx.size(); }
+  };
+
+  //------------------------------------------------------------------
+  //                 Sparse Block Matrix
+  //
+  // A symmetric matrix of BlockN x BlockN blocks. Only the lower
+  // triangle (including the diagonal) is stored, in block compressed
+  // sparse row form. Use:
+  //
+  //   MatrixSparseBlock<double,6> S(num_cameras);
+  //   S.add_block(k,j);   // declare every nonzero block once
+  //   S.compress();       // freeze the structure
+  //   S.block(k,j) = ...; // fill, k >= j
+  //   x = sparse_solve(S, b);
+  //
+  // set_zero() clears the values but keeps the structure and its
+  // symbolic analysis, so repeated solves only pay for the numeric
+  // factorization.
+  //------------------------------------------------------------------
+  template <class ElemT, size_t BlockN>
+  class MatrixSparseBlock : public MatrixBase<MatrixSparseBlock<ElemT,BlockN> > {
+  public:
+    typedef Matrix<ElemT,BlockN,BlockN> block_type;
+    typedef Vector<ElemT,BlockN> block_vector_type;
+
+  private:
+    size_t m_block_rows;
+    std::vector< std::set<size_t> > m_declared;
+    bool m_compressed;
+
+    // Block CSR storage of the lower triangle
+    std::vector<size_t> m_row_ptr;
+    std::vector<size_t> m_col_idx;
+    std::vector<block_type> m_blocks;
+
+    // Factorization
+    boost::shared_ptr<SparseBlockSymbolic> m_symbolic;
+    std::vector<block_type> m_L, m_D_inverse;
+    bool m_factored;
+
+    ElemT m_zero;
+
+    ssize_t find_block( size_t i, size_t j ) const {
+      std::vector<size_t>::const_iterator begin = m_col_idx.begin() + m_row_ptr[i];
+      std::vector<size_t>::const_iterator end   = m_col_idx.begin() + m_row_ptr[i+1];
+      std::vector<size_t>::const_iterator it = std::lower_bound( begin, end, j );
+      if ( it == end || *it != j )
+        return -1;
+      return it - m_col_idx.begin();
+    }
+
+  public:
+    /// Common Definitions
+    typedef ElemT value_type;
+    typedef ElemT& reference_type;
+    typedef ElemT const& const_reference_type;
+    typedef IndexingMatrixIterator<MatrixSparseBlock<ElemT,BlockN> > iterator;
+    typedef IndexingMatrixIterator<const MatrixSparseBlock<ElemT,BlockN> > const_iterator;
+
+    /// Constructors
+    MatrixSparseBlock() : m_block_rows(0), m_compressed(false),
+                          m_factored(false), m_zero(0) {
+      m_row_ptr.push_back(0);
+    }
+
+    MatrixSparseBlock( size_t block_rows ) :
+      m_block_rows(block_rows), m_declared(block_rows),
+      m_compressed(false), m_factored(false), m_zero(0) {
+      // The diagonal is always part of the structure
+      for ( size_t i = 0; i < block_rows; ++i )
+        m_declared[i].insert(i);
+    }
+
+    /// Declare block (i,j) (and by symmetry (j,i)) as nonzero
+    void add_block( size_t i, size_t j ) {
+      VW_ASSERT( i < m_block_rows && j < m_block_rows,
+                 ArgumentErr() << "MatrixSparseBlock::add_block: block index out of range." );
+      if ( j > i )
+        std::swap(i,j);
+      if ( m_compressed ) {
+        if ( find_block(i,j) >= 0 )
+          return;
+        // Reopen the structure, keeping the existing blocks declared
+        m_declared.resize( m_block_rows );
+        for ( size_t r = 0; r < m_block_rows; ++r )
+          m_declared[r].insert( m_col_idx.begin() + m_row_ptr[r],
+                                m_col_idx.begin() + m_row_ptr[r+1] );
+        m_compressed = false;
+      }
+      m_declared[i].insert(j);
+    }
+
+    /// Freeze the declared structure into compressed storage. All
+    /// values are set to zero and any previous symbolic analysis is
+    /// discarded.
+    void compress() {
+      if ( m_compressed )
+        return;
+      m_row_ptr.resize( m_block_rows+1 );
+      m_col_idx.clear();
+      m_row_ptr[0] = 0;
+      for ( size_t i = 0; i < m_block_rows; ++i ) {
+        m_col_idx.insert( m_col_idx.end(), m_declared[i].begin(), m_declared[i].end() );
+        m_row_ptr[i+1] = m_col_idx.size();
+      }
+      m_blocks.clear();
+      m_blocks.resize( m_col_idx.size() );
+      std::vector< std::set<size_t> >().swap( m_declared );
+      m_symbolic.reset();
+      m_factored = false;
+      m_compressed = true;
+    }
+
+    /// Zero all values while keeping structure and symbolic analysis
+    void set_zero() {
+      VW_ASSERT( m_compressed, LogicErr() << "MatrixSparseBlock must be compressed first." );
+      std::fill( m_blocks.begin(), m_blocks.end(), block_type() );
+      m_factored = false;
+    }
+
+    /// Simple Access
+    size_t rows() const { return m_block_rows*BlockN; }
+    size_t cols() const { return m_block_rows*BlockN; }
+    size_t block_rows() const { return m_block_rows; }
+    size_t block_size() const { return BlockN; }
+    size_t nonzero_blocks() const { return m_blocks.size(); }
+    bool compressed() const { return m_compressed; }
+
+    void set_size( size_t /*new_rows*/, size_t /*new_cols*/, bool /*preserve*/ = false ) {
+      vw_throw( NoImplErr() << "MatrixSparseBlock::set_size, code has not been written yet." );
+    }
+
+    /// Is (i,j) part of the structure?
+    bool has_block( size_t i, size_t j ) const {
+      VW_ASSERT( m_compressed, LogicErr() << "MatrixSparseBlock must be compressed first." );
+      if ( j > i )
+        std::swap(i,j);
+      return find_block(i,j) >= 0;
+    }
+
+    /// Block access, only for the stored lower triangle (i >= j)
+    block_type& block( size_t i, size_t j ) {
+      VW_ASSERT( m_compressed, LogicErr() << "MatrixSparseBlock must be compressed first." );
+      VW_ASSERT( i >= j, ArgumentErr() << "MatrixSparseBlock::block: only the lower triangle is stored." );
+      ssize_t idx = find_block(i,j);
+      if ( idx < 0 )
+        vw_throw( LogicErr() << "MatrixSparseBlock::block: (" << i << "," << j
+                  << ") is not part of the structure." );
+      m_factored = false;
+      return m_blocks[idx];
+    }
+    block_type const& block( size_t i, size_t j ) const {
+      VW_ASSERT( m_compressed, LogicErr() << "MatrixSparseBlock must be compressed first." );
+      VW_ASSERT( i >= j, ArgumentErr() << "MatrixSparseBlock::block: only the lower triangle is stored." );
+      ssize_t idx = find_block(i,j);
+      if ( idx < 0 )
+        vw_throw( LogicErr() << "MatrixSparseBlock::block: (" << i << "," << j
+                  << ") is not part of the structure." );
+      return m_blocks[idx];
+    }
+
+    /// Element Access. Writes must land inside a declared block.
+    reference_type operator()( size_t row, size_t col ) {
+      if ( col > row )
+        std::swap(row,col);
+      return block( row/BlockN, col/BlockN )( row%BlockN, col%BlockN );
+    }
+    const_reference_type operator()( size_t row, size_t col ) const {
+      if ( col > row )
+        std::swap(row,col);
+      ssize_t idx = find_block( row/BlockN, col/BlockN );
+      if ( idx < 0 )
+        return m_zero;
+      return m_blocks[idx]( row%BlockN, col%BlockN );
+    }
+
+    /// Pointer Access
+    value_type *data() {
+      vw_throw( NoImplErr() << "MatrixSparseBlock::data can not provide direct pointer access.");
+      return 0;
+    }
+    iterator begin() { return iterator(*this,0,0); }
+    const_iterator begin() const { return const_iterator(*this,0,0); }
+    iterator end() { return iterator(*this,rows(),0); }
+    const_iterator end() const { return const_iterator(*this,rows(),0); }
+
+    /// Raw compressed storage
+    std::vector<size_t> const& row_ptr() const { return m_row_ptr; }
+    std::vector<size_t> const& col_index() const { return m_col_idx; }
+    std::vector<block_type> const& blocks() const { return m_blocks; }
+
+    /// Factorization state
+    boost::shared_ptr<SparseBlockSymbolic> symbolic() const { return m_symbolic; }
+    void set_symbolic( boost::shared_ptr<SparseBlockSymbolic> symbolic ) {
+      m_symbolic = symbolic; m_factored = false;
+    }
+    bool factored() const { return m_factored; }
+    std::vector<block_type> const& L_blocks() const { return m_L; }
+    std::vector<block_type> const& D_inverse_blocks() const { return m_D_inverse; }
+
+    // Used by sparse_ldl_decomposition
+    void set_factor( std::vector<block_type>& L, std::vector<block_type>& D_inverse ) {
+      m_L.swap( L );
+      m_D_inverse.swap( D_inverse );
+      m_factored = true;
+    }
+  };
+
+  /// Dump for MatrixSparseBlock, one character per block
+  template <class ElemT, size_t BlockN>
+  inline std::ostream& operator<<( std::ostream& os, MatrixSparseBlock<ElemT,BlockN> const& m ) {
+    os << "MatrixSparseBlock" << m.rows() << "x" << m.cols() << "@" << BlockN << "\n";
+    for ( size_t i = 0; i < m.block_rows(); i++ ) {
+      for ( size_t j = 0; j < m.block_rows(); j++ )
+        os << ( m.has_block(i,j) ? "#" : "." );
+      os << "\n";
+    }
+    return os;
+  }
+
+  //------------------------------------------------------------------
+  // Minimum Degree Ordering
+  //
+  // Computes a fill reducing elimination order of the block graph
+  // with Boost's multiple minimum degree algorithm. The result is
+  // order[k] = block eliminated k-th.
+  //------------------------------------------------------------------
+  template <class ElemT, size_t BlockN>
+  std::vector<size_t> minimum_degree_ordering( MatrixSparseBlock<ElemT,BlockN> const& A ) {
+    typedef boost::adjacency_list<boost::vecS, boost::vecS, boost::directedS> Graph;
+    size_t n = A.block_rows();
+    Graph G( n );
+    std::vector<size_t> const& row_ptr = A.row_ptr();
+    std::vector<size_t> const& col_idx = A.col_index();
+    for ( size_t i = 0; i < n; i++ )
+      for ( size_t k = row_ptr[i]; k < row_ptr[i+1]; k++ )
+        if ( col_idx[k] != i ) {
+          boost::add_edge( i, col_idx[k], G );
+          boost::add_edge( col_idx[k], i, G );
+        }
+
+    std::vector<int> inverse_perm(n, 0), perm(n, 0), degree(n, 0), supernode_sizes(n, 1);
+    boost::property_map<Graph, boost::vertex_index_t>::type id = get(boost::vertex_index, G);
+    if ( n > 0 )
+      boost::minimum_degree_ordering( G,
+                                      make_iterator_property_map(&degree[0], id, degree[0]),
+                                      &inverse_perm[0], &perm[0],
+                                      make_iterator_property_map(&supernode_sizes[0], id, supernode_sizes[0]),
+                                      0, id );
+
+    std::vector<size_t> order( n );
+    for ( size_t k = 0; k < n; k++ )
+      order[k] = perm[k];
+    return order;
+  }
+
+  //------------------------------------------------------------------
+  // Symbolic Analysis
+  //
+  // Given an elimination order, computes the block structure of L
+  // with the elimination tree and the map from the blocks of A into
+  // the factor. The ordering defaults to minimum_degree_ordering.
+  //------------------------------------------------------------------
+  template <class ElemT, size_t BlockN>
+  boost::shared_ptr<SparseBlockSymbolic>
+  sparse_block_symbolic( MatrixSparseBlock<ElemT,BlockN> const& A,
+                         std::vector<size_t> const& order ) {
+    VW_ASSERT( A.compressed(), LogicErr() << "MatrixSparseBlock must be compressed first." );
+    size_t n = A.block_rows();
+    VW_ASSERT( order.size() == n, ArgumentErr() << "sparse_block_symbolic: ordering has the wrong size." );
+
+    boost::shared_ptr<SparseBlockSymbolic> sym( new SparseBlockSymbolic );
+    sym->order = order;
+    sym->position.resize( n );
+    for ( size_t k = 0; k < n; k++ )
+      sym->position[order[k]] = k;
+
+    std::vector<size_t> const& row_ptr = A.row_ptr();
+    std::vector<size_t> const& col_idx = A.col_index();
+
+    // Structure of A below the diagonal, by permuted column
+    std::vector< std::vector<size_t> > structure( n );
+    for ( size_t i = 0; i < n; i++ )
+      for ( size_t k = row_ptr[i]; k < row_ptr[i+1]; k++ ) {
+        size_t p = sym->position[i], q = sym->position[col_idx[k]];
+        if ( p > q )
+          structure[q].push_back(p);
+        else if ( q > p )
+          structure[p].push_back(q);
+      }
+
+    // Symbolic elimination: the structure of column k of L is its
+    // structure in A merged with that of its children in the
+    // elimination tree.
+    std::vector< std::vector<size_t> > children( n );
+    sym->L_col_ptr.resize( n+1 );
+    sym->L_col_ptr[0] = 0;
+    std::vector< std::vector<size_t> > L_cols( n );
+    for ( size_t k = 0; k < n; k++ ) {
+      std::set<size_t> rows( structure[k].begin(), structure[k].end() );
+      for ( size_t c = 0; c < children[k].size(); c++ ) {
+        std::vector<size_t> const& child = L_cols[ children[k][c] ];
+        for ( size_t r = 0; r < child.size(); r++ )
+          if ( child[r] > k )
+            rows.insert( child[r] );
+      }
+      L_cols[k].assign( rows.begin(), rows.end() );
+      if ( !L_cols[k].empty() )
+        children[ L_cols[k].front() ].push_back(k);
+    }
+    for ( size_t k = 0; k < n; k++ ) {
+      sym->L_row_idx.insert( sym->L_row_idx.end(), L_cols[k].begin(), L_cols[k].end() );
+      sym->L_col_ptr[k+1] = sym->L_row_idx.size();
+    }
+
+    // Where every block of A goes in the factor
+    sym->A_to_L.resize( col_idx.size() );
+    sym->A_transposed.resize( col_idx.size() );
+    for ( size_t i = 0; i < n; i++ )
+      for ( size_t k = row_ptr[i]; k < row_ptr[i+1]; k++ ) {
+        size_t p = sym->position[i], q = sym->position[col_idx[k]];
+        sym->A_transposed[k] = p < q;
+        if ( p == q ) {
+          sym->A_to_L[k] = -1;
+          continue;
+        }
+        if ( p < q )
+          std::swap(p,q);
+        std::vector<size_t>::const_iterator begin = sym->L_row_idx.begin() + sym->L_col_ptr[q];
+        std::vector<size_t>::const_iterator end   = sym->L_row_idx.begin() + sym->L_col_ptr[q+1];
+        sym->A_to_L[k] = std::lower_bound( begin, end, p ) - sym->L_row_idx.begin();
+      }
+
+    VW_OUT(DebugMessage,"math") << "-> Sparse block symbolic: " << col_idx.size()
+                                << " blocks in A, " << sym->L_row_idx.size() + n
+                                << " blocks in L+D\n";
+    return sym;
+  }
+
+  template <class ElemT, size_t BlockN>
+  boost::shared_ptr<SparseBlockSymbolic>
+  sparse_block_symbolic( MatrixSparseBlock<ElemT,BlockN> const& A ) {
+    return sparse_block_symbolic( A, minimum_degree_ordering(A) );
+  }
+
+  //--------------------------------------------------------------------
+  //        Block L*D*L^T Decompostion for Symmetric Sparse Matrices
+  //--------------------------------------------------------------------
+
+  // Computes P*A*P^T = L*D*L^T where L is unit block lower triangular
+  // and D is block diagonal. The symbolic analysis is computed on the
+  // first call and reused afterwards. Unlike the skyline version the
+  // values of A are left untouched; the factor is stored alongside
+  // them.
+  template <class ElemT, size_t BlockN>
+  void sparse_ldl_decomposition( MatrixSparseBlock<ElemT,BlockN>& A ) {
+    typedef typename MatrixSparseBlock<ElemT,BlockN>::block_type block_type;
+
+    if ( !A.symbolic() )
+      A.set_symbolic( sparse_block_symbolic(A) );
+    SparseBlockSymbolic const& sym = *A.symbolic();
+    size_t n = A.block_rows();
+
+    // Scatter A into the factor storage
+    std::vector<block_type> L( sym.L_row_idx.size() ), D( n ), D_inverse( n );
+    std::vector<size_t> const& row_ptr = A.row_ptr();
+    std::vector<block_type> const& blocks = A.blocks();
+    for ( size_t i = 0; i < n; i++ )
+      for ( size_t k = row_ptr[i]; k < row_ptr[i+1]; k++ ) {
+        if ( sym.A_to_L[k] < 0 )
+          D[ sym.position[i] ] += blocks[k];
+        else if ( sym.A_transposed[k] )
+          L[ sym.A_to_L[k] ] += transpose( blocks[k] );
+        else
+          L[ sym.A_to_L[k] ] += blocks[k];
+      }
+
+    // Right looking factorization, one block column at a time
+    std::vector<block_type> LD; // L(:,k)*D(k) for the current column
+    for ( size_t k = 0; k < n; k++ ) {
+      try {
+        D_inverse[k] = inverse( D[k] );
+      } catch ( const MathErr& ) {
+        VW_OUT(DebugMessage,"math") << "-> Sparse block LDL: singular pivot block " << k << "\n";
+        D_inverse[k] = block_type();
+      }
+
+      size_t begin = sym.L_col_ptr[k], end = sym.L_col_ptr[k+1];
+      LD.resize( end - begin );
+      for ( size_t a = begin; a < end; a++ ) {
+        LD[a-begin] = L[a];
+        L[a] = LD[a-begin] * D_inverse[k];
+      }
+
+      // Schur update of the trailing submatrix: A_ij -= L_ik D_k L_jk^T
+      for ( size_t b = begin; b < end; b++ ) {
+        size_t j = sym.L_row_idx[b];
+        D[j] -= L[b] * transpose( LD[b-begin] );
+        size_t slot = sym.L_col_ptr[j];
+        for ( size_t a = b+1; a < end; a++ ) {
+          size_t i = sym.L_row_idx[a];
+          while ( sym.L_row_idx[slot] < i )
+            slot++;
+          L[slot] -= L[a] * transpose( LD[b-begin] );
+        }
+      }
+    }
+
+    A.set_factor( L, D_inverse );
+  }
+
+  //-------------------------------------------------------------------
+  //            Solve Sparse Block Linear System: Ax=b Given LDL^T
+  //-------------------------------------------------------------------
+
+  /// Assumes A has already been through sparse_ldl_decomposition
+  template <class ElemT, size_t BlockN, class VectorT>
+  Vector<ElemT> sparse_solve_ldl( MatrixSparseBlock<ElemT,BlockN>& A, VectorT const& b ) {
+    typedef typename MatrixSparseBlock<ElemT,BlockN>::block_vector_type block_vector_type;
+    VW_ASSERT( A.factored(), LogicErr() << "sparse_solve_ldl: matrix has not been decomposed.\n" );
+    VW_ASSERT( b.size() == A.rows(), ArgumentErr() << "sparse_solve_ldl: b has the wrong size.\n" );
+
+    SparseBlockSymbolic const& sym = *A.symbolic();
+    size_t n = A.block_rows();
+
+    // Permute
+    std::vector<block_vector_type> y( n );
+    for ( size_t k = 0; k < n; k++ )
+      y[k] = subvector( b, sym.order[k]*BlockN, BlockN );
+
+    // Forward Substitution Step ( L*y'=y )
+    for ( size_t k = 0; k < n; k++ )
+      for ( size_t a = sym.L_col_ptr[k]; a < sym.L_col_ptr[k+1]; a++ )
+        y[ sym.L_row_idx[a] ] -= A.L_blocks()[a] * y[k];
+
+    // Divide by D ( D*y''=y' )
+    for ( size_t k = 0; k < n; k++ )
+      y[k] = A.D_inverse_blocks()[k] * y[k];
+
+    // Back Substitution step ( L^T*x=y'' )
+    for ( ssize_t k = n-1; k >= 0; k-- )
+      for ( size_t a = sym.L_col_ptr[k]; a < sym.L_col_ptr[k+1]; a++ )
+        y[k] -= transpose( A.L_blocks()[a] ) * y[ sym.L_row_idx[a] ];
+
+    // Undo permutation
+    Vector<ElemT> x( A.rows() );
+    for ( size_t k = 0; k < n; k++ )
+      subvector( x, sym.order[k]*BlockN, BlockN ) = y[k];
+    return x;
+  }
+
+  //--------------------------------------------------------------
+  //            Solve Sparse Block Linear System: Ax=b
+  //--------------------------------------------------------------
+
+  /// Decomposes A (reusing its symbolic analysis) and solves. The
+  /// values of A are preserved.
+  template <class ElemT, size_t BlockN, class VectorT>
+  Vector<ElemT> sparse_solve( MatrixSparseBlock<ElemT,BlockN>& A, VectorT const& b ) {
+    sparse_ldl_decomposition( A );
+    return sparse_solve_ldl( A, b );
+  }
+
+  /// Solves AX=B where X and B are matrices
+  template <class ElemT, size_t BlockN, class BMatrixT>
+  Matrix<typename PromoteType<typename BMatrixT::value_type, typename BMatrixT::value_type>::type>
+  multi_sparse_solve( MatrixSparseBlock<ElemT,BlockN>& A, BMatrixT & B ) {
+    VW_ASSERT(A.rows() == B.rows(), ArgumentErr() << "multi_sparse_solve: AX=B means A, B have same # of rows.\n");
+
+    Matrix<double> X(B.rows(), B.cols());
+    Vector<double> current_col(A.cols());
+
+    sparse_ldl_decomposition( A );
+    for(size_t i = 0; i < B.cols(); i++){
+      current_col = select_col(B, i);
+      select_col(X, i) = sparse_solve_ldl(A, current_col);
+    }
+    return X;
+  }
+
+  //-------------------------------------------------------------------
+  //            Selected Inversion
+  //
+  // Computes the diagonal blocks of inverse(A) from the LDL^T factors
+  // without forming the rest of the inverse. With Z = inverse(P*A*P^T)
+  // the Takahashi equations
+  //
+  //   Z_ik = -sum_j( Z_ij * L_jk )                 i in struct(L(:,k))
+  //   Z_kk = inverse(D_k) - sum_j( L_jk^T * Z_jk )
+  //
+  // only ever reference Z inside the structure of L, so walking the
+  // columns backwards costs about as much as the factorization and
+  // needs memory proportional to the factor.
+  //-------------------------------------------------------------------
+
+  /// Returns the diagonal blocks of inverse(A), in the original
+  /// order. A is decomposed first if it hasn't been already.
+  template <class ElemT, size_t BlockN>
+  std::vector<typename MatrixSparseBlock<ElemT,BlockN>::block_type>
+  sparse_selected_inverse( MatrixSparseBlock<ElemT,BlockN>& A ) {
+    typedef typename MatrixSparseBlock<ElemT,BlockN>::block_type block_type;
+
+    if ( !A.factored() )
+      sparse_ldl_decomposition( A );
+    SparseBlockSymbolic const& sym = *A.symbolic();
+    std::vector<block_type> const& L = A.L_blocks();
+    std::vector<block_type> const& D_inverse = A.D_inverse_blocks();
+    size_t n = A.block_rows();
+
+    // Z inside the structure of L (stored like L) and on the diagonal
+    std::vector<block_type> Z_lower( L.size() ), Z_diag( n );
+
+    for ( ssize_t k = n-1; k >= 0; k-- ) {
+      size_t begin = sym.L_col_ptr[k], end = sym.L_col_ptr[k+1];
+
+      // Z_ik for every i in the column. Z_ij with both i and j in the
+      // column is in the structure since struct(L(:,k)) is a clique.
+      for ( size_t a = begin; a < end; a++ ) {
+        size_t i = sym.L_row_idx[a];
+        block_type sum;
+        for ( size_t b = begin; b < end; b++ ) {
+          size_t j = sym.L_row_idx[b];
+          if ( i == j ) {
+            sum += Z_diag[i] * L[b];
+          } else {
+            size_t lo = std::min(i,j), hi = std::max(i,j);
+            std::vector<size_t>::const_iterator col_begin = sym.L_row_idx.begin() + sym.L_col_ptr[lo];
+            std::vector<size_t>::const_iterator col_end   = sym.L_row_idx.begin() + sym.L_col_ptr[lo+1];
+            size_t slot = std::lower_bound( col_begin, col_end, hi ) - sym.L_row_idx.begin();
+            if ( i > j )
+              sum += Z_lower[slot] * L[b];
+            else
+              sum += transpose( Z_lower[slot] ) * L[b];
+          }
+        }
+        Z_lower[a] = -sum;
+      }
+
+      Z_diag[k] = D_inverse[k];
+      for ( size_t a = begin; a < end; a++ )
+        Z_diag[k] -= transpose( L[a] ) * Z_lower[a];
+    }
+
+    // Undo permutation
+    std::vector<block_type> result( n );
+    for ( size_t k = 0; k < n; k++ )
+      result[ sym.order[k] ] = Z_diag[k];
+    return result;
+  }
+
+}} // namespace vw::math
+
+#endif//__VW_MATH_SPARSE_BLOCK_MATRIX_H__
@@ -0,0 +1,200 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+/// \file RTree.h
+///
+/// A static R-tree for finding which of a set of bounding boxes
+/// intersect a query box.
+///
+/// The tree is bulk loaded with the Sort-Tile-Recursive algorithm from
+/// "STR: A Simple and Efficient Algorithm for R-Tree Packing,"
+/// Leutenegger, Lopez & Edgington 1997, so all nodes but the last of
+/// each level are full and siblings overlap little.  It can't be
+/// modified once built; call build() again if the boxes change.
+///
+#ifndef __VW_MATH_RTREE_H__
+#define __VW_MATH_RTREE_H__
+
+#include <vw/Core/Exception.h>
+#include <vw/Math/BBox.h>
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+#include <vector>
+
+namespace vw {
+namespace math {
+
+  template <class RealT, size_t DimN>
+  class RTree {
+  public:
+    typedef BBox<RealT, DimN> box_type;
+
+    RTree( size_t fanout = 16 ) : m_fanout(fanout), m_size(0) {
+      VW_ASSERT( fanout > 1, ArgumentErr() << "RTree: fanout must be at least 2." );
+    }
+
+    RTree( std::vector<box_type> const& boxes, size_t fanout = 16 ) : m_fanout(fanout), m_size(0) {
+      VW_ASSERT( fanout > 1, ArgumentErr() << "RTree: fanout must be at least 2." );
+      build( boxes );
+    }
+
+    /// Index 'boxes', replacing whatever was indexed before. Empty
+    /// boxes are left out, since they don't intersect anything.
+    void build( std::vector<box_type> const& boxes );
+
+    /// Number of boxes in the tree.
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+
+    /// Find the boxes that intersect 'box' (in the sense of
+    /// BBox::intersects).  'result' is set to their indices in the
+    /// vector given to build(), in increasing order.
+    void intersecting( box_type const& box, std::vector<size_t>& result ) const;
+
+  private:
+    struct Item {
+      box_type box;
+      size_t   index;
+      Item( box_type const& box, size_t index ) : box(box), index(index) {}
+    };
+
+    // Children of a node are [first, first+count) in the level below,
+    // or in m_items for a leaf.
+    struct Node {
+      box_type box;
+      size_t   first, count;
+    };
+
+    class CenterLess {
+      size_t m_dim;
+    public:
+      CenterLess( size_t dim ) : m_dim(dim) {}
+      bool operator()( Item const& a, Item const& b ) const {
+        return a.box.min()[m_dim] + a.box.max()[m_dim] < b.box.min()[m_dim] + b.box.max()[m_dim];
+      }
+    };
+
+    void tile( typename std::vector<Item>::iterator begin,
+               typename std::vector<Item>::iterator end, size_t dim ) const;
+    void pack( std::vector<Item>& items, std::vector<Node>& nodes ) const;
+
+    size_t                          m_fanout, m_size;
+    std::vector<Item>               m_items;
+    std::vector<std::vector<Node> > m_levels; ///< Leaves first, the root last
+  };
+
+
+  // Sort-Tile-Recursive ordering: sort along one dimension, cut into
+  // slabs, and order each slab along the remaining dimensions, so that
+  // every run of m_fanout items is compact.
+  template <class RealT, size_t DimN>
+  void RTree<RealT, DimN>::tile( typename std::vector<Item>::iterator begin,
+                                 typename std::vector<Item>::iterator end, size_t dim ) const {
+    size_t count = end - begin;
+    if ( count <= m_fanout )
+      return;
+    std::sort( begin, end, CenterLess(dim) );
+    if ( dim + 1 == DimN )
+      return;
+
+    size_t pages = (count + m_fanout - 1) / m_fanout;
+    size_t slabs = size_t( std::ceil( std::pow( double(pages), 1.0 / double(DimN - dim) ) ) );
+    size_t slab_size = m_fanout * ( (pages + slabs - 1) / slabs );
+    for ( size_t i = 0; i < count; i += slab_size )
+      tile( begin + i, begin + std::min( i + slab_size, count ), dim + 1 );
+  }
+
+  // Order 'items' and group them into nodes of m_fanout.
+  template <class RealT, size_t DimN>
+  void RTree<RealT, DimN>::pack( std::vector<Item>& items, std::vector<Node>& nodes ) const {
+    tile( items.begin(), items.end(), 0 );
+    nodes.clear();
+    for ( size_t i = 0; i < items.size(); i += m_fanout ) {
+      Node node;
+      node.first = i;
+      node.count = std::min( m_fanout, items.size() - i );
+      node.box = items[i].box;
+      for ( size_t j = 1; j < node.count; j++ )
+        node.box.grow( items[i+j].box );
+      nodes.push_back( node );
+    }
+  }
+
+  template <class RealT, size_t DimN>
+  void RTree<RealT, DimN>::build( std::vector<box_type> const& boxes ) {
+    m_items.clear();
+    m_levels.clear();
+    for ( size_t i = 0; i < boxes.size(); i++ )
+      if ( !boxes[i].empty() )
+        m_items.push_back( Item( boxes[i], i ) );
+    m_size = m_items.size();
+    if ( m_items.empty() )
+      return;
+
+    m_levels.push_back( std::vector<Node>() );
+    pack( m_items, m_levels.back() );
+    while ( m_levels.back().size() > 1 ) {
+      // Pack the nodes of the last level as items, then put them in
+      // that order so each parent's children are contiguous.
+      std::vector<Node>& children = m_levels.back();
+      std::vector<Item> items;
+      for ( size_t i = 0; i < children.size(); i++ )
+        items.push_back( Item( children[i].box, i ) );
+      std::vector<Node> parents;
+      pack( items, parents );
+
+      std::vector<Node> ordered( children.size() );
+      for ( size_t i = 0; i < items.size(); i++ )
+        ordered[i] = children[items[i].index];
+      children.swap( ordered );
+      m_levels.push_back( std::vector<Node>() );
+      m_levels.back().swap( parents );
+    }
+  }
+
+  template <class RealT, size_t DimN>
+  void RTree<RealT, DimN>::intersecting( box_type const& box, std::vector<size_t>& result ) const {
+    result.clear();
+    if ( m_levels.empty() )
+      return;
+
+    std::vector<std::pair<size_t, size_t> > stack; // (level, node)
+    stack.push_back( std::make_pair( m_levels.size() - 1, size_t(0) ) );
+    while ( !stack.empty() ) {
+      size_t level = stack.back().first;
+      Node const& node = m_levels[level][stack.back().second];
+      stack.pop_back();
+      if ( !node.box.intersects( box ) )
+        continue;
+      if ( level == 0 ) {
+        for ( size_t i = node.first; i < node.first + node.count; i++ )
+          if ( m_items[i].box.intersects( box ) )
+            result.push_back( m_items[i].index );
+      } else {
+        for ( size_t i = node.first; i < node.first + node.count; i++ )
+          stack.push_back( std::make_pair( level - 1, i ) );
+      }
+    }
+    std::sort( result.begin(), result.end() );
+  }
+
+}} // namespace vw::math
+
+#endif // __VW_MATH_RTREE_H__
@@ -19,7 +19,9 @@
 // TestConjugateGradient.h
 #include <gtest/gtest_VW.h>
 #include <vw/Math/Vector.h>
+#include <vw/Math/Matrix.h>
 #include <vw/Math/ConjugateGradient.h>
+#include <test/Helpers.h>
 
 using namespace vw;
 using namespace vw::math;
@@ -62,3 +64,78 @@ TEST( ConjugateGradient, ConjugateGradient ) {
   EXPECT_NEAR(result[0], 0.1962, 1e-3);
   EXPECT_NEAR(result[1], 0.4846, 1e-3);
 }
+
+// Symmetric positive definite operator used by the linear solver tests.
+struct SPDOperator {
+  Matrix<double> m_A;
+  SPDOperator() : m_A(3,3) {
+    m_A(0,0) = 4;  m_A(0,1) = 1;  m_A(0,2) = 0;
+    m_A(1,0) = 1;  m_A(1,1) = 3;  m_A(1,2) = -1;
+    m_A(2,0) = 0;  m_A(2,1) = -1; m_A(2,2) = 5;
+  }
+  Vector<double> operator()( Vector<double> const& x ) const { return m_A * x; }
+};
+
+struct JacobiPreconditioner {
+  SPDOperator const& m_op;
+  JacobiPreconditioner( SPDOperator const& op ) : m_op(op) {}
+  Vector<double> operator()( Vector<double> const& r ) const {
+    Vector<double> z(r.size());
+    for ( size_t i = 0; i < r.size(); i++ )
+      z[i] = r[i] / m_op.m_A(i,i);
+    return z;
+  }
+};
+
+TEST( ConjugateGradient, LinearCG ) {
+  SPDOperator A;
+  Vector<double> b(3), x(3);
+  b[0] = 1; b[1] = 2; b[2] = 3;
+  int iterations = preconditioned_conjugate_gradient( A, IdentityPreconditioner(), b, x, 1e-12, 10 );
+  EXPECT_LE( iterations, 3 );
+  EXPECT_VECTOR_NEAR( A(x), b, 1e-9 );
+}
+
+TEST( ConjugateGradient, PreconditionedCG ) {
+  SPDOperator A;
+  Vector<double> b(3), x(3);
+  b[0] = -2; b[1] = 0.5; b[2] = 7;
+  int iterations = preconditioned_conjugate_gradient( A, JacobiPreconditioner(A), b, x, 1e-12, 10 );
+  EXPECT_LE( iterations, 3 );
+  EXPECT_VECTOR_NEAR( A(x), b, 1e-9 );
+
+  // A zero right hand side is solved without iterating
+  Vector<double> zero(3), x0(3);
+  EXPECT_EQ( 0, preconditioned_conjugate_gradient( A, JacobiPreconditioner(A), zero, x0, 1e-12, 10 ) );
+  EXPECT_VECTOR_NEAR( x0, zero, 1e-12 );
+}
+
+struct NegatedOperator {
+  SPDOperator m_op;
+  Vector<double> operator()( Vector<double> const& x ) const { return -m_op(x); }
+};
+
+TEST( ConjugateGradient, PCGStatus ) {
+  SPDOperator A;
+  Vector<double> b(3);
+  b[0] = 1; b[1] = 2; b[2] = 3;
+
+  // Converging on the last allowed step still counts as converged
+  Vector<double> x(3);
+  PCGStatus status = PCG_MAX_ITERATIONS;
+  int iterations = preconditioned_conjugate_gradient( A, IdentityPreconditioner(), b, x, 1e-12, 10 );
+  x = Vector<double>(3);
+  EXPECT_EQ( iterations, preconditioned_conjugate_gradient( A, IdentityPreconditioner(), b, x, 1e-12,
+                                                            iterations, &status ) );
+  EXPECT_EQ( PCG_CONVERGED, status );
+
+  x = Vector<double>(3);
+  preconditioned_conjugate_gradient( A, IdentityPreconditioner(), b, x, 1e-12, 1, &status );
+  EXPECT_EQ( PCG_MAX_ITERATIONS, status );
+
+  // -A is negative definite
+  x = Vector<double>(3);
+  EXPECT_EQ( 0, preconditioned_conjugate_gradient( NegatedOperator(), IdentityPreconditioner(), b, x,
+                                                   1e-12, 10, &status ) );
+  EXPECT_EQ( PCG_NOT_POSITIVE_DEFINITE, status );
+}
@@ -0,0 +1,209 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <gtest/gtest_VW.h>
+#include <vw/Math/MatrixSparseBlock.h>
+#include <test/Helpers.h>
+
+#include <boost/random.hpp>
+
+using namespace vw;
+using namespace vw::math;
+
+static const double DELTA = 1e-6;
+
+typedef MatrixSparseBlock<double,3> SparseBlock3;
+
+// Fill every declared block with random values and make the matrix
+// diagonally dominant so that it is positive definite.
+template <class GenT>
+void fill_block_matrix( SparseBlock3& A, GenT& generator ) {
+  A.set_zero();
+  for ( size_t i = 0; i < A.block_rows(); i++ )
+    for ( size_t j = 0; j <= i; j++ ) {
+      if ( !A.has_block(i,j) )
+        continue;
+      SparseBlock3::block_type& block = A.block(i,j);
+      for ( size_t r = 0; r < 3; r++ )
+        for ( size_t c = 0; c < 3; c++ )
+          block(r,c) = generator() - 0.5;
+    }
+  for ( size_t i = 0; i < A.block_rows(); i++ ) {
+    SparseBlock3::block_type& block = A.block(i,i);
+    block = 0.5 * ( block + transpose(block) );
+    for ( size_t r = 0; r < 3; r++ )
+      block(r,r) += 4 * A.block_rows();
+  }
+}
+
+// Randomly connected band plus a few long range links, like a strip
+// of cameras with loop closures.
+void build_structure( SparseBlock3& A ) {
+  size_t n = A.block_rows();
+  for ( size_t i = 1; i < n; i++ ) {
+    A.add_block(i,i-1);
+    if ( i > 2 ) A.add_block(i,i-3);
+  }
+  A.add_block(n-1,0);
+  A.add_block(n/2,1);
+  A.compress();
+}
+
+TEST(SparseBlock, Creation) {
+  SparseBlock3 A(4);
+  A.add_block(2,0);
+  A.add_block(1,3);
+  A.compress();
+
+  EXPECT_EQ( 12u, A.rows() );
+  EXPECT_EQ( 12u, A.cols() );
+  EXPECT_EQ( 6u, A.nonzero_blocks() );
+  EXPECT_TRUE( A.has_block(0,2) );
+  EXPECT_TRUE( A.has_block(3,1) );
+  EXPECT_FALSE( A.has_block(1,0) );
+
+  A(7,0) = 5;
+  A(4,10) = 3;
+  SparseBlock3 const& A_const = A;
+  EXPECT_EQ( 5, A_const(0,7) );
+  EXPECT_EQ( 3, A_const(10,4) );
+  EXPECT_EQ( 0, A_const(4,0) );
+  EXPECT_EQ( 5, A_const.block(2,0)(1,0) );
+  EXPECT_THROW( A(4,0) = 1, LogicErr );
+
+  // Adding a new block reopens the structure
+  A.add_block(1,0);
+  A.compress();
+  EXPECT_EQ( 7u, A.nonzero_blocks() );
+  EXPECT_TRUE( A.has_block(1,0) );
+}
+
+TEST(SparseBlock, LDL_solve) {
+  boost::mt19937 random_gen(42);
+  boost::variate_generator<boost::mt19937&, boost::uniform_01<> > generator( random_gen, boost::uniform_01<>() );
+
+  SparseBlock3 A(20);
+  build_structure(A);
+  fill_block_matrix(A, generator);
+  Matrix<double> A_dense = A;
+
+  Vector<double> b(A.rows());
+  for ( size_t i = 0; i < b.size(); i++ )
+    b[i] = generator();
+
+  Vector<double> x_dense = inverse(A_dense)*b;
+  Vector<double> x_sparse = sparse_solve(A, b);
+  for ( size_t i = 0; i < b.size(); i++ )
+    EXPECT_NEAR( x_dense[i], x_sparse[i], DELTA );
+
+  // Values of A are preserved by the solve
+  Vector<double> b_prime = A*x_sparse;
+  for ( size_t i = 0; i < b.size(); i++ )
+    EXPECT_NEAR( b[i], b_prime[i], DELTA );
+}
+
+TEST(SparseBlock, SymbolicReuse) {
+  boost::mt19937 random_gen(7);
+  boost::variate_generator<boost::mt19937&, boost::uniform_01<> > generator( random_gen, boost::uniform_01<>() );
+
+  SparseBlock3 A(15);
+  build_structure(A);
+  fill_block_matrix(A, generator);
+  Vector<double> b(A.rows());
+  for ( size_t i = 0; i < b.size(); i++ )
+    b[i] = generator();
+
+  sparse_solve(A, b);
+  boost::shared_ptr<SparseBlockSymbolic> symbolic = A.symbolic();
+  ASSERT_TRUE( symbolic.get() != 0 );
+
+  // New values, same structure
+  fill_block_matrix(A, generator);
+  Matrix<double> A_dense = A;
+  Vector<double> x = sparse_solve(A, b);
+  EXPECT_EQ( symbolic.get(), A.symbolic().get() );
+  Vector<double> b_prime = A_dense*x;
+  for ( size_t i = 0; i < b.size(); i++ )
+    EXPECT_NEAR( b[i], b_prime[i], DELTA );
+}
+
+TEST(SparseBlock, MinimumDegreeOrdering) {
+  // Arrow matrix: block 0 is connected to everything. In natural
+  // order eliminating it first fills in the whole matrix, a minimum
+  // degree ordering eliminates it last and has no fill at all.
+  size_t n = 12;
+  SparseBlock3 A(n);
+  for ( size_t i = 1; i < n; i++ )
+    A.add_block(i,0);
+  A.compress();
+
+  std::vector<size_t> natural(n);
+  for ( size_t i = 0; i < n; i++ )
+    natural[i] = i;
+  EXPECT_EQ( (n-1)*n/2, sparse_block_symbolic(A, natural)->nonzero_blocks() );
+
+  std::vector<size_t> order = minimum_degree_ordering(A);
+  ASSERT_EQ( n, order.size() );
+  EXPECT_EQ( 0u, order.back() );
+  EXPECT_EQ( n-1, sparse_block_symbolic(A, order)->nonzero_blocks() );
+
+  // And the solve is still correct in that order
+  boost::mt19937 random_gen(3);
+  boost::variate_generator<boost::mt19937&, boost::uniform_01<> > generator( random_gen, boost::uniform_01<>() );
+  fill_block_matrix(A, generator);
+  Matrix<double> A_dense = A;
+  Vector<double> b(A.rows());
+  for ( size_t i = 0; i < b.size(); i++ )
+    b[i] = generator();
+  Vector<double> b_prime = A_dense*sparse_solve(A, b);
+  for ( size_t i = 0; i < b.size(); i++ )
+    EXPECT_NEAR( b[i], b_prime[i], DELTA );
+}
+
+TEST(SparseBlock, MultiSolve) {
+  boost::mt19937 random_gen(11);
+  boost::variate_generator<boost::mt19937&, boost::uniform_01<> > generator( random_gen, boost::uniform_01<>() );
+
+  SparseBlock3 A(6);
+  build_structure(A);
+  fill_block_matrix(A, generator);
+  Matrix<double> A_dense = A;
+
+  Matrix<double> Id(A.rows(), A.rows());
+  Id.set_identity();
+  Matrix<double> A_inverse = multi_sparse_solve(A, Id);
+  Matrix<double> should_be_identity = A_dense*A_inverse;
+  for ( size_t i = 0; i < A.rows(); i++ )
+    for ( size_t j = 0; j < A.rows(); j++ )
+      EXPECT_NEAR( Id(i,j), should_be_identity(i,j), DELTA );
+}
+
+TEST(SparseBlock, SelectedInverse) {
+  boost::mt19937 random_gen(5);
+  boost::variate_generator<boost::mt19937&, boost::uniform_01<> > generator( random_gen, boost::uniform_01<>() );
+
+  SparseBlock3 A(25);
+  build_structure(A);
+  fill_block_matrix(A, generator);
+  Matrix<double> A_inverse = inverse( Matrix<double>(A) );
+
+  std::vector<SparseBlock3::block_type> diagonal = sparse_selected_inverse(A);
+  ASSERT_EQ( A.block_rows(), diagonal.size() );
+  for ( size_t k = 0; k < diagonal.size(); k++ )
+    EXPECT_MATRIX_NEAR( submatrix(A_inverse, 3*k, 3*k, 3, 3), diagonal[k], DELTA );
+}
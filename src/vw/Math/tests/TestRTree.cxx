@@ -0,0 +1,104 @@
+// __BEGIN_LICENSE__
+//  Copyright (c) 2006-2013, United States Government as represented by the
+//  Administrator of the National Aeronautics and Space Administration. All
+//  rights reserved.
+//
+//  The NASA Vision Workbench is licensed under the Apache License,
+//  Version 2.0 (the "License"); you may not use this file except in
+//  compliance with the License. You may obtain a copy of the License at
+//  http://www.apache.org/licenses/LICENSE-2.0
+//
+//  Unless required by applicable law or agreed to in writing, software
+//  distributed under the License is distributed on an "AS IS" BASIS,
+//  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+//  See the License for the specific language governing permissions and
+//  limitations under the License.
+// __END_LICENSE__
+
+
+#include <gtest/gtest_VW.h>
+#include <vw/Math/RTree.h>
+
+#include <boost/random.hpp>
+
+using namespace vw;
+using namespace vw::math;
+
+typedef RTree<int32,2> RTree2i;
+
+template <class BoxT>
+std::vector<size_t> brute_force( std::vector<BoxT> const& boxes, BoxT const& query ) {
+  std::vector<size_t> result;
+  for ( size_t i = 0; i < boxes.size(); i++ )
+    if ( !boxes[i].empty() && boxes[i].intersects( query ) )
+      result.push_back( i );
+  return result;
+}
+
+TEST(RTree, Empty) {
+  RTree2i tree;
+  EXPECT_TRUE( tree.empty() );
+  std::vector<size_t> result( 3 );
+  tree.intersecting( BBox2i(0,0,10,10), result );
+  EXPECT_TRUE( result.empty() );
+
+  // Empty boxes are not indexed
+  std::vector<BBox2i> boxes( 2 );
+  boxes[1] = BBox2i(5,5,3,3);
+  tree.build( boxes );
+  EXPECT_EQ( 1u, tree.size() );
+  tree.intersecting( BBox2i(0,0,10,10), result );
+  ASSERT_EQ( 1u, result.size() );
+  EXPECT_EQ( 1u, result[0] );
+
+  EXPECT_THROW( RTree2i( 1 ), ArgumentErr );
+}
+
+TEST(RTree, Grid) {
+  // Abutting tiles, like a mosaic: touching edges don't intersect
+  std::vector<BBox2i> tiles;
+  for ( int32 row = 0; row < 30; row++ )
+    for ( int32 col = 0; col < 40; col++ )
+      tiles.push_back( BBox2i( col*100, row*100, 100, 100 ) );
+  RTree2i tree( tiles, 4 );
+  EXPECT_EQ( tiles.size(), tree.size() );
+
+  std::vector<size_t> result;
+  tree.intersecting( BBox2i( 250, 150, 100, 100 ), result );
+  ASSERT_EQ( 4u, result.size() );
+  EXPECT_EQ( 1u*40+2, result[0] );
+  EXPECT_EQ( 1u*40+3, result[1] );
+  EXPECT_EQ( 2u*40+2, result[2] );
+  EXPECT_EQ( 2u*40+3, result[3] );
+
+  tree.intersecting( BBox2i( 300, 200, 100, 100 ), result );
+  ASSERT_EQ( 1u, result.size() );
+  EXPECT_EQ( 2u*40+3, result[0] );
+
+  tree.intersecting( BBox2i( 4000, 0, 10, 10 ), result );
+  EXPECT_TRUE( result.empty() );
+}
+
+TEST(RTree, Random) {
+  boost::mt19937 gen(42);
+  boost::uniform_real<> coord(0, 1000), size(0, 80);
+  boost::variate_generator<boost::mt19937&, boost::uniform_real<> > rand_coord( gen, coord ), rand_size( gen, size );
+
+  std::vector<BBox3> boxes;
+  for ( size_t i = 0; i < 2000; i++ ) {
+    Vector3 lo( rand_coord(), rand_coord(), rand_coord() );
+    boxes.push_back( BBox3( lo, lo + Vector3( rand_size(), rand_size(), rand_size() ) ) );
+  }
+  RTree<double,3> tree( boxes );
+
+  std::vector<size_t> result;
+  for ( size_t i = 0; i < 200; i++ ) {
+    Vector3 lo( rand_coord(), rand_coord(), rand_coord() );
+    BBox3 query( lo, lo + Vector3( 3*rand_size(), 3*rand_size(), 3*rand_size() ) );
+    tree.intersecting( query, result );
+    std::vector<size_t> expected = brute_force( boxes, query );
+    ASSERT_EQ( expected.size(), result.size() );
+    for ( size_t j = 0; j < expected.size(); j++ )
+      EXPECT_EQ( expected[j], result[j] );
+  }
+}
@@ -28,6 +28,7 @@
 #include <list>
 
 #include <vw/Core/Cache.h>
+#include <vw/Core/ThreadPool.h>
 #include <vw/Core/ProgressCallback.h>
 #include <vw/Image/ImageView.h>
 #include <vw/Image/ImageViewRef.h>
@@ -37,7 +38,9 @@
 #include <vw/Image/Transform.h>
 #include <vw/Image/Filter.h>
 #include <vw/Image/SparseImageCheck.h>
+#include <vw/Math/RTree.h>
 #include <vw/FileIO/DiskImageResource.h>
+#include <vw/FileIO/DiskImageView.h>
 
 namespace vw {
 namespace mosaic {
@@ -114,6 +117,15 @@ namespace mosaic {
       }
     }
 
+    // Additive composition into just the rows [row_begin,row_end) of
+    // the destination, so that threads can fill separate bands of it.
+    void addto_rows( ImageView<PixelT> const& dest, int ox, int oy, int row_begin, int row_end ) const {
+      BBox2i sum_bbox = bbox;
+      sum_bbox.crop( BBox2i( Vector2i(ox,oy+row_begin), Vector2i(ox+dest.cols(),oy+row_end) ) );
+      if( sum_bbox.empty() ) return;
+      crop( dest, sum_bbox-Vector2i(ox,oy) ) += crop( image, sum_bbox-bbox.min() );
+    }
+
     void subtract_expanded( PositionedImage const& other ) {
       vw::rasterize( image - edge_extend( resample( other.image, 2 ), bbox-2*other.bbox.min(), ZeroEdgeExtension() ), image );
     }
@@ -140,6 +152,14 @@ namespace mosaic {
   // ImageComposite
   // *******************************************************************
 
+  /// How ImageComposite combines overlapping sources.
+  enum BlendMode {
+    DraftBlend,     ///< Later sources overwrite earlier ones
+    MultiBandBlend, ///< Laplacian pyramid blending along grassfire seams
+    FeatherBlend,   ///< Weighted by distance from each source's edge, up to the blend radius
+    SeamBlend       ///< Each pixel from the source whose edge is farthest, up to the blend radius
+  };
+
   /// ?
   template <class PixelT>
   class ImageComposite : public ImageViewBase<ImageComposite<PixelT> > {
@@ -153,19 +173,6 @@ namespace mosaic {
       std::vector<PositionedImage<channel_type> > masks;
     };
 
-    class SourceGenerator {
-      ImageViewRef<pixel_type> m_source;
-    public:
-      typedef ImageView<pixel_type> value_type;
-      SourceGenerator( ImageViewRef<pixel_type> const& source ) : m_source(source) {}
-      size_t size() const {
-        return m_source.cols() * m_source.rows() * sizeof(pixel_type);
-      }
-      boost::shared_ptr<value_type> generate() const {
-        return boost::shared_ptr<value_type>( new value_type(m_source) );
-      }
-    };
-
     class GrassfireGenerator {
       ImageViewRef<pixel_type> m_source;
     public:
@@ -180,60 +187,57 @@ namespace mosaic {
       }
     };
 
-    class AlphaGenerator {
-    public:
-      ImageComposite& m_composite;
-      size_t m_index;
-    public:
-      typedef ImageView<channel_type> value_type;
-      AlphaGenerator( ImageComposite& composite, size_t index ) : m_composite(composite), m_index(index) {}
-      size_t size() const {
-        return m_composite.sources[m_index].size() / PixelNumChannels<pixel_type>::value;
-      }
-      boost::shared_ptr<value_type> generate() const {
-        ImageView<pixel_type> source = *m_composite.sources[m_index];
-        m_composite.sources[m_index].release();
-        m_composite.sources[m_index].deprioritize();
-        return boost::shared_ptr<value_type>( new value_type( select_alpha_channel( source ) ) );
-      }
-    };
-
-    class PyramidGenerator {
-    public:
-      ImageComposite& m_composite;
-      size_t m_index;
-    public:
-      typedef Pyramid value_type;
-      PyramidGenerator( ImageComposite& composite, size_t index ) : m_composite(composite), m_index(index) {}
-      size_t size() const {
-        return size_t( double(m_composite.sources[m_index].size()) * 1.66 ); // 1.66 = (5/4)*(4/3)
-      }
-      boost::shared_ptr<value_type> generate() const;
+    // The part of one source that a patch needs
+    struct SourcePatch {
+      BBox2i                  region;
+      ImageView<channel_type> alpha;
+      Pyramid                 pyramid;
     };
 
-    friend class PyramidGenerator;
+    class MaskTask;
+    class PyramidTask;
+    class AccumulateTask;
+    class WeightTask;
 
     std::vector<BBox2i > bboxes;
     BBox2i view_bbox, data_bbox;
     int    mindim, levels;
-    bool   m_draft_mode;
+    int    m_num_threads;
+    int    m_blend_radius;
+    BlendMode m_blend_mode;
     bool   m_fill_holes;
     bool   m_reuse_masks;
     Cache& m_cache;
-    std::vector<ImageViewRef<pixel_type> >        sourcerefs;
-    std::vector<Cache::Handle<SourceGenerator > > sources;
-    std::vector<Cache::Handle<AlphaGenerator  > > alphas;
-    std::vector<Cache::Handle<PyramidGenerator> > pyramids;
+    std::vector<ImageViewRef<pixel_type> >   sourcerefs;
+    std::vector<ImageViewRef<channel_type> > maskrefs;
+    math::RTree<int32,2> m_index;
 
     void generate_masks( ProgressCallback const& progress_callback ) const;
+    void generate_mask( size_t index, std::vector<Cache::Handle<GrassfireGenerator> > const& grassfires ) const;
+
+    // Indices of the sources whose bboxes intersect 'bbox', using the
+    // index once prepare() has built it.
+    void find_sources( BBox2i const& bbox, std::vector<size_t>& result ) const {
+      if( m_index.empty() ) {
+        result.clear();
+        for( size_t i = 0; i < bboxes.size(); ++i )
+          if( bbox.intersects( bboxes[i] ) ) result.push_back( i );
+      }
+      else m_index.intersecting( bbox, result );
+    }
+
+    Pyramid generate_pyramid( size_t index, ImageView<pixel_type> const& source, BBox2i const& region ) const;
+    void generate_source_patch( size_t index, BBox2i const& padded_bbox, SourcePatch& patch ) const;
+    void generate_weights( size_t index, BBox2i const& patch_bbox, ImageView<float32>& weights ) const;
 
     ImageView<pixel_type> blend_patch( BBox2i const& patch_bbox ) const;
     ImageView<pixel_type> draft_patch( BBox2i const& patch_bbox ) const;
+    ImageView<pixel_type> feather_patch( BBox2i const& patch_bbox ) const;
 
   public:
     typedef pixel_type result_type;
 
-    ImageComposite() : m_draft_mode(false), m_fill_holes(false), m_reuse_masks(false), m_cache(vw_system_cache()) {}
+    ImageComposite() : m_num_threads(1), m_blend_radius(32), m_blend_mode(MultiBandBlend), m_fill_holes(false), m_reuse_masks(false), m_cache(vw_system_cache()) {}
 
     void insert( ImageViewRef<pixel_type> const& image, int x, int y );
 
@@ -241,16 +245,42 @@ namespace mosaic {
     void prepare( BBox2i const& total_bbox, const ProgressCallback &progress_callback = ProgressCallback::dummy_instance() );
 
     ImageView<pixel_type> generate_patch( BBox2i const& patch_bbox ) const {
-      if( m_draft_mode ) return draft_patch( patch_bbox );
-      else return blend_patch( patch_bbox );
+      switch( m_blend_mode ) {
+      case DraftBlend:     return draft_patch( patch_bbox );
+      case MultiBandBlend: return blend_patch( patch_bbox );
+      default:             return feather_patch( patch_bbox );
+      }
     }
 
-    void set_draft_mode (bool draft_mode ) { m_draft_mode = draft_mode; }
+    void set_draft_mode (bool draft_mode ) { m_blend_mode = draft_mode ? DraftBlend : MultiBandBlend; }
+
+    /// Feathering and seams only look at the sources within the blend
+    /// radius of each patch, and need no masks from prepare(), so they
+    /// are much cheaper than multi-band blending.
+    void set_blend_mode( BlendMode blend_mode ) { m_blend_mode = blend_mode; }
+    BlendMode blend_mode() const { return m_blend_mode; }
+
+    /// Width in pixels of the feathered band along each source's edge,
+    /// and how far inside the upper source the seam falls.
+    void set_blend_radius( int radius ) {
+      VW_ASSERT( radius > 0, ArgumentErr() << "ImageComposite: blend radius must be positive." );
+      m_blend_radius = radius;
+    }
 
     void set_fill_holes (bool fill_holes ) { m_fill_holes = fill_holes; }
 
     void set_reuse_masks(bool reuse_masks) { m_reuse_masks = reuse_masks; }
 
+    /// Number of threads prepare() uses to generate the masks, and
+    /// each patch uses to build the source pyramids and sum them.  The
+    /// default of 1 suits callers that already rasterize patches in
+    /// parallel; set it when patches are requested one at a time, as
+    /// QuadTreeGenerator does.  The result doesn't depend on it.
+    void set_num_threads(int num_threads) {
+      VW_ASSERT( num_threads > 0, ArgumentErr() << "ImageComposite: number of threads must be positive." );
+      m_num_threads = num_threads;
+    }
+
     int32 cols  () const { return view_bbox.width();  }
     int32 rows  () const { return view_bbox.height(); }
     int32 planes() const { return 1;                  }
@@ -280,7 +310,10 @@ namespace mosaic {
     }
 
     bool sparse_check( BBox2i const& bbox ) const {
-      for (unsigned int i = 0; i < bboxes.size(); ++i) {
+      std::vector<size_t> overlapping;
+      find_sources( bbox, overlapping );
+      for( size_t k = 0; k < overlapping.size(); ++k ) {
+        size_t i = overlapping[k];
         BBox2i src_bbox = bboxes[i];
         src_bbox.crop(bbox);
         if( ! src_bbox.empty() ) {
@@ -314,73 +347,180 @@ namespace mosaic {
 } // namespace vw
 
 
+// Generates the masks of a range of sources.  The masks are
+// independent, so each thread gets its own sources.
+template <class PixelT>
+class vw::mosaic::ImageComposite<PixelT>::MaskTask : public Task {
+  ImageComposite const& m_composite;
+  std::vector<Cache::Handle<GrassfireGenerator> > const& m_grassfires;
+  size_t m_index;
+  ProgressCallback const& m_progress;
+  Mutex& m_mutex;
+  size_t& m_num_done;
+public:
+  MaskTask( ImageComposite const& composite, std::vector<Cache::Handle<GrassfireGenerator> > const& grassfires,
+            size_t index, ProgressCallback const& progress, Mutex& mutex, size_t& num_done )
+    : m_composite(composite), m_grassfires(grassfires), m_index(index),
+      m_progress(progress), m_mutex(mutex), m_num_done(num_done) {}
+
+  virtual void operator()() {
+    m_composite.generate_mask( m_index, m_grassfires );
+    Mutex::Lock lock( m_mutex );
+    m_num_done++;
+    m_progress.report_fractional_progress( double(m_num_done), double(m_composite.sourcerefs.size()) );
+  }
+};
+
+// Builds the pyramid of one source for a patch.
+template <class PixelT>
+class vw::mosaic::ImageComposite<PixelT>::PyramidTask : public Task {
+  ImageComposite const& m_composite;
+  size_t m_index;
+  BBox2i m_padded_bbox;
+  SourcePatch& m_patch;
+public:
+  PyramidTask( ImageComposite const& composite, size_t index, BBox2i const& padded_bbox, SourcePatch& patch )
+    : m_composite(composite), m_index(index), m_padded_bbox(padded_bbox), m_patch(patch) {}
+
+  virtual void operator()() {
+    m_composite.generate_source_patch( m_index, m_padded_bbox, m_patch );
+  }
+};
+
+// Sums a band of rows of one pyramid level over all the sources.
+// Every pixel is summed in source order, whichever thread does it, so
+// the patch is the same as when it's summed serially.
+template <class PixelT>
+class vw::mosaic::ImageComposite<PixelT>::AccumulateTask : public Task {
+  std::vector<SourcePatch> const& m_patches;
+  int m_level;
+  ImageView<pixel_type> m_sum;
+  ImageView<channel_type> m_msum;
+  Vector2i m_origin;
+  int m_row_begin, m_row_end;
+public:
+  AccumulateTask( std::vector<SourcePatch> const& patches, int level,
+                  ImageView<pixel_type> const& sum, ImageView<channel_type> const& msum,
+                  Vector2i const& origin, int row_begin, int row_end )
+    : m_patches(patches), m_level(level), m_sum(sum), m_msum(msum),
+      m_origin(origin), m_row_begin(row_begin), m_row_end(row_end) {}
+
+  virtual void operator()() {
+    for( size_t k=0; k<m_patches.size(); ++k ) {
+      m_patches[k].pyramid.images[m_level].addto_rows( m_sum, m_origin.x(), m_origin.y(), m_row_begin, m_row_end );
+      m_patches[k].pyramid.masks[m_level].addto_rows( m_msum, m_origin.x(), m_origin.y(), m_row_begin, m_row_end );
+    }
+  }
+};
+
+// Computes the blend weights of one source over a patch.
+template <class PixelT>
+class vw::mosaic::ImageComposite<PixelT>::WeightTask : public Task {
+  ImageComposite const& m_composite;
+  size_t m_index;
+  BBox2i m_patch_bbox;
+  ImageView<float32>& m_weights;
+public:
+  WeightTask( ImageComposite const& composite, size_t index, BBox2i const& patch_bbox, ImageView<float32>& weights )
+    : m_composite(composite), m_index(index), m_patch_bbox(patch_bbox), m_weights(weights) {}
+
+  virtual void operator()() {
+    m_composite.generate_weights( m_index, m_patch_bbox, m_weights );
+  }
+};
+
+
 template <class PixelT>
 void vw::mosaic::ImageComposite<PixelT>::generate_masks( vw::ProgressCallback const& progress_callback ) const {
   vw_out(DebugMessage, "mosaic") << "Generating masks..." << std::endl;
   std::vector<Cache::Handle<GrassfireGenerator> > grassfires;
-  for( unsigned i=0; i<sources.size(); ++i )
+  for( unsigned i=0; i<sourcerefs.size(); ++i )
     grassfires.push_back( m_cache.insert( GrassfireGenerator( sourcerefs[i] ) ) );
-  for( unsigned p1=0; p1<sources.size(); ++p1 ) {
-    ImageView<float> mask = copy( *(grassfires[p1]) );
-    for( unsigned p2=0; p2<sources.size(); ++p2 ) {
-      if( p1 == p2 ) continue;
-      int ox = bboxes[p2].min().x() - bboxes[p1].min().x();
-      int oy = bboxes[p2].min().y() - bboxes[p1].min().y();
-      if( ! ( ox >= bboxes[p1].width() ||
-              oy >= bboxes[p1].height() ||
-              -ox >= bboxes[p2].width() ||
-              -oy >= bboxes[p2].height() ) )
-      {
-        ImageView<float> other = *grassfires[p2];
-        int left = std::max( ox, 0 );
-        int top = std::max( oy, 0 );
-        int right = std::min( bboxes[p2].width()+ox, bboxes[p1].width() );
-        int bottom = std::min( bboxes[p2].height()+oy, bboxes[p1].height() );
-        for( int j=top; j<bottom; ++j ) {
-          for( int i=left; i<right; ++i ) {
-            if( ( other(i-ox,j-oy) > mask(i,j) ) ||
-                ( other(i-ox,j-oy) == mask(i,j) && p2 > p1 ) )
-              mask(i,j) = 0;
-          }
-        }
-      }
-      progress_callback.report_fractional_progress( double(p1*(sources.size()+1)+p2+1), double((sources.size()+1)*sources.size()) );
+
+  if( m_num_threads > 1 && sourcerefs.size() > 1 ) {
+    Mutex mutex;
+    size_t num_done = 0;
+    FifoWorkQueue queue( std::min( m_num_threads, int(sourcerefs.size()) ) );
+    for( unsigned p=0; p<sourcerefs.size(); ++p )
+      queue.add_task( boost::shared_ptr<Task>( new MaskTask( *this, grassfires, p, progress_callback, mutex, num_done ) ) );
+    queue.join_all();
+  }
+  else {
+    for( unsigned p=0; p<sourcerefs.size(); ++p ) {
+      generate_mask( p, grassfires );
+      progress_callback.report_fractional_progress( double(p+1), double(sourcerefs.size()) );
     }
-    mask = threshold( mask );
-    std::ostringstream filename;
-    filename << "mask." << p1 << ".png";
-    write_image( filename.str(), mask );
-    progress_callback.report_fractional_progress( double((p1+1)*(sources.size()+1)), double((sources.size()+1)*sources.size()) );
   }
   // report_finished() called by prepare(), so don't call it here
 }
 
 
+// Writes the mask of one source: where it has the greatest grassfire
+// value of all the sources.  Other threads may be using the same
+// grassfires, so each lookup goes through its own copy of the handle.
 template <class PixelT>
-boost::shared_ptr<typename vw::mosaic::ImageComposite<PixelT>::Pyramid> vw::mosaic::ImageComposite<PixelT>::PyramidGenerator::generate() const {
-  vw_out(DebugMessage, "mosaic") << "ImageComposite generating pyramid " << m_index << std::endl;
-  boost::shared_ptr<Pyramid> ptr( new Pyramid );
-  ImageView<pixel_type> source = copy(*m_composite.sources[m_index]);
-  m_composite.sources[m_index].release();
-  m_composite.sources[m_index].deprioritize();
+void vw::mosaic::ImageComposite<PixelT>::generate_mask( size_t p1, std::vector<Cache::Handle<GrassfireGenerator> > const& grassfires ) const {
+  std::vector<size_t> overlapping;
+  find_sources( bboxes[p1], overlapping );
+
+  // Where no other source overlaps the mask is just the alpha
+  // channel, thresholded below, and the grassfire isn't needed.
+  ImageView<float> mask;
+  if( overlapping.size() > 1 ) {
+    Cache::Handle<GrassfireGenerator> grassfire = grassfires[p1];
+    mask = copy( *grassfire );
+    grassfire.release();
+  }
+  else mask = channel_cast<float>( select_alpha_channel( sourcerefs[p1] ) );
+
+  for( unsigned k=0; k<overlapping.size(); ++k ) {
+    size_t p2 = overlapping[k];
+    if( p1 == p2 ) continue;
+    int ox = bboxes[p2].min().x() - bboxes[p1].min().x();
+    int oy = bboxes[p2].min().y() - bboxes[p1].min().y();
+    if( ! ( ox >= bboxes[p1].width() ||
+            oy >= bboxes[p1].height() ||
+            -ox >= bboxes[p2].width() ||
+            -oy >= bboxes[p2].height() ) )
+    {
+      Cache::Handle<GrassfireGenerator> grassfire = grassfires[p2];
+      ImageView<float> other = *grassfire;
+      grassfire.release();
+      int left = std::max( ox, 0 );
+      int top = std::max( oy, 0 );
+      int right = std::min( bboxes[p2].width()+ox, bboxes[p1].width() );
+      int bottom = std::min( bboxes[p2].height()+oy, bboxes[p1].height() );
+      for( int j=top; j<bottom; ++j ) {
+        for( int i=left; i<right; ++i ) {
+          if( ( other(i-ox,j-oy) > mask(i,j) ) ||
+              ( other(i-ox,j-oy) == mask(i,j) && p2 > p1 ) )
+            mask(i,j) = 0;
+        }
+      }
+    }
+  }
+  mask = threshold( mask );
+  std::ostringstream filename;
+  filename << "mask." << p1 << ".png";
+  write_image( filename.str(), mask );
+}
 
-  // This is sort of a kluge: the hole-filling algorithm currently
-  // doesn't cope well with partially-transparent source pixels.
-  if( m_composite.m_fill_holes ) source /= select_alpha_channel(source);
 
-  PositionedImage<pixel_type> image_high( m_composite.view_bbox.width(), m_composite.view_bbox.height(), source, m_composite.bboxes[m_index] );
+// Builds the Laplacian pyramid of the part 'region' of a source
+// image, where 'source' holds those pixels.
+template <class PixelT>
+typename vw::mosaic::ImageComposite<PixelT>::Pyramid
+vw::mosaic::ImageComposite<PixelT>::generate_pyramid( size_t index, ImageView<pixel_type> const& source, BBox2i const& region ) const {
+  Pyramid pyr;
+  PositionedImage<pixel_type> image_high( view_bbox.width(), view_bbox.height(), source, region );
   PositionedImage<pixel_type> image_low = image_high.reduce();
-  ImageView<channel_type> mask_image;
+  ImageView<channel_type> mask_image = crop( maskrefs[index], region - bboxes[index].min() );
+  PositionedImage<channel_type> mask( view_bbox.width(), view_bbox.height(), mask_image, region );
 
-  std::ostringstream mask_filename;
-  mask_filename << "mask." << m_index << ".png";
-  read_image( mask_image, mask_filename.str() );
-  PositionedImage<channel_type> mask( m_composite.view_bbox.width(), m_composite.view_bbox.height(), mask_image, m_composite.bboxes[m_index] );
-
-  for( int l=0; l<m_composite.levels; ++l ) {
+  for( int l=0; l<levels; ++l ) {
     PositionedImage<pixel_type> diff = image_high;
     if( l > 0 ) mask = mask.reduce();
-    if( l < m_composite.levels-1 ) {
+    if( l < levels-1 ) {
       PositionedImage<pixel_type> next_image_low = image_low.reduce();
       image_low.unpremultiply();
       diff.subtract_expanded( image_low );
@@ -388,19 +528,35 @@ boost::shared_ptr<typename vw::mosaic::ImageComposite<PixelT>::Pyramid> vw::mosa
       image_low = next_image_low;
     }
     diff *= mask;
-    ptr->images.push_back( diff );
-    ptr->masks.push_back( mask );
+    pyr.images.push_back( diff );
+    pyr.masks.push_back( mask );
   }
-  return ptr;
+  return pyr;
 }
 
 
+// Fills in what a patch needs from one source: its pyramid over the
+// part of 'padded_bbox' it covers, and its alpha channel there.
+template <class PixelT>
+void vw::mosaic::ImageComposite<PixelT>::generate_source_patch( size_t index, BBox2i const& padded_bbox, SourcePatch& patch ) const {
+  patch.region = padded_bbox;
+  patch.region.crop( bboxes[index] );
+  ImageView<pixel_type> source = crop( sourcerefs[index], patch.region - bboxes[index].min() );
+
+  // Not needed when filling holes, which sets the alpha everywhere
+  if( !m_fill_holes ) patch.alpha = select_alpha_channel( source );
+
+  // This is sort of a kluge: the hole-filling algorithm currently
+  // doesn't cope well with partially-transparent source pixels.
+  if( m_fill_holes ) source /= select_alpha_channel( source );
+
+  patch.pyramid = generate_pyramid( index, source, patch.region );
+}
+
 template <class PixelT>
 void vw::mosaic::ImageComposite<PixelT>::insert( ImageViewRef<pixel_type> const& image, int x, int y ) {
   sourcerefs.push_back( image );
-  sources.push_back( m_cache.insert( SourceGenerator( image ) ) );
-  alphas.push_back( m_cache.insert( AlphaGenerator( *this, pyramids.size() ) ) );
-  pyramids.push_back( m_cache.insert( PyramidGenerator( *this, pyramids.size() ) ) );
+  m_index = math::RTree<int32,2>();
 
   int cols = image.cols(), rows = image.rows();
   BBox2i image_bbox( Vector2i(x, y), Vector2i(x+cols, y+rows) );
@@ -421,15 +577,22 @@ void vw::mosaic::ImageComposite<PixelT>::insert( ImageViewRef<pixel_type> const&
 template <class PixelT>
 void vw::mosaic::ImageComposite<PixelT>::prepare( vw::ProgressCallback const& progress_callback ) {
   // Translate bboxes to origin
-  for( unsigned i=0; i<sources.size(); ++i )
+  for( unsigned i=0; i<sourcerefs.size(); ++i )
     bboxes[i] -= view_bbox.min();
   data_bbox -= view_bbox.min();
+  m_index.build( bboxes );
 
   levels = (int) floorf( logf( float(mindim)/2.0f ) / logf(2.0f) ) - 1;
   if( levels < 1 ) levels = 1;
 
-  if( !m_draft_mode && !m_reuse_masks ) {
-    generate_masks( progress_callback );
+  if( m_blend_mode == MultiBandBlend ) {
+    if( !m_reuse_masks ) generate_masks( progress_callback );
+    maskrefs.clear();
+    for( unsigned i=0; i<sourcerefs.size(); ++i ) {
+      std::ostringstream filename;
+      filename << "mask." << i << ".png";
+      maskrefs.push_back( DiskImageView<channel_type>( filename.str() ) );
+    }
   }
   progress_callback.report_finished();
 }
@@ -486,25 +649,59 @@ vw::ImageView<PixelT> vw::mosaic::ImageComposite<PixelT>::blend_patch( BBox2i co
     padded_bbox.max().y() = 2*padded_bbox.max().y();
   }
 
-  // Make a list of the images whose bounding boxes permit them to
-  // impact the patch, prioritizing ones that are already in memory.
-  std::list<unsigned> image_list;
-  for( unsigned p=0; p<sources.size(); ++p ) {
-    if( ! padded_bbox.intersects( bboxes[p] ) ) continue;
-    if( ! pyramids[p].valid() ) image_list.push_back( p );
-    else image_list.push_front( p );
+  // The pyramids are built from just those source pixels, which gives
+  // the patch the same coefficients as the pyramids of the whole
+  // sources would, so nothing needs to be kept between patches.
+  std::vector<size_t> overlapping;
+  find_sources( padded_bbox, overlapping );
+
+  // Build each source's pyramid, then add them all to the blend
+  // pyramid.  Both steps are spread over m_num_threads.
+  std::vector<SourcePatch> patches( overlapping.size() );
+  if( m_num_threads > 1 && overlapping.size() > 1 ) {
+    FifoWorkQueue queue( std::min( m_num_threads, int(overlapping.size()) ) );
+    for( size_t k=0; k<overlapping.size(); ++k )
+      queue.add_task( boost::shared_ptr<Task>( new PyramidTask( *this, overlapping[k], padded_bbox, patches[k] ) ) );
+    queue.join_all();
+  }
+  else {
+    for( size_t k=0; k<overlapping.size(); ++k )
+      generate_source_patch( overlapping[k], padded_bbox, patches[k] );
   }
 
-  // Add each source image pyramid to the blend pyramid.
-  std::list<unsigned>::iterator ili=image_list.begin(), ilend=image_list.end();
-  for( ; ili!=ilend; ++ili ) {
-    unsigned p = *ili;
-    boost::shared_ptr<Pyramid> pyr = pyramids[p];
+  if( m_num_threads > 1 ) {
+    FifoWorkQueue queue( m_num_threads );
     for( int l=0; l<levels; ++l ) {
-      pyr->images[l].addto( sum_pyr[l], bbox_pyr[l].min().x(), bbox_pyr[l].min().y() );
-      pyr->masks[l].addto( msum_pyr[l], bbox_pyr[l].min().x(), bbox_pyr[l].min().y() );
+      // A few bands per thread, so that the big levels balance out
+      int rows = sum_pyr[l].rows();
+      int bands = std::min( rows, 4*m_num_threads );
+      for( int b=0; b<bands; ++b )
+        queue.add_task( boost::shared_ptr<Task>( new AccumulateTask( patches, l, sum_pyr[l], msum_pyr[l], bbox_pyr[l].min(),
+                                                                     rows*b/bands, rows*(b+1)/bands ) ) );
+    }
+    queue.join_all();
+  }
+  else {
+    for( size_t k=0; k<patches.size(); ++k ) {
+      for( int l=0; l<levels; ++l ) {
+        patches[k].pyramid.images[l].addto( sum_pyr[l], bbox_pyr[l].min().x(), bbox_pyr[l].min().y() );
+        patches[k].pyramid.masks[l].addto( msum_pyr[l], bbox_pyr[l].min().x(), bbox_pyr[l].min().y() );
+      }
+    }
+  }
+
+  // The maximal source alpha over the patch
+  ImageView<channel_type> alpha( patch_bbox.width(), patch_bbox.height() );
+  for( size_t k=0; k<patches.size() && !m_fill_holes; ++k ) {
+    BBox2i overlap = patch_bbox;
+    overlap.crop( bboxes[overlapping[k]] );
+    for( int j=0; j<overlap.height(); ++j ) {
+      for( int i=0; i<overlap.width(); ++i ) {
+        channel_type source_alpha = patches[k].alpha( overlap.min().x()+i-patches[k].region.min().x(), overlap.min().y()+j-patches[k].region.min().y() );
+        channel_type& patch_alpha = alpha( overlap.min().x()+i-patch_bbox.min().x(), overlap.min().y()+j-patch_bbox.min().y() );
+        if( source_alpha > patch_alpha ) patch_alpha = source_alpha;
+      }
     }
-    pyramids[p].release();
   }
 
   // Collapse the pyramid
@@ -525,28 +722,7 @@ vw::ImageView<PixelT> vw::mosaic::ImageComposite<PixelT>::blend_patch( BBox2i co
     composite /= select_alpha_channel( composite );
   }
   else {
-
-    // Trim to the maximal source alpha, reloading images if needed
-    ImageView<channel_type> alpha( patch_bbox.width(), patch_bbox.height() );
-    for( unsigned p=0; p<sources.size(); ++p ) {
-      if( ! patch_bbox.intersects( bboxes[p] ) ) continue;
-
-      ImageView<channel_type> source_alpha = *alphas[p];
-      alphas[p].release();
-
-      BBox2i overlap = patch_bbox;
-      overlap.crop( bboxes[p] );
-      for( int j=0; j<overlap.height(); ++j ) {
-        for( int i=0; i<overlap.width(); ++i ) {
-          if( source_alpha( overlap.min().x()+i-bboxes[p].min().x(), overlap.min().y()+j-bboxes[p].min().y() ) >
-              alpha( overlap.min().x()+i-patch_bbox.min().x(), overlap.min().y()+j-patch_bbox.min().y() ) ) {
-            alpha( overlap.min().x()+i-patch_bbox.min().x(), overlap.min().y()+j-patch_bbox.min().y() ) =
-              source_alpha( overlap.min().x()+i-bboxes[p].min().x(), overlap.min().y()+j-bboxes[p].min().y() );
-          }
-        }
-      }
-    }
-
+    // Trim to the maximal source alpha
     composite *= alpha / select_alpha_channel( composite );
   }
 
@@ -564,8 +740,10 @@ vw::ImageView<PixelT> vw::mosaic::ImageComposite<PixelT>::draft_patch( BBox2i co
   ImageView<pixel_type> composite(patch_bbox.width(),patch_bbox.height());
 
   // Add each image to the composite.
-  for( unsigned p=0; p<sources.size(); ++p ) {
-    if( ! patch_bbox.intersects( bboxes[p] ) ) continue;
+  std::vector<size_t> overlapping;
+  find_sources( patch_bbox, overlapping );
+  for( size_t k=0; k<overlapping.size(); ++k ) {
+    size_t p = overlapping[k];
     BBox2i bbox = patch_bbox;
     bbox.crop( bboxes[p] );
     PositionedImage<pixel_type> image( view_bbox.width(), view_bbox.height(), crop(sourcerefs[p],bbox-bboxes[p].min()), bbox );
@@ -575,4 +753,85 @@ vw::ImageView<PixelT> vw::mosaic::ImageComposite<PixelT>::draft_patch( BBox2i co
   return composite;
 }
 
+// The weight of a source at a pixel is its grassfire distance from the
+// source's edge or a transparent pixel, capped at the blend radius.
+// Nothing beyond the radius can lower a capped distance, so it is
+// computed from just the patch grown by the radius.
+template <class PixelT>
+void vw::mosaic::ImageComposite<PixelT>::generate_weights( size_t index, BBox2i const& patch_bbox, ImageView<float32>& weights ) const {
+  BBox2i region = patch_bbox;
+  region.expand( m_blend_radius );
+  ImageView<float32> alpha = channel_cast<float32>( select_alpha_channel(
+    crop( edge_extend( sourcerefs[index], ZeroEdgeExtension() ), region - bboxes[index].min() ) ) );
+  ImageView<float32> distance;
+  grassfire( alpha, distance );
+
+  weights.set_size( patch_bbox.width(), patch_bbox.height() );
+  for( int j=0; j<weights.rows(); ++j )
+    for( int i=0; i<weights.cols(); ++i )
+      weights(i,j) = std::min( distance(i+m_blend_radius,j+m_blend_radius), float32(m_blend_radius) );
+}
+
+
+// Generates a patch in FeatherBlend or SeamBlend mode.
+template <class PixelT>
+vw::ImageView<PixelT> vw::mosaic::ImageComposite<PixelT>::feather_patch( BBox2i const& patch_bbox ) const {
+#if VW_DEBUG_LEVEL > 1
+  vw_out(DebugMessage, "mosaic") << "ImageComposite compositing patch " << patch_bbox << "..." << std::endl;
+#endif
+  std::vector<size_t> overlapping;
+  find_sources( patch_bbox, overlapping );
+
+  // Without an overlap there's nothing to blend
+  if( overlapping.size() < 2 ) return draft_patch( patch_bbox );
+
+  std::vector<ImageView<float32> > weights( overlapping.size() );
+  if( m_num_threads > 1 ) {
+    FifoWorkQueue queue( std::min( m_num_threads, int(overlapping.size()) ) );
+    for( size_t k=0; k<overlapping.size(); ++k )
+      queue.add_task( boost::shared_ptr<Task>( new WeightTask( *this, overlapping[k], patch_bbox, weights[k] ) ) );
+    queue.join_all();
+  }
+  else {
+    for( size_t k=0; k<overlapping.size(); ++k )
+      generate_weights( overlapping[k], patch_bbox, weights[k] );
+  }
+
+  // In SeamBlend mode wsum holds the weight of the chosen source
+  typedef typename CompoundChannelCast<pixel_type,float32>::type sum_type;
+  ImageView<pixel_type> composite( patch_bbox.width(), patch_bbox.height() );
+  ImageView<sum_type> sum;
+  if( m_blend_mode == FeatherBlend ) sum.set_size( patch_bbox.width(), patch_bbox.height() );
+  ImageView<float32> wsum( patch_bbox.width(), patch_bbox.height() );
+  for( size_t k=0; k<overlapping.size(); ++k ) {
+    size_t p = overlapping[k];
+    BBox2i bbox = patch_bbox;
+    bbox.crop( bboxes[p] );
+    ImageView<pixel_type> source = crop( sourcerefs[p], bbox-bboxes[p].min() );
+    int ox = bbox.min().x()-patch_bbox.min().x(), oy = bbox.min().y()-patch_bbox.min().y();
+    for( int j=0; j<source.rows(); ++j ) {
+      for( int i=0; i<source.cols(); ++i ) {
+        float32 weight = weights[k](ox+i,oy+j);
+        if( weight == 0 ) continue;
+        if( m_blend_mode == FeatherBlend ) {
+          sum(ox+i,oy+j) += weight * channel_cast<float32>( source(i,j) );
+          wsum(ox+i,oy+j) += weight;
+        }
+        // Later sources win ties, as in draft mode
+        else if( weight >= wsum(ox+i,oy+j) ) {
+          composite(ox+i,oy+j) = source(i,j);
+          wsum(ox+i,oy+j) = weight;
+        }
+      }
+    }
+  }
+
+  if( m_blend_mode == FeatherBlend ) {
+    for( int j=0; j<composite.rows(); ++j )
+      for( int i=0; i<composite.cols(); ++i )
+        if( wsum(i,j) > 0 ) composite(i,j) = channel_cast<channel_type>( sum(i,j) / wsum(i,j) );
+  }
+  return composite;
+}
+
 #endif // __VW_MOSAIC_IMAGECOMPOSITE_H__
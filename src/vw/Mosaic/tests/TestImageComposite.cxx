@@ -17,11 +17,14 @@
 
 
 #include <gtest/gtest_VW.h>
+#include <test/Helpers.h>
 #include <vw/Mosaic/ImageComposite.h>
+#include <vw/Image/PixelTypes.h>
 
 using namespace std;
 using namespace vw;
 using namespace vw::mosaic;
+using namespace vw::test;
 
 ImageView<uint32> make(uint32 x) {
   ImageView<uint32> img(8,8);
@@ -50,3 +53,180 @@ TEST(TestImageComposite, Basic) {
       EXPECT_EQ(2, c(col, row)) << "at (" << col << "," << row << ")";
   }
 }
+
+TEST(TestImageComposite, DraftOrder) {
+  // A grid of overlapping tiles; where they overlap the last one
+  // inserted is on top.
+  ImageComposite<uint32> c;
+  c.set_draft_mode(true);
+  for (uint32 i = 0; i < 100; ++i)
+    c.insert(make(i+1), 6*(i%10), 6*(i/10));
+  c.prepare();
+  EXPECT_EQ(62, c.cols());
+  EXPECT_EQ(62, c.rows());
+
+  ImageView<uint32> image = c.generate_patch(BBox2i(0,0,62,62));
+  for (int32 row = 0; row < 62; ++row)
+    for (int32 col = 0; col < 62; ++col) {
+      int32 i = std::min(col/6, 9), j = std::min(row/6, 9);
+      EXPECT_EQ(uint32(10*j+i+1), image(col, row)) << "at (" << col << "," << row << ")";
+    }
+}
+
+typedef PixelRGBA<float32> PixelT;
+
+// A piece of one big textured image
+PixelT texture(int32 x, int32 y) {
+  float v = 0.2f + 0.05f*((x*7 + y*3) % 11);
+  return PixelT(v, 0.5f*v, 1.0f-v, 1.0f);
+}
+
+ImageView<PixelT> make_piece(BBox2i const& bbox) {
+  ImageView<PixelT> img(bbox.width(), bbox.height());
+  for (int32 row = 0; row < bbox.height(); ++row)
+    for (int32 col = 0; col < bbox.width(); ++col)
+      img(col, row) = texture(bbox.min().x()+col, bbox.min().y()+row);
+  return img;
+}
+
+// Is pix at least 'border' pixels inside any of the three bboxes?
+bool inside(BBox2i const* bboxes, Vector2i const& pix, int32 border) {
+  for (int32 i = 0; i < 3; ++i) {
+    BBox2i bbox = bboxes[i];
+    bbox.contract(border);
+    if (bbox.contains(pix)) return true;
+  }
+  return false;
+}
+
+TEST(TestImageComposite, BlendPatches) {
+  UnlinkName mask0("mask.0.png"), mask1("mask.1.png"), mask2("mask.2.png");
+
+  // Overlapping pieces of the same image blend back into that image,
+  // whichever way the mosaic is cut into patches.
+  BBox2i pieces[3] = { BBox2i(0, 0, 90, 70), BBox2i(60, 20, 80, 90), BBox2i(10, 80, 70, 40) };
+  ImageComposite<PixelT> c;
+  for (int32 i = 0; i < 3; ++i)
+    c.insert(make_piece(pieces[i]), pieces[i].min().x(), pieces[i].min().y());
+  c.prepare();
+  ASSERT_EQ(140, c.cols());
+  ASSERT_EQ(120, c.rows());
+
+  for (int32 size = 16; size <= 256; size *= 4) {
+    for (int32 y = 0; y < c.rows(); y += size)
+      for (int32 x = 0; x < c.cols(); x += size) {
+        ImageView<PixelT> patch = c.generate_patch(BBox2i(x, y, size, size));
+        for (int32 row = 0; row < size && y+row < c.rows(); ++row)
+          for (int32 col = 0; col < size && x+col < c.cols(); ++col) {
+            Vector2i pix(x+col, y+row);
+            if (inside(pieces, pix, 0)) {
+              // Pyramids of different sources disagree near their edges
+              if (inside(pieces, pix, 8))
+                EXPECT_PIXEL_NEAR(texture(pix.x(), pix.y()), patch(col, row), 1e-3);
+            }
+            else
+              EXPECT_EQ(0, patch(col, row).a());
+          }
+      }
+  }
+}
+
+TEST(TestImageComposite, Threaded) {
+  UnlinkName mask0("mask.0.png"), mask1("mask.1.png"), mask2("mask.2.png");
+
+  // Threads change how the work is split, not the result
+  BBox2i pieces[3] = { BBox2i(0, 0, 90, 70), BBox2i(60, 20, 80, 90), BBox2i(10, 80, 70, 40) };
+  ImageComposite<PixelT> serial, threaded;
+  threaded.set_num_threads(4);
+  for (int32 i = 0; i < 3; ++i) {
+    serial.insert(make_piece(pieces[i]), pieces[i].min().x(), pieces[i].min().y());
+    threaded.insert(make_piece(pieces[i]), pieces[i].min().x(), pieces[i].min().y());
+  }
+  serial.prepare();
+  ImageView<PixelT> expected = serial.generate_patch(BBox2i(0, 0, 140, 120));
+  threaded.prepare();
+  ImageView<PixelT> result = threaded.generate_patch(BBox2i(0, 0, 140, 120));
+
+  ASSERT_EQ(expected.cols(), result.cols());
+  ASSERT_EQ(expected.rows(), result.rows());
+  for (int32 row = 0; row < result.rows(); ++row)
+    for (int32 col = 0; col < result.cols(); ++col)
+      EXPECT_PIXEL_EQ(expected(col, row), result(col, row));
+
+  EXPECT_THROW(threaded.set_num_threads(0), ArgumentErr);
+}
+
+ImageView<PixelT> make_constant(int32 cols, int32 rows, PixelT const& value) {
+  ImageView<PixelT> img(cols, rows);
+  fill(img, value);
+  return img;
+}
+
+TEST(TestImageComposite, Feather) {
+  // Pieces of one image feather back into that image
+  BBox2i pieces[3] = { BBox2i(0, 0, 90, 70), BBox2i(60, 20, 80, 90), BBox2i(10, 80, 70, 40) };
+  ImageComposite<PixelT> c;
+  c.set_blend_mode(FeatherBlend);
+  c.set_blend_radius(10);
+  for (int32 i = 0; i < 3; ++i)
+    c.insert(make_piece(pieces[i]), pieces[i].min().x(), pieces[i].min().y());
+  c.prepare();
+  ImageView<PixelT> whole = c.generate_patch(BBox2i(0, 0, 140, 120));
+  for (int32 row = 0; row < 120; ++row)
+    for (int32 col = 0; col < 140; ++col) {
+      if (inside(pieces, Vector2i(col, row), 0))
+        EXPECT_PIXEL_NEAR(texture(col, row), whole(col, row), 1e-5);
+      else
+        EXPECT_EQ(0, whole(col, row).a());
+    }
+
+  // Two flat images: the weights ramp up over the radius from each edge
+  PixelT red(1, 0, 0, 1), blue(0, 0, 1, 1);
+  ImageComposite<PixelT> f;
+  f.set_blend_mode(FeatherBlend);
+  f.set_blend_radius(8);
+  f.insert(make_constant(60, 40, red), 0, 0);
+  f.insert(make_constant(60, 40, blue), 30, 0);
+  f.prepare();
+  ImageView<PixelT> feathered = f.generate_patch(BBox2i(0, 0, 90, 40));
+  EXPECT_PIXEL_NEAR(red, feathered(29, 20), 1e-6);
+  EXPECT_PIXEL_NEAR((8*red + 4*blue) / 12, feathered(33, 20), 1e-6);
+  EXPECT_PIXEL_NEAR((red + blue) / 2, feathered(37, 20), 1e-6);
+  EXPECT_PIXEL_NEAR(blue, feathered(60, 20), 1e-6);
+
+  // Patches match the whole, however the mosaic is cut up
+  for (int32 size = 7; size <= 64; size *= 3)
+    for (int32 y = 0; y < 40; y += size)
+      for (int32 x = 0; x < 90; x += size) {
+        ImageView<PixelT> patch = f.generate_patch(BBox2i(x, y, size, size));
+        for (int32 row = 0; row < size && y+row < 40; ++row)
+          for (int32 col = 0; col < size && x+col < 90; ++col)
+            EXPECT_PIXEL_EQ(feathered(x+col, y+row), patch(col, row));
+      }
+
+  EXPECT_THROW(f.set_blend_radius(0), ArgumentErr);
+}
+
+TEST(TestImageComposite, Seam) {
+  // The seam runs where the upper source is a radius from its edge
+  PixelT red(1, 0, 0, 1), blue(0, 0, 1, 1);
+  ImageComposite<PixelT> c;
+  c.set_blend_mode(SeamBlend);
+  c.set_blend_radius(8);
+  c.set_num_threads(2);
+  c.insert(make_constant(60, 40, red), 0, 0);
+  c.insert(make_constant(60, 40, blue), 30, 0);
+  c.prepare();
+  ImageView<PixelT> whole = c.generate_patch(BBox2i(0, 0, 90, 40));
+  for (int32 col = 0; col < 90; ++col)
+    EXPECT_PIXEL_EQ(col < 37 ? red : blue, whole(col, 20)) << "at column " << col;
+
+  for (int32 size = 7; size <= 64; size *= 3)
+    for (int32 y = 0; y < 40; y += size)
+      for (int32 x = 0; x < 90; x += size) {
+        ImageView<PixelT> patch = c.generate_patch(BBox2i(x, y, size, size));
+        for (int32 row = 0; row < size && y+row < 40; ++row)
+          for (int32 col = 0; col < size && x+col < 90; ++col)
+            EXPECT_PIXEL_EQ(whole(x+col, y+row), patch(col, row));
+      }
+}
@@ -28,6 +28,7 @@
 #include <vw/Math.h>
 #include <iostream>
 #include <cmath>
+#include <vector>
 
 namespace vw {
   namespace stereo {
@@ -84,10 +85,12 @@ namespace vw {
       AffineMixtureComponent(ImageViewBase<ImageT> const& left,
                              ImageViewBase<ImageT> const& right,
                              Vector2i window_size, PrecisionT sigma_0, PrecisionT sigma_min) :
-      left_r(left.impl()), right_r(right.impl()), s(sigma_0), s0(sigma_0), s_min(sigma_min),
+      s(sigma_0), s0(sigma_0), s_min(sigma_min),
         M_transform_linear(matrix_data_linear), M_transform_offset(matrix_data_offset),
         pos_linearize(0, 0), w(window_size(0), window_size(1)), p(window_size(0), window_size(1)), w_gaussian(window_size(0), window_size(1)),
-        r_window(window_size(0), window_size(1)), l_window(window_size(0), window_size(1)), err(window_size(0), window_size(1))
+        sqrt_w_gaussian(window_size(0), window_size(1)), log_sqrt_w_gaussian(window_size(0), window_size(1)), w_adj(window_size(0), window_size(1)),
+        r_window(window_size(0), window_size(1)), r_window_dx(window_size(0), window_size(1)), r_window_dy(window_size(0), window_size(1)),
+        l_window(window_size(0), window_size(1)), err(window_size(0), window_size(1))
         {
           matrix_data_linear[0] = 1.; matrix_data_linear[1] = 0.; // linear component of affine transform
           matrix_data_linear[2] = 0; matrix_data_linear[3] = 1; // linear component of affine transform
@@ -102,18 +105,10 @@ namespace vw {
           fill(w, 1.);
           fill(p, .5);
 
-          // make derivative kernels
-          ImageView<PrecisionT> dx_kernel(3,3), dy_kernel(3,3);
-          fill(dx_kernel, 0.);
-          dx_kernel(0,1) = .5; dx_kernel(1,1) = 0; dx_kernel(2,1) = -.5;
-          fill(dy_kernel, 0.);
-          dy_kernel(1,0) = .5; dy_kernel(1,1) = 0; dy_kernel(1,2) = -.5;
-
-          // precompute and cache right image derivatives
-          r_image_dx = convolution_filter(right_r, dx_kernel);
-          r_image_dy = convolution_filter(right_r, dy_kernel);
+          set_images(left, right);
 
           l_likelihood = INFINITY;
+          last_change = INFINITY;
 
           debug = false;
 
@@ -127,6 +122,27 @@ namespace vw {
           window.max() = Vector2(window_size(0), window_size(1));
         }
 
+      /// Switch to a new image pair, reusing the buffers when the size
+      /// has not changed.  The right image is rasterized here, once,
+      /// since every step of the fit resamples it.  The left image is
+      /// only cropped once per window.
+      template<class ImageT>
+      void set_images(ImageViewBase<ImageT> const& left, ImageViewBase<ImageT> const& right) {
+        left_r = ImageViewRef<PixelT>(left.impl());
+        right_r = right.impl();
+
+        // make derivative kernels
+        ImageView<PrecisionT> dx_kernel(3,3), dy_kernel(3,3);
+        fill(dx_kernel, 0.);
+        dx_kernel(0,1) = .5; dx_kernel(1,1) = 0; dx_kernel(2,1) = -.5;
+        fill(dy_kernel, 0.);
+        dy_kernel(1,0) = .5; dy_kernel(1,1) = 0; dy_kernel(1,2) = -.5;
+
+        // precompute and cache right image derivatives
+        r_image_dx = convolution_filter(right_r, dx_kernel);
+        r_image_dy = convolution_filter(right_r, dy_kernel);
+      }
+
       void reset(BBox2i left_window,
                  PrecisionT disparity_x, PrecisionT disparity_y,
                  Matrix2x2 warp, ImageView<PrecisionT> const& g) {
@@ -149,11 +165,16 @@ namespace vw {
 
         T = AffineTransformOrigin(M_transform_linear, M_transform_offset, pos_linearize);
 
-        r_window = crop(transform(right_r, T), window);
         l_window = crop(left_r, window);
-        err = r_window - l_window;
+        warp_window(false);
 
         w_gaussian = g;
+        for(int j = 0; j < w_gaussian.rows(); j++) {
+          for(int i = 0; i < w_gaussian.cols(); i++) {
+            sqrt_w_gaussian(i, j) = sqrt(w_gaussian(i, j));
+            log_sqrt_w_gaussian(i, j) = log(sqrt_w_gaussian(i, j));
+          }
+        }
       }
 
       PrecisionT log_likelihood() {
@@ -167,8 +188,15 @@ namespace vw {
 
       void update_posterior() {
         // our model distribution is N(J_{Tx}, s/w_gaussian)
-        p = exp(-.5*w_gaussian*pow(err/s, 2))*sqrt(w_gaussian)/(s*sqrt_2_pi); // gaussian posterior density
+        // p = exp(-.5*w_gaussian*pow(err/s, 2))*sqrt(w_gaussian)/(s*sqrt_2_pi); // gaussian posterior density
         // <=> to exp(-.5*pow(err/(s/sqrt(w_g)), 2))/(sqrt_2_pi*s/sqrt(w_g)); // gaussian posterior density
+        PrecisionT norm = s*sqrt_2_pi;
+        for(int j = 0; j < p.rows(); j++) {
+          for(int i = 0; i < p.cols(); i++) {
+            PrecisionT e = err(i, j)/s;
+            p(i, j) = exp(-.5*w_gaussian(i, j)*(e*e))*sqrt_w_gaussian(i, j)/norm;
+          }
+        }
       }
 
       PrecisionT sigma() {
@@ -200,39 +228,48 @@ namespace vw {
 
       ImageView<PrecisionT> const& prob() const { return p; }
 
+      /// The largest change of any of the six affine parameters made by
+      /// the last fit_parameters().
+      PrecisionT parameter_change() const { return last_change; }
+
       void set_debug(bool p_debug) { debug = p_debug; }
 
       inline void m_compute_gradient_hessian(Vector<PrecisionT, 6> &gradient, Matrix<double, 6, 6> &hessian,
                                              int x, int y,
-                                             ImageView<PrecisionT> const &weights, ImageView<PixelT> const &err,
+                                             ImageView<PrecisionT> const &weights, ImageView<PrecisionT> const &err,
                                              ImageView<PixelT> const &r_window_dx, ImageView<PixelT> const &r_window_dy) const
       {
         int kernel_height = err.rows();
         int kernel_width = err.cols();
 
-        typename ImageView<PrecisionT>::pixel_accessor weights_iter = weights.origin();
-        typename ImageView<PixelT>::pixel_accessor err_iter = err.origin();
-
-        typename ImageView<PixelT>::pixel_accessor dx_iter = r_window_dx.origin();
-        typename ImageView<PixelT>::pixel_accessor dy_iter = r_window_dy.origin();
+        // The sums are kept in locals rather than in gradient and
+        // hessian so that they can stay in registers.
+        PrecisionT g0 = 0, g1 = 0, g2 = 0, g3 = 0, g4 = 0, g5 = 0;
+        PrecisionT h00 = 0, h01 = 0, h02 = 0, h03 = 0, h04 = 0, h05 = 0;
+        PrecisionT h11 = 0, h12 = 0, h13 = 0, h14 = 0, h15 = 0;
+        PrecisionT h22 = 0, h23 = 0, h24 = 0, h25 = 0;
+        PrecisionT h33 = 0, h34 = 0, h35 = 0;
+        PrecisionT h44 = 0, h45 = 0;
+        PrecisionT h55 = 0;
 
-        fill(gradient, 0);
-        hessian.set_zero();
         int i, j;
         for(i = 0; i < kernel_height; i++) {
+          PrecisionT const* weights_ptr = &weights(0, i);
+          PrecisionT const* err_ptr = &err(0, i);
+          PixelT const* dx_ptr = &r_window_dx(0, i);
+          PixelT const* dy_ptr = &r_window_dy(0, i);
+          PrecisionT ty = y + i - (kernel_height-1)/2.;
+          PrecisionT tyty = ty*ty;
           for(j = 0; j < kernel_width; j++) {
-            PrecisionT ty = y + i - (kernel_height-1)/2.;
             PrecisionT tx = x + j - (kernel_width-1)/2.;
 
             PrecisionT txtx = tx*tx;
-            PrecisionT tyty = ty*ty;
             PrecisionT txty = tx*ty;
 
-
-            PrecisionT cache_w = *weights_iter;
-            PrecisionT cache_e = *err_iter;
-            PrecisionT cache_dx = *dx_iter;
-            PrecisionT cache_dy = *dy_iter;
+            PrecisionT cache_w = weights_ptr[j];
+            PrecisionT cache_e = err_ptr[j];
+            PrecisionT cache_dx = dx_ptr[j];
+            PrecisionT cache_dy = dy_ptr[j];
 
             // these are implemented directly below, but commented out here as a reference
             //PrecisionT cache_a = cache_dx*cache_dx;
@@ -244,49 +281,53 @@ namespace vw {
             PrecisionT cache_w_cache_b = cache_w*cache_dx*cache_dy;
             PrecisionT cache_w_cache_c = cache_w*cache_dy*cache_dy;
 
-            gradient(0) += cache_w_cache_e*tx*cache_dx; // lhs(0) += tx * dx_val * de_val; // a
-            gradient(1) += cache_w_cache_e*tx*cache_dy; // lhs(3) += tx * dy_val * e_val;  // c
-            gradient(2) += cache_w_cache_e*ty*cache_dx; // lhs(1) += ty * dx_val * e_val;  // b
-            gradient(3) += cache_w_cache_e*ty*cache_dy; // lhs(4) += ty * dy_val * e_val;  // d
-            gradient(4) += cache_w_cache_e*cache_dx;    // lhs(2) +=      dx_val * e_val;  // horizontal
-            gradient(5) += cache_w_cache_e*cache_dy;    // lhs(5) +=      dy_val * e_val;  // vertical
-
-            hessian(0, 0) += cache_w_cache_a*txtx;
-            hessian(0, 1) += cache_w_cache_b*txtx;
-            hessian(0, 2) += cache_w_cache_a*txty;
+            g0 += cache_w_cache_e*tx*cache_dx; // lhs(0) += tx * dx_val * de_val; // a
+            g1 += cache_w_cache_e*tx*cache_dy; // lhs(3) += tx * dy_val * e_val;  // c
+            g2 += cache_w_cache_e*ty*cache_dx; // lhs(1) += ty * dx_val * e_val;  // b
+            g3 += cache_w_cache_e*ty*cache_dy; // lhs(4) += ty * dy_val * e_val;  // d
+            g4 += cache_w_cache_e*cache_dx;    // lhs(2) +=      dx_val * e_val;  // horizontal
+            g5 += cache_w_cache_e*cache_dy;    // lhs(5) +=      dy_val * e_val;  // vertical
 
-            hessian(0, 3) += cache_w_cache_b*txty;
-            hessian(0, 4) += cache_w_cache_a*tx;
-            hessian(0, 5) += cache_w_cache_b*tx;
+            h00 += cache_w_cache_a*txtx;
+            h01 += cache_w_cache_b*txtx;
+            h02 += cache_w_cache_a*txty;
 
-            hessian(1, 1) += cache_w_cache_c*txtx;
-            hessian(1, 2) += cache_w_cache_b*txty;
+            h03 += cache_w_cache_b*txty;
+            h04 += cache_w_cache_a*tx;
+            h05 += cache_w_cache_b*tx;
 
-            hessian(1, 3) += cache_w_cache_c*txty;
-            hessian(1, 4) += cache_w_cache_b*tx;
-            hessian(1, 5) += cache_w_cache_c*tx;
+            h11 += cache_w_cache_c*txtx;
+            h12 += cache_w_cache_b*txty;
 
-            hessian(2, 2) += cache_w_cache_a*tyty;
-            hessian(2, 3) += cache_w_cache_b*tyty;
-            hessian(2, 4) += cache_w_cache_a*ty;
-            hessian(2, 5) += cache_w_cache_b*ty;
+            h13 += cache_w_cache_c*txty;
+            h14 += cache_w_cache_b*tx;
+            h15 += cache_w_cache_c*tx;
 
-            hessian(3, 3) += cache_w_cache_c*tyty;
-            hessian(3, 4) += cache_w_cache_b*ty;
-            hessian(3, 5) += cache_w_cache_c*ty;
+            h22 += cache_w_cache_a*tyty;
+            h23 += cache_w_cache_b*tyty;
+            h24 += cache_w_cache_a*ty;
+            h25 += cache_w_cache_b*ty;
 
-            hessian(4, 4) += cache_w_cache_a;
-            hessian(4, 5) += cache_w_cache_b;
+            h33 += cache_w_cache_c*tyty;
+            h34 += cache_w_cache_b*ty;
+            h35 += cache_w_cache_c*ty;
 
-            hessian(5, 5) += cache_w_cache_c;
+            h44 += cache_w_cache_a;
+            h45 += cache_w_cache_b;
 
-            weights_iter.next_col();
-            err_iter.next_col();
-            dx_iter.next_col();
-            dy_iter.next_col();
+            h55 += cache_w_cache_c;
           }
-
         }
+
+        gradient(0) = g0; gradient(1) = g1; gradient(2) = g2;
+        gradient(3) = g3; gradient(4) = g4; gradient(5) = g5;
+
+        hessian(0, 0) = h00; hessian(0, 1) = h01; hessian(0, 2) = h02; hessian(0, 3) = h03; hessian(0, 4) = h04; hessian(0, 5) = h05;
+        hessian(1, 1) = h11; hessian(1, 2) = h12; hessian(1, 3) = h13; hessian(1, 4) = h14; hessian(1, 5) = h15;
+        hessian(2, 2) = h22; hessian(2, 3) = h23; hessian(2, 4) = h24; hessian(2, 5) = h25;
+        hessian(3, 3) = h33; hessian(3, 4) = h34; hessian(3, 5) = h35;
+        hessian(4, 4) = h44; hessian(4, 5) = h45;
+        hessian(5, 5) = h55;
         int k, l;
         for(k = 0; k < 6; k++) {
           for(l = k; l < 6; l++) {
@@ -312,10 +353,12 @@ namespace vw {
         PrecisionT x = pos_linearize(0);
         PrecisionT y = pos_linearize(1);
 
-        ImageViewRef<PrecisionT> w_adj = w*w_gaussian;
-
-        ImageView<PixelT> r_window_dx(window.width(), window.height());
-        ImageView<PixelT> r_window_dy(window.width(), window.height());
+        // the weights do not change during the fit
+        for(int j = 0; j < w.rows(); j++) {
+          for(int i = 0; i < w.cols(); i++) {
+            w_adj(i, j) = w(i, j)*w_gaussian(i, j);
+          }
+        }
 
         typedef Vector<PrecisionT, 6> Vector6;
         typedef Matrix<PrecisionT, 6, 6> Matrix66;
@@ -323,9 +366,14 @@ namespace vw {
         Vector6 gradient, soln;
         Matrix66 hessian_temp;
 
-        Vector6* gradient_hist = new Vector6[inner_loop_iter_max];
-        Vector6* state_hist = new Vector6[inner_loop_iter_max];
-        Matrix66* hessian_hist = new Matrix66[inner_loop_iter_max];
+        // only kept for debugging
+        std::vector<Vector6> gradient_hist(debug ? inner_loop_iter_max : 0);
+        std::vector<Vector6> state_hist(debug ? inner_loop_iter_max : 0);
+        std::vector<Matrix66> hessian_hist(debug ? inner_loop_iter_max : 0);
+
+        PrecisionT start_state[6];
+        std::copy(matrix_data_linear, matrix_data_linear + 4, start_state);
+        std::copy(matrix_data_offset, matrix_data_offset + 2, start_state + 4);
 
         PrecisionT initial_norm_grad = 0;
         if(debug) {
@@ -333,11 +381,9 @@ namespace vw {
         }
         // initialized cropped transformations of the right window under the current value of T; and err
         T = AffineTransformOrigin(M_transform_linear, M_transform_offset, Vector2(x, y));
-        r_window = crop(transform(right_r, T), window);
-        l_window = crop(left_r, window);
-        err = r_window - l_window;
+        warp_window(false); // l_window was cropped by reset()
 
-        double l_likelihood_old = sum_of_pixel_values(.5*w_adj*pow(err/s,2) - w*log(sqrt(w_gaussian))) + sum_of_pixel_values(w)*(log(s) + log(sqrt_2_pi)); //TODO: remove
+        double l_likelihood_old = m_log_likelihood(s) + sum_of_pixel_values(w)*(log(s) + log(sqrt_2_pi)); //TODO: remove
 
         // the transformation parameter, 'T', is estimated iteratively in this inner loop
         int inner_loop_iter;
@@ -350,10 +396,7 @@ namespace vw {
           inner_loop_window_timer.start();
 
           // compute the transformed derivatives
-          r_window_dx = crop(transform(r_image_dx, T), window);
-          r_window_dy = crop(transform(r_image_dy, T), window);
-
-          err = r_window - l_window;
+          warp_window(true);
 
           inner_loop_window_timer.stop();
           //std::cout << "inner loop window setup " << 1000*inner_loop_window_timer.elapsed_seconds() << std::endl;
@@ -398,7 +441,7 @@ namespace vw {
 
           Stopwatch lm_timer;
           // perform the update here; do line search
-          PrecisionT f_value_last = sum_of_pixel_values(w_adj*pow(err, 2));
+          PrecisionT f_value_last = m_weighted_sse();
           bool min_step_size_hit = false;
           lm_timer.start();
 
@@ -448,8 +491,7 @@ namespace vw {
               //std::cout << "updating" << std::endl;
               //PrecisionT determinant = matrix_data_linear[0]*matrix_data_linear[3] - matrix_data_linear[1]*matrix_data_linear[2]; // unused
               T = AffineTransformOrigin(M_transform_linear, M_transform_offset, Vector2(x, y));
-              r_window = crop(transform(right_r, T), window);
-              err = r_window - l_window;
+              warp_window(false);
               min_step_size_hit = true;
               //std::cout << "min_step_size_hit" << std::endl;
               break;
@@ -499,9 +541,8 @@ namespace vw {
             T = AffineTransformOrigin(M_transform_linear, M_transform_offset, Vector2(x, y));
 
             //std::cout << "updating values" << std::endl;
-            r_window = crop(transform(right_r, T), window);
-            err = r_window - l_window;
-            f_value = sum_of_pixel_values(w_adj*pow(err, 2));
+            warp_window(false);
+            f_value = m_weighted_sse();
             //std::cout << "solved" << std::endl;
             //std::cout << "testing: " << matrix_data_linear[0] << " " << matrix_data_linear[1] << " " << matrix_data_linear[2] << " " << matrix_data_linear[3] << " "
             // << matrix_data_offset[0] << " " << matrix_data_offset[1] << std::endl;
@@ -547,15 +588,14 @@ namespace vw {
 
         // recompute these with the final converged values
         T = AffineTransformOrigin(M_transform_linear, M_transform_offset, Vector2(x, y));
-        r_window = crop(transform(right_r, T), window);
-        err = r_window - l_window;
+        warp_window(false);
 
         PrecisionT sum_weights = sum_of_pixel_values(w); // this is the normalization constant for the weights
 
-        s = sqrt(sum_of_pixel_values(w_adj*pow(err, 2))/sum_weights);
+        s = sqrt(m_weighted_sse()/sum_weights);
         s = std::max<double>(s, s_min); // threshold the variance so it never gets too small
 
-        l_likelihood = sum_of_pixel_values(.5*w_adj*pow(err/s,2) - w*log(sqrt(w_gaussian))) + sum_weights*(log(s) + log(sqrt_2_pi));
+        l_likelihood = m_log_likelihood(s) + sum_weights*(log(s) + log(sqrt_2_pi));
         l_set = true;
 
         if(l_likelihood_old + 1e-8 < l_likelihood) {
@@ -565,17 +605,111 @@ namespace vw {
 
         hess = hess/(sum_weights*s*s);
 
-        // Clean up our dynamic arrays
-        delete[] gradient_hist;
-        delete[] state_hist;
-        delete[] hessian_hist;
+        last_change = 0;
+        for(int i = 0; i < 4; i++)
+          last_change = std::max<PrecisionT>(last_change, fabs(matrix_data_linear[i] - start_state[i]));
+        for(int i = 0; i < 2; i++)
+          last_change = std::max<PrecisionT>(last_change, fabs(matrix_data_offset[i] - start_state[i+4]));
       }
 
     private:
+      typedef typename FloatType<typename CompoundChannelType<PixelT>::type>::type real_type;
+
+      // Where a window pixel lands in the right image, and its bilinear
+      // weights, in the arithmetic of BilinearInterpolation, so that the
+      // windows below match crop(transform(image, T), window) exactly.
+      struct Footprint {
+        int32 x, y;
+        bool integer, inside;
+        real_type normx, normy, norm1mx, norm1my;
+      };
+
+      static PixelT tap(ImageView<PixelT> const& image, int32 x, int32 y) {
+        if (x < 0 || y < 0 || x >= image.cols() || y >= image.rows())
+          return PixelT(); // zero edge extension
+        return image(x, y);
+      }
+
+      static PixelT sample(ImageView<PixelT> const& image, Footprint const& f) {
+        if (f.integer)
+          return tap(image, f.x, f.y);
+        PixelT p00, p10, p01, p11;
+        if (f.inside) {
+          PixelT const* row0 = &image(f.x, f.y);
+          PixelT const* row1 = &image(f.x, f.y+1);
+          p00 = row0[0]; p10 = row0[1];
+          p01 = row1[0]; p11 = row1[1];
+        }
+        else {
+          p00 = tap(image, f.x, f.y);   p10 = tap(image, f.x+1, f.y);
+          p01 = tap(image, f.x, f.y+1); p11 = tap(image, f.x+1, f.y+1);
+        }
+        real_type result = p00 * f.norm1mx;
+        result += p10 * f.normx;
+        result *= f.norm1my;
+        real_type row = p01 * f.norm1mx;
+        row += p11 * f.normx;
+        result += row * f.normy;
+        return result;
+      }
+
+      // Resample the right window (and, if asked, its derivatives) under
+      // the current T, and update err to match.
+      void warp_window(bool derivatives) {
+        Footprint f;
+        for(int v = 0; v < window.height(); v++) {
+          for(int u = 0; u < window.width(); u++) {
+            Vector2 pt = T.reverse(Vector2(window.min().x() + u, window.min().y() + v));
+            double i = pt[0], j = pt[1];
+            f.x = math::impl::_floor(i);
+            f.y = math::impl::_floor(j);
+            f.integer = f.x == i && f.y == j;
+            f.inside = f.x >= 0 && f.y >= 0 && f.x + 1 < right_r.cols() && f.y + 1 < right_r.rows();
+            f.normx = real_type(i)-real_type(f.x);
+            f.normy = real_type(j)-real_type(f.y);
+            f.norm1mx = 1-f.normx;
+            f.norm1my = 1-f.normy;
+
+            PixelT r = sample(right_r, f);
+            r_window(u, v) = r;
+            if(derivatives) {
+              r_window_dx(u, v) = sample(r_image_dx, f);
+              r_window_dy(u, v) = sample(r_image_dy, f);
+            }
+            PixelT e = r - l_window(u, v);
+            err(u, v) = e;
+          }
+        }
+      }
+
+      // sum_of_pixel_values(w_adj*pow(err, 2))
+      PrecisionT m_weighted_sse() const {
+        PrecisionT sum = 0;
+        for(int j = 0; j < err.rows(); j++) {
+          for(int i = 0; i < err.cols(); i++) {
+            PrecisionT e = err(i, j);
+            sum += w_adj(i, j)*(e*e);
+          }
+        }
+        return sum;
+      }
+
+      // sum_of_pixel_values(.5*w_adj*pow(err/sigma,2) - w*log(sqrt(w_gaussian)))
+      PrecisionT m_log_likelihood(PrecisionT sigma) const {
+        PrecisionT sum = 0;
+        for(int j = 0; j < err.rows(); j++) {
+          for(int i = 0; i < err.cols(); i++) {
+            PrecisionT e = err(i, j)/sigma;
+            sum += .5*w_adj(i, j)*(e*e) - w(i, j)*log_sqrt_w_gaussian(i, j);
+          }
+        }
+        return sum;
+      }
+
       bool debug;
 
       ImageViewRef<PixelT> left_r;
-      ImageViewRef<PixelT> right_r;
+      ImageView<PixelT> right_r;
 
       PrecisionT s, s0;
       PrecisionT s_min;
@@ -597,13 +731,17 @@ namespace vw {
       ImageView<PrecisionT> w;  // weights
       ImageView<PrecisionT> p; // posterior probabilities of data in window
       ImageView<PrecisionT> w_gaussian;  // gaussian window
+      ImageView<PrecisionT> sqrt_w_gaussian, log_sqrt_w_gaussian; // cached per window
+      ImageView<PrecisionT> w_adj; // w*w_gaussian, during a fit
 
       ImageView<PixelT> r_window;
+      ImageView<PixelT> r_window_dx, r_window_dy;
       ImageView<PixelT> l_window;
       ImageView<PrecisionT> err;
 
       AffineTransformOrigin T;
       bool l_set;
+      PrecisionT last_change; // see parameter_change()
 
       // numerical optimization parameters
       PrecisionT epsilon_inner;
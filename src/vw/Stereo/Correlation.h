@@ -23,6 +23,7 @@
 #include <vw/Core/FundamentalTypes.h>
 #include <vw/Core/Stopwatch.h>
 #include <vw/Image/AlgorithmFunctions.h>
+#include <vw/Image/CensusTransform.h>
 #include <vw/Image/PixelMask.h>
 #include <vw/Stereo/Algorithms.h>
 #include <vw/Stereo/CostFunctions.h>
@@ -151,6 +152,69 @@ namespace stereo {
 
 
 
+  /// The threshold SGM uses for its ternary census on uint8 images,
+  /// scaled to the channel type's range.  The scale is fixed by the
+  /// type, so it means the same in every tile.
+  template <class ChannelT>
+  typename AccumulatorType<ChannelT>::type ternary_census_threshold() {
+    const double TERNARY_DIFF_THRESHOLD = 5.0 / 255.0;
+    return typename AccumulatorType<ChannelT>::type
+      (TERNARY_DIFF_THRESHOLD * ChannelRange<ChannelT>::max());
+  }
+
+  /// Census version of best_of_search_convolution.  Both rasters are
+  /// transformed into 5x5 census descriptors on their own pixel values,
+  /// so that each disparity only costs a Hamming distance per pixel
+  /// before the box sum.
+  template <class PixelT>
+  ImageView<PixelMask<Vector2i> >
+  census_best_of_search(CostFunctionType         cost_type,
+                        ImageView<PixelT> const& left_raster,
+                        ImageView<PixelT> const& right_raster,
+                        BBox2i            const& left_region,
+                        Vector2i          const& search_volume,
+                        Vector2i          const& kernel_size) {
+    typedef typename PixelChannelType<PixelT>::type channel_type;
+
+    ImageView<channel_type> left  = pixel_cast<channel_type>(left_raster ),
+                            right = pixel_cast<channel_type>(right_raster);
+
+    if (cost_type == TERNARY_CENSUS_TRANSFORM) {
+      ImageView<uint64> left_census, right_census;
+      ternary_census_transform_5x5(left,  left_census,  ternary_census_threshold<channel_type>());
+      ternary_census_transform_5x5(right, right_census, ternary_census_threshold<channel_type>());
+      return best_of_search_convolution<HammingCost>(left_census, right_census, left_region,
+                                                     search_volume, kernel_size);
+    }
+    ImageView<uint32> left_census, right_census;
+    census_transform_5x5(left,  left_census );
+    census_transform_5x5(right, right_census);
+    return best_of_search_convolution<HammingCost>(left_census, right_census, left_region,
+                                                   search_volume, kernel_size);
+  } // End function census_best_of_search
+
+  /// The census descriptors census_best_of_search() matches, for a
+  /// whole image.  Plain census descriptors are widened to 64 bits so
+  /// both kinds share a type.  Pass crops of the result to
+  /// calc_census_disparity() to match many regions of one image
+  /// without transforming each of them again.
+  template <class PixelT>
+  void census_descriptors(CostFunctionType         cost_type,
+                          ImageView<PixelT> const& image,
+                          ImageView<uint64>      & census) {
+    typedef typename PixelChannelType<PixelT>::type channel_type;
+    ImageView<channel_type> channels = pixel_cast<channel_type>(image);
+    if (cost_type == TERNARY_CENSUS_TRANSFORM) {
+      ternary_census_transform_5x5(channels, census, ternary_census_threshold<channel_type>());
+      return;
+    }
+    ImageView<uint32> plain;
+    census_transform_5x5(channels, plain);
+    census = pixel_cast<uint64>(plain);
+  }
+
+
+
   /// This actually RASTERIZES/COPY the input images. It then makes an
   /// allocation to store current costs.
   ///
@@ -203,11 +267,31 @@ namespace stereo {
       return best_of_search_convolution<NCCCost>(left, right, left_region, search_volume, kernel_size);
     case SQUARED_DIFFERENCE:
       return best_of_search_convolution<SquaredCost>(left, right, left_region, search_volume, kernel_size);
+    case CENSUS_TRANSFORM:
+    case TERNARY_CENSUS_TRANSFORM:
+      return census_best_of_search(cost_type, left, right, left_region, search_volume, kernel_size);
     default: // case ABSOLUTE_DIFFERENCE:
       return best_of_search_convolution<AbsoluteCost>(left, right, left_region, search_volume, kernel_size);
     }
     
   } // End function calc_disparity
+
+  /// calc_disparity() for a census cost on descriptors that were
+  /// already computed by census_descriptors().  The regions are the
+  /// same as calc_disparity()'s.
+  template <class ImageT1, class ImageT2>
+  ImageView<PixelMask<Vector2i> >
+  calc_census_disparity(ImageViewBase<ImageT1> const& left_census,
+                        ImageViewBase<ImageT2> const& right_census,
+                        BBox2i                 const& left_region,
+                        Vector2i               const& search_volume,
+                        Vector2i               const& kernel_size) {
+    BBox2i right_region = left_region;
+    right_region.max() += search_volume - Vector2i(1,1);
+    ImageView<uint64> left ( crop(left_census.impl(),  left_region) );
+    ImageView<uint64> right( crop(right_census.impl(), right_region) );
+    return best_of_search_convolution<HammingCost>(left, right, left_region, search_volume, kernel_size);
+  } // End function calc_census_disparity
   
   
 
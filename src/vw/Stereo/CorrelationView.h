@@ -25,12 +25,15 @@
 #include <vw/Image/Algorithms.h>
 #include <vw/Image/ErodeView.h>
 #include <vw/Image/PerPixelAccessorViews.h>
+#include <vw/Image/ImageViewRef.h>
+#include <vw/Image/BlockRasterize.h>
 #include <vw/FileIO.h>
 #include <vw/Stereo/Correlation.h>
 #include <vw/Stereo/Correlate.h>
 #include <vw/Stereo/DisparityMap.h>
 #include <vw/Stereo/PreFilter.h>
 #include <boost/foreach.hpp>
+#include <boost/shared_ptr.hpp>
 #include <ctime>
 
 #include <vw/Stereo/SGM.h>
@@ -160,7 +163,8 @@ namespace stereo {
       m_sgm_subpixel_mode(sgm_subpixel_mode),
       m_sgm_search_buffer(sgm_search_buffer),
       m_memory_limit_mb(memory_limit_mb),
-      m_write_debug_images(write_debug_images){
+      m_write_debug_images(write_debug_images),
+      m_seed_level(0), m_seed(new SearchSeed){
       
       if (algorithm != CORRELATION_WINDOW)
         m_prefilter_mode = PREFILTER_NONE; // SGM/MGM works best with no prefilter
@@ -201,6 +205,18 @@ namespace stereo {
       vw::rasterize(prerasterize(proc_bbox), dest, bbox);
     }
 
+    /// Before the first tile, correlate the whole image at 1/2^level of
+    /// its resolution, and start each tile from the disparities found
+    /// there instead of from the whole search region.  Each part of the
+    /// tile then searches only around what the low resolution pass saw
+    /// nearby, so flat ground searches a few disparities.  Only the
+    /// CORRELATION_WINDOW algorithm uses this.  Zero, the default,
+    /// turns it off.
+    void set_search_seed_level(int32 level) {
+      VW_ASSERT( level >= 0, ArgumentErr() << "PyramidCorrelationView: the seed level cannot be negative." );
+      m_seed_level = level;
+      m_seed.reset(new SearchSeed);
+    }
 
 
   private: // Variables
@@ -237,6 +253,17 @@ namespace stereo {
 
     bool m_write_debug_images; ///< If true, write out a bunch of intermediate images.
 
+    /// The low resolution disparity that seeds the tiles.  It is found by
+    /// the first tile that needs it and shared by copies of the view.
+    struct SearchSeed {
+      Mutex mutex;
+      bool  ready;
+      ImageView<pixel_typeI> disparity; ///< In pixels of the seed resolution
+      SearchSeed() : ready(false) {}
+    };
+    int32 m_seed_level;
+    boost::shared_ptr<SearchSeed> m_seed;
+
   private: // Functions
 
     /// Downsample a mask by two.
@@ -283,6 +310,18 @@ namespace stereo {
     void disparity_blob_filter(ImageView<pixel_typeI > &disparity, int level,
                                int max_blob_area) const;
 
+    /// Return the seed disparity, computing it on the first call.
+    SearchSeed const& search_seed() const;
+
+    /// Fill zones for the coarsest level of the tile in bbox from the seed.
+    /// - level_mask is the left mask at that level and level_range its
+    ///   full disparity range.  Valid pixels with no seed disparity get
+    ///   zones of their own with the full range.
+    /// - Returns false if the seed does not cover the tile.
+    bool seed_zones(BBox2i const& bbox, int32 level,
+                    ImageView<typename Mask1T::pixel_type> const& level_mask,
+                    BBox2i const& level_range, std::vector<SearchParam>& zones) const;
+
 
 
   }; // End class PyramidCorrelationView
@@ -215,19 +215,213 @@ disparity_blob_filter(ImageView<pixel_typeI> &disparity, int level,
     vw_out() << "Finished writing DEBUG data...\n";
   } // End DEBUG
 
-  // Do the entire image at once!
-  BBox2i tile_size = bounding_box(disparity);
-  int big_size = tile_size.width();
-  if (tile_size.height() > big_size) 
-    big_size = tile_size.height();
-    
-  BlobIndexThreaded smallBlobIndex(disparity, area, big_size);
-  ImageView<pixel_typeI> filtered_image = applyErodeView(disparity, smallBlobIndex);
+  // Correlation tiles are already processed in parallel, so label
+  // this one with a single thread.
+  TiledBlobIndex blob_index(disparity, vw_settings().default_tile_size(), 1);
+  ImageView<uint32> labels;
+  blob_index.labels(disparity, bounding_box(disparity), labels);
+  for (int row = 0; row < disparity.rows(); ++row) {
+    for (int col = 0; col < disparity.cols(); ++col) {
+      uint32 label = labels(col, row);
+      if (label && blob_index.stats(label).area <= uint64(area))
+        invalidate(disparity(col, row));
+    }
+  }
+}
+
+
+
+namespace detail {
+  // Divide rounding down and up, for coordinates that may be negative
+  inline Vector2i floor_quot(Vector2i const& v, int32 d) {
+    return Vector2i(int32(std::floor(double(v[0])/d)), int32(std::floor(double(v[1])/d)));
+  }
+  inline Vector2i ceil_quot(Vector2i const& v, int32 d) {
+    return Vector2i(int32(std::ceil(double(v[0])/d)), int32(std::ceil(double(v[1])/d)));
+  }
+} // namespace detail
+
+
+template <class Image1T, class Image2T, class Mask1T, class Mask2T>
+typename PyramidCorrelationView<Image1T, Image2T, Mask1T, Mask2T>::SearchSeed const&
+PyramidCorrelationView<Image1T, Image2T, Mask1T, Mask2T>::
+search_seed() const {
 
-  disparity = filtered_image;
+  SearchSeed& seed = *m_seed;
+  Mutex::Lock lock(seed.mutex);
+  if (seed.ready)
+    return seed;
+
+  typedef typename Image1T::pixel_type Pixel1T;
+  typedef typename Image2T::pixel_type Pixel2T;
+  typedef typename Mask1T::pixel_type  MaskPixelT;
+  const int32 scale = 1 << m_seed_level;
+
+#if VW_DEBUG_LEVEL > 0
+  Stopwatch watch;
+  watch.start();
+#endif
+
+  // 1.) Shrink the images with the same smoothing as build_image_pyramids(),
+  //     a level at a time but lazily, and rasterize the result in blocks so
+  //     that the whole image is never held at full resolution.
+  std::vector<typename DefaultKernelT<Pixel1T>::type > kernel(5);
+  kernel[0] = kernel[4] = 1.0/16.0;
+  kernel[1] = kernel[3] = 4.0/16.0;
+  kernel[2] = 6.0/16.0;
+  ImageViewRef<Pixel1T>    left      = m_left_image;
+  ImageViewRef<Pixel2T>    right     = m_right_image;
+  ImageViewRef<MaskPixelT> left_mask = m_left_mask;
+  for ( int32 i = 0; i < m_seed_level; ++i ) {
+    ImageViewRef<Pixel1T>    next_left      = subsample(separable_convolution_filter(left, kernel,kernel),2);
+    ImageViewRef<Pixel2T>    next_right     = subsample(separable_convolution_filter(right,kernel,kernel),2);
+    ImageViewRef<MaskPixelT> next_left_mask = subsample_mask_by_two(left_mask);
+    left      = next_left;
+    right     = next_right;
+    left_mask = next_left_mask;
+  }
+  Vector2i block_size(std::max(16, 1024/scale), std::max(16, 1024/scale));
+  ImageView<Pixel1T>    left_small      = block_rasterize(left,      block_size);
+  ImageView<Pixel2T>    right_small     = block_rasterize(right,     block_size);
+  ImageView<MaskPixelT> left_mask_small = block_rasterize(left_mask, block_size);
+  left_small  = prefilter_image(left_small,  m_prefilter_mode, m_prefilter_width);
+  right_small = prefilter_image(right_small, m_prefilter_mode, m_prefilter_width);
+
+  // 2.) Correlate the whole image over the search region at this scale,
+  //     rounded outwards.
+  BBox2i search_region(detail::floor_quot(m_search_region.min(), scale),
+                       detail::ceil_quot (m_search_region.max(), scale));
+  Vector2i half_kernel = m_kernel_size/2;
+  BBox2i left_region = bounding_box(left_small);
+  left_region.expand(half_kernel);
+  BBox2i right_region = left_region + search_region.min();
+  right_region.max() += search_region.size();
+
+  ImageView<pixel_typeI> disparity
+    = calc_disparity(m_cost_type,
+                     crop(edge_extend(left_small,  ConstantEdgeExtension()), left_region),
+                     crop(edge_extend(right_small, ConstantEdgeExtension()), right_region),
+                     left_region - left_region.min(),
+                     search_region.size() + Vector2i(1,1),
+                     m_kernel_size);
+
+  // A wrong seed would keep a tile from finding the right disparity, so
+  // throw out what fails the consistency check or the outlier filter.
+  if ( m_consistency_threshold >= 0 ) {
+    ImageView<pixel_typeI> disparity_rl
+      = calc_disparity(m_cost_type,
+                       crop(edge_extend(right_small, ConstantEdgeExtension()), right_region),
+                       crop(edge_extend(left_small,  ConstantEdgeExtension()),
+                            left_region - (search_region.size()+Vector2i(1,1))),
+                       right_region - right_region.min(),
+                       search_region.size() + Vector2i(1,1),
+                       m_kernel_size) -
+      pixel_typeI(search_region.size()+Vector2i(1,1));
+    stereo::cross_corr_consistency_check( disparity, disparity_rl,
+                                          m_consistency_threshold, false );
+  }
+  if ( m_filter_half_kernel > 0 ) {
+    ImageView<pixel_typeI> filtered
+      = disparity_cleanup_using_thresh(disparity, m_filter_half_kernel, m_filter_half_kernel,
+                                       3.0, 0.5);
+    disparity = filtered;
+  }
+  for ( int32 row = 0; row < disparity.rows(); ++row )
+    for ( int32 col = 0; col < disparity.cols(); ++col )
+      if ( !left_mask_small(col, row) )
+        invalidate(disparity(col, row));
+  disparity += pixel_typeI(search_region.min());
+
+  seed.disparity = disparity;
+  seed.ready     = true;
+
+#if VW_DEBUG_LEVEL > 0
+  watch.stop();
+  vw_out(DebugMessage,"stereo") << "Search seed " << bounding_box(disparity) << " at 1/" << scale
+                                << " resolution processed in " << watch.elapsed_seconds() << " s\n";
+#endif
+  if (m_write_debug_images)
+    write_image( "disparity_seed.tif", pixel_cast<PixelMask<Vector2f> >(seed.disparity) );
+
+  return seed;
 }
 
 
+template <class Image1T, class Image2T, class Mask1T, class Mask2T>
+bool PyramidCorrelationView<Image1T, Image2T, Mask1T, Mask2T>::
+seed_zones(BBox2i const& bbox, int32 level,
+           ImageView<typename Mask1T::pixel_type> const& level_mask,
+           BBox2i const& level_range, std::vector<SearchParam>& zones) const {
+
+  SearchSeed const& seed = search_seed();
+  const int32 scale   = 1 << m_seed_level;
+  const int32 upscale = 1 << level;
+
+  BBox2i tile_box(detail::floor_quot(bbox.min(), scale),
+                  detail::ceil_quot (bbox.max(), scale));
+  tile_box.crop(bounding_box(seed.disparity));
+  if (tile_box.empty())
+    return false;
+
+  // Resample the seed to this level of the tile, taking each pixel's
+  // centre, in this level's disparities.  Those start at the search
+  // region minimum.
+  ImageView<pixel_typeI> level_seed(level_mask.cols(), level_mask.rows());
+  for ( int32 row = 0; row < level_seed.rows(); ++row ) {
+    for ( int32 col = 0; col < level_seed.cols(); ++col ) {
+      Vector2i center = bbox.min() + Vector2i(col, row)*upscale + Vector2i(upscale, upscale)/2;
+      Vector2i seed_pixel = detail::floor_quot(center, scale);
+      if ( !bounding_box(seed.disparity).contains(seed_pixel) ||
+           !is_valid(seed.disparity(seed_pixel[0], seed_pixel[1])) )
+        continue; // Left invalid
+      Vector2i d = seed.disparity(seed_pixel[0], seed_pixel[1]).child()*scale - m_search_region.min();
+      level_seed(col, row) = pixel_typeI(Vector2i(int32(round(double(d[0])/upscale)),
+                                                  int32(round(double(d[1])/upscale))));
+    }
+  }
+
+  // Split the tile the way later levels are split.  The seed is only good
+  // to a seed pixel and the rounding above, so widen every range by that.
+  std::vector<SearchParam> seed_list;
+  subdivide_regions(level_seed, bounding_box(level_seed), seed_list, m_kernel_size);
+  const int32 slack = (scale + upscale - 1)/upscale + 1;
+
+  // subdivide_regions() leaves out the parts with no valid seed.  Those
+  // inside the mask get zones of their own with the full range, split
+  // the same way from an image holding just them.  Every pixel there
+  // spans the full range, so the split only follows where they are.
+  // These zones go first, so the seeded zones they overlap win.
+  ImageView<uint8> covered(level_seed.cols(), level_seed.rows());
+  fill(covered, 0);
+  BOOST_FOREACH( SearchParam& zone, seed_list ) {
+    fill(crop(covered, zone.image_region()), 1);
+    zone.disparity_range().expand(slack);
+    zone.disparity_range().crop(level_range);
+    if (zone.disparity_range().empty())
+      zone.disparity_range() = level_range;
+  }
+  ImageView<pixel_typeI> unseeded(level_seed.cols(), level_seed.rows());
+  bool any_unseeded = false;
+  for ( int32 row = 0; row < covered.rows(); ++row )
+    for ( int32 col = 0; col < covered.cols(); ++col )
+      if ( !covered(col, row) && level_mask(col, row) ) {
+        unseeded(col, row) = pixel_typeI((col + row) % 2 ? level_range.min()
+                                                         : level_range.max() - Vector2i(1,1));
+        any_unseeded = true;
+      }
+  if ( any_unseeded ) {
+    std::vector<SearchParam> unseeded_list;
+    subdivide_regions(unseeded, bounding_box(unseeded), unseeded_list, m_kernel_size);
+    BOOST_FOREACH( SearchParam& zone, unseeded_list ) {
+      zone.disparity_range() = level_range;
+      zones.push_back(zone);
+    }
+  }
+  zones.insert(zones.end(), seed_list.begin(), seed_list.end());
+
+  return true;
+}
+
 
 template <class Image1T, class Image2T, class Mask1T, class Mask2T>
 typename PyramidCorrelationView<Image1T, Image2T, Mask1T, Mask2T>::prerasterize_type
@@ -288,8 +482,15 @@ prerasterize(BBox2i const& bbox) const {
     // the entire image and uses the disparity range that was loaded into the class.
     BBox2i initial_disparity_range = BBox2i(0,0,m_search_region.width ()/max_upscaling+1,
                                                 m_search_region.height()/max_upscaling+1);
-    zones.push_back( SearchParam(bounding_box(left_mask_pyramid[max_pyramid_levels]),
-                                 initial_disparity_range) );
+    // - With a seed, the zones instead come from the low resolution pass
+    //   over the whole image.
+    bool seeded = false;
+    if (m_seed_level > 0 && m_algorithm == CORRELATION_WINDOW)
+      seeded = seed_zones(bbox, max_pyramid_levels, left_mask_pyramid[max_pyramid_levels],
+                          initial_disparity_range, zones);
+    if (!seeded)
+      zones.push_back( SearchParam(bounding_box(left_mask_pyramid[max_pyramid_levels]),
+                                   initial_disparity_range) );
     vw_out(DebugMessage,"stereo") << "initial_disparity_range = " << initial_disparity_range << std::endl;
 
     // Perform correlation. Keep track of how much time elapsed
@@ -499,6 +700,16 @@ prerasterize(BBox2i const& bbox) const {
         // - Prioritize the zones which take less time so we don't miss
         //   a bunch of tiles because we spent all our time on a slow one.
         std::sort(zones.begin(), zones.end(), SearchParamLessThan()); // Sort the zones, smallest to largest.
+
+        // Census costs transform this level once; the zones match crops of it.
+        const bool use_census = (m_cost_type == CENSUS_TRANSFORM ||
+                                 m_cost_type == TERNARY_CENSUS_TRANSFORM);
+        ImageView<uint64> left_census, right_census;
+        if (use_census) {
+          census_descriptors(m_cost_type, left_pyramid [level], left_census );
+          census_descriptors(m_cost_type, right_pyramid[level], right_census);
+        }
+
         BOOST_FOREACH( SearchParam const& zone, zones ) {
 
           // The input zone is in the normal pixel coordinates for this  level.
@@ -529,13 +740,21 @@ prerasterize(BBox2i const& bbox) const {
 
           // Compute left to right disparity vectors in this zone.
           // - The cropped regions we pass in have padding for the kernel.
-          crop(disparity, zone.image_region())
-            = calc_disparity(m_cost_type,
-                             crop(left_pyramid [level], left_region), 
-                             crop(right_pyramid[level], right_region),
-                             left_region - left_region.min(), // Specify that the whole cropped region is valid
-                             zone.disparity_range().size(), 
-                             m_kernel_size);
+          if (use_census)
+            crop(disparity, zone.image_region())
+              = calc_census_disparity(crop(left_census,  left_region),
+                                      crop(right_census, right_region),
+                                      left_region - left_region.min(),
+                                      zone.disparity_range().size(),
+                                      m_kernel_size);
+          else
+            crop(disparity, zone.image_region())
+              = calc_disparity(m_cost_type,
+                               crop(left_pyramid [level], left_region), 
+                               crop(right_pyramid[level], right_region),
+                               left_region - left_region.min(), // Specify that the whole cropped region is valid
+                               zone.disparity_range().size(), 
+                               m_kernel_size);
 
 
           // TODO: Support checks at higher levels like with SGM!
@@ -556,13 +775,21 @@ prerasterize(BBox2i const& bbox) const {
             }
             // Compute right to left disparity in this zone       
             
-            disparity_rl = calc_disparity(m_cost_type,
-                             crop(edge_extend(right_pyramid[level]), right_region),
-                             crop(edge_extend(left_pyramid [level]),
-                                  left_region - zone.disparity_range().size()),
-                             right_region - right_region.min(),
-                             zone.disparity_range().size(), m_kernel_size)
-            - pixel_typeI(zone.disparity_range().size());
+            if (use_census)
+              disparity_rl = calc_census_disparity(crop(edge_extend(right_census), right_region),
+                               crop(edge_extend(left_census),
+                                    left_region - zone.disparity_range().size()),
+                               right_region - right_region.min(),
+                               zone.disparity_range().size(), m_kernel_size)
+              - pixel_typeI(zone.disparity_range().size());
+            else
+              disparity_rl = calc_disparity(m_cost_type,
+                               crop(edge_extend(right_pyramid[level]), right_region),
+                               crop(edge_extend(left_pyramid [level]),
+                                    left_region - zone.disparity_range().size()),
+                               right_region - right_region.min(),
+                               zone.disparity_range().size(), m_kernel_size)
+              - pixel_typeI(zone.disparity_range().size());
 
 
             // Find pixels where the disparity distance is greater than m_consistency_threshold
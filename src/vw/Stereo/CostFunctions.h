@@ -21,6 +21,7 @@
 
 #include <vw/Image/Manipulation.h>
 #include <vw/Image/ImageMath.h>
+#include <vw/Image/CensusTransform.h>
 #include <vw/Stereo/Algorithms.h>
 
 namespace vw {
@@ -215,6 +216,45 @@ namespace stereo {
     }
   };
 
+  /// Number of differing bits between two census descriptors.
+  struct HammingDistanceFunctor : ReturnFixedType<int32> {
+    template <class Arg1T, class Arg2T>
+    inline int32 operator()( Arg1T arg1, Arg2T arg2 ) const {
+      return int32( hamming_distance( arg1, arg2 ) );
+    }
+  };
+
+  /// Cost between images of bit-packed census descriptors, such as those
+  /// from census_transform_5x5().
+  template <class ImageT, bool IsInteger>
+  struct HammingCost {
+    typedef int32 accumulator_type;
+    typedef int32 pixel_accumulator_type;
+
+    // Does nothing
+    template <class ImageT1, class ImageT2>
+    HammingCost( ImageViewBase<ImageT1> const& /*left*/,
+                 ImageViewBase<ImageT2> const& /*right*/,
+                 Vector2i const& /*kernel_size*/ ) {}
+
+    template <class ImageT1, class ImageT2>
+    BinaryPerPixelView<ImageT1,ImageT2,HammingDistanceFunctor>
+    operator()( ImageViewBase<ImageT1> const& left,
+                ImageViewBase<ImageT2> const& right ) const {
+      typedef BinaryPerPixelView<ImageT1,ImageT2,HammingDistanceFunctor> result_type;
+      return result_type(left.impl(),right.impl());
+    }
+
+    // Does nothing
+    inline void cost_modification( ImageView<pixel_accumulator_type>& /*cost_metric*/,
+                                   Vector2i const& /*disparity*/ ) const {}
+
+    inline bool quality_comparison( accumulator_type cost,
+                                    accumulator_type quality ) const {
+      return cost < quality;
+    }
+  };
+
   template <class ImageT, bool IsInteger>
   struct SquaredCost {
     typedef typename SqrDiffAccumulatorType<ImageT>::type accumulator_type;
@@ -24,8 +24,13 @@
 #include <vw/Image/PixelMask.h>
 #include <vw/Image/Manipulation.h>
 #include <vw/Image/ImageView.h>
+#include <vw/Core/Thread.h>
 #include <vw/Math.h>
 #include <ostream>
+#include <vector>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 
 // For the PixelDisparity math.
 #include <boost/operators.hpp>
@@ -33,6 +38,9 @@
 namespace vw {
   namespace stereo {
 
+    template<class PixelT, class PrecisionT> class AffineMixtureComponent;
+    template<class PixelT, class PrecisionT> class GammaMixtureComponent;
+
     template <class ImagePixelT>
       class EMSubpixelCorrelatorView : public ImageViewBase<EMSubpixelCorrelatorView<ImagePixelT> > {
     public:
@@ -99,15 +107,19 @@ namespace vw {
       };
 
       void set_pyramid_levels(int levels) { pyramid_levels = levels; }
-      // EM parameter setters
-      void set_kernel_size(Vector2i size) { m_kernel_size = size; }
+      // EM parameter setters.  Those that the mixture components are
+      // built with start a fresh set of workspaces.
+      void set_kernel_size(Vector2i size) { m_kernel_size = size; m_workspaces.reset(new WorkspacePool); }
       void set_em_iter_max(int iter) { em_iter_max = iter; }
       void set_em_epsilon(double epsilon) { epsilon_em = epsilon; }
+      /// Stop a pixel's EM loop once no affine parameter moved by more
+      /// than this in an iteration.  Zero turns the check off.
+      void set_affine_epsilon(double epsilon) { epsilon_affine = epsilon; }
       void set_prob_inlier_0(double P) { P_inlier_0 = P; }
       void set_prob_inlier_min(double P) { P_inlier_min = P; }
       void set_prob_inlier_max(double P) { P_inlier_max = P; }
-      void set_sigma_affine_0(double s) { sigma_p1_0 = s; }
-      void set_sigma_affine_min(double s) { sigma_p1_min = s; }
+      void set_sigma_affine_0(double s) { sigma_p1_0 = s; m_workspaces.reset(new WorkspacePool); }
+      void set_sigma_affine_min(double s) { sigma_p1_min = s; m_workspaces.reset(new WorkspacePool); }
       // affine model parameter setters
       void set_inner_iter_max(int iter) { inner_iter_max = iter; }
       void set_inner_epsilon(double epsilon) { epsilon_inner = epsilon; }
@@ -139,6 +151,55 @@ namespace vw {
       }
 
     private:
+      /// The mixture components and scratch images of one pyramid level.
+      struct LevelWorkspace {
+        boost::shared_ptr<AffineMixtureComponent<ImagePixelT, double> > affine;
+        boost::shared_ptr<GammaMixtureComponent<ImagePixelT, double> > outlier1, outlier2;
+        ImageView<float> image_hack;
+      };
+
+      /// Everything prerasterize() allocates apart from its result.  It
+      /// is kept for the next tile, which is usually the same size, so
+      /// that the images are rasterized in place instead of reallocated.
+      struct Workspace {
+        ImageView<ImagePixelT> left_image_patch, right_image_patch;
+        ImageView<disparity_pixel> disparity_map_patch_in;
+        std::vector<ImageView<ImagePixelT> > left_pyramid, right_pyramid;
+        std::vector<ImageView<Matrix2x2> > warps;
+        std::vector<ImageView<disparity_pixel> > disparity_map_pyramid;
+        std::vector<LevelWorkspace> levels;
+      };
+
+      /// Workspaces not in use.  Each tile being rasterized takes one,
+      /// so there are as many as there have been concurrent tiles.
+      class WorkspacePool {
+        Mutex m_mutex;
+        std::vector<boost::shared_ptr<Workspace> > m_free;
+      public:
+        boost::shared_ptr<Workspace> acquire() {
+          Mutex::Lock lock(m_mutex);
+          if (m_free.empty())
+            return boost::shared_ptr<Workspace>(new Workspace);
+          boost::shared_ptr<Workspace> workspace = m_free.back();
+          m_free.pop_back();
+          return workspace;
+        }
+        void release(boost::shared_ptr<Workspace> const& workspace) {
+          Mutex::Lock lock(m_mutex);
+          m_free.push_back(workspace);
+        }
+      };
+
+      /// Returns a workspace to its pool when the tile is done.
+      class WorkspaceLease : private boost::noncopyable {
+        boost::shared_ptr<WorkspacePool> m_pool;
+        boost::shared_ptr<Workspace> m_workspace;
+      public:
+        WorkspaceLease(boost::shared_ptr<WorkspacePool> const& pool) : m_pool(pool), m_workspace(pool->acquire()) {}
+        ~WorkspaceLease() { m_pool->release(m_workspace); }
+        Workspace& operator*() const { return *m_workspace; }
+      };
+
       // Image references
       ImageViewRef<ImagePixelT> m_left_image, m_right_image;
       ImageViewRef<disparity_pixel> m_course_disparity;
@@ -150,6 +211,7 @@ namespace vw {
       Vector2i m_kernel_size;
       int em_iter_max;
       double epsilon_em;
+      double epsilon_affine;
       double P_inlier_0;
       double P_inlier_min;
       double P_inlier_max;
@@ -167,13 +229,17 @@ namespace vw {
       int debug_level;
       BBox2i debug_region;
 
+      // Shared by copies of this view, which rasterize with the same
+      // settings.
+      boost::shared_ptr<WorkspacePool> m_workspaces;
+
       // private helper methods
       template <class ImageT, class DisparityT1, class DisparityT2, class AffineT>
         inline void
         m_subpixel_refine(ImageViewBase<ImageT> const& left_image, ImageViewBase<ImageT> const& right_image,
                           ImageViewBase<DisparityT1> &disparity_in, ImageViewBase<DisparityT2> &disparity_out,
                           ImageViewBase<AffineT> & affine_warps,
-                          BBox2i const& ROI, bool final, bool debug = false) const;
+                          BBox2i const& ROI, bool final, LevelWorkspace& workspace, bool debug = false) const;
     }; // end class
 
 
@@ -118,7 +118,7 @@ namespace vw {
     EMSubpixelCorrelatorView<ImagePixelT>::EMSubpixelCorrelatorView(ImageViewBase<Image1T> const& left_image, ImageViewBase<Image2T> const& right_image,
                                                                     ImageViewBase<DisparityT> const& course_disparity, int debug) :
       m_left_image(left_image.impl()), m_right_image(right_image.impl()),
-      m_course_disparity(course_disparity.impl()), debug_level(debug)
+      m_course_disparity(course_disparity.impl()), debug_level(debug), m_workspaces(new WorkspacePool)
     {
       // Basic assertions
       VW_ASSERT((left_image.impl().cols() == right_image.impl().cols()) &&
@@ -146,6 +146,7 @@ namespace vw {
       sigma_n_min = 1e-4; // 1e-3 for apollo
       mu_n_0 = 0.;
       epsilon_em = 1;
+      epsilon_affine = 1e-4;
       // affine model defaults
       inner_iter_max = 8; //8
       epsilon_inner = 1e-8; // 1e-8
@@ -200,10 +201,15 @@ namespace vw {
       left_crop_bbox.min() -= Vector2i(m_kernel_size[0], m_kernel_size[1]);
       left_crop_bbox.max() += Vector2i(m_kernel_size[0], m_kernel_size[1]);
 
+      // Everything but the output comes from this thread's workspace
+      WorkspaceLease lease(m_workspaces);
+      Workspace& workspace = *lease;
+
       // We crop the images to the expanded bounding box and edge
       // extend in case the new bbox extends past the image bounds.
-      ImageView<ImagePixelT> left_image_patch, right_image_patch;
-      ImageView<disparity_pixel> disparity_map_patch_in;
+      ImageView<ImagePixelT>& left_image_patch = workspace.left_image_patch;
+      ImageView<ImagePixelT>& right_image_patch = workspace.right_image_patch;
+      ImageView<disparity_pixel>& disparity_map_patch_in = workspace.disparity_map_patch_in;
       ImageView<result_type> disparity_map_patch_out;
 
 
@@ -231,10 +237,16 @@ namespace vw {
       double blur_sigma_progressive = .5; // 3*sigma = 1.5 pixels
 
       // create the pyramid first
-      std::vector<ImageView<ImagePixelT> > left_pyramid(pyramid_levels), right_pyramid(pyramid_levels);
+      std::vector<ImageView<ImagePixelT> >& left_pyramid = workspace.left_pyramid;
+      std::vector<ImageView<ImagePixelT> >& right_pyramid = workspace.right_pyramid;
       std::vector<BBox2i> regions_of_interest(pyramid_levels);
-      std::vector<ImageView<Matrix2x2> > warps(pyramid_levels);
-      std::vector<ImageView<disparity_pixel> > disparity_map_pyramid(pyramid_levels);
+      std::vector<ImageView<Matrix2x2> >& warps = workspace.warps;
+      std::vector<ImageView<disparity_pixel> >& disparity_map_pyramid = workspace.disparity_map_pyramid;
+      left_pyramid.resize(pyramid_levels);
+      right_pyramid.resize(pyramid_levels);
+      warps.resize(pyramid_levels);
+      disparity_map_pyramid.resize(pyramid_levels);
+      workspace.levels.resize(pyramid_levels);
 
 
       // initialize the pyramid at level 0
@@ -291,18 +303,18 @@ namespace vw {
           // and upsample for the next level
           m_subpixel_refine(edge_extend(process_left_image, ZeroEdgeExtension()), edge_extend(process_right_image, ZeroEdgeExtension()),
                             disparity_map_pyramid[i], disparity_map_pyramid[i], warps[i],
-                            regions_of_interest[i], false, debug_level == i);
+                            regions_of_interest[i], false, workspace.levels[i], debug_level == i);
 
           // upsample the warps and the refined map for the next level of processing
           int up_width = left_pyramid[i-1].cols();
           int up_height = left_pyramid[i-1].rows();
-          warps[i-1] = copy(resize(warps[i], up_width , up_height, ConstantEdgeExtension(), NearestPixelInterpolation())); //upsample affine transforms
-          disparity_map_pyramid[i-1] = copy(detail::upsample_disp_map_by_two(disparity_map_pyramid[i], up_width, up_height));
+          warps[i-1] = resize(warps[i], up_width , up_height, ConstantEdgeExtension(), NearestPixelInterpolation()); //upsample affine transforms
+          disparity_map_pyramid[i-1] = detail::upsample_disp_map_by_two(disparity_map_pyramid[i], up_width, up_height);
         }
         else { // here there is no next level so we refine directly to the output patch
           m_subpixel_refine(edge_extend(process_left_image, ZeroEdgeExtension()), edge_extend(process_right_image, ZeroEdgeExtension()),
                             disparity_map_pyramid[i], disparity_map_patch_out, warps[i],
-                            regions_of_interest[i], true, debug_level == i);
+                            regions_of_interest[i], true, workspace.levels[i], debug_level == i);
         }
       }
 
@@ -348,7 +360,8 @@ namespace vw {
                                                              ImageViewBase<DisparityT1> & disparity_in,
                                                              ImageViewBase<DisparityT2> & disparity_out,
                                                              ImageViewBase<AffineT> & affine_warps,
-                                                             BBox2i const& ROI, bool final, bool p_debug) const {
+                                                             BBox2i const& ROI, bool final, LevelWorkspace& workspace,
+                                                             bool p_debug) const {
 
       // algorithm features to enable
       bool blur_posterior = false;
@@ -390,15 +403,18 @@ namespace vw {
       }
 #endif
 
-      // allocate memory once for all inner loop operations
-      ImageView<double> weights_p1(m_kernel_size(0), m_kernel_size(1));
-      ImageView<double> weights_outlier1(m_kernel_size(0), m_kernel_size(1));
-      ImageView<double> weights_outlier2(m_kernel_size(0), m_kernel_size(1));
-      ImageView<double> temp_sum(m_kernel_size(0), m_kernel_size(1));
-
-      AffineMixtureComponent<typename ImageT::pixel_type, double> affine_comp(laplacian_filter(gaussian_filter(left_image.impl(), 1.)), // 1.0 worked best
-                                                                              laplacian_filter(gaussian_filter(right_image.impl(), 1.)),
-                                                                              m_kernel_size, sigma_p1_0, sigma_p1_min);
+      // The mixture components are kept in the workspace with their
+      // buffers, and only pointed at this tile's images.
+      if(!workspace.affine) {
+        workspace.affine.reset(new AffineMixtureComponent<ImagePixelT, double>(laplacian_filter(gaussian_filter(left_image.impl(), 1.)), // 1.0 worked best
+                                                                                  laplacian_filter(gaussian_filter(right_image.impl(), 1.)),
+                                                                                  m_kernel_size, sigma_p1_0, sigma_p1_min));
+      }
+      else {
+        workspace.affine->set_images(laplacian_filter(gaussian_filter(left_image.impl(), 1.)),
+                                     laplacian_filter(gaussian_filter(right_image.impl(), 1.)));
+      }
+      AffineMixtureComponent<ImagePixelT, double>& affine_comp = *workspace.affine;
       affine_comp.set_max_iter(inner_iter_max);
       affine_comp.set_epsilon_convergence(epsilon_inner);
       affine_comp.set_min_determinant(affine_min_det);
@@ -407,9 +423,23 @@ namespace vw {
 
       //GaussianMixtureComponent<typename ImageT::pixel_type, double> outlier_comp1(left_image.impl(), m_kernel_size, mu_n_0, sigma_n_0, sigma_n_min);
       //GaussianMixtureComponent<typename ImageT::pixel_type, double> outlier_comp2(left_image.impl(), m_kernel_size, mu_n_0, sigma_n_0, sigma_n_min);
-      GammaMixtureComponent<typename ImageT::pixel_type, double> outlier_comp1(left_image.impl(), m_kernel_size, 1., .25, 1e-2, 1e-2); // k_0 = 1., theta_0 = .25 worked best
-      ImageView<float> image_hack = 1. - left_image.impl(); //TODO: remove this hack
-      GammaMixtureComponent<typename ImageT::pixel_type, double> outlier_comp2(image_hack.impl(), m_kernel_size, 1., .25, 1e-2, 1e-2);
+      ImageView<float>& image_hack = workspace.image_hack;
+      image_hack = 1. - left_image.impl(); //TODO: remove this hack
+      if(!workspace.outlier1) {
+        workspace.outlier1.reset(new GammaMixtureComponent<ImagePixelT, double>(left_image.impl(), m_kernel_size, 1., .25, 1e-2, 1e-2)); // k_0 = 1., theta_0 = .25 worked best
+        workspace.outlier2.reset(new GammaMixtureComponent<ImagePixelT, double>(image_hack.impl(), m_kernel_size, 1., .25, 1e-2, 1e-2));
+      }
+      else {
+        workspace.outlier1->set_image(left_image.impl());
+        workspace.outlier2->set_image(image_hack.impl());
+      }
+      GammaMixtureComponent<ImagePixelT, double>& outlier_comp1 = *workspace.outlier1;
+      GammaMixtureComponent<ImagePixelT, double>& outlier_comp2 = *workspace.outlier2;
+
+      // The E step below writes the weights straight into the components
+      ImageView<double>& weights_p1 = affine_comp.weights();
+      ImageView<double>& weights_outlier1 = outlier_comp1.weights();
+      ImageView<double>& weights_outlier2 = outlier_comp2.weights();
 
       int kernel_width = m_kernel_size(0);
       int kernel_height = m_kernel_size(1);
@@ -466,7 +496,9 @@ namespace vw {
           w_gaussian = weight_template;
 
           pixel_timer.start();
-          l_window = crop(edge_extend(left_image.impl(), ZeroEdgeExtension()), window_box);
+          if(debug) {
+            l_window = crop(edge_extend(left_image.impl(), ZeroEdgeExtension()), window_box);
+          }
 
           if(debug) {
             vw_out() << "course estimate = " << pos << " + "
@@ -478,8 +510,10 @@ namespace vw {
           affine_comp.reset(window_box, edge_extend(disparity_in.impl())(x, y).child().x(), edge_extend(disparity_in.impl())(x, y).child().y(),
                             affine_warps.impl()(x, y),
                             w_gaussian);
-          outlier_comp1.reset(window_box, w_gaussian);
-          outlier_comp2.reset(window_box, w_gaussian);
+          if(use_left_outliers)
+            outlier_comp1.reset(window_box, w_gaussian);
+          if(use_right_outliers)
+            outlier_comp2.reset(window_box, w_gaussian);
 
           double P_1;
           double P_outlier1;
@@ -557,51 +591,52 @@ namespace vw {
           }
 
           affine_comp.update_posterior();
-          outlier_comp1.update_posterior();
-          outlier_comp2.update_posterior();
+          if(use_left_outliers)
+            outlier_comp1.update_posterior();
+          if(use_right_outliers)
+            outlier_comp2.update_posterior();
           em_timer.start();
           for(em_iter = 0; em_iter < em_iter_max; em_iter++) {
-            Stopwatch inner_loop_init_timer;
-            inner_loop_init_timer.start();
             // compute the weights with the posterior distribution (Q)
-            weights_p1 = copy(affine_comp.prob()*P_1);
-            if(blur_posterior) {
-              if(use_left_outliers) {
-                weights_outlier1 = copy(outlier_comp1.prob()*P_outlier1);
-                weights_outlier1 = gaussian_filter(weights_outlier1, blur_posterior_sigma);
-              }
-              if(use_right_outliers) {
-                weights_outlier2 = copy(outlier_comp2.prob()*P_outlier2);
-                weights_outlier2 = gaussian_filter(weights_outlier2, blur_posterior_sigma);
+            for(int j = 0; j < kernel_height; j++) {
+              for(int i = 0; i < kernel_width; i++) {
+                weights_p1(i, j) = affine_comp.prob()(i, j)*P_1;
+                if(use_left_outliers)
+                  weights_outlier1(i, j) = outlier_comp1.prob()(i, j)*P_outlier1;
+                if(use_right_outliers)
+                  weights_outlier2(i, j) = outlier_comp2.prob()(i, j)*P_outlier2;
               }
             }
-            else {
-              if(use_left_outliers) {
-                weights_outlier1 = copy(outlier_comp1.prob()*P_outlier1);
-              }
-              if(use_right_outliers) {
-                weights_outlier2 = copy(outlier_comp2.prob()*P_outlier2);
-              }
+            if(blur_posterior) {
+              if(use_left_outliers)
+                weights_outlier1 = copy(gaussian_filter(weights_outlier1, blur_posterior_sigma));
+              if(use_right_outliers)
+                weights_outlier2 = copy(gaussian_filter(weights_outlier2, blur_posterior_sigma));
             }
 
-            // normalize the weights
-            temp_sum = copy(weights_p1);
-            if(use_left_outliers)
-              temp_sum += weights_outlier1;
-            if(use_right_outliers)
-              temp_sum += weights_outlier2;
-            weights_p1 = weights_p1/temp_sum;
-            if(use_left_outliers)
-              weights_outlier1 = weights_outlier1/temp_sum;
-            if(use_right_outliers)
-              weights_outlier2 = weights_outlier2/temp_sum;
-
-            // compute P(inlier) and P(outlier)
-            sum_weights_p1 = sum_of_pixel_values(weights_p1);
-            if(use_left_outliers)
-              sum_weights_outlier1 = sum_of_pixel_values(weights_outlier1);
-            if(use_right_outliers)
-              sum_weights_outlier2 = sum_of_pixel_values(weights_outlier2);
+            // normalize the weights, and compute P(inlier) and P(outlier)
+            sum_weights_p1 = 0;
+            sum_weights_outlier1 = 0;
+            sum_weights_outlier2 = 0;
+            for(int j = 0; j < kernel_height; j++) {
+              for(int i = 0; i < kernel_width; i++) {
+                double temp_sum = weights_p1(i, j);
+                if(use_left_outliers)
+                  temp_sum += weights_outlier1(i, j);
+                if(use_right_outliers)
+                  temp_sum += weights_outlier2(i, j);
+                weights_p1(i, j) /= temp_sum;
+                sum_weights_p1 += weights_p1(i, j);
+                if(use_left_outliers) {
+                  weights_outlier1(i, j) /= temp_sum;
+                  sum_weights_outlier1 += weights_outlier1(i, j);
+                }
+                if(use_right_outliers) {
+                  weights_outlier2(i, j) /= temp_sum;
+                  sum_weights_outlier2 += weights_outlier2(i, j);
+                }
+              }
+            }
 
             P_1 = sum_weights_p1/(double)(N);
             P_1 = std::min(P_1, P_inlier_max);
@@ -619,16 +654,14 @@ namespace vw {
             }
 
             // fit all the parameters (M-step)
-            affine_comp.weights() = copy(weights_p1);
-            if(sum_weights_p1 >= 1e-2) {
+            bool affine_fit = sum_weights_p1 >= 1e-2;
+            if(affine_fit) {
               affine_comp.fit_parameters();
             }
             if(use_left_outliers) {
-              outlier_comp1.weights() = copy(weights_outlier1);
               outlier_comp1.fit_parameters();
             }
             if(use_right_outliers) {
-              outlier_comp2.weights() = copy(weights_outlier2);
               outlier_comp2.fit_parameters();
             }
 
@@ -705,6 +738,10 @@ namespace vw {
             if(fabs(f_value_last - f_value) < epsilon_em) {
               break;
             }
+            // the rest of the iterations would barely move the match
+            if(affine_fit && affine_comp.parameter_change() < epsilon_affine) {
+              break;
+            }
           } // end em loop
           em_timer.stop();
 
@@ -53,9 +53,10 @@ namespace stereo {
                           Vector2i window_size,
                           PrecisionT k_0, PrecisionT theta_0,
                           PrecisionT pk_min, PrecisionT ptheta_min) : image_r(image.impl()), image_c(window_size(0), window_size(1)),
+      log_c(window_size(0), window_size(1)),
       _k(k_0), k0(k_0),
       _theta(theta_0), theta0(theta_0), k_min(pk_min), theta_min(ptheta_min),
-      w(window_size(0), window_size(1)), w_gaussian(window_size(0), window_size(1)), w_local(image.impl().cols(), image.impl().rows()),
+      w(window_size(0), window_size(1)), w_gaussian(window_size(0), window_size(1)),
       p(window_size(0), window_size(1)) {
 
       fill(w, 1.);
@@ -67,7 +68,14 @@ namespace stereo {
       var_min = 1e-3; // 1e-2 worked best
 
       image_r = clamp(image_r, 1e-14, INFINITY);
-      image_c = clamp(crop(transform(edge_extend(image_r, ZeroEdgeExtension()), T), window), 1e-14, INFINITY);
+      l_set = false;
+    }
+
+    /// Switch to a new image, as if newly constructed.
+    template<class ImageT>
+    void set_image(ImageViewBase<ImageT> const& image) {
+      image_r = clamp(ImageViewRef<PixelT>(image.impl()), 1e-14, INFINITY);
+      l_likelihood = INFINITY;
       l_set = false;
     }
 
@@ -78,37 +86,42 @@ namespace stereo {
       _theta = theta0;
       window = left_window;
       image_c = clamp(crop(transform(edge_extend(image_r, ZeroEdgeExtension()), T), window), 1e-14, INFINITY);
+      log_c = log(image_c);
       w_gaussian = g;
     }
 
     void fit_parameters() { // weights only used here, so transform the weights into the correct space only here
-      BBox2i image_size(0, 0, image_r.cols(), image_r.rows());
-      BBox2i bbox = compute_transformed_bbox_fast(translate(edge_extend(w, ZeroEdgeExtension()), window.min().x(), window.min().y()).get_size(), inverse(T));
-      bbox.max().x() += 1; //for some reason compute transformed bbox outputs an inclusive bottom-right boundry point....
-      bbox.max().y() += 1;
-      bbox += inverse(T).forward(window.min());
-      bbox.crop(image_size);
-
       /*
+        BBox2i image_size(0, 0, image_r.cols(), image_r.rows());
+        BBox2i bbox = compute_transformed_bbox_fast(translate(edge_extend(w, ZeroEdgeExtension()), window.min().x(), window.min().y()).get_size(), inverse(T));
+        bbox.max().x() += 1; //for some reason compute transformed bbox outputs an inclusive bottom-right boundry point....
+        bbox.max().y() += 1;
+        bbox += inverse(T).forward(window.min());
+        bbox.crop(image_size);
+
         ImageView<PrecisionT> w_adj = crop(transform(crop(translate(edge_extend(w, ZeroEdgeExtension()), window.min().x(), window.min().y()),
                                                           image_size),
                                                      inverse(T)),
                                            bbox);
       */
-      ImageViewRef<PrecisionT> w_adj = w;
-
-      PrecisionT sum_weights_adj = sum_of_pixel_values(w_adj);
+      PrecisionT sum_weights_adj = sum_of_pixel_values(w);
 
       if(sum_weights_adj < 1e-10)
         return;
 
         PrecisionT k_last = _k;
         PrecisionT theta_last = _theta;
-        double l_likelihood_old = -sum_of_pixel_values(w*((_k-1)*log(image_c) - image_c/_theta)) + sum_weights_adj*(_k*log(_theta) + lgamma(_k));
+        double l_likelihood_old = -m_weighted_log_density() + sum_weights_adj*(_k*log(_theta) + lgamma(_k));
 
         PrecisionT mu = 0, mu_log = 0;
-        mu = sum_of_pixel_values(w*image_c)/sum_weights_adj;
-        mu_log = sum_of_pixel_values(w*log(image_c))/sum_weights_adj;
+        for(int j = 0; j < w.rows(); j++) {
+          for(int i = 0; i < w.cols(); i++) {
+            mu += w(i, j)*image_c(i, j);
+            mu_log += w(i, j)*log_c(i, j);
+          }
+        }
+        mu /= sum_weights_adj;
+        mu_log /= sum_weights_adj;
 
         PrecisionT s = log(mu) - mu_log;
         if(s <= 0) { // this is to keep things well conditioned; the equation log(k) - digamma(k) = s cannot be solved for s <= 0
@@ -145,8 +158,7 @@ namespace stereo {
 
 
 
-        l_likelihood = -sum_of_pixel_values(w*((_k-1)*log(image_c) -
-                                               image_c/_theta))
+        l_likelihood = -m_weighted_log_density()
           + sum_weights_adj*(_k*log(_theta) + lgamma(_k));
 
         l_set = true;
@@ -158,8 +170,7 @@ namespace stereo {
           //std::cout << "s = " << s << std::endl;
           _k = k_last;
           _theta = theta_last;
-          l_likelihood = -sum_of_pixel_values(w*((_k-1)*log(image_c) -
-                                                 image_c/_theta))
+          l_likelihood = -m_weighted_log_density()
             + sum_weights_adj*(_k*log(_theta) + lgamma(_k));
         }
 
@@ -182,19 +193,25 @@ namespace stereo {
       }
 
       void update_posterior() {
-        p = exp((_k-1)*log(image_c) - image_c/_theta - lgamma(_k) - _k*log(_theta));
+        // p = exp((_k-1)*log(image_c) - image_c/_theta - lgamma(_k) - _k*log(_theta));
+        PrecisionT lgamma_k = lgamma(_k), k_log_theta = _k*log(_theta);
+        for(int j = 0; j < p.rows(); j++) {
+          for(int i = 0; i < p.cols(); i++) {
+            p(i, j) = exp((_k-1)*log_c(i, j) - image_c(i, j)/_theta - lgamma_k - k_log_theta);
+          }
+        }
       }
 
       void set_affine_transform(AffineTransformOrigin const& T_new) {
         T = T_new;
         image_c = clamp(crop(transform(edge_extend(image_r, ZeroEdgeExtension()), T), window), 1e-14, INFINITY);
+        log_c = log(image_c);
       }
 
       PrecisionT log_likelihood() {
         if(!l_set) {
           PrecisionT sum_weights = sum_of_pixel_values(w); // this is the normalization constant for the weights
-          l_likelihood = -sum_of_pixel_values(w*((_k-1)*log(image_c) -
-                                                 image_c/_theta))
+          l_likelihood = -m_weighted_log_density()
             + sum_weights*(_k*log(_theta) + lgamma(_k));
           l_set = true;
         }
@@ -209,8 +226,20 @@ namespace stereo {
       ImageView<PrecisionT> const& prob() const { return p; }
 
     private:
+      // sum_of_pixel_values(w*((_k-1)*log(image_c) - image_c/_theta))
+      PrecisionT m_weighted_log_density() const {
+        PrecisionT sum = 0;
+        for(int j = 0; j < w.rows(); j++) {
+          for(int i = 0; i < w.cols(); i++) {
+            sum += w(i, j)*((_k-1)*log_c(i, j) - image_c(i, j)/_theta);
+          }
+        }
+        return sum;
+      }
+
       ImageViewRef<PixelT> image_r;
       ImageView<PixelT> image_c; // clipped image
+      ImageView<PixelT> log_c; // log(image_c)
 
       BBox2i window;
 
@@ -224,7 +253,6 @@ namespace stereo {
       ImageView<PrecisionT> w;  // weights
       ImageView<PrecisionT> w_gaussian;  // gaussian window
       ImageView<PrecisionT> err;  // errors
-      ImageView<PrecisionT> w_local; // weights in local coordinate frame
       ImageView<PrecisionT> p; // posterior probabilities of data in window
 
       AffineTransformOrigin T;
@@ -26,6 +26,10 @@
 #include <vw/Camera/CameraModel.h>
 #include <vw/Stereo/StereoModel.h>
 #include <vw/Core/Exception.h>
+#include <vw/Core/ThreadPool.h>
+
+#include <algorithm>
+#include <typeinfo>
 using namespace std;
 
 namespace vw { namespace stereo { namespace detail {
@@ -48,6 +52,57 @@ namespace vw { namespace stereo { namespace detail {
       return output;
     }
   };
+
+  // The threshold on 1 - cos(angle) below which rays count as parallel.
+  double parallel_tolerance(bool least_squares, double angle_tol) {
+    // This threshold was chosen empirically for now, but should
+    // probably be revisited once a more rigorous analysis has
+    // been completed. -mbroxton (11-MAR-07)
+    if (angle_tol > 0) return angle_tol; // can be over-ridden from the outside
+    return least_squares ? 1e-5 : 1e-4;
+  }
+
+  // Triangulates a band of rows of a disparity map, one row per batch.
+  class TriangulateRowsTask : public Task {
+    StereoModel const& m_model;
+    ImageView<PixelMask<Vector2f> > const& m_disparity;
+    ImageView<Vector3>& m_xyz;
+    ImageView<double>& m_error;
+    int32 m_row_begin, m_row_end;
+  public:
+    TriangulateRowsTask(StereoModel const& model,
+                        ImageView<PixelMask<Vector2f> > const& disparity,
+                        ImageView<Vector3>& xyz, ImageView<double>& error,
+                        int32 row_begin, int32 row_end) :
+      m_model(model), m_disparity(disparity), m_xyz(xyz), m_error(error),
+      m_row_begin(row_begin), m_row_end(row_end) {}
+
+    void operator()() {
+      vector<Vector2> pix1, pix2;
+      vector<Vector3> points;
+      vector<double>  errors;
+      vector<int32>   cols;
+      for (int32 y = m_row_begin; y < m_row_end; y++) {
+        pix1.clear(); pix2.clear(); cols.clear();
+        for (int32 x = 0; x < m_disparity.cols(); x++) {
+          PixelMask<Vector2f> const& disp = m_disparity(x,y);
+          if ( is_valid(disp) ) {
+            cols.push_back(x);
+            pix1.push_back(Vector2(x, y));
+            pix2.push_back(Vector2(x + disp[0], y + disp[1]));
+          } else {
+            m_xyz(x,y) = Vector3();
+            m_error(x,y) = 0;
+          }
+        }
+        m_model.triangulate(pix1, pix2, points, errors);
+        for (size_t k = 0; k < cols.size(); k++) {
+          m_xyz(cols[k],y) = points[k];
+          m_error(cols[k],y) = errors[k];
+        }
+      }
+    }
+  };
 }
   
 // Constructor with n cameras
@@ -77,15 +132,7 @@ bool StereoModel::are_nearly_parallel(bool least_squares,
   // rays.  The threshold of 1e-4 corresponds to a convergence of less
   // than theta = 0.81 degrees, so if the two rays are within 0.81
   // degrees of being parallel, we reject this point.
-  //
-  // This threshold was chosen empirically for now, but should
-  // probably be revisited once a more rigorous analysis has
-  // been completed. -mbroxton (11-MAR-07)
-  double tol;
-  if (least_squares) tol = 1e-5;
-  else               tol = 1e-4;
-
-  if (angle_tol > 0) tol = angle_tol; // can be over-ridden from the outside
+  double tol = detail::parallel_tolerance(least_squares, angle_tol);
 
   bool are_par = true;
   for (int p = 0; p < int(camDirs.size()) - 1; p++){
@@ -181,6 +228,92 @@ Vector3 StereoModel::operator()(Vector2 const& pix1, Vector2 const& pix2,
   return result;
 }
 
+void StereoModel::triangulate(vector<Vector2> const& pix1, vector<Vector2> const& pix2,
+                              vector<Vector3>& points, vector<double>& errors) const {
+  VW_ASSERT(pix1.size() == pix2.size(),
+            vw::ArgumentErr() << "StereoModel::triangulate: the pixel lists differ in size.\n");
+  size_t n = pix1.size();
+  points.assign(n, Vector3());
+  errors.assign(n, 0.0);
+
+  // A subclass may triangulate differently, so it is asked pixel by pixel.
+  if (typeid(*this) != typeid(StereoModel) || m_cameras.size() != 2) {
+    for (size_t i = 0; i < n; i++)
+      points[i] = (*this)(pix1[i], pix2[i], errors[i]);
+    return;
+  }
+
+  // Only pairs where both pixels are valid get rays.
+  vector<size_t>  index;
+  vector<Vector2> valid1, valid2;
+  index.reserve(n); valid1.reserve(n); valid2.reserve(n);
+  for (size_t i = 0; i < n; i++) {
+    if (pix1[i] != pix1[i] || pix1[i] == camera::CameraModel::invalid_pixel() ||
+        pix2[i] != pix2[i] || pix2[i] == camera::CameraModel::invalid_pixel())
+      continue;
+    index.push_back(i);
+    valid1.push_back(pix1[i]);
+    valid2.push_back(pix2[i]);
+  }
+  size_t m = index.size();
+
+  vector<Vector3> dir1, dir2, ctr1, ctr2;
+  try {
+    m_cameras[0]->pixels_to_vectors(valid1, dir1);
+    m_cameras[1]->pixels_to_vectors(valid2, dir2);
+    m_cameras[0]->camera_centers   (valid1, ctr1);
+    m_cameras[1]->camera_centers   (valid2, ctr2);
+  } catch (const camera::PixelToRayErr& /*e*/) {
+    // Some pixel in the batch has no ray; the single pixel path
+    // finds out which.
+    for (size_t k = 0; k < m; k++)
+      points[index[k]] = (*this)(valid1[k], valid2[k], errors[index[k]]);
+    return;
+  }
+
+  // The two ray case of triangulate_point() and the reflection of
+  // operator(), written out per component with no branches so that
+  // the compiler can vectorize the loop over the batch.
+  double tol = detail::parallel_tolerance(m_least_squares, m_angle_tol);
+  vector<Vector3> result(m), error(m);
+  vector<uint8>   usable(m), reflect(m);
+  for (size_t k = 0; k < m; k++) {
+    double const *d1 = &dir1[k][0], *d2 = &dir2[k][0], *c1 = &ctr1[k][0], *c2 = &ctr2[k][0];
+    double v12[3] = { d1[1]*d2[2] - d1[2]*d2[1], d1[2]*d2[0] - d1[0]*d2[2], d1[0]*d2[1] - d1[1]*d2[0] };
+    double v1[3]  = { v12[1]*d1[2] - v12[2]*d1[1], v12[2]*d1[0] - v12[0]*d1[2], v12[0]*d1[1] - v12[1]*d1[0] };
+    double v2[3]  = { v12[1]*d2[2] - v12[2]*d2[1], v12[2]*d2[0] - v12[0]*d2[2], v12[0]*d2[1] - v12[1]*d2[0] };
+    double c21[3] = { c2[0]-c1[0], c2[1]-c1[1], c2[2]-c1[2] };
+    double c12[3] = { c1[0]-c2[0], c1[1]-c2[1], c1[2]-c2[2] };
+    double s1 = (v2[0]*c21[0] + v2[1]*c21[1] + v2[2]*c21[2]) / (v2[0]*d1[0] + v2[1]*d1[1] + v2[2]*d1[2]);
+    double s2 = (v1[0]*c12[0] + v1[1]*c12[1] + v1[2]*c12[2]) / (v1[0]*d2[0] + v1[1]*d2[1] + v1[2]*d2[2]);
+    double *r = &result[k][0], *e = &error[k][0];
+    for (int j = 0; j < 3; j++) {
+      double p1 = c1[j] + s1*d1[j], p2 = c2[j] + s2*d2[j];
+      e[j] = p1 - p2;
+      r[j] = 0.5 * (p1 + p2);
+    }
+    usable [k] = 1 - (d1[0]*d2[0] + d1[1]*d2[1] + d1[2]*d2[2]) >= tol;
+    reflect[k] = ((r[0]-c1[0])*d1[0] + (r[1]-c1[1])*d1[1] + (r[2]-c1[2])*d1[2]) < 0 ||
+                 ((r[0]-c2[0])*d2[0] + (r[1]-c2[1])*d2[1] + (r[2]-c2[2])*d2[2]) < 0;
+  }
+
+  for (size_t k = 0; k < m; k++) {
+    if (!usable[k])
+      continue; // Nearly parallel rays
+    Vector3 point = result[k];
+    if (m_least_squares) {
+      // Refining moves the point, so reflection is decided again
+      refine_point(valid1[k], valid2[k], point);
+      reflect[k] = dot_prod(point - ctr1[k], dir1[k]) < 0 ||
+                   dot_prod(point - ctr2[k], dir2[k]) < 0;
+    }
+    if (reflect[k])
+      point = -point + 2*ctr1[k];
+    points[index[k]] = point;
+    errors[index[k]] = norm_2(error[k]);
+  }
+}
+
 double StereoModel::convergence_angle(Vector2 const& pix1, Vector2 const& pix2) const {
   return acos(dot_prod(m_cameras[0]->pixel_to_vector(pix1),
                        m_cameras[1]->pixel_to_vector(pix2)));
@@ -292,7 +425,8 @@ void StereoModel::refine_point(Vector2 const& pix1,
 
 ImageView<Vector3>
 StereoModel::operator()(ImageView<PixelMask<Vector2f> > const& disparity_map,
-                        ImageView<double> &error) const {
+                        ImageView<double> &error,
+                        int num_threads) const {
   
   // Error analysis
   double mean_error = 0.0;
@@ -304,36 +438,39 @@ StereoModel::operator()(ImageView<PixelMask<Vector2f> > const& disparity_map,
   ImageView<Vector3> xyz(disparity_map.cols(), disparity_map.rows());
   error.set_size(disparity_map.cols(), disparity_map.rows());
 
-  // Compute 3D position for each pixel in the disparity map
+  // Compute 3D position for each pixel in the disparity map, a band
+  // of rows per task and a row per batch.
   vw_out() << "StereoModel: Applying camera models\n";
-  for (int32 y = 0; y < disparity_map.rows(); y++) {
-    if (y % 100 == 0) {
-      printf("\tStereoModel computing points: %0.2f%% complete.\r", 100.0f*float(y)/disparity_map.rows());
-      fflush(stdout);
+  if (num_threads <= 1) {
+    detail::TriangulateRowsTask task(*this, disparity_map, xyz, error, 0, disparity_map.rows());
+    task();
+  } else {
+    const int32 band = 16;
+    FifoWorkQueue queue(num_threads);
+    for (int32 y = 0; y < disparity_map.rows(); y += band) {
+      boost::shared_ptr<Task> task(new detail::TriangulateRowsTask(*this, disparity_map, xyz, error, y,
+                                                                   std::min(y + band, disparity_map.rows())));
+      queue.add_task(task);
     }
+    queue.join_all();
+  }
+
+  for (int32 y = 0; y < disparity_map.rows(); y++) {
     for (int32 x = 0; x < disparity_map.cols(); x++) {
-      if ( is_valid(disparity_map(x,y)) ) {
-        xyz(x,y) = (*this)(Vector2( x, y),
-                           Vector2( x+disparity_map(x,y)[0],
-                                    y+disparity_map(x,y)[1]),
-                           error(x,y) );
-
-        if (error(x,y) >= 0) {
-          // Keep track of error statistics
-          if (error(x,y) > max_error)
-            max_error = error(x,y);
-          mean_error += error(x,y);
-            ++point_count;
-        } else {
-          // rays diverge or are parallel
-          xyz(x,y) = Vector3();
-          divergent++;
-        }
+      if ( !is_valid(disparity_map(x,y)) )
+        continue;
+      if (error(x,y) >= 0) {
+        // Keep track of error statistics
+        if (error(x,y) > max_error)
+          max_error = error(x,y);
+        mean_error += error(x,y);
+        ++point_count;
       } else {
+        // rays diverge or are parallel
         xyz(x,y) = Vector3();
-        error(x,y) = 0;
-      }
+        divergent++;
       }
+    }
   }
 
   if (divergent != 0)
@@ -21,6 +21,8 @@
 
 #include <vw/Math/Vector.h>
 
+#include <vector>
+
 namespace vw {
 
   template <class PixelT> class ImageView;
@@ -62,10 +64,13 @@ namespace stereo {
     /// in zero vector pixels in the point image.
     ///
     /// Users really shouldn't use this method, the ideal method is
-    /// the 'stereo_triangulate' in StereoView.h.
+    /// the 'stereo_triangulate' in StereoView.h.  Bands of rows are
+    /// triangulated on num_threads threads; the camera models must
+    /// be safe to call concurrently when that is more than one.
     ImageView<Vector3> operator()(ImageView<PixelMask<Vector2f> > const&
                                   disparity_map,
-                                  ImageView<double> &error ) const;
+                                  ImageView<double> &error,
+                                  int num_threads = 1 ) const;
 
     /// Apply a stereo model to multiple or just two image coordinates.
     /// Returns an xyz point. The error is set to 0 if triangulation
@@ -75,6 +80,17 @@ namespace stereo {
     virtual Vector3 operator()(Vector2              const& pix1,   Vector2 const& pix2, Vector3& errorVec ) const;
     virtual Vector3 operator()(Vector2              const& pix1,   Vector2 const& pix2, double & error    ) const;
 
+    /// Triangulate many pixel pairs at once, such as a row of a
+    /// disparity map.  The rays for the whole batch come from one
+    /// pixels_to_vectors() and camera_centers() call per camera, and
+    /// the closest approach is solved over the batch in a single
+    /// loop.  The results match the two pixel operator() above,
+    /// including zero points and errors where triangulation fails.
+    /// Subclasses, and models with more than two cameras, are
+    /// triangulated through operator() a pixel at a time.
+    void triangulate(std::vector<Vector2> const& pix1, std::vector<Vector2> const& pix2,
+                     std::vector<Vector3>& points, std::vector<double>& errors) const;
+
     /// Returns the dot product of the two rays emanating from camera
     /// 1 and camera 2 through pix1 and pix2 respectively.  This can
     /// effectively be interpreted as the angle (in radians) between
@@ -24,6 +24,7 @@
 #include <vw/Image/PixelTypes.h>
 #include <vw/Stereo/StereoModel.h>
 #include <limits>
+#include <vector>
 
 namespace vw {
 
@@ -122,7 +123,36 @@ namespace stereo {
     /// \cond INTERNAL
     typedef StereoView<typename DisparityImageT::prerasterize_type> prerasterize_type;
     inline prerasterize_type prerasterize( BBox2i const& bbox ) const { return prerasterize_type( m_disparity_map.prerasterize(bbox), m_stereo_model ); }
-    template <class DestT> inline void rasterize( DestT const& dest, BBox2i const& bbox ) const { vw::rasterize( prerasterize(bbox), dest, bbox ); }
+    /// Triangulates a row at a time through StereoModel::triangulate().
+    template <class DestT> inline void rasterize( DestT const& dest, BBox2i const& bbox ) const {
+      typedef typename DestT::pixel_type     DestPixelT;
+      typedef typename DestT::pixel_accessor DestAccT;
+      VW_ASSERT( int(dest.cols())==bbox.width() && int(dest.rows())==bbox.height(),
+                 ArgumentErr() << "rasterize: Source and destination must have same dimensions." );
+      typename DisparityImageT::prerasterize_type disparity = m_disparity_map.prerasterize(bbox);
+      std::vector<Vector2> pix1, pix2;
+      std::vector<Vector3> points;
+      std::vector<double>  errors;
+      DestAccT drow = dest.origin();
+      for ( int32 j = bbox.min().y(); j < bbox.max().y(); j++ ) {
+        pix1.clear(); pix2.clear();
+        for ( int32 i = bbox.min().x(); i < bbox.max().x(); i++ ) {
+          if ( !is_valid(disparity(i,j)) )
+            continue;
+          pix1.push_back( Vector2(i,j) );
+          pix2.push_back( Vector2(i,j) + DispHelper(disparity(i,j)) );
+        }
+        m_stereo_model.triangulate( pix1, pix2, points, errors );
+        // For missing pixels in the disparity map, we return a null 3D position.
+        DestAccT dcol = drow;
+        size_t k = 0;
+        for ( int32 i = bbox.min().x(); i < bbox.max().x(); i++ ) {
+          *dcol = is_valid(disparity(i,j)) ? DestPixelT( points[k++] ) : DestPixelT();
+          dcol.next_col();
+        }
+        drow.next_row();
+      }
+    }
     /// \endcond
   };
 
@@ -212,3 +212,50 @@ TEST_F( CorrelationU8, CrossCorrelation ) {
   ASSERT_TRUE( is_valid(disparity(10,10)) );
   CheckResult( disparity );
 }
+
+TEST_F( CorrelationGRAYU8, CensusTransform ) {
+  result_type disparity =
+    calc_disparity( CENSUS_TRANSFORM,
+                    input1, input2,
+                    bounding_box( input1 ),
+                    search_volume, kernel_size );
+  ASSERT_EQ( 19, disparity.cols() );
+  ASSERT_EQ( 21, disparity.rows() );
+  ASSERT_TRUE( is_valid(disparity(10,10)) );
+  CheckResult( disparity );
+}
+
+TEST_F( CorrelationGRAYF32, TernaryCensusTransform ) {
+  result_type disparity =
+    calc_disparity( TERNARY_CENSUS_TRANSFORM,
+                    input1, input2,
+                    bounding_box( input1 ),
+                    search_volume, kernel_size );
+  ASSERT_EQ( 19, disparity.cols() );
+  ASSERT_EQ( 21, disparity.rows() );
+  ASSERT_TRUE( is_valid(disparity(10,10)) );
+  CheckResult( disparity );
+}
+
+TEST_F( CorrelationGRAYU8, PrecomputedCensus ) {
+  // Descriptors of the whole images, matched a region at a time
+  CostFunctionType types[2] = { CENSUS_TRANSFORM, TERNARY_CENSUS_TRANSFORM };
+  for ( int t = 0; t < 2; t++ ) {
+    ImageView<uint64> left_census, right_census;
+    census_descriptors( types[t], input1, left_census  );
+    census_descriptors( types[t], input2, right_census );
+    result_type whole =
+      calc_census_disparity( left_census, right_census, bounding_box( input1 ),
+                             search_volume, kernel_size );
+    EXPECT_EQ( 19, whole.cols() );
+    EXPECT_EQ( 21, whole.rows() );
+    CheckResult( whole );
+
+    BBox2i region( 4, 6, 15, 12 );
+    result_type part =
+      calc_census_disparity( left_census, right_census, region, search_volume, kernel_size );
+    EXPECT_EQ( 9, part.cols() );
+    EXPECT_EQ( 8, part.rows() );
+    CheckResult( part );
+  }
+}
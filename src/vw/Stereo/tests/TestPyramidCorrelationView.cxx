@@ -169,6 +169,33 @@ TEST_F( PyramidViewGRAYU8, NullPreprocess ) {
   ASSERT_EQ( input1.cols(), disparity_map.cols() );
   ASSERT_EQ( input1.rows(), disparity_map.rows() );
   check_error( disparity_map, .90, .990, "Cross Correlation" );
+
+  // Census costs match crops of one transform per pyramid level
+  disparity_map =
+    pyramid_correlate( input1, input2,
+                       constant_view(uint8(255), input1),
+                       constant_view(uint8(255), input2),
+                       PREFILTER_NONE, 0,
+                       search_volume, kernel_size,
+                       CENSUS_TRANSFORM,
+                       corr_timeout, seconds_per_op,
+                       2, 0, filter_radius, max_levels );
+  ASSERT_EQ( input1.cols(), disparity_map.cols() );
+  ASSERT_EQ( input1.rows(), disparity_map.rows() );
+  check_error( disparity_map, .90, .990, "Census Transform" );
+
+  disparity_map =
+    pyramid_correlate( input1, input2,
+                       constant_view(uint8(255), input1),
+                       constant_view(uint8(255), input2),
+                       PREFILTER_NONE, 0,
+                       search_volume, kernel_size,
+                       TERNARY_CENSUS_TRANSFORM,
+                       corr_timeout, seconds_per_op,
+                       2, 0, filter_radius, max_levels );
+  ASSERT_EQ( input1.cols(), disparity_map.cols() );
+  ASSERT_EQ( input1.rows(), disparity_map.rows() );
+  check_error( disparity_map, .90, .990, "Ternary Census Transform" );
 }
 
 TEST_F( PyramidViewGRAYI16, NullPreprocess ) {
@@ -410,3 +437,82 @@ TEST_F( PyramidViewU8, NullPreprocess ) {
   ASSERT_EQ( input1.rows(), disparity_map.rows() );
   check_error( disparity_map, .90, .990, "Cross Correlation" );
 }
+
+TEST_F( PyramidViewGRAYU8, BlobFilter ) {
+  ImageView<PixelMask<Vector2i> > unfiltered =
+    pyramid_correlate( input1, input2,
+                       constant_view(uint8(255), input1),
+                       constant_view(uint8(255), input2),
+                       PREFILTER_NONE, 0,
+                       search_volume, kernel_size,
+                       ABSOLUTE_DIFFERENCE,
+                       corr_timeout, seconds_per_op,
+                       -1, 0, filter_radius, max_levels );
+  ImageView<PixelMask<Vector2i> > disparity_map =
+    pyramid_correlate( input1, input2,
+                       constant_view(uint8(255), input1),
+                       constant_view(uint8(255), input2),
+                       PREFILTER_NONE, 0,
+                       search_volume, kernel_size,
+                       ABSOLUTE_DIFFERENCE,
+                       corr_timeout, seconds_per_op,
+                       -1, 0, filter_radius, max_levels,
+                       CORRELATION_WINDOW, 0, SemiGlobalMatcher::SUBPIXEL_LC_BLEND,
+                       Vector2i(2,2), 6000, 40 );
+  ASSERT_EQ( input1.cols(), disparity_map.cols() );
+  ASSERT_EQ( input1.rows(), disparity_map.rows() );
+  check_error( disparity_map, .909, .99, "Blob Filter" );
+
+  // Filtering only removes pixels
+  for ( int32 j = 0; j < disparity_map.rows(); j++ )
+    for ( int32 i = 0; i < disparity_map.cols(); i++ )
+      if ( is_valid(disparity_map(i,j)) ) {
+        EXPECT_TRUE( is_valid(unfiltered(i,j)) );
+      }
+}
+
+TEST_F( PyramidViewGRAYU8, SearchSeed ) {
+  ImageView<uint8> mask1 = constant_view(uint8(255), input1);
+  ImageView<uint8> mask2 = constant_view(uint8(255), input2);
+  PyramidCorrelationView<image_type, image_type, ImageView<uint8>, ImageView<uint8> > view =
+    pyramid_correlate( input1, input2, mask1, mask2,
+                       PREFILTER_NONE, 0,
+                       search_volume, kernel_size,
+                       ABSOLUTE_DIFFERENCE,
+                       corr_timeout, seconds_per_op,
+                       -1, 0, filter_radius, max_levels );
+  view.set_search_seed_level( 2 );
+  // Several tiles, all seeded from the one low resolution pass
+  ImageView<PixelMask<Vector2i> > disparity_map = block_rasterize( view, Vector2i(100,100), 1 );
+  ASSERT_EQ( input1.cols(), disparity_map.cols() );
+  ASSERT_EQ( input1.rows(), disparity_map.rows() );
+  check_error( disparity_map, .909, .99, "Search Seed" );
+}
+
+TEST_F( PyramidViewGRAYU8, CensusTransform ) {
+  ImageView<PixelMask<Vector2i> > disparity_map =
+    pyramid_correlate( input1, input2,
+                       constant_view(uint8(255), input1),
+                       constant_view(uint8(255), input2),
+                       PREFILTER_NONE, 0,
+                       search_volume, kernel_size,
+                       CENSUS_TRANSFORM,
+                       corr_timeout, seconds_per_op,
+                       -1, 0, filter_radius, max_levels );
+  ASSERT_EQ( input1.cols(), disparity_map.cols() );
+  ASSERT_EQ( input1.rows(), disparity_map.rows() );
+  check_error( disparity_map, .90, .990, "Census Transform" );
+
+  disparity_map =
+    pyramid_correlate( input1, input2,
+                       constant_view(uint8(255), input1),
+                       constant_view(uint8(255), input2),
+                       PREFILTER_NONE, 0,
+                       search_volume, kernel_size,
+                       TERNARY_CENSUS_TRANSFORM,
+                       corr_timeout, seconds_per_op,
+                       2, 0, filter_radius, max_levels );
+  ASSERT_EQ( input1.cols(), disparity_map.cols() );
+  ASSERT_EQ( input1.rows(), disparity_map.rows() );
+  check_error( disparity_map, .90, .990, "Ternary Census Transform" );
+}
@@ -227,3 +227,70 @@ TEST( StereoView, Float ) {
   EXPECT_VECTOR_NEAR( lpc(2,0), Vector3(0.769,0,0.769), 1e-2 );
 
 }
+
+TEST( StereoModel, Triangulate ) {
+  boost::shared_ptr<CameraModel> pin1( new camera::PinholeModel( Vector3(), math::identity_matrix<3>(), 20, 20, 15, 10 ) );
+  boost::shared_ptr<CameraModel> pin2( new camera::PinholeModel( Vector3(1,0,0), math::identity_matrix<3>(), 20, 20, 15, 10 ) );
+  camera::AdjustedCameraModel adj1( pin1 ), adj2( pin2 );
+  adj1.set_rotation( euler_to_quaternion( M_PI/80, M_PI/120, M_PI/150, "xyz" ) );
+  adj2.set_rotation( euler_to_quaternion( M_PI/90, M_PI/130, M_PI/99, "xyz" ) );
+  adj1.set_translation( Vector3( 0.2, 0.14, 0.033 ) );
+
+  // Valid, missing, parallel and backwards disparities
+  ImageView<PixelMask<Vector2f> > disparity( 40, 30 );
+  for ( int32 j = 0; j < disparity.rows(); j++ )
+    for ( int32 i = 0; i < disparity.cols(); i++ ) {
+      if ( (i + j) % 7 == 0 )
+        continue;
+      disparity(i,j) = PixelMask<Vector2f>( Vector2f( -10 + 0.37*i - 0.21*j, 0.05*j ) );
+    }
+  disparity(5,5) = PixelMask<Vector2f>( Vector2f( 0, 0 ) );
+  disparity(6,5) = PixelMask<Vector2f>( Vector2f( 25, 0 ) );
+
+  for ( int lsq = 0; lsq < 2; lsq++ ) {
+    StereoModel model( &adj1, &adj2, lsq );
+    // Refinement stops at its own tolerance, so tiny differences in
+    // the starting point show through.
+    double tol = lsq ? 1e-4 : 1e-9;
+
+    std::vector<Vector2> pix1, pix2;
+    for ( int32 j = 0; j < disparity.rows(); j++ )
+      for ( int32 i = 0; i < disparity.cols(); i++ ) {
+        pix1.push_back( Vector2(i,j) );
+        pix2.push_back( is_valid(disparity(i,j)) ? Vector2(i,j) + DispHelper(disparity(i,j))
+                                                 : CameraModel::invalid_pixel() );
+      }
+    std::vector<Vector3> points;
+    std::vector<double>  errors;
+    model.triangulate( pix1, pix2, points, errors );
+    ASSERT_EQ( pix1.size(), points.size() );
+    ASSERT_EQ( pix1.size(), errors.size() );
+
+    ImageView<Vector3> view = StereoView<ImageView<PixelMask<Vector2f> > >( disparity, model );
+    ImageView<double> image_error;
+    ImageView<Vector3> image = model( disparity, image_error );
+
+    int32 zero = 0;
+    for ( size_t k = 0; k < pix1.size(); k++ ) {
+      double error;
+      Vector3 expected = model( pix1[k], pix2[k], error );
+      if ( expected == Vector3() )
+        zero++;
+      int32 i = pix1[k][0], j = pix1[k][1];
+      EXPECT_VECTOR_NEAR( expected, points[k], tol * (1 + norm_2(expected)) );
+      EXPECT_NEAR( error, errors[k], tol );
+      EXPECT_VECTOR_NEAR( expected, view(i,j), tol * (1 + norm_2(expected)) );
+
+      // The whole image version adds the disparity in single precision
+      if ( is_valid(disparity(i,j)) )
+        expected = model( Vector2(i,j), Vector2( i+disparity(i,j)[0], j+disparity(i,j)[1] ), error );
+      else
+        error = 0;
+      EXPECT_VECTOR_NEAR( expected, image(i,j), tol * (1 + norm_2(expected)) );
+      EXPECT_NEAR( error, image_error(i,j), tol );
+    }
+    // At least the missing pixels and the parallel pair
+    EXPECT_LE( 172, zero );
+    EXPECT_GT( 600, zero );
+  }
+}
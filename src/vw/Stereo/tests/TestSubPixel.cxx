@@ -21,6 +21,7 @@
 
 #include <vw/Image.h>
 #include <vw/Stereo/SubpixelView.h>
+#include <vw/Stereo/EMSubpixelCorrelatorView.h>
 #include <vw/FileIO.h>
 #include <boost/foreach.hpp>
 #include <boost/random/linear_congruential.hpp>
@@ -193,3 +194,32 @@ TEST_F( SubPixelCorrelate70Test, BayesEM70 ) {
   EXPECT_LT(error, 0.9);
   EXPECT_LE(invalid_count, 48);
 }
+
+// Testing the EM Subpixel Correlator
+//--------------------------------------------------------------
+TEST_F( SubPixelCorrelate95Test, EMSubpixel ) {
+  stereo::EMSubpixelCorrelatorView<float32>
+    view( channel_cast_rescale<float32>(image1),
+          channel_cast_rescale<float32>(image2), starting_disp );
+  view.set_kernel_size( Vector2i(11,11) );
+  view.set_pyramid_levels( 2 );
+
+  BBox2i roi( 40, 40, 20, 20 );
+  ImageView<PixelMask<Vector<float,5> > > result = crop( view, roi );
+  // The second pass reuses the first pass's workspace
+  ImageView<PixelMask<Vector<float,5> > > again = crop( view, roi );
+
+  int32 valid_count = 0;
+  double error = 0;
+  for ( int32 j = 0; j < roi.height(); j++ )
+    for ( int32 i = 0; i < roi.width(); i++ ) {
+      EXPECT_TRUE( result(i,j) == again(i,j) );
+      if ( !is_valid(result(i,j)) )
+        continue;
+      valid_count++;
+      float expected = stretch * float(i+roi.min().x()) + translation - (i+roi.min().x());
+      error += fabs(result(i,j)[0] - expected) + fabs(result(i,j)[1]);
+    }
+  ASSERT_GT( valid_count, roi.width()*roi.height()/2 );
+  EXPECT_LT( error / valid_count, 0.5 );
+}
@@ -34,7 +34,10 @@
 
 #include <vw/Core/Log.h>
 #include <vw/Core/ProgressCallback.h>
+#include <vw/Core/Settings.h>
+#include <vw/Core/Thread.h>
 #include <vw/Image.h>
+#include <vw/Image/Contours.h>
 #include <vw/FileIO.h>
 
 #include <cmath>
@@ -46,25 +49,6 @@ namespace po = boost::program_options;
 // fwd declaration of function in FitCurves.cpp
 BezierContour FitCurve(PointContour &contour, double error);
 
-vw::ImageView<float> load_dem_from_file(std::string file_in) {
-    //    Open the file for reading
-    vw::ImageView<float> dem;
-    boost::shared_ptr<vw::DiskImageResource> r( vw::DiskImageResourcePtr(file_in) );
-    
-    vw::vw_out(vw::InfoMessage) << "Loading DEM from file" << std::endl;
-    vw::vw_out(vw::DebugMessage) << r->rows()
-        << "x" << r->cols() << "x" << r->planes()
-        << "  " << r->channels() << " channel(s)"
-        << " type: " << r->type()
-        << " pxfmt: " << r->pixel_format()
-        << " chtype: " << r->channel_type()
-        << "\n";
-    //    Read the data
-    //tpc.set_progress_text("Status (loading image):   " );
-    vw::read_image(dem, *r);
-    return dem;
-}
-
 void read_segments_from_file(SegmentList &segment_list,
         std::string file_in, int &rows, int &cols)
 {
@@ -229,14 +213,30 @@ void draw_point_contours(PointContourSet cset,
     }
 }
 
-void draw_Bezier_contours(BezierContourSet bcset, Cairo::RefPtr<Cairo::Context> cr, float nodataval) {
-    vw::vw_out(vw::InfoMessage) << "Writing Bezier contours to output surface\n";
-    BezierContourSet::iterator bcset_iter;
+void set_Bezier_line_style(Cairo::RefPtr<Cairo::Context> cr) {
     double line_width;
     line_width = 2.0;
     //cr->device_to_user_distance(line_width, tmp);
     cr->set_line_width(line_width);
     cr->set_source_rgb(0.0, 0.0, 1.0);
+}
+
+void draw_Bezier_contour(BezierContour const& contour, Cairo::RefPtr<Cairo::Context> cr) {
+    BezierContour::const_iterator c_iter = contour.begin();
+    cr->begin_new_path();
+    cr->move_to((*c_iter)[0][0], (*c_iter)[0][1]);
+    while (++c_iter != contour.end()) {
+        cr->curve_to((*c_iter)[1][0], (*c_iter)[1][1],
+                     (*c_iter)[2][0], (*c_iter)[2][1],
+                     (*c_iter)[3][0], (*c_iter)[3][1]);
+    }
+    cr->stroke();
+}
+
+void draw_Bezier_contours(BezierContourSet bcset, Cairo::RefPtr<Cairo::Context> cr, float nodataval) {
+    vw::vw_out(vw::InfoMessage) << "Writing Bezier contours to output surface\n";
+    BezierContourSet::iterator bcset_iter;
+    set_Bezier_line_style(cr);
 
     int level = int(nodataval);
     for (bcset_iter = bcset.begin(); bcset_iter != bcset.end(); bcset_iter++) {
@@ -244,21 +244,41 @@ void draw_Bezier_contours(BezierContourSet bcset, Cairo::RefPtr<Cairo::Context>
         if (newlevel != level) {
             level = newlevel;
         }
-
-        BezierContour contour = (*bcset_iter).second;
-        BezierContour::iterator c_iter = contour.begin();
-        cr->begin_new_path();
-        cr->move_to((*c_iter)[0][0], (*c_iter)[0][1]);
-        while (++c_iter != contour.end()) {
-            cr->curve_to((*c_iter)[1][0], (*c_iter)[1][1],
-                         (*c_iter)[2][0], (*c_iter)[2][1],
-                         (*c_iter)[3][0], (*c_iter)[3][1]);
-        }
-        cr->stroke();
+        draw_Bezier_contour((*bcset_iter).second, cr);
     }
 }
 
+// Contour sinks for tiled_contours: each finished polyline is written
+// out as soon as it arrives instead of being collected first. Lines
+// can arrive from several threads at once, so the output is locked;
+// the curve fitting happens before taking the lock.
+struct BezierContourDrawer {
+    Cairo::RefPtr<Cairo::Context> cr;
+    double error;
+    boost::shared_ptr<vw::Mutex> mutex;
 
+    void operator()(int /*level*/, PointContour const& contour) const {
+        PointContour c = contour;
+        BezierContour bc = FitCurve(c, error);
+        vw::Mutex::Lock lock(*mutex);
+        draw_Bezier_contour(bc, cr);
+    }
+};
+
+struct ContourSegmentWriter {
+    std::ofstream* ofs;
+    boost::shared_ptr<vw::Mutex> mutex;
+
+    void operator()(int level, PointContour const& contour) const {
+        vw::Mutex::Lock lock(*mutex);
+        PointContour::const_iterator a = contour.begin(), b = a;
+        for (++b; b != contour.end(); ++a, ++b) {
+            *ofs << std::setprecision(8) << std::fixed
+                 << (*a)[0] << "\t" << (*a)[1] << "\t" << (*b)[0] << "\t"
+                 << (*b)[1] << "\t" << level << std::endl;
+        }
+    }
+};
 
 void write_points_to_file(std::string file_out, SegmentList segment_list, int rows, int cols) {
     vw::vw_out(vw::InfoMessage) << "Writing contour points to text file\n";
@@ -298,6 +318,10 @@ int main(int argc, char *argv[])
             "set \"NO DATA\" value")
         ("contour-interval,c", po::value<int>()->default_value(100),
             "set contour interval")
+        ("tile-size,t", po::value<int>()->default_value(256),
+            "contour the DEM in tiles of this many cells on a side")
+        ("threads", po::value<int>()->default_value(0),
+            "number of threads to contour with (0 for the default)")
     ;
 
     po::options_description hidden("Hidden options");
@@ -344,6 +368,10 @@ int main(int argc, char *argv[])
     std::string output_type = vm["output-type"].as<std::string>();
     float nodataval = vm["no-data-value"].as<float>();
     int cint = vm["contour-interval"].as<int>();
+    int tile_size = vm["tile-size"].as<int>();
+    int num_threads = vm["threads"].as<int>();
+    if (num_threads <= 0)
+        num_threads = vw::vw_settings().default_num_threads();
 
     vw::vw_log().console_log().rule_set().clear();
     vw::vw_log().console_log().rule_set().add_rule(vw::WarningMessage, "console");
@@ -372,10 +400,11 @@ int main(int argc, char *argv[])
     vw::vw_out(vw::DebugMessage) << "Image file: " << image_file << std::endl;
     vw::vw_out(vw::DebugMessage) << "No-data value: " << nodataval << std::endl;
     vw::vw_out(vw::DebugMessage) << "Contour interval: " << cint << std::endl;
+    vw::vw_out(vw::DebugMessage) << "Tile size: " << tile_size << std::endl;
+    vw::vw_out(vw::DebugMessage) << "Threads: " << num_threads << std::endl;
 
     // done parsing options
 
-    vw::ImageView<float> dem;
     //TerminalProgressCallback tpc();
     PointContourSet cset;
     SegmentList segment_list;
@@ -383,41 +412,56 @@ int main(int argc, char *argv[])
     float error = 1.0e-3;
 
     if (input_type == "tiff") {
-        // 1. Load DEM from file
-        dem = load_dem_from_file(file_in);
+        // Contour the DEM tile by tile straight off disk, writing each
+        // contour out as soon as it is finished.
+        vw::vw_out(vw::InfoMessage) << "Running tiled marching squares\n";
+        vw::DiskImageView<float> dem(file_in);
         rows = dem.rows();
         cols = dem.cols();
 
-        // 2. Run contouring algorithm on DEM
-        conrec(dem, cset, cint, nodataval, segment_list);
-
+        if (output_type == "text") {
+            vw::vw_out(vw::InfoMessage) << "Writing contour points to text file\n";
+            std::ofstream ofs(file_out.c_str());
+            ofs << rows << "\t" << cols << std::endl;
+            ContourSegmentWriter writer;
+            writer.ofs = &ofs;
+            writer.mutex.reset(new vw::Mutex);
+            vw::tiled_contours(dem, writer, cint, nodataval, tile_size, num_threads);
+        } else {
+            BezierContourDrawer drawer;
+            drawer.cr = create_output_surface(output_type, cols, rows, image_file, file_out);
+            drawer.error = error;
+            drawer.mutex.reset(new vw::Mutex);
+            set_Bezier_line_style(drawer.cr);
+            vw::tiled_contours(dem, drawer, cint, nodataval, tile_size, num_threads);
+            write_output_file(drawer.cr, output_type, file_out);
+        }
     }
     else if (input_type == "text") {
         // read contour segments from file
         read_segments_from_file(segment_list, file_in, rows, cols);
-    }
-
-    if (output_type == "text") {
-        write_points_to_file(file_out, segment_list, rows, cols);
 
-    } else { // SVG or PNG
-        // Load segments into point contour set
-        load_segments_into_pcs(segment_list, cset);
+        if (output_type == "text") {
+            write_points_to_file(file_out, segment_list, rows, cols);
 
-        // Fit Bezier curves to contours
-        BezierContourSet bcset;
-        fit_Bezier_curves_to_contours(cset, bcset, error);
+        } else { // SVG or PNG
+            // Load segments into point contour set
+            load_segments_into_pcs(segment_list, cset);
 
-        Cairo::RefPtr<Cairo::Context> cr;
+            // Fit Bezier curves to contours
+            BezierContourSet bcset;
+            fit_Bezier_curves_to_contours(cset, bcset, error);
 
-        cr = create_output_surface(output_type, cols, rows, image_file, file_out);
+            Cairo::RefPtr<Cairo::Context> cr;
 
-        //Draw contours onto surface
-        //draw_point_contours(cset, cr, nodataval);
-        draw_Bezier_contours(bcset, cr, nodataval);
+            cr = create_output_surface(output_type, cols, rows, image_file, file_out);
 
-        write_output_file(cr, output_type, file_out);
+            //Draw contours onto surface
+            //draw_point_contours(cset, cr, nodataval);
+            draw_Bezier_contours(bcset, cr, nodataval);
 
+            write_output_file(cr, output_type, file_out);
+        }
     }
 
     return 0;
@@ -23,6 +23,7 @@
 #endif
 
 #include <vw/Core/Debugging.h>
+#include <vw/Core/Metrics.h>
 #include <vw/Math/Geometry.h>
 #include <vw/Math/RANSAC.h>
 #include <vw/Math/Vector.h>
@@ -68,6 +69,8 @@ int main( int argc, char *argv[] ) {
   Matrix3x3 alignment;
   float mask_value;
   int   filter_radius;
+  std::string metrics_file;
+  double metrics_period;
 
   po::options_description desc("Options");
   desc.add_options()
@@ -98,6 +101,8 @@ int main( int argc, char *argv[] ) {
     ("sgm",        "Use the SGM stereo algorithm.")
     ("sgm-smooth", "Use the smoothed version of the SGM stereo algorithm.")
     ("debug",      "Write out debugging images")
+    ("metrics-file",       po::value(&metrics_file),   "Write runtime metrics to this file, or to the log if not given")
+    ("metrics-period",     po::value(&metrics_period)->default_value(0), "Dump runtime metrics every this many seconds (0 to disable)")
     ;
   po::positional_options_description p;
   p.add("left", 1);
@@ -130,154 +135,175 @@ int main( int argc, char *argv[] ) {
   if (tile_size > 0)
     vw::vw_settings().set_default_tile_size(tile_size);
 
-  // If the user provided a match file, use it to align the images.
-  std::string match_filename = fs::path( left_file_name ).replace_extension().string() + "__" +
-                               fs::path( right_file_name ).stem().string() + ".match";
-  if ( fs::exists( match_filename ) ) {
-    vw_out() << "Found a match file. Using it to pre-align images.\n";
-    std::vector<ip::InterestPoint> matched_ip1, matched_ip2;
-    ip::read_binary_match_file( match_filename,
-                                matched_ip1, matched_ip2 );
-    std::vector<Vector3> ransac_ip1 = ip::iplist_to_vectorlist(matched_ip1);
-    std::vector<Vector3> ransac_ip2 = ip::iplist_to_vectorlist(matched_ip2);
-    vw::math::RandomSampleConsensus<vw::math::HomographyFittingFunctor, vw::math::InterestPointErrorMetric> 
-        ransac( vw::math::HomographyFittingFunctor(), vw::math::InterestPointErrorMetric(), 100, 30, ransac_ip1.size()/2, true );
-    alignment = ransac( ransac_ip2, ransac_ip1 );
-
-    DiskImageView<PixelGray<float> > right_disk_image( right_file_name );
-    right_file_name = "aligned_right.tif";
-    write_image( right_file_name, transform(right_disk_image, HomographyTransform(alignment)),
-                 TerminalProgressCallback( "tools.correlate", "Aligning: ") );
-    found_alignment = true;
-  }
+  // The metrics dump is stopped, writing one last time, however the
+  // correlation ends, so the file shows how far it got.
+  try {
+    if (metrics_period > 0)
+      start_metrics_dump(metrics_file, metrics_period);
+
+    // If the user provided a match file, use it to align the images.
+    std::string match_filename = fs::path( left_file_name ).replace_extension().string() + "__" +
+                                 fs::path( right_file_name ).stem().string() + ".match";
+    if ( fs::exists( match_filename ) ) {
+      vw_out() << "Found a match file. Using it to pre-align images.\n";
+      std::vector<ip::InterestPoint> matched_ip1, matched_ip2;
+      ip::read_binary_match_file( match_filename,
+                                  matched_ip1, matched_ip2 );
+      std::vector<Vector3> ransac_ip1 = ip::iplist_to_vectorlist(matched_ip1);
+      std::vector<Vector3> ransac_ip2 = ip::iplist_to_vectorlist(matched_ip2);
+      vw::math::RandomSampleConsensus<vw::math::HomographyFittingFunctor, vw::math::InterestPointErrorMetric> 
+          ransac( vw::math::HomographyFittingFunctor(), vw::math::InterestPointErrorMetric(), 100, 30, ransac_ip1.size()/2, true );
+      alignment = ransac( ransac_ip2, ransac_ip1 );
+
+      DiskImageView<PixelGray<float> > right_disk_image( right_file_name );
+      right_file_name = "aligned_right.tif";
+      write_image( right_file_name, transform(right_disk_image, HomographyTransform(alignment)),
+                   TerminalProgressCallback( "tools.correlate", "Aligning: ") );
+      found_alignment = true;
+    }
 
-  // Load input images
-  DiskImageView<PixelGray<float> > left_disk_image (left_file_name );
-  DiskImageView<PixelGray<float> > right_disk_image(right_file_name );
-  int cols = std::min(left_disk_image.cols(),right_disk_image.cols());
-  int rows = std::min(left_disk_image.rows(),right_disk_image.rows());
-  ImageViewRef<PixelGray<float> > left  = edge_extend(left_disk_image, 0,0,cols,rows);
-  ImageViewRef<PixelGray<float> > right = edge_extend(right_disk_image,0,0,cols,rows);
-
-  // Set up masks
-  ImageView<uint8> left_mask  = constant_view( uint8(255), left );
-  ImageView<uint8> right_mask = constant_view( uint8(255), right);
-  if (vm.count("mask-value")) {
-    left_mask  = apply_mask(copy_mask(left_mask,  create_mask(left,  mask_value)), 0);
-    right_mask = apply_mask(copy_mask(right_mask, create_mask(right, mask_value)), 0);
+    // Load input images
+    DiskImageView<PixelGray<float> > left_disk_image (left_file_name );
+    DiskImageView<PixelGray<float> > right_disk_image(right_file_name );
+    int cols = std::min(left_disk_image.cols(),right_disk_image.cols());
+    int rows = std::min(left_disk_image.rows(),right_disk_image.rows());
+    ImageViewRef<PixelGray<float> > left  = edge_extend(left_disk_image, 0,0,cols,rows);
+    ImageViewRef<PixelGray<float> > right = edge_extend(right_disk_image,0,0,cols,rows);
+
+    // Set up masks
+    ImageView<uint8> left_mask  = constant_view( uint8(255), left );
+    ImageView<uint8> right_mask = constant_view( uint8(255), right);
+    if (vm.count("mask-value")) {
+      left_mask  = apply_mask(copy_mask(left_mask,  create_mask(left,  mask_value)), 0);
+      right_mask = apply_mask(copy_mask(right_mask, create_mask(right, mask_value)), 0);
     
-    write_image("correlate_left_mask.tif", left_mask);
-    write_image("correlate_right_mask.tif", right_mask);
-  }
+      write_image("correlate_left_mask.tif", left_mask);
+      write_image("correlate_right_mask.tif", right_mask);
+    }
 
-  bool write_debug_images = (vm.count("debug"));
-
-  stereo::CostFunctionType corr_type;
-  switch(correlator_type) {
-    case 0: corr_type = ABSOLUTE_DIFFERENCE;      break;
-    case 1: corr_type = SQUARED_DIFFERENCE;       break;
-    case 2: corr_type = CROSS_CORRELATION;        break;
-    case 3: corr_type = CENSUS_TRANSFORM;         break;
-    case 4: corr_type = TERNARY_CENSUS_TRANSFORM; break;
-    default: vw_throw( NoImplErr() << "Invalid correlation type entered!\n" );
-  };
-
-  CorrelationAlgorithm stereo_algorithm = CORRELATION_WINDOW;
-  if (vm.count("sgm") != 0)
-    stereo_algorithm = CORRELATION_SGM;
-  if (vm.count("sgm-smooth") != 0)
-    stereo_algorithm = CORRELATION_MGM;
-
-  // TODO: Hook up to options!
-  SemiGlobalMatcher::SgmSubpixelMode sgm_subpixel_mode = SemiGlobalMatcher::SUBPIXEL_LC_BLEND;
-  Vector2i sgm_search_buffer(4,3);
-  size_t memory_limit_mb = 1024*4;
-
-  ImageViewRef<PixelMask<Vector2f> > disparity_map;
-  int corr_timeout = 0;
-  double seconds_per_op = 0.0;
-  BBox2i search_range(Vector2i(h_corr_min, v_corr_min), 
-                      Vector2i(h_corr_max, v_corr_max));
-  Vector2i kernel_size(xkernel, ykernel);
-  std::cout << "Correlate max search range = " << search_range << std::endl;
-  disparity_map =
-    stereo::pyramid_correlate( left,      right,
-                               left_mask, right_mask,
-                               stereo::PREFILTER_LOG, log,
-                               search_range, kernel_size,
-                               corr_type, corr_timeout, seconds_per_op,
-                               lrthresh, min_lr_level,
-                               filter_radius, max_pyramid_levels, 
-                               stereo_algorithm, collar_size,
-                               sgm_subpixel_mode,
-                               sgm_search_buffer,
-                               memory_limit_mb,
-                               blob_filter_area,
-                               write_debug_images);
-
-  // TODO: Call the code used in stereo_fltr!
-
-/*
-
-// TODO: Debug code for experimenting with disparity filtering code.
-  int texture_smooth_range = 15;
-  float texture_max_percentage = 0.85;
-  int max_kernel_size = 13;
-
-  std::cout << "Generating texture image...\n";
-  ImageView<float> texture_image;
-  ImageView<float> leftR = left;
-  float max_texture = texture_measure(leftR, texture_image, texture_smooth_range);
-  write_image( "texture_image.tif", texture_image );
-
-  std::cout << "Rasterizing disparity image...\n";
-  ImageView<PixelMask<Vector2f> > disparity_map_raster = disparity_map;
-  //disparity_map.rasterize(disparity_map_raster, bounding_box(disparity_map));
+    bool write_debug_images = (vm.count("debug"));
+
+    stereo::CostFunctionType corr_type;
+    switch(correlator_type) {
+      case 0: corr_type = ABSOLUTE_DIFFERENCE;      break;
+      case 1: corr_type = SQUARED_DIFFERENCE;       break;
+      case 2: corr_type = CROSS_CORRELATION;        break;
+      case 3: corr_type = CENSUS_TRANSFORM;         break;
+      case 4: corr_type = TERNARY_CENSUS_TRANSFORM; break;
+      default: vw_throw( NoImplErr() << "Invalid correlation type entered!\n" );
+    };
+
+    CorrelationAlgorithm stereo_algorithm = CORRELATION_WINDOW;
+    if (vm.count("sgm") != 0)
+      stereo_algorithm = CORRELATION_SGM;
+    if (vm.count("sgm-smooth") != 0)
+      stereo_algorithm = CORRELATION_MGM;
+
+    // TODO: Hook up to options!
+    SemiGlobalMatcher::SgmSubpixelMode sgm_subpixel_mode = SemiGlobalMatcher::SUBPIXEL_LC_BLEND;
+    Vector2i sgm_search_buffer(4,3);
+    size_t memory_limit_mb = 1024*4;
+
+    ImageViewRef<PixelMask<Vector2f> > disparity_map;
+    int corr_timeout = 0;
+    double seconds_per_op = 0.0;
+    BBox2i search_range(Vector2i(h_corr_min, v_corr_min), 
+                        Vector2i(h_corr_max, v_corr_max));
+    Vector2i kernel_size(xkernel, ykernel);
+    std::cout << "Correlate max search range = " << search_range << std::endl;
+    disparity_map =
+      stereo::pyramid_correlate( left,      right,
+                                 left_mask, right_mask,
+                                 stereo::PREFILTER_LOG, log,
+                                 search_range, kernel_size,
+                                 corr_type, corr_timeout, seconds_per_op,
+                                 lrthresh, min_lr_level,
+                                 filter_radius, max_pyramid_levels, 
+                                 stereo_algorithm, collar_size,
+                                 sgm_subpixel_mode,
+                                 sgm_search_buffer,
+                                 memory_limit_mb,
+                                 blob_filter_area,
+                                 write_debug_images);
+
+    // TODO: Call the code used in stereo_fltr!
+
+  /*
+
+  // TODO: Debug code for experimenting with disparity filtering code.
+    int texture_smooth_range = 15;
+    float texture_max_percentage = 0.85;
+    int max_kernel_size = 13;
+
+    std::cout << "Generating texture image...\n";
+    ImageView<float> texture_image;
+    ImageView<float> leftR = left;
+    float max_texture = texture_measure(leftR, texture_image, texture_smooth_range);
+    write_image( "texture_image.tif", texture_image );
+
+    std::cout << "Rasterizing disparity image...\n";
+    ImageView<PixelMask<Vector2f> > disparity_map_raster = disparity_map;
+    //disparity_map.rasterize(disparity_map_raster, bounding_box(disparity_map));
   
-  std::cout << "Filtering disparity image...\n";
-  ImageView<PixelMask<Vector2f> > disparity_map_filtered;
-  texture_preserving_disparity_filter(disparity_map_raster, disparity_map_filtered, texture_image, 
-                                      texture_max_percentage*max_texture, max_kernel_size);
+    std::cout << "Filtering disparity image...\n";
+    ImageView<PixelMask<Vector2f> > disparity_map_filtered;
+    texture_preserving_disparity_filter(disparity_map_raster, disparity_map_filtered, texture_image, 
+                                        texture_max_percentage*max_texture, max_kernel_size);
   
-  write_image( "texture_filtered_disp.tif", disparity_map_filtered );
-  //write_image( "subpixel_disp.tif", disparity );
-  //write_image( "subpixel_deltas.tif", deltas );
+    write_image( "texture_filtered_disp.tif", disparity_map_filtered );
+    //write_image( "subpixel_disp.tif", disparity );
+    //write_image( "subpixel_deltas.tif", deltas );
   
-  std::cout << "Done!\n";
-
-
-*/
-
-  //ImageViewRef<PixelMask<Vector2f> > result = pixel_cast<PixelMask<Vector2f> >(disparity_map);
-  if ( found_alignment )
-    disparity_map = transform_disparities(disparity_map, HomographyTransform(alignment) );
-
-  // Actually invoke the raster
-  {
-    vw::Timer corr_timer("Correlation Time");
-    cartography::GdalWriteOptions geo_opt;
-    geo_opt.raster_tile_size = Vector2i(1024, 1024);
-    if (stereo_algorithm == CORRELATION_WINDOW) {
-      block_write_gdal_image("disparity.tif", disparity_map, geo_opt);
-    }
-    else { // SGM/MGM needs to be rasterized in a single tile.
-      ImageView<PixelMask<Vector2f> > result = disparity_map;
-      block_write_gdal_image("disparity.tif", result, geo_opt);
+    std::cout << "Done!\n";
+
+
+  */
+
+    //ImageViewRef<PixelMask<Vector2f> > result = pixel_cast<PixelMask<Vector2f> >(disparity_map);
+    if ( found_alignment )
+      disparity_map = transform_disparities(disparity_map, HomographyTransform(alignment) );
+
+    // Actually invoke the raster
+    {
+      vw::Timer corr_timer("Correlation Time");
+      cartography::GdalWriteOptions geo_opt;
+      geo_opt.raster_tile_size = Vector2i(1024, 1024);
+      if (stereo_algorithm == CORRELATION_WINDOW) {
+        block_write_gdal_image("disparity.tif", disparity_map, geo_opt);
+      }
+      else { // SGM/MGM needs to be rasterized in a single tile.
+        ImageView<PixelMask<Vector2f> > result = disparity_map;
+        block_write_gdal_image("disparity.tif", result, geo_opt);
+      }
     }
-  }
 
-  //// Write disparity debug images
-  //DiskImageView<PixelMask<Vector2i> > solution("disparity.tif");
-  //BBox2 disp_range = get_disparity_range(solution);
-  //std::cout << "Found disparity range: " << disp_range << "\n";
-
-  // Are these working properly?
-  //write_image( "x_disparity.tif",
-  //             channel_cast<uint8>(apply_mask(copy_mask(clamp(normalize(select_channel(solution,0), 
-  //                                 disp_range.min().x(), disp_range.max().x(),0,255)),solution))) );
-  //write_image( "y_disparity.tif",
-  //             channel_cast<uint8>(apply_mask(copy_mask(clamp(normalize(select_channel(solution,1), 
-  //                                 disp_range.min().y(), disp_range.max().y(),0,255)),solution))) );
+    //// Write disparity debug images
+    //DiskImageView<PixelMask<Vector2i> > solution("disparity.tif");
+    //BBox2 disp_range = get_disparity_range(solution);
+    //std::cout << "Found disparity range: " << disp_range << "\n";
+
+    // Are these working properly?
+    //write_image( "x_disparity.tif",
+    //             channel_cast<uint8>(apply_mask(copy_mask(clamp(normalize(select_channel(solution,0), 
+    //                                 disp_range.min().x(), disp_range.max().x(),0,255)),solution))) );
+    //write_image( "y_disparity.tif",
+    //             channel_cast<uint8>(apply_mask(copy_mask(clamp(normalize(select_channel(solution,1), 
+    //                                 disp_range.min().y(), disp_range.max().y(),0,255)),solution))) );
+
+    stop_metrics_dump();
+  } catch ( const Exception& e ) {
+    stop_metrics_dump();
+    std::cerr << "\n\nVW Error: " << e.what() << std::endl;
+    return 1;
+  } catch ( const std::bad_alloc& e ) {
+    stop_metrics_dump();
+    std::cerr << "\n\nError: Ran out of Memory!" << std::endl;
+    return 1;
+  } catch ( const std::exception& e ) {
+    stop_metrics_dump();
+    std::cerr << "\n\nError: " << e.what() << std::endl;
+    return 1;
+  }
 
   return 0;
 }
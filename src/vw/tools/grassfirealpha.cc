@@ -18,6 +18,8 @@
 #include <vw/Core/FundamentalTypes.h>
 #include <vw/Core/Log.h>
 #include <vw/Image/Algorithms.h>
+#include <vw/Image/BlockRasterize.h>
+#include <vw/Image/DistanceTransform.h>
 #include <vw/Image/ImageIO.h>
 #include <vw/Image/ImageView.h>
 #include <vw/Image/ImageViewRef.h>
@@ -156,6 +158,22 @@ struct Options {
   float blur_sigma;
 };
 
+// Distance from the edge of the data, computed a block at a time.  It
+// only needs to go as far as the feather length.  Without one the full
+// range is needed first, so the distances are rasterized once, in
+// parallel blocks, and both the range and the blend come from that.
+template <class ImageT>
+ImageViewRef<float32> feather_distance( ImageViewBase<ImageT> const& data, Options& opt ) {
+  if (opt.feather_max >= 1)
+    return EuclideanDistanceView<ImageT>( data.impl(), opt.feather_max );
+
+  int32 block_size = vw_settings().default_tile_size();
+  ImageView<float32> distance =
+    block_rasterize( EuclideanDistanceView<ImageT>( data.impl() ), Vector2i( block_size, block_size ) );
+  opt.feather_max = max_pixel_value( distance );
+  return distance;
+}
+
 // Operation code for data that uses nodata
 template <class PixelT>
 void grassfire_nodata( Options& opt,
@@ -167,15 +185,12 @@ void grassfire_nodata( Options& opt,
   cartography::GeoReference georef;
   cartography::read_georeference(georef, input);
   DiskImageView<PixelT> input_image(input);
-  ImageView<int32> distance =
-    grassfire(notnodata(input_image,
-                        inter_type(opt.nodata)));
-
-  // Check to see if the user has specified a feather length.  If not,
-  // then we send the feather_max to the max pixel value (which
-  // results in a full grassfire blend all the way to the center of the image.)
-  if (opt.feather_max < 1)
-    opt.feather_max = max_pixel_value( distance );
+  // If the user hasn't specified a feather length, feather_max is
+  // set to the max distance (which results in a full grassfire blend
+  // all the way to the center of the image.)
+  ImageViewRef<float32> distance =
+    feather_distance(notnodata(input_image,
+                               inter_type(opt.nodata)), opt);
   vw_out() << "\t--> Distance range: [ " << opt.feather_min << " " << opt.feather_max << " ]\n";
 
   ImageViewRef<inter_type> norm_dist;
@@ -214,13 +229,10 @@ void grassfire_alpha( Options& opt,
   cartography::GeoReference georef;
   cartography::read_georeference(georef, input);
   DiskImageView<PixelT> input_image(input);
-  ImageView<int32> distance = grassfire(apply_mask(invert_mask(alpha_to_mask(input_image)),1));
-
-  // Check to see if the user has specified a feather length.  If not,
-  // then we send the feather_max to the max pixel value (which
-  // results in a full grassfire blend all the way to the center of the image.)
-  if (opt.feather_max < 1)
-    opt.feather_max = max_pixel_value( distance );
+  // If the user hasn't specified a feather length, feather_max is
+  // set to the max distance (which results in a full grassfire blend
+  // all the way to the center of the image.)
+  ImageViewRef<float32> distance = feather_distance(apply_mask(invert_mask(alpha_to_mask(input_image)),1), opt);
   vw_out() << "\t--> Distance range: [ " << opt.feather_min << " " << opt.feather_max << " ]\n";
 
   typedef typename CompoundChannelType<PixelT>::type inter_type;
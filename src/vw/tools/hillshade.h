@@ -29,9 +29,11 @@
 #include <vw/Image/PixelMask.h>
 #include <vw/Image/MaskViews.h>
 #include <vw/Image/PerPixelAccessorViews.h>
+#include <vw/Image/TerrainDerivatives.h>
 #include <vw/FileIO/DiskImageView.h>
 #include <vw/FileIO/DiskImageResource.h>
 #include <vw/Cartography/GeoReference.h>
+#include <vw/Cartography/GeoReferenceUtils.h>
 #include <vw/tools/Common.h>
 
 namespace vw{
@@ -45,22 +47,6 @@ namespace vw{
     cartography::GeoReference georef;
     cartography::read_georeference(georef, input_file_name);
 
-    // Select the pixel scale.
-    float u_scale, v_scale;
-    if (scale == 0) {
-      if (georef.is_projected()) {
-        u_scale = georef.transform()(0,0);
-        v_scale = georef.transform()(1,1);
-      } else {
-        double meters_per_degree = 2*M_PI*georef.datum().semi_major_axis()/360.0;
-        u_scale = georef.transform()(0,0) * meters_per_degree;
-        v_scale = georef.transform()(1,1) * meters_per_degree;
-      }
-    } else {
-      u_scale = scale;
-      v_scale = -scale;
-    }
-
     // Set the direction of the light source.
     Vector3f light_0(1,0,0);
     Vector3f light = vw::math::euler_to_rotation_matrix(elevation*M_PI/180, azimuth*M_PI/180, 0, "yzx") * light_0;
@@ -89,9 +75,20 @@ namespace vw{
       dem = gaussian_filter(dem, blur_sigma);
     }
 
+    // Select the pixel spacing, per row for geographic DEMs.
+    std::vector<double> x_spacing, y_spacing;
+    if (scale == 0) {
+      cartography::dem_pixel_spacing(georef, dem.rows(), x_spacing, y_spacing);
+    } else {
+      x_spacing.assign(dem.rows(), scale);
+      y_spacing.assign(dem.rows(), -scale);
+    }
+
     // The final result is the dot product of the light source with the normals
+    ImageViewRef<PixelMask<float> > shade =
+      terrain_derivative(dem, TerrainHillshade, x_spacing, y_spacing, HornStencil, Vector3(light));
     ImageViewRef<PixelMask<PixelGray<uint8> > > shaded_image =
-      channel_cast_rescale<uint8>(clamp(dot_prod(compute_normals(dem, u_scale, v_scale), light)));
+      channel_cast_rescale<uint8>(clamp(pixel_cast<PixelMask<PixelGray<float> > >(shade)));
 
     // Save the result
     vw_out() << "Writing shaded relief image: " << output_file_name << "\n";
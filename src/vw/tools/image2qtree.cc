@@ -183,6 +183,8 @@ int handle_options(int argc, char *argv[], Options& opt) {
   po::options_description general_options("Description: Turns georeferenced image(s) into a quadtree with geographical metadata\n\nGeneral Options");
   general_options.add_options()
     ("output-name,o", po::value(&opt.output_file_name), "Specify the base output directory")
+    ("metrics-file",   po::value(&opt.metrics_file),   "Write runtime metrics to this file, or to the log if not given")
+    ("metrics-period", po::value(&opt.metrics_period), "Dump runtime metrics every this many seconds (default: off)")
     ("help,h",        po::bool_switch(&opt.help),       "Display this help message");
 
 
@@ -219,8 +221,12 @@ const std::string projection_options_str = "DEFAULT, NONE, SINUSOIDAL, MERCATOR,
     ("max-lod-pixels"   , po::value(&opt.kml.max_lod_pixels)->default_value(1024), "Max LoD in pixels, or -1 for none (kml only)")
     ("draw-order-offset", po::value(&opt.kml.draw_order_offset)->default_value(0), "Offset for the <drawOrder> tag for this overlay (kml only)")
     ("multiband"        , po::bool_switch(&opt.multiband)                        , "Composite images using multi-band blending")
+    ("feather"          , po::bool_switch(&opt.feather)                          , "Composite images by feathering their overlaps")
+    ("seam"             , po::bool_switch(&opt.seam)                             , "Composite images with a seam through their overlaps")
+    ("blend-radius"     , po::value(&opt.blend_radius)->default_value(32)        , "Width in pixels of the feathering, or of the seam's margin inside the upper image")
     ("aspect-ratio"     , po::value(&opt.aspect_ratio)                           , "Pixel aspect ratio (for polar overlays; should be a power of two)")
-    ("global-resolution", po::value(&opt.global_resolution)                      , "Override the global pixel resolution; should be a power of two");
+    ("global-resolution", po::value(&opt.global_resolution)                      , "Override the global pixel resolution; should be a power of two")
+    ("transform-grid-cache", po::value(&opt.transform_grid_cache)                , "Reproject each input through one lookup grid, saved in this directory and reused by later runs with the same georeferences");
 
   po::options_description projection_options("Input Projection Options");
   projection_options.add_options()
@@ -321,18 +327,27 @@ int main(int argc, char **argv) {
   if (!handle_options(argc, argv, opt))
     return 1;
 
+  // The metrics dump is stopped, writing one last time, however run()
+  // ends, so the file shows how far it got.
   try {
+    if ( opt.metrics_period > 0 )
+      start_metrics_dump( opt.metrics_file, opt.metrics_period );
     run(opt);
+    stop_metrics_dump();
   } catch ( const ArgumentErr& e ) {
+    stop_metrics_dump();
     vw_out() << e.what() << std::endl;
     return 1;
   } catch ( const Exception& e ) {
+    stop_metrics_dump();
     std::cerr << "\n\nVW Error: " << e.what() << std::endl;
     return 1;
   } catch ( const std::bad_alloc& e ) {
+    stop_metrics_dump();
     std::cerr << "\n\nError: Ran out of Memory!" << std::endl;
     return 1;
   } catch ( const std::exception& e ) {
+    stop_metrics_dump();
     std::cerr << "\n\nError: " << e.what() << std::endl;
     return 1;
   }
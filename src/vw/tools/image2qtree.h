@@ -21,9 +21,12 @@
 
 #include <vw/Core/ProgressCallback.h>
 #include <vw/Core/Log.h>
+#include <vw/Core/Metrics.h>
+#include <vw/Core/Settings.h>
 #include <vw/Math/BBox.h>
 #include <vw/Math/Vector.h>
 #include <vw/Image/Transform.h>
+#include <vw/Image/TransformGrid.h>
 #include <vw/Image/MaskViews.h>
 #include <vw/FileIO/DiskImageResource.h>
 #include <vw/FileIO/DiskImageResourceJPEG.h>
@@ -41,9 +44,12 @@
 #include <vw/tools/Common.h>
 
 #include <fstream>
+#include <sstream>
 
 #include <boost/algorithm/string/trim.hpp>
 #include <boost/smart_ptr/shared_ptr.hpp>
+#include <boost/filesystem/operations.hpp>
+#include <boost/filesystem/path.hpp>
 #include <boost/filesystem/path_traits.hpp>
 #include <boost/foreach.hpp>
 namespace fs = boost::filesystem;
@@ -73,6 +79,10 @@ struct Options {
     east(0), west(0),
     channel_type("DEFAULT"),
     multiband(false),
+    feather(false),
+    seam(false),
+    blend_radius(32),
+    metrics_period(0),
     help(false),
     normalize(false),
     terrain(false),
@@ -100,6 +110,12 @@ struct Options {
   std::string mode; // Quadtree type
 
   bool multiband;
+  bool feather;
+  bool seam;
+  int  blend_radius;
+  std::string metrics_file;
+  double      metrics_period;
+  std::string transform_grid_cache;
   bool help;
   bool normalize;
   bool terrain;
@@ -312,6 +328,15 @@ void do_mosaic(const Options& opt, const vw::ProgressCallback *progress) {
         BBox2i correction(-geotx.reverse(geotx.forward(Vector2()))[0],0,source.cols(),source.rows());
         source = crop(transform_only( crop( interpolate(source), correction ),
                                       geotx ), bbox );
+      } else if ( !opt.transform_grid_cache.empty() ) {
+        // One lookup grid for the whole reprojection, shared by every
+        // tile and kept on disk for the next run with the same georefs.
+        std::ostringstream key;
+        key << input_georef << output_georef;
+        fs::create_directories( opt.transform_grid_cache );
+        fs::path cache = fs::path( opt.transform_grid_cache ) /
+                         ( fs::path( filename ).stem().string() + ".tgrid" );
+        source = transform( source, grid_approximate( geotx, bbox, cache.string(), key.str() ), bbox );
       } else {
         source = transform( source, geotx, bbox );
       }
@@ -355,8 +380,18 @@ void do_mosaic(const Options& opt, const vw::ProgressCallback *progress) {
   }
 
   // Prepare the composite.
-  if(!opt.multiband)
-    composite.set_draft_mode( true );
+  if(opt.multiband)
+    composite.set_blend_mode( mosaic::MultiBandBlend );
+  else if(opt.feather)
+    composite.set_blend_mode( mosaic::FeatherBlend );
+  else if(opt.seam)
+    composite.set_blend_mode( mosaic::SeamBlend );
+  else
+    composite.set_blend_mode( mosaic::DraftBlend );
+  composite.set_blend_radius( opt.blend_radius );
+  // The quadtree asks for one patch at a time, so the composite has
+  // to do its own threading.
+  composite.set_num_threads( vw_settings().default_num_threads() );
   composite.prepare( total_bbox, *progress );
   VW_ASSERT(composite.rows() > 0 && composite.cols() > 0,
             LogicErr() << "Composite image is empty. Georeference calculation is probably incorrect.");
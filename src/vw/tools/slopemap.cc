@@ -20,11 +20,15 @@
 #include <vw/Image/ImageMath.h>
 #include <vw/Image/Algorithms.h>
 #include <vw/Image/Manipulation.h>
+#include <vw/Image/ImageViewRef.h>
+#include <vw/Image/MaskViews.h>
+#include <vw/Image/TerrainDerivatives.h>
 #include <vw/Math/Matrix.h>
 #include <vw/Math/Vector.h>
 #include <vw/Math/LinearAlgebra.h>
 #include <vw/FileIO/DiskImageView.h>
 #include <vw/Cartography/GeoReference.h>
+#include <vw/Cartography/GeoReferenceUtils.h>
 #include <vw/tools/Common.h>
 
 #include <iostream>
@@ -53,11 +57,12 @@ struct Options {
   bool output_pretty; //probably more for debugging purposes than for anything else
   Algorithm algorithm;
   bool spherically_defined;
+  bool per_pixel;
 };
 
 //basic utilities
 
-Vector3 pixel_to_cart (Vector2 pos, double alt, GeoReference GR) {
+Vector3 pixel_to_cart (Vector2 pos, double alt, GeoReference const& GR) {
   Vector2 loc_longlat2=GR.point_to_lonlat(GR.pixel_to_point(pos));
   Vector3 loc_longlat3(loc_longlat2(0),loc_longlat2(1),alt);
   Vector3 loc_cartesian=GR.datum().geodetic_to_cartesian(loc_longlat3);
@@ -65,7 +70,7 @@ Vector3 pixel_to_cart (Vector2 pos, double alt, GeoReference GR) {
 }
 
 template <class ImageT>
-Vector3 pixel_to_cart (Vector2 pos, DiskImageView<ImageT> img, GeoReference GR) {
+Vector3 pixel_to_cart (Vector2 pos, DiskImageView<ImageT> const& img, GeoReference const& GR) {
   return pixel_to_cart(pos,img((int)pos[0],(int)pos[1]),GR);
 }
 
@@ -133,7 +138,7 @@ Vector2 gradient_aspect_from_dtheta_dphi(double rho, double theta, double phi, d
 }
 
 template <class ImageT>
-Vector2 uneven_grid (const ::Options& opt, int x, int y, DiskImageView<ImageT> img, GeoReference GR) {
+Vector2 uneven_grid (const ::Options& opt, int x, int y, DiskImageView<ImageT> const& img, GeoReference const& GR) {
 
   Vector3 center=pixel_to_cart(Vector2(x,y),img,GR);
   Vector3 center_normal=normalize(center);
@@ -220,7 +225,7 @@ Vector2 uneven_grid (const ::Options& opt, int x, int y, DiskImageView<ImageT> i
 }
 
 template <class ImageT>
-Vector2 interpolate_plane (int x, int y, DiskImageView<ImageT> img, GeoReference GR) {
+Vector2 interpolate_plane (int x, int y, DiskImageView<ImageT> const& img, GeoReference const& GR) {
   Matrix<double> A(9,4);
   int i=0;
   int j=0;
@@ -254,6 +259,51 @@ Vector2 interpolate_plane (int x, int y, DiskImageView<ImageT> img, GeoReference
   return gradient_aspect_from_normals(center_normal, plane_normal);
 }
 
+template <class ViewT>
+void write_georeferenced_block_image( std::string const& filename, ImageViewBase<ViewT> const& image,
+                                      GeoReference const& GR ) {
+  boost::scoped_ptr<DiskImageResource> r(DiskImageResource::create(filename, image.format()));
+  if ( r->has_block_write() )
+    r->set_block_write_size( Vector2i( vw_settings().default_tile_size(),
+                                       vw_settings().default_tile_size() ) );
+  write_georeference( *r, GR );
+  block_write_image( *r, image, TerminalProgressCallback( "tools.slopemap", "Writing:") );
+}
+
+// Horn's and Fleming & Hoffer's stencils in the local tangent plane,
+// with the ground spacing found once per row from the datum, written
+// out block by block in parallel. Unlike the per-pixel path, border
+// pixels get the stencil on an edge-extended DEM rather than 0, and
+// aspect is the downslope direction clockwise from north.
+template <class imageT>
+void do_stencil_slopemap (const ::Options &opt, GeoReference const& GR, DiskImageView<imageT> const& img) {
+  std::vector<double> x_spacing, y_spacing;
+  dem_pixel_spacing( GR, img.rows(), x_spacing, y_spacing );
+  TerrainStencil stencil = opt.algorithm == HORN ? HornStencil : ZevenbergenThorneStencil;
+
+  ImageViewRef<PixelMask<float> > gradient_angle =
+    terrain_derivative( pixel_cast<PixelMask<imageT> >(img), TerrainSlope, x_spacing, y_spacing, stencil );
+  ImageViewRef<PixelMask<float> > aspect =
+    terrain_derivative( pixel_cast<PixelMask<imageT> >(img), TerrainAspect, x_spacing, y_spacing, stencil );
+
+  if(opt.output_gradient) write_georeferenced_block_image( opt.output_prefix + "_gradient.tif", apply_mask(gradient_angle), GR );
+  if(opt.output_aspect)   write_georeferenced_block_image( opt.output_prefix + "_aspect.tif",   apply_mask(aspect), GR );
+  if(opt.output_pretty) {
+    ImageView<PixelHSV<double> > pretty(img.cols(),img.rows());
+    ImageView<float> res0 = apply_mask(aspect), res1 = apply_mask(gradient_angle);
+    for(int y=0;y<img.rows();y++)
+      for(int x=0;x<img.cols();x++)
+        pretty(x,y) = PixelHSV<double>(res0(x,y),res1(x,y),(res1(x,y))+0.2*fabs(M_PI-res0(x,y)));
+    select_channel(pretty,0)=normalize(select_channel(pretty,0),0,2*M_PI,0,1);
+    select_channel(pretty,1)=normalize(select_channel(pretty,1),0,M_PI/2,0.1,1);
+    select_channel(pretty,2)=normalize(select_channel(pretty,2),0.3,0.6);
+
+    ImageView<PixelRGB<uint8> > pretty2=pixel_cast_rescale<PixelRGB<uint8> >( copy(pretty) );
+    pretty2=PixelRGB<uint8>(255,255,255)-pretty2;
+    write_image( opt.output_prefix + "_pretty.tif", pretty2);
+  }
+}
+
 template <class imageT>
 void do_slopemap (const ::Options &opt) { //not sure what the arguments are
 
@@ -262,6 +312,11 @@ void do_slopemap (const ::Options &opt) { //not sure what the arguments are
 
   DiskImageView<imageT> img(opt.input_file_name);
 
+  if(!opt.per_pixel && (opt.algorithm==HORN || opt.algorithm==FH)) {
+    do_stencil_slopemap(opt, GR, img);
+    return;
+  }
+
   int x;
   int y;
 
@@ -318,7 +373,8 @@ int main( int argc, char *argv[] ) {
     ("no-gradient", "Do not output gradient")
     ("pretty", "Output colored image.")
     ("opt.algorithm", po::value<std::string>(&algorithm_string)->default_value("horn"), "Choose an algorithm to calculate slope/aspect from [ horn, fh, sa, planefit ]. Horn: Horn's algorithm; FH: Fleming & Hoffer's (rook's case); SA: Sharpnack & Akin's (queen's case)")
-    ("spherical", po::value<bool>(&opt.spherically_defined)->default_value(true), "Spherical/elliptical datum (recommended); otherwise, a flat grid");
+    ("spherical", po::value<bool>(&opt.spherically_defined)->default_value(true), "Spherical/elliptical datum (recommended); otherwise, a flat grid. Only used by sa and by horn and fh with --per-pixel.")
+    ("per-pixel", "Fit horn and fh per pixel as before, instead of with 3x3 stencils in the local tangent plane. The stencils use the ground spacing at each row's latitude, fill the border pixels from an edge-extended DEM instead of leaving them 0, and report aspect as the downslope direction clockwise from north.");
 
   po::positional_options_description p;
   p.add("input-file", 1);
@@ -373,6 +429,7 @@ int main( int argc, char *argv[] ) {
   opt.output_aspect   = !(vm.count("no-aspect"));
   opt.output_gradient = !(vm.count("no-gradient"));
   opt.output_pretty   = vm.count("pretty");
+  opt.per_pixel       = vm.count("per-pixel");
 
   if(!opt.output_aspect && !opt.output_gradient && !opt.output_pretty) {
     vw_out() << "No output specified. Select at least one of [ gradient, output, pretty ].\n"
@@ -36,6 +36,7 @@
 #include <vw/FileIO/DiskImageResource.h>
 #include <vw/Camera/PinholeModel.h>
 #include <vw/Camera/LensDistortion.h>
+#include <vw/Camera/DistortionMap.h>
 #include <vw/FileIO/FileUtils.h>
 #include <vw/tools/Common.h>
 #include <vw/Cartography/GeoReferenceUtils.h>
@@ -51,6 +52,7 @@ namespace fs = boost::filesystem;
 using namespace vw;
 using vw::camera::PinholeModel;
 using vw::camera::LensDistortion;
+using vw::camera::DistortionMap;
 
 // Global variables, to make it easier to invoke the function do_work
 // with many channels and channel types.
@@ -59,6 +61,27 @@ bool preserve_pixel_type = false;
 double output_nodata_value = -std::numeric_limits<float>::max();
 bool output_nodata_value_was_set = false;
 std::string interpolation_method;
+double distortion_map_tolerance = 1e-3;
+
+// Lens distortion in pixel units, looked up in the distortion map
+// where there is one.
+Vector2 distort_pixel(PinholeModel const& camera, DistortionMap const* map,
+                      Vector2 const& pix) {
+  Vector2 result;
+  if (map && map->distorted_pixel(pix, result))
+    return result;
+  const double pitch = camera.pixel_pitch();
+  return camera.lens_distortion()->distorted_coordinates(camera, pix*pitch)/pitch;
+}
+
+Vector2 undistort_pixel(PinholeModel const& camera, DistortionMap const* map,
+                        Vector2 const& pix) {
+  Vector2 result;
+  if (map && map->undistorted_pixel(pix, result))
+    return result;
+  const double pitch = camera.pixel_pitch();
+  return camera.lens_distortion()->undistorted_coordinates(camera, pix*pitch)/pitch;
+}
 
 template <class ImageT>
 class UndistortView: public ImageViewBase< UndistortView<ImageT> >{
@@ -111,17 +134,14 @@ public:
     else
       vw_throw(NoImplErr() << "Unknown interpolation method: " << interpolation_method << "\n");
     
-    const LensDistortion* lens_ptr = m_camera_model.lens_distortion();
-    const double pitch = m_camera_model.pixel_pitch();
+    DistortionMap const* map = m_camera_model.distortion_map().get();
 
     ImageView<result_type> tile(bbox.width(), bbox.height());
 
     for (int col = bbox.min().x(); col < bbox.max().x(); col++){
       for (int row = bbox.min().y(); row < bbox.max().y(); row++){
 
-        Vector2 lens_loc = elem_prod(Vector2(col, row) + m_offset, pitch);
-        Vector2 out_loc  = lens_ptr->distorted_coordinates(m_camera_model, lens_loc);
-        Vector2 in_loc = elem_quot(out_loc, pitch);
+        Vector2 in_loc = distort_pixel(m_camera_model, map, Vector2(col, row) + m_offset);
 
         tile(col - bbox.min().x(), row - bbox.min().y() )
           = interp_dist_img(in_loc[0], in_loc[1]);
@@ -165,30 +185,28 @@ void do_work() {
   
   const int width_in  = dist_img.cols();
   const int height_in = dist_img.rows();
-  const LensDistortion* lens_ptr = camera_model.lens_distortion();
-  const double pitch = camera_model.pixel_pitch();
+
+  // Tabulate the lens distortion once rather than solving for it at
+  // every output pixel.
+  if (distortion_map_tolerance > 0) {
+    vw_out() << "Building the distortion map.\n";
+    camera_model.set_distortion_map
+      (boost::shared_ptr<DistortionMap const>(new DistortionMap(camera_model,
+                                                                Vector2i(width_in, height_in),
+                                                                distortion_map_tolerance)));
+  }
+  DistortionMap const* map = camera_model.distortion_map().get();
 
   // Figure out the size of the undistorted image
   // - Iterate along each side of the image and record where the output pixels go
-  Vector2 out_loc, lens_loc;
   BBox2   output_area;
   for (int r=0; r<height_in; ++r) {
-    lens_loc = elem_prod(Vector2(0, r), pitch);
-    out_loc  = lens_ptr->undistorted_coordinates(camera_model, lens_loc);
-    output_area.grow(elem_quot(out_loc, pitch));
-    
-    lens_loc = elem_prod(Vector2(width_in-1, r), pitch);
-    out_loc  = lens_ptr->undistorted_coordinates(camera_model, lens_loc);
-    output_area.grow(elem_quot(out_loc, pitch));
+    output_area.grow(undistort_pixel(camera_model, map, Vector2(0, r)));
+    output_area.grow(undistort_pixel(camera_model, map, Vector2(width_in-1, r)));
   }
   for (int c=0; c<width_in; ++c) {
-    lens_loc = elem_prod(Vector2(c, 0), pitch);
-    out_loc  = lens_ptr->undistorted_coordinates(camera_model, lens_loc);
-    output_area.grow(elem_quot(out_loc, pitch));
-    
-    lens_loc = elem_prod(Vector2(c, height_in-1), pitch);
-    out_loc  = lens_ptr->undistorted_coordinates(camera_model, lens_loc);
-    output_area.grow(elem_quot(out_loc, pitch));
+    output_area.grow(undistort_pixel(camera_model, map, Vector2(c, 0)));
+    output_area.grow(undistort_pixel(camera_model, map, Vector2(c, height_in-1)));
   }
 
   Vector2 offset = output_area.min();
@@ -393,7 +411,9 @@ int main( int argc, char *argv[] ) {
      "Set the output nodata value. Only applicable if the output is a single-channel image with pixels that are float or double.")
     ("preserve-pixel-type", po::bool_switch(&preserve_pixel_type)->default_value(false),
      "Save the undistorted image with integer pixels if so is the input. This may result in reduced accuracy.")
-    ("interpolation-method",  po::value<std::string>(&interpolation_method)->default_value("bilinear"), "Interpolation method. Options: bilinear, bicubic. Default: bilinear.");
+    ("interpolation-method",  po::value<std::string>(&interpolation_method)->default_value("bilinear"), "Interpolation method. Options: bilinear, bicubic. Default: bilinear.")
+    ("distortion-map-tolerance", po::value(&distortion_map_tolerance)->default_value(1e-3),
+     "Precompute the lens distortion on a grid accurate to this many pixels. Set to 0 to evaluate the lens distortion model at every pixel.");
       
   po::positional_options_description p;
   p.add("input-file", 1);